@@ -41,6 +41,7 @@
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Event.h>
 #include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
 
 /* TI-RTOS Header files */ 
 #include <ti/drivers/Power.h>
@@ -53,6 +54,7 @@
 
 /* Standard C Libraries */
 #include <stdlib.h>
+#include <string.h>
 
 /* EasyLink API Header files */ 
 #include "easylink/EasyLink.h"
@@ -60,6 +62,7 @@
 /* Application Header files */ 
 #include "RadioProtocol.h"
 #include "NodeRadioTask.h"
+#include "NodeRetry.h"
 #include "NodeTask.h"
 
 #include <ti/devices/DeviceFamily.h>
@@ -75,27 +78,111 @@
 #define NODERADIO_TASK_PRIORITY   3
 
 #define RADIO_EVENT_ALL                 0xFFFFFFFF
-#define RADIO_EVENT_SEND_ADC_DATA       (uint32_t)(1 << 0)
+#define RADIO_EVENT_MESSAGE_QUEUED      (uint32_t)(1 << 0)
 #define RADIO_EVENT_DATA_ACK_RECEIVED   (uint32_t)(1 << 1)
 #define RADIO_EVENT_ACK_TIMEOUT         (uint32_t)(1 << 2)
 #define RADIO_EVENT_SEND_FAIL           (uint32_t)(1 << 3)
+#define RADIO_EVENT_BACKOFF_DONE        (uint32_t)(1 << 5)
+#define RADIO_EVENT_BEACON_RECEIVED     (uint32_t)(1 << 6)
+#define RADIO_EVENT_BEACON_MISSED       (uint32_t)(1 << 7)
+#define RADIO_EVENT_JOIN_RESPONSE       (uint32_t)(1 << 8)
+#define RADIO_EVENT_JOIN_BACKOFF_DONE   (uint32_t)(1 << 9)
 #ifdef FEATURE_BLE_ADV
 #define NODE_EVENT_UBLE                 (uint32_t)(1 << 4)
 #endif
 
-#define NODERADIO_MAX_RETRIES 2
-#define NORERADIO_ACK_TIMEOUT_TIME_MS (160)
+/* The radio timer runs at 4 MHz */
+#define NODERADIO_RAT_TICKS_PER_US      4
+
+/* Before sending, the node listens for the concentrator's beacon and then
+ * sends in its TDMA slot, see RadioProtocol.h. The next beacon is predicted
+ * from the last one for up to NODERADIO_TDMA_RESYNC_MS, with the listen
+ * window widened by NODERADIO_TDMA_DRIFT_PPM of the time since. After that,
+ * or when a predicted beacon is missed, the node listens for up to
+ * NODERADIO_TDMA_ACQUIRE_MS. If no beacon comes, the concentrator does not
+ * send them and the next NODERADIO_TDMA_ACQUIRE_SKIP messages are sent with
+ * CCA only. */
+#define NODERADIO_TDMA_RESYNC_MS        300000
+#define NODERADIO_TDMA_DRIFT_PPM        100
+#define NODERADIO_TDMA_ACQUIRE_MS       1100
+#define NODERADIO_TDMA_ACQUIRE_SKIP     16
+
+/* The node gets its address from the concentrator by joining with its IEEE
+ * address. Before every join it waits a random time of 1 to
+ * NODERADIO_JOIN_BACKOFF_MS << (joins tried, at most
+ * NODERADIO_JOIN_BACKOFF_MAX_EXPONENT) ms, so that nodes powered up together,
+ * or told to join again together, spread out. */
+#define NODERADIO_JOIN_BACKOFF_MS             500
+#define NODERADIO_JOIN_BACKOFF_MAX_EXPONENT   6
+
+#define NODERADIO_TX_QUEUE_MASK (NODERADIO_TX_QUEUE_SIZE - 1)
+
+#if RADIO_SENSOR_REPORT_MAX_SIZE(2) > EASYLINK_MAX_DATA_LENGTH
+#error A SensorReport of RADIO_BATCH_MAX_SAMPLES does not fit a packet
+#endif
+
+#if (NODERADIO_TX_QUEUE_SIZE & NODERADIO_TX_QUEUE_MASK) != 0
+#error NODERADIO_TX_QUEUE_SIZE must be a power of two
+#endif
 
 
 /***** Type declarations *****/
 struct RadioOperation {
-    EasyLink_TxPacket easyLinkTxPacket;
     uint8_t retriesDone;
     uint8_t maxNumberOfRetries;
     uint32_t ackTimeoutMs;
+    uint32_t ackWindowMs;   /* Ack window of the current attempt */
+    uint32_t txDoneTime;    /* Radio time when the last attempt was sent */
     enum NodeRadioOperationStatus result;
 };
 
+struct NodeRadioTdma {
+    uint8_t slot;               /* From the last ack, RADIO_TDMA_NO_SLOT if none */
+    uint8_t channel;            /* Channel of the slot, RADIO_CHANNEL_ANY if any */
+    uint8_t channelMask;        /* Channels not blacklisted, from the last beacon */
+    uint8_t tunedChannel;       /* Channel the radio is on */
+    uint32_t baseFrequency;     /* Frequency of channel 0 in Hz */
+    uint32_t channelWaitCount;  /* Beacons skipped waiting for the own channel */
+    uint8_t synced;             /* beaconTime can be used to predict the next beacon */
+    uint8_t acquireSkip;        /* Messages left to send without listening for beacons */
+    uint8_t slotCount;
+    uint32_t beaconTime;        /* Radio time the last beacon was received */
+    uint32_t superframeTicks;
+    uint32_t slotTicks;
+    uint32_t beaconCount;
+    uint32_t missedBeaconCount;
+};
+
+struct NodeRadioJoin {
+    uint8_t ieeeAddr[RADIO_IEEE_ADDRESS_SIZE];
+    uint8_t joined;         /* nodeAddress was given by the concentrator */
+    uint8_t active;         /* The radio operation is a join request */
+    uint8_t waiting;        /* joinClock runs to the next join */
+    uint8_t attempts;       /* Joins started since the last successful one */
+    uint32_t joinCount;
+    uint32_t rejoinCount;   /* Times the concentrator did not know the address */
+};
+
+struct NodeRadioCcaStats {
+    uint32_t deferralCount; /* Times CCA found the channel busy and backed off */
+    uint32_t busyFailCount; /* Attempts given up because the channel stayed busy */
+};
+
+struct NodeRadioMessage {
+    uint8_t sampleCount;
+    uint16_t id;
+    NodeRadio_SendDoneCallback callback;
+    struct NodeRadioSample samples[RADIO_BATCH_MAX_SAMPLES];
+};
+
+struct NodeRadioTxQueue {
+    struct NodeRadioMessage messages[NODERADIO_TX_QUEUE_SIZE];
+    uint8_t head;           /* Written by the submitting tasks with interrupts disabled */
+    uint8_t tail;           /* Only written by the NodeRadioTask */
+    uint16_t lastId;
+    uint32_t rejectedCount; /* Messages not queued because the queue was full */
+};
+
 
 /***** Variable declarations *****/
 static Task_Params nodeRadioTaskParams;
@@ -107,10 +194,38 @@ Event_Struct radioOperationEvent; /* not static so you can see in ROV */
 static Event_Handle radioOperationEventHandle;
 Semaphore_Struct radioResultSem;  /* not static so you can see in ROV */
 static Semaphore_Handle radioResultSemHandle;
+Semaphore_Struct txSlotSem;       /* not static so you can see in ROV */
+static Semaphore_Handle txSlotSemHandle;
+struct NodeRadioTxQueue txQueue;  /* not static so you can see in ROV */
 static struct RadioOperation currentRadioOperation;
+static uint8_t* txPayload;          /* Reserved EasyLink Tx buffer, packets are built in place */
+struct NodeRetry_AckTimer ackTimer; /* not static so you can see in ROV */
+struct NodeRadioCcaStats ccaStats;  /* not static so you can see in ROV */
+struct NodeRadioTdma tdma;          /* not static so you can see in ROV */
+struct NodeRadioJoin join;          /* not static so you can see in ROV */
+static struct JoinResponsePacket joinResponse;
+static struct BeaconPacket receivedBeacon;
+static volatile uint32_t beaconRxTime;
+static volatile uint8_t ackSlot;
+static volatile uint8_t ackChannel;
+static struct NodeConfig ackConfig;
+static uint8_t configVersion = RADIO_CONFIG_NO_VERSION;
+static NodeRadio_ConfigCallback configCallback;
+Clock_Struct backoffClock;        /* not static so you can see in ROV */
+static Clock_Handle backoffClockHandle;
+Clock_Struct joinClock;           /* not static so you can see in ROV */
+static Clock_Handle joinClockHandle;
+static uint32_t backoffRandom;
+static volatile uint32_t ackRxTime;
+static bool radioOperationActive;
+static enum NodeRadioOperationStatus blockingSendResult;
 static uint16_t adcData;
-static uint8_t nodeAddress = 0;
-static struct DualModeSensorPacket dmSensorPacket;
+static uint8_t nodeAddress = RADIO_UNJOINED_ADDRESS;
+static uint8_t rxAddressFilter[2];
+static uint32_t uptime100MiliSec;
+static struct SensorReport sensorReport;
+static struct SensorReportReference reportReference;
+static uint8_t reportSequence;
 
 
 /* previous Tick count used to calculate uptime */
@@ -121,9 +236,32 @@ extern PIN_Handle ledPinHandle;
 
 /***** Prototypes *****/
 static void nodeRadioTaskFunction(UArg arg0, UArg arg1);
+static uint16_t queueMessage(const struct NodeRadioSample* samples, uint8_t count,
+                             NodeRadio_SendDoneCallback callback, uint32_t timeout);
+static void blockingSendDone(enum NodeRadioOperationStatus status, uint16_t messageId);
+static void startNextMessage(void);
+static void startJoin(void);
+static void joinResponseReceived(void);
+static void scheduleJoin(void);
+static void setNodeAddress(uint8_t address);
 static void returnRadioOperationStatus(enum NodeRadioOperationStatus status);
-static void sendDmPacket(struct DualModeSensorPacket sensorPacket, uint8_t maxNumberOfRetries, uint32_t ackTimeoutMs);
+static void updateUptime(void);
+static void sendSensorReport(const struct NodeRadioMessage* message);
+static void startRadioOperation(uint8_t maxNumberOfRetries, uint32_t ackTimeoutMs);
 static void resendPacket(void);
+static void transmitPacket(void);
+static void transmitAt(uint32_t absTime, bool useCca);
+static void commitPacket(uint8_t len);
+static void listenForBeacon(void);
+static void setChannel(uint8_t channel);
+static void beaconReceived(void);
+static void beaconMissed(void);
+static void txDoneCallback(EasyLink_Status status);
+static void beaconRxCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status);
+static void startBackoff(void);
+static void backoffTimeoutCallback(UArg arg0);
+static void joinTimeoutCallback(UArg arg0);
+static uint32_t getRandom(void);
 static void rxDoneCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status);
 
 #ifdef FEATURE_BLE_ADV
@@ -145,6 +283,21 @@ void NodeRadioTask_init(void) {
     Semaphore_construct(&radioResultSem, 0, &semParam);
     radioResultSemHandle = Semaphore_handle(&radioResultSem);
 
+    /* Create counting semaphore of the free send queue slots */
+    Semaphore_construct(&txSlotSem, NODERADIO_TX_QUEUE_SIZE, &semParam);
+    txSlotSemHandle = Semaphore_handle(&txSlotSem);
+
+    /* Create one-shot clock for the wait before a retry */
+    Clock_Params clkParams;
+    Clock_Params_init(&clkParams);
+    clkParams.startFlag = FALSE;
+    Clock_construct(&backoffClock, backoffTimeoutCallback, 1, &clkParams);
+    backoffClockHandle = Clock_handle(&backoffClock);
+
+    /* Create one-shot clock for the wait before a join */
+    Clock_construct(&joinClock, joinTimeoutCallback, 1, &clkParams);
+    joinClockHandle = Clock_handle(&joinClock);
+
     /* Create event used internally for state changes */
     Event_Params eventParam;
     Event_Params_init(&eventParam);
@@ -161,7 +314,12 @@ void NodeRadioTask_init(void) {
 
 uint8_t nodeRadioTask_getNodeAddr(void)
 {
-    return nodeAddress;
+    return join.joined ? nodeAddress : RADIO_ADDRESS_UNASSIGNED;
+}
+
+void NodeRadioTask_registerConfigCallback(NodeRadio_ConfigCallback callback)
+{
+    configCallback = callback;
 }
 
 static void nodeRadioTaskFunction(UArg arg0, UArg arg1)
@@ -175,7 +333,6 @@ static void nodeRadioTaskFunction(UArg arg0, UArg arg1)
 
     EasyLink_Params easyLink_Params;
     EasyLink_Params_init(&easyLink_Params);
-    //EasyLink_TxPacket pkt;
 
 #ifdef FEATURE_BLE_ADV
     easyLink_Params.pClientEventCb = &rfSwitchCallback;
@@ -198,34 +355,59 @@ static void nodeRadioTaskFunction(UArg arg0, UArg arg1)
      * EasyLink_setFrequency(868000000);
      */
 
-    /* Use the True Random Number Generator to generate sensor node address randomly */;
+    /* The node only ever sends through the radio's own Tx buffer */
+    if (EasyLink_reserveTxBuffer(&txPayload) != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_reserveTxBuffer failed");
+    }
+
+    /* The IEEE address identifies the node when it joins */
+    if (EasyLink_getIeeeAddr(join.ieeeAddr) != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_getIeeeAddr failed");
+    }
+
+    /* Use the True Random Number Generator to seed the retry and join
+     * backoff, it must differ between nodes */
     Power_setDependency(PowerCC26XX_PERIPH_TRNG);
     TRNGEnable();
-    /* Do not accept the same address as the concentrator, in that case get a new random value */
-    do
+    while (!(TRNGStatusGet() & TRNG_NUMBER_READY))
     {
-        while (!(TRNGStatusGet() & TRNG_NUMBER_READY))
-        {
-            //wait for random number generator
-        }
-        nodeAddress = (uint8_t)TRNGNumberGet(TRNG_LOW_WORD);
-    } while (nodeAddress == RADIO_CONCENTRATOR_ADDRESS);
+        //wait for random number generator
+    }
+    backoffRandom = TRNGNumberGet(TRNG_LOW_WORD) | 1;
     TRNGDisable();
     Power_releaseDependency(PowerCC26XX_PERIPH_TRNG);
 
-    /* Set the filter to the generated random address */
-    if (EasyLink_enableRxAddrFilter(&nodeAddress, 1, 1) != EasyLink_Status_Success)
+    /* Set the filter to the unjoined address until the concentrator gives
+     * one, and the broadcast address for the beacons */
+    rxAddressFilter[0] = nodeAddress;
+    rxAddressFilter[1] = RADIO_BROADCAST_ADDRESS;
+    if (EasyLink_enableRxAddrFilter(rxAddressFilter, 1, 2) != EasyLink_Status_Success)
     {
         System_abort("EasyLink_enableRxAddrFilter failed");
     }
 
-    /* Setup ADC sensor packet */
-    dmSensorPacket.header.sourceAddress = nodeAddress;
-    dmSensorPacket.header.packetType = RADIO_PACKET_TYPE_DM_SENSOR_PACKET;
+    /* No TDMA slot until the concentrator gives one */
+    tdma.slot = RADIO_TDMA_NO_SLOT;
+    tdma.channel = RADIO_CHANNEL_ANY;
+
+    /* The channels are spaced from the frequency in smartrf_settings */
+    tdma.baseFrequency = EasyLink_getFrequency();
+    tdma.tunedChannel = RADIO_CHANNEL_BEACON;
+
+    /* Setup sensor report, the source address is set on joining */
+    sensorReport.header.packetType = RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET;
+    sensorReport.fields = RADIO_FIELD_BIT(RADIO_FIELD_UPTIME) | RADIO_FIELD_BIT(RADIO_FIELD_BATT) |
+                          RADIO_FIELD_BIT(RADIO_FIELD_BUTTON) | RADIO_FIELD_BIT(RADIO_FIELD_CONFIG_VERSION) |
+                          RADIO_FIELD_BIT(RADIO_FIELD_AGE) | RADIO_FIELD_BIT(RADIO_FIELD_ADC);
 
     /* Initialise previous Tick count used to calculate uptime for the TLM beacon */
     prevTicks = Clock_getTicks();
 
+    /* No round trip measured yet */
+    NodeRetry_init(&ackTimer);
+
 #ifdef FEATURE_BLE_ADV
     /* Initialize the Simple Beacon module wit default params */
     BleAdv_Params_init(&bleAdv_Params);
@@ -239,52 +421,56 @@ static void nodeRadioTaskFunction(UArg arg0, UArg arg1)
     BleAdv_setAdvertiserType(BleAdv_AdertiserMs);
 #endif
 
+    /* Join after a random wait, messages are queued until then */
+    scheduleJoin();
+
     /* Enter main task loop */
     while (1)
     {
         /* Wait for an event */
         uint32_t events = Event_pend(radioOperationEventHandle, 0, RADIO_EVENT_ALL, BIOS_WAIT_FOREVER);
 
-        /* If we should send ADC data */
-        if (events & RADIO_EVENT_SEND_ADC_DATA)
+        /* If we get an ACK from the concentrator */
+        if ((events & RADIO_EVENT_DATA_ACK_RECEIVED) && radioOperationActive)
         {
-            uint32_t currentTicks;
-
-            currentTicks = Clock_getTicks();
-            //check for wrap around
-            if (currentTicks > prevTicks)
+            /* Only acks to a first attempt are timed, an ack after a retry
+             * may belong to any of the attempts */
+            if (currentRadioOperation.retriesDone == 0)
             {
-                //calculate time since last reading in 0.1s units
-                dmSensorPacket.time100MiliSec += ((currentTicks - prevTicks) * Clock_tickPeriod) / 100000;
+                NodeRetry_updateAckTimer(&ackTimer, (ackRxTime - currentRadioOperation.txDoneTime) / NODERADIO_RAT_TICKS_PER_US);
             }
-            else
+
+            /* The next report is sent against the one just acked */
+            if (txPayload[1] == RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET)
             {
-                //calculate time since last reading in 0.1s units
-                dmSensorPacket.time100MiliSec += ((prevTicks - currentTicks) * Clock_tickPeriod) / 100000;
+                RadioProtocol_setSensorReportReference(&sensorReport, &reportReference);
             }
-            prevTicks = currentTicks;
 
-            dmSensorPacket.batt = AONBatMonBatteryVoltageGet();
-            dmSensorPacket.adcValue = adcData;
-            dmSensorPacket.button = !PIN_getInputValue(Board_PIN_BUTTON0);
-
-            sendDmPacket(dmSensorPacket, NODERADIO_MAX_RETRIES, NORERADIO_ACK_TIMEOUT_TIME_MS);
-        }
+            /* The concentrator may have given or moved the TDMA slot */
+            tdma.slot = ackSlot;
+            tdma.channel = ackChannel;
 
-        /* If we get an ACK from the concentrator */
-        if (events & RADIO_EVENT_DATA_ACK_RECEIVED)
-        {
+            /* A config is repeated in the acks until a batch reports its
+             * version back, so only a new version is passed on */
+            if ((ackConfig.version != RADIO_CONFIG_NO_VERSION) && (ackConfig.version != configVersion))
+            {
+                configVersion = ackConfig.version;
+                if (configCallback)
+                {
+                    configCallback(&ackConfig);
+                }
+            }
             returnRadioOperationStatus(NodeRadioStatus_Success);
         }
 
         /* If we get an ACK timeout */
-        if (events & RADIO_EVENT_ACK_TIMEOUT)
+        if ((events & RADIO_EVENT_ACK_TIMEOUT) && radioOperationActive)
         {
 
             /* If we haven't resent it the maximum number of times yet, then resend packet */
             if (currentRadioOperation.retriesDone < currentRadioOperation.maxNumberOfRetries)
             {
-                resendPacket();
+                startBackoff();
             }
             else
             {
@@ -293,10 +479,58 @@ static void nodeRadioTaskFunction(UArg arg0, UArg arg1)
             }
         }
 
+        /* If the beacon came, send in the superframe it started */
+        if ((events & RADIO_EVENT_BEACON_RECEIVED) && radioOperationActive)
+        {
+            beaconReceived();
+        }
+
+        /* If no beacon came */
+        if ((events & RADIO_EVENT_BEACON_MISSED) && radioOperationActive)
+        {
+            beaconMissed();
+        }
+
+        /* If the wait before a retry is over */
+        if ((events & RADIO_EVENT_BACKOFF_DONE) && radioOperationActive)
+        {
+            resendPacket();
+        }
+
+        /* If the concentrator answered a join, or did not know the address */
+        if ((events & RADIO_EVENT_JOIN_RESPONSE) && radioOperationActive)
+        {
+            joinResponseReceived();
+        }
+
         /* If send fail */
-        if (events & RADIO_EVENT_SEND_FAIL)
+        if ((events & RADIO_EVENT_SEND_FAIL) && radioOperationActive)
         {
-            returnRadioOperationStatus(NodeRadioStatus_Failed);
+            if (join.active)
+            {
+                /* No answer to the join, try again later */
+                join.active = 0;
+                radioOperationActive = false;
+                scheduleJoin();
+            }
+            else
+            {
+                returnRadioOperationStatus(NodeRadioStatus_Failed);
+            }
+        }
+
+        /* If the wait before a join is over */
+        if ((events & RADIO_EVENT_JOIN_BACKOFF_DONE) && (!radioOperationActive))
+        {
+            join.waiting = 0;
+            startJoin();
+        }
+
+        /* If the radio is free and a message is waiting, send it. This also
+         * picks up RADIO_EVENT_MESSAGE_QUEUED. */
+        if ((!radioOperationActive) && join.joined && (txQueue.head != txQueue.tail))
+        {
+            startNextMessage();
         }
 
 #ifdef FEATURE_BLE_ADV
@@ -308,128 +542,597 @@ static void nodeRadioTaskFunction(UArg arg0, UArg arg1)
     }
 }
 
+uint16_t NodeRadioTask_submitAdcData(uint16_t data, NodeRadio_SendDoneCallback callback)
+{
+    struct NodeRadioSample sample;
+
+    sample.value = data;
+    sample.ticks = Clock_getTicks();
+
+    return queueMessage(&sample, 1, callback, BIOS_NO_WAIT);
+}
+
+uint16_t NodeRadioTask_submitBatchData(const struct NodeRadioSample* samples, uint8_t count,
+                                       NodeRadio_SendDoneCallback callback)
+{
+    return queueMessage(samples, count, callback, BIOS_NO_WAIT);
+}
+
 enum NodeRadioOperationStatus NodeRadioTask_sendAdcData(uint16_t data)
 {
     enum NodeRadioOperationStatus status;
+    struct NodeRadioSample sample;
 
-    /* Get radio access semaphore */
-    Semaphore_pend(radioAccessSemHandle, BIOS_WAIT_FOREVER);
+    sample.value = data;
+    sample.ticks = Clock_getTicks();
 
-    /* Save data to send */
-    adcData = data;
+    /* Get radio access semaphore, one blocking caller at a time */
+    Semaphore_pend(radioAccessSemHandle, BIOS_WAIT_FOREVER);
 
-    /* Raise RADIO_EVENT_SEND_ADC_DATA event */
-    Event_post(radioOperationEventHandle, RADIO_EVENT_SEND_ADC_DATA);
+    /* Queue the data, waiting for room if needed */
+    queueMessage(&sample, 1, blockingSendDone, BIOS_WAIT_FOREVER);
 
     /* Wait for result */
     Semaphore_pend(radioResultSemHandle, BIOS_WAIT_FOREVER);
 
     /* Get result */
-    status = currentRadioOperation.result;
+    status = blockingSendResult;
 
     /* Return radio access semaphore */
     Semaphore_post(radioAccessSemHandle);
 
     return status;
 }
+
 enum NodeRadioOperationStatus NodeRadioTask_sendMotionData(uint16_t data)
+{
+    // Motion data goes in the same packet as ADC data
+    return NodeRadioTask_sendAdcData(data);
+}
+
+enum NodeRadioOperationStatus NodeRadioTask_sendBatchData(const struct NodeRadioSample* samples, uint8_t count)
 {
     enum NodeRadioOperationStatus status;
 
-    // Get radio access semaphore
+    /* Get radio access semaphore, one blocking caller at a time */
     Semaphore_pend(radioAccessSemHandle, BIOS_WAIT_FOREVER);
 
-    // Save data to send
-    adcData = data;
-
-    // Raise RADIO_EVENT_SEND_ADC_DATA event
-    Event_post(radioOperationEventHandle, RADIO_EVENT_SEND_ADC_DATA);
+    /* Queue the data, waiting for room if needed */
+    queueMessage(samples, count, blockingSendDone, BIOS_WAIT_FOREVER);
 
-    // Wait for result
+    /* Wait for result */
     Semaphore_pend(radioResultSemHandle, BIOS_WAIT_FOREVER);
 
-    // Get result
-    status = currentRadioOperation.result;
+    /* Get result */
+    status = blockingSendResult;
 
-    // Return radio access semaphore
+    /* Return radio access semaphore */
     Semaphore_post(radioAccessSemHandle);
 
     return status;
 }
 
+/* Copies a message into the send queue and wakes up the task. Returns the
+ * message id, or 0 if no slot got free within timeout. */
+static uint16_t queueMessage(const struct NodeRadioSample* samples, uint8_t count,
+                             NodeRadio_SendDoneCallback callback, uint32_t timeout)
+{
+    struct NodeRadioMessage* message;
+    uint16_t id;
+    UInt key;
+
+    if (count > RADIO_BATCH_MAX_SAMPLES)
+    {
+        count = RADIO_BATCH_MAX_SAMPLES;
+    }
+
+    /* Take a free slot */
+    if (!Semaphore_pend(txSlotSemHandle, timeout))
+    {
+        txQueue.rejectedCount++;
+        return 0;
+    }
+
+    /* Several tasks may submit, so fill the slot with interrupts off */
+    key = Hwi_disable();
+    message = &txQueue.messages[txQueue.head & NODERADIO_TX_QUEUE_MASK];
+    message->sampleCount = count;
+    message->callback = callback;
+    memcpy(message->samples, samples, count * sizeof(struct NodeRadioSample));
+
+    /* 0 is never a valid id */
+    if (++txQueue.lastId == 0)
+    {
+        txQueue.lastId = 1;
+    }
+    id = txQueue.lastId;
+    message->id = id;
+
+    txQueue.head++;
+    Hwi_restore(key);
+
+    /* Raise RADIO_EVENT_MESSAGE_QUEUED event */
+    Event_post(radioOperationEventHandle, RADIO_EVENT_MESSAGE_QUEUED);
+
+    return id;
+}
+
+static void blockingSendDone(enum NodeRadioOperationStatus status, uint16_t messageId)
+{
+    /* Hand the result to the waiting NodeRadioTask_send* call */
+    blockingSendResult = status;
+    Semaphore_post(radioResultSemHandle);
+}
+
+/* Starts sending the oldest message in the queue */
+static void startNextMessage(void)
+{
+    struct NodeRadioMessage* message = &txQueue.messages[txQueue.tail & NODERADIO_TX_QUEUE_MASK];
+
+    radioOperationActive = true;
+
+    /* The newest value is also the one in the BLE beacons */
+    if (message->sampleCount > 0)
+    {
+        adcData = message->samples[message->sampleCount - 1].value;
+    }
+
+    sendSensorReport(message);
+}
+
+/* Asks the concentrator for an address */
+static void startJoin(void)
+{
+    struct JoinRequestPacket request;
+
+    radioOperationActive = true;
+    join.active = 1;
+
+    request.header.sourceAddress = RADIO_UNJOINED_ADDRESS;
+    request.header.packetType = RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET;
+    memcpy(request.ieeeAddr, join.ieeeAddr, RADIO_IEEE_ADDRESS_SIZE);
+
+    /* Build the join request in the Tx buffer */
+    commitPacket(RadioProtocol_packJoinRequestPacket(&request, txPayload));
+
+    /* Sent like the data, with retries, the response takes the place of the ack */
+    startRadioOperation(NODERETRY_MAX_RETRIES, ackTimer.timeoutMs);
+}
+
+static void joinResponseReceived(void)
+{
+    if (!join.active)
+    {
+        /* The concentrator does not know the address, it was reset without
+         * its join table or the node joined another one. The message stays
+         * queued and is sent again once the node has joined. */
+        join.joined = 0;
+        join.rejoinCount++;
+        radioOperationActive = false;
+        setNodeAddress(RADIO_UNJOINED_ADDRESS);
+        scheduleJoin();
+    }
+    else if (memcmp(joinResponse.ieeeAddr, join.ieeeAddr, RADIO_IEEE_ADDRESS_SIZE) != 0)
+    {
+        /* The response to another joining node, keep waiting for ours */
+        Event_post(radioOperationEventHandle, RADIO_EVENT_ACK_TIMEOUT);
+    }
+    else if (joinResponse.address == RADIO_UNJOINED_ADDRESS)
+    {
+        /* The concentrator has no address left, try again later */
+        join.active = 0;
+        radioOperationActive = false;
+        scheduleJoin();
+    }
+    else
+    {
+        join.joined = 1;
+        join.active = 0;
+        join.attempts = 0;
+        join.joinCount++;
+        radioOperationActive = false;
+        setNodeAddress(joinResponse.address);
+    }
+}
+
+/* Starts the random wait before the next join, the longest wait doubles with
+ * every failed join */
+static void scheduleJoin(void)
+{
+    uint8_t exponent = (join.attempts < NODERADIO_JOIN_BACKOFF_MAX_EXPONENT) ?
+                       join.attempts : NODERADIO_JOIN_BACKOFF_MAX_EXPONENT;
+    uint32_t windowMs = (uint32_t)NODERADIO_JOIN_BACKOFF_MS << exponent;
+    uint32_t delayMs = 1 + (getRandom() % windowMs);
+
+    if (join.attempts < 0xFF)
+    {
+        join.attempts++;
+    }
+    join.waiting = 1;
+
+    Clock_setTimeout(joinClockHandle, (delayMs * 1000) / Clock_tickPeriod);
+    Clock_start(joinClockHandle);
+}
+
+/* Sends from and receives on address */
+static void setNodeAddress(uint8_t address)
+{
+    nodeAddress = address;
+    sensorReport.header.sourceAddress = address;
+
+    /* The concentrator keeps the report reference by address */
+    reportReference.sequence = RADIO_REPORT_NO_REFERENCE;
+
+    /* The TDMA slot belonged to the old address */
+    tdma.slot = RADIO_TDMA_NO_SLOT;
+    tdma.channel = RADIO_CHANNEL_ANY;
+
+    rxAddressFilter[0] = address;
+    if (EasyLink_enableRxAddrFilter(rxAddressFilter, 1, 2) != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_enableRxAddrFilter failed");
+    }
+}
+
 static void returnRadioOperationStatus(enum NodeRadioOperationStatus result)
 {
+    struct NodeRadioMessage* message = &txQueue.messages[txQueue.tail & NODERADIO_TX_QUEUE_MASK];
+    NodeRadio_SendDoneCallback callback = message->callback;
+    uint16_t id = message->id;
+
     /* Save result */
     currentRadioOperation.result = result;
 
-    /* Post result semaphore */
-    Semaphore_post(radioResultSemHandle);
+    /* Free the slot before the callback, so it can submit again */
+    txQueue.tail++;
+    radioOperationActive = false;
+    Semaphore_post(txSlotSemHandle);
+
+    /* Report the result to the submitter */
+    if (callback)
+    {
+        callback(result, id);
+    }
 }
 
-static void sendDmPacket(struct DualModeSensorPacket sensorPacket, uint8_t maxNumberOfRetries, uint32_t ackTimeoutMs)
+/* Sends the samples of the message, and the node's state, as a SensorReport
+ * against the last acked one */
+static void sendSensorReport(const struct NodeRadioMessage* message)
 {
-    /* Set destination address in EasyLink API */
-    currentRadioOperation.easyLinkTxPacket.dstAddr[0] = RADIO_CONCENTRATOR_ADDRESS;
+    uint32_t age;
+    uint8_t i;
+
+    updateUptime();
+
+    if (++reportSequence > RADIO_REPORT_SEQUENCE_MASK)
+    {
+        reportSequence = 1;
+    }
+    sensorReport.sequence = reportSequence;
+    sensorReport.values[RADIO_FIELD_UPTIME] = uptime100MiliSec;
+    sensorReport.values[RADIO_FIELD_BATT] = AONBatMonBatteryVoltageGet();
+    sensorReport.values[RADIO_FIELD_BUTTON] = !PIN_getInputValue(Board_PIN_BUTTON0);
+    sensorReport.values[RADIO_FIELD_CONFIG_VERSION] = configVersion;
+    sensorReport.sampleCount = message->sampleCount;
+
+    /* Sample times are sent as their age, which needs no shared clock */
+    for (i = 0; i < message->sampleCount; i++)
+    {
+        age = ((prevTicks - message->samples[i].ticks) * Clock_tickPeriod) / 100000;
+        sensorReport.samples[RADIO_FIELD_AGE - RADIO_FIELD_FIRST_SAMPLE_FIELD][i] = (age > 0xFFFF) ? 0xFFFF : age;
+        sensorReport.samples[RADIO_FIELD_ADC - RADIO_FIELD_FIRST_SAMPLE_FIELD][i] = message->samples[i].value;
+    }
 
-    /* Copy ADC packet to payload
+    /* Build the report in the Tx buffer
      * Note that the EasyLink API will implcitily both add the length byte and the destination address byte. */
-    currentRadioOperation.easyLinkTxPacket.payload[0] = dmSensorPacket.header.sourceAddress;
-    currentRadioOperation.easyLinkTxPacket.payload[1] = dmSensorPacket.header.packetType;
-    currentRadioOperation.easyLinkTxPacket.payload[2] = (dmSensorPacket.adcValue & 0xFF00) >> 8;
-    currentRadioOperation.easyLinkTxPacket.payload[3] = (dmSensorPacket.adcValue & 0xFF);
-    currentRadioOperation.easyLinkTxPacket.payload[4] = (dmSensorPacket.batt & 0xFF00) >> 8;
-    currentRadioOperation.easyLinkTxPacket.payload[5] = (dmSensorPacket.batt & 0xFF);
-    currentRadioOperation.easyLinkTxPacket.payload[6] = (dmSensorPacket.time100MiliSec & 0xFF000000) >> 24;
-    currentRadioOperation.easyLinkTxPacket.payload[7] = (dmSensorPacket.time100MiliSec & 0x00FF0000) >> 16;
-    currentRadioOperation.easyLinkTxPacket.payload[8] = (dmSensorPacket.time100MiliSec & 0xFF00) >> 8;
-    currentRadioOperation.easyLinkTxPacket.payload[9] = (dmSensorPacket.time100MiliSec & 0xFF);
-    currentRadioOperation.easyLinkTxPacket.payload[10] = dmSensorPacket.button;
-
-    currentRadioOperation.easyLinkTxPacket.len = sizeof(struct DualModeSensorPacket);
+    commitPacket(RadioProtocol_packSensorReport(&sensorReport, &reportReference, txPayload));
 
+    startRadioOperation(NODERETRY_MAX_RETRIES, ackTimer.timeoutMs);
+}
+
+/* Sends the packet committed to the Tx buffer and waits for the ack */
+static void startRadioOperation(uint8_t maxNumberOfRetries, uint32_t ackTimeoutMs)
+{
     /* Setup retries */
     currentRadioOperation.maxNumberOfRetries = maxNumberOfRetries;
     currentRadioOperation.ackTimeoutMs = ackTimeoutMs;
     currentRadioOperation.retriesDone = 0;
-    EasyLink_setCtrl(EasyLink_Ctrl_AsyncRx_TimeOut, EasyLink_ms_To_RadioTime(ackTimeoutMs));
+    currentRadioOperation.ackWindowMs = ackTimeoutMs;
 
-    /* Send packet  */
-    if (EasyLink_transmit(&currentRadioOperation.easyLinkTxPacket) != EasyLink_Status_Success)
+    /* Count down the messages sent without looking for beacons */
+    if (tdma.acquireSkip > 0)
     {
-        System_abort("EasyLink_transmit failed");
+        tdma.acquireSkip--;
     }
-#if defined(Board_DIO30_SWPWR)
-    /* this was a blocking call, so Tx is now complete. Turn off the RF switch power */
-    PIN_setOutputValue(blePinHandle, Board_DIO30_SWPWR, 0);
-#endif
 
-    /* Enter RX */
-    if (EasyLink_receiveAsync(rxDoneCallback, 0) != EasyLink_Status_Success)
+    /* Send packet, txDoneCallback enters RX */
+    transmitPacket();
+}
+
+/* Advances the uptime sent in the packets to now */
+static void updateUptime(void)
+{
+    uint32_t currentTicks = Clock_getTicks();
+
+    //calculate time since last reading in 0.1s units, unsigned so it also
+    //holds across a tick count wrap around
+    uptime100MiliSec += ((currentTicks - prevTicks) * Clock_tickPeriod) / 100000;
+    prevTicks = currentTicks;
+}
+
+static void resendPacket(void)
+{
+    /* Increase retries by one */
+    currentRadioOperation.retriesDone++;
+
+    /* Double the ack window on every retry */
+    currentRadioOperation.ackWindowMs = NodeRetry_ackWindowMs(currentRadioOperation.ackTimeoutMs,
+                                                              currentRadioOperation.retriesDone);
+
+    /* The concentrator may have taken the first attempt of a report as its
+     * reference already, so the retries are sent against none. The frame is
+     * rebuilt for the first retry only, the later ones send it as it is. */
+    if ((currentRadioOperation.retriesDone == 1) && (txPayload[1] == RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET))
+    {
+        commitPacket(RadioProtocol_packSensorReport(&sensorReport, NULL, txPayload));
+    }
+
+    /* Send packet, txDoneCallback enters RX and waits for ACK with timeout */
+    transmitPacket();
+}
+
+/* Sends the packet in the TDMA schedule if the concentrator sends beacons,
+ * else once the channel is clear */
+static void transmitPacket(void)
+{
+    if (tdma.acquireSkip > 0)
+    {
+        setChannel(RADIO_CHANNEL_BEACON);
+        transmitAt(0, true);
+    }
+    else
+    {
+        listenForBeacon();
+    }
+}
+
+/* Sends the packet at absTime, 0 for now. With CCA it is sent once the
+ * channel is clear, without it at exactly absTime. */
+static void transmitAt(uint32_t absTime, bool useCca)
+{
+    EasyLink_Status status;
+
+    if (useCca)
+    {
+        status = EasyLink_transmitCommittedCCAAsync(absTime, txDoneCallback, getRandom);
+    }
+    else
+    {
+        status = EasyLink_transmitCommittedAsync(absTime, txDoneCallback);
+    }
+    if (status != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_transmitAsync failed");
+    }
+}
+
+/* Completes the len byte packet written to txPayload, all packets go to the
+ * concentrator */
+static void commitPacket(uint8_t len)
+{
+    uint8_t dstAddr = RADIO_CONCENTRATOR_ADDRESS;
+
+    if (EasyLink_commitTxBuffer(&dstAddr, len) != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_commitTxBuffer failed");
+    }
+}
+
+/* Turns the receiver on for the next beacon only. If the last beacon is
+ * recent, the next one is predicted from it, else the node listens for a
+ * whole superframe. */
+static void listenForBeacon(void)
+{
+    uint32_t now = RF_getCurrentTime();
+    uint32_t superframes;
+    uint32_t expected;
+    uint32_t guard;
+    uint32_t start = 0;
+    uint32_t window = EasyLink_ms_To_RadioTime(NODERADIO_TDMA_ACQUIRE_MS);
+
+    if (tdma.synced && ((now - tdma.beaconTime) < EasyLink_ms_To_RadioTime(NODERADIO_TDMA_RESYNC_MS)))
+    {
+        /* First beacon that is still far enough away to start RX for it */
+        superframes = ((now - tdma.beaconTime) / tdma.superframeTicks) + 1;
+        expected = tdma.beaconTime + superframes * tdma.superframeTicks;
+        guard = EasyLink_ms_To_RadioTime(RADIO_TDMA_GUARD_MS) +
+                (superframes * tdma.superframeTicks / 1000000) * NODERADIO_TDMA_DRIFT_PPM;
+        if ((int32_t)(expected - guard - now) < (int32_t)EasyLink_ms_To_RadioTime(1))
+        {
+            superframes++;
+            expected += tdma.superframeTicks;
+            guard += (tdma.superframeTicks / 1000000) * NODERADIO_TDMA_DRIFT_PPM;
+        }
+        start = expected - guard;
+        window = 2 * guard;
+    }
+    else
+    {
+        tdma.synced = 0;
+    }
+
+    setChannel(RADIO_CHANNEL_BEACON);
+    EasyLink_setCtrl(EasyLink_Ctrl_AsyncRx_TimeOut, window);
+    if (EasyLink_receiveAsync(beaconRxCallback, start) != EasyLink_Status_Success)
     {
         System_abort("EasyLink_receiveAsync failed");
     }
 }
 
-static void resendPacket(void)
+/* Tunes the radio to the channel, which must be idle */
+static void setChannel(uint8_t channel)
+{
+    if (channel == tdma.tunedChannel)
+    {
+        return;
+    }
+
+    if (EasyLink_setFrequency(tdma.baseFrequency + (uint32_t)channel * RADIO_CHANNEL_SPACING_HZ) !=
+        EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_setFrequency failed");
+    }
+    tdma.tunedChannel = channel;
+}
+
+/* Schedules the packet in the superframe the beacon just started */
+static void beaconReceived(void)
 {
-    /* Send packet  */
-    if (EasyLink_transmit(&currentRadioOperation.easyLinkTxPacket) != EasyLink_Status_Success)
+    uint32_t superframeStart;
+    uint32_t contentionStart;
+    uint32_t contentionTicks;
+    bool ownSlot;
+
+    tdma.synced = 1;
+    tdma.beaconTime = beaconRxTime;
+    tdma.superframeTicks = EasyLink_ms_To_RadioTime((uint32_t)receivedBeacon.superframeMs);
+    tdma.slotTicks = EasyLink_ms_To_RadioTime((uint32_t)receivedBeacon.slotMs);
+    tdma.slotCount = receivedBeacon.slotCount;
+    tdma.channelMask = receivedBeacon.channelMask;
+    tdma.beaconCount++;
+
+    /* The slot is only valid in the superframes on its channel. A node whose
+     * channel has been blacklisted sends in the contention period of any
+     * superframe until the concentrator gives it a new one. */
+    ownSlot = (tdma.slot < tdma.slotCount) &&
+              ((tdma.channel == RADIO_CHANNEL_ANY) || (receivedBeacon.channel == RADIO_CHANNEL_ANY) ||
+               (tdma.channel == receivedBeacon.channel));
+    if ((!ownSlot) && (tdma.slot < tdma.slotCount) && (tdma.channel < RADIO_CHANNEL_COUNT) &&
+        (tdma.channelMask & (1 << tdma.channel)))
+    {
+        /* Wait for the superframe on the own channel */
+        tdma.channelWaitCount++;
+        listenForBeacon();
+        return;
+    }
+
+    /* Single channel concentrators stay on the beacon channel */
+    if (receivedBeacon.channel < RADIO_CHANNEL_COUNT)
+    {
+        setChannel(receivedBeacon.channel);
+    }
+
+    superframeStart = tdma.beaconTime + EasyLink_ms_To_RadioTime(RADIO_TDMA_FIRST_SLOT_OFFSET_MS);
+
+    if (ownSlot)
     {
-        System_abort("EasyLink_transmit failed");
+        /* Own slot, nobody else sends in it */
+        transmitAt(superframeStart + tdma.slot * tdma.slotTicks, false);
     }
+    else
+    {
+        /* No slot yet, pick a random time in the contention period that
+         * leaves a slot's time for the packet and its ack */
+        contentionStart = superframeStart + tdma.slotCount * tdma.slotTicks;
+        contentionTicks = tdma.superframeTicks - (contentionStart - tdma.beaconTime) -
+                          EasyLink_ms_To_RadioTime(RADIO_TDMA_GUARD_MS) - tdma.slotTicks;
+        if ((int32_t)contentionTicks <= 0)
+        {
+            contentionTicks = 1;
+        }
+        transmitAt(contentionStart + (getRandom() % contentionTicks), true);
+    }
+}
+
+static void beaconMissed(void)
+{
+    tdma.missedBeaconCount++;
+
+    if (tdma.synced)
+    {
+        /* The prediction was off, listen for a whole superframe */
+        tdma.synced = 0;
+        listenForBeacon();
+    }
+    else
+    {
+        /* No beacons at all, send with CCA only for a while */
+        tdma.acquireSkip = NODERADIO_TDMA_ACQUIRE_SKIP;
+        transmitAt(0, true);
+    }
+}
+
+static void txDoneCallback(EasyLink_Status status)
+{
 #if defined(Board_DIO30_SWPWR)
-    /* this was a blocking call, so Tx is now complete. Turn off the RF switch power */
+    /* Tx is now complete. Turn off the RF switch power */
     PIN_setOutputValue(blePinHandle, Board_DIO30_SWPWR, 0);
 #endif
 
-    /* Enter RX and wait for ACK with timeout */
-    if (EasyLink_receiveAsync(rxDoneCallback, 0) != EasyLink_Status_Success)
+    /* Copy the CCA deferrals counted by EasyLink, for ROV */
+    EasyLink_getCtrl(EasyLink_Ctrl_Cca_BusyCount, &ccaStats.deferralCount);
+
+    if (status == EasyLink_Status_Success)
     {
-        System_abort("EasyLink_receiveAsync failed");
+        currentRadioOperation.txDoneTime = RF_getCurrentTime();
+
+        /* Enter RX right away, the concentrator acks at once */
+        EasyLink_setCtrl(EasyLink_Ctrl_AsyncRx_TimeOut,
+                         EasyLink_ms_To_RadioTime(currentRadioOperation.ackWindowMs));
+        if (EasyLink_receiveAsync(rxDoneCallback, 0) != EasyLink_Status_Success)
+        {
+            Event_post(radioOperationEventHandle, RADIO_EVENT_ACK_TIMEOUT);
+        }
+    }
+    else
+    {
+        /* The channel stayed busy or the TX failed. This counts as an
+         * attempt without an ack, so the retry backs off. */
+        if (status == EasyLink_Status_Busy_Error)
+        {
+            ccaStats.busyFailCount++;
+        }
+        Event_post(radioOperationEventHandle, RADIO_EVENT_ACK_TIMEOUT);
     }
+}
 
-    /* Increase retries by one */
-    currentRadioOperation.retriesDone++;
+/* Waits a random time before the next retry, the longest wait doubles with
+ * every retry */
+static void startBackoff(void)
+{
+    uint32_t delayMs = NodeRetry_backoffMs(currentRadioOperation.retriesDone, getRandom());
+
+    Clock_setTimeout(backoffClockHandle, (delayMs * 1000) / Clock_tickPeriod);
+    Clock_start(backoffClockHandle);
+}
+
+static void backoffTimeoutCallback(UArg arg0)
+{
+    Event_post(radioOperationEventHandle, RADIO_EVENT_BACKOFF_DONE);
+}
+
+static void joinTimeoutCallback(UArg arg0)
+{
+    Event_post(radioOperationEventHandle, RADIO_EVENT_JOIN_BACKOFF_DONE);
+}
+
+/* xorshift32, good enough to spread the retries of different nodes. Also
+ * EasyLink's CCA backoff generator, called from the RF callback (SWI), so the
+ * state is updated with interrupts off. */
+static uint32_t getRandom(void)
+{
+    uint32_t random;
+    UInt key = Hwi_disable();
+
+    random = backoffRandom;
+    random ^= random << 13;
+    random ^= random >> 17;
+    random ^= random << 5;
+    backoffRandom = random;
+
+    Hwi_restore(key);
+
+    return random;
 }
 
 #ifdef FEATURE_BLE_ADV
@@ -500,9 +1203,33 @@ static void bleAdv_updateMsButtonCB(uint8_t *pButton)
 }
 #endif
 
+static void beaconRxCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status)
+{
+#if defined(Board_DIO30_SWPWR)
+    /* Rx is now complete. Turn off the RF switch power */
+    PIN_setOutputValue(blePinHandle, Board_DIO30_SWPWR, 0);
+#endif
+
+    /* Only a beacon from the concentrator will do, anything else ends the
+     * listen window like a timeout */
+    if ((status == EasyLink_Status_Success) &&
+        RadioProtocol_unpackBeaconPacket(rxPacket->payload, rxPacket->len, &receivedBeacon) &&
+        (receivedBeacon.header.sourceAddress == RADIO_CONCENTRATOR_ADDRESS) &&
+        (receivedBeacon.superframeMs != 0))
+    {
+        beaconRxTime = rxPacket->absTime;
+        Event_post(radioOperationEventHandle, RADIO_EVENT_BEACON_RECEIVED);
+    }
+    else
+    {
+        Event_post(radioOperationEventHandle, RADIO_EVENT_BEACON_MISSED);
+    }
+}
+
 static void rxDoneCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status)
 {
-    struct PacketHeader* packetHeader;
+    struct AckPacket ackPacket;
+    struct JoinResponsePacket response;
 
 #if defined(Board_DIO30_SWPWR)
     /* Rx is now complete. Turn off the RF switch power */
@@ -512,12 +1239,23 @@ static void rxDoneCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status)
     /* If this callback is called because of a packet received */
     if (status == EasyLink_Status_Success)
     {
-        /* Check the payload header */
-        packetHeader = (struct PacketHeader*)rxPacket->payload;
-
-        /* Check if this is an ACK packet */
-        if (packetHeader->packetType == RADIO_PACKET_TYPE_ACK_PACKET)
+        /* Check if this is a join response, which also ends a data
+         * operation if the concentrator does not know the address */
+        if (RadioProtocol_unpackJoinResponsePacket(rxPacket->payload, rxPacket->len, &response))
+        {
+            joinResponse = response;
+            Event_post(radioOperationEventHandle, RADIO_EVENT_JOIN_RESPONSE);
+        }
+        /* Check if this is an ACK packet, which does not answer a join */
+        else if ((!join.active) && RadioProtocol_unpackAckPacket(rxPacket->payload, rxPacket->len, &ackPacket))
         {
+            /* Save when it arrived for the round trip estimate, the slot
+             * and any config */
+            ackRxTime = rxPacket->absTime;
+            ackSlot = ackPacket.slot;
+            ackChannel = ackPacket.channel;
+            ackConfig = ackPacket.config;
+
             /* Signal ACK packet received */
             Event_post(radioOperationEventHandle, RADIO_EVENT_DATA_ACK_RECEIVED);
         }
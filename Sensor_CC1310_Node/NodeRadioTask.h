@@ -34,6 +34,7 @@
 #define TASKS_NODERADIOTASKTASK_H_
 
 #include "stdint.h"
+#include "RadioProtocol.h"
 
 #define NODE_ACTIVITY_LED1 Board_PIN_LED0
 #define NODE_ACTIVITY_LED2 Board_PIN_LED1
@@ -44,13 +45,51 @@ enum NodeRadioOperationStatus {
     NodeRadioStatus_FailedNotConnected,
 };
 
+/* A reading waiting to be sent in a batch */
+struct NodeRadioSample {
+    uint16_t value;
+    uint32_t ticks;     /* Clock_getTicks() when it was taken */
+};
+
+/* Number of messages that can wait to be sent, must be a power of two */
+#ifndef NODERADIO_TX_QUEUE_SIZE
+#define NODERADIO_TX_QUEUE_SIZE 4
+#endif
+
+/* Called from the NodeRadioTask when a submitted message is acked or has
+ * failed all retries, with the id returned when it was submitted. It must
+ * not block. */
+typedef void (*NodeRadio_SendDoneCallback)(enum NodeRadioOperationStatus status, uint16_t messageId);
+
+/* Called from the NodeRadioTask when an ack brings a new config version from
+ * the concentrator. Only the fields in config->fields are set. It must not
+ * block. */
+typedef void (*NodeRadio_ConfigCallback)(const struct NodeConfig* config);
+
 /* Initializes the NodeRadioTask and creates all TI-RTOS objects */
 void NodeRadioTask_init(void);
 
-/* Sends an ADC value to the concentrator */
+/* Queues an ADC value for sending to the concentrator and returns at once.
+ * Returns the message id, or 0 if the queue is full. callback may be NULL. */
+uint16_t NodeRadioTask_submitAdcData(uint16_t data, NodeRadio_SendDoneCallback callback);
+
+/* Queues up to RADIO_BATCH_MAX_SAMPLES readings, oldest first, for sending to
+ * the concentrator in one packet. The readings are copied. Returns the
+ * message id, or 0 if the queue is full. callback may be NULL. */
+uint16_t NodeRadioTask_submitBatchData(const struct NodeRadioSample* samples, uint8_t count,
+                                       NodeRadio_SendDoneCallback callback);
+
+/* Sends an ADC value to the concentrator, blocks until it is acked or failed */
 enum NodeRadioOperationStatus NodeRadioTask_sendAdcData(uint16_t data);
 
-/* Get node address, return 0 if node address has not been set */
+/* Sends up to RADIO_BATCH_MAX_SAMPLES readings, oldest first, to the
+ * concentrator in one packet, blocks until it is acked or failed */
+enum NodeRadioOperationStatus NodeRadioTask_sendBatchData(const struct NodeRadioSample* samples, uint8_t count);
+
+/* Register the config received callback */
+void NodeRadioTask_registerConfigCallback(NodeRadio_ConfigCallback callback);
+
+/* Get node address, returns RADIO_ADDRESS_UNASSIGNED until the node has joined */
 uint8_t nodeRadioTask_getNodeAddr(void);
 
 #endif /* TASKS_NODERADIOTASKTASK_H_ */
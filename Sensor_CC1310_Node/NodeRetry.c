@@ -0,0 +1,66 @@
+/*
+ *  ======== NodeRetry.c ========
+ *
+ *  Ack window and retry backoff of the node radio, see NodeRetry.h.
+ */
+
+/***** Includes *****/
+#include "NodeRetry.h"
+
+
+/***** Function definitions *****/
+void NodeRetry_init(struct NodeRetry_AckTimer* timer)
+{
+    timer->srttUs = 0;
+    timer->rttvarUs = 0;
+    timer->lastRttUs = 0;
+    timer->timeoutMs = NODERETRY_ACK_TIMEOUT_MS;
+}
+
+void NodeRetry_updateAckTimer(struct NodeRetry_AckTimer* timer, uint32_t rttUs)
+{
+    uint32_t deltaUs;
+    uint32_t timeoutMs;
+
+    timer->lastRttUs = rttUs;
+
+    if (timer->srttUs == 0)
+    {
+        timer->srttUs = rttUs;
+        timer->rttvarUs = rttUs / 2;
+    }
+    else
+    {
+        deltaUs = (timer->srttUs > rttUs) ? (timer->srttUs - rttUs) : (rttUs - timer->srttUs);
+        timer->rttvarUs = timer->rttvarUs - (timer->rttvarUs / 4) + (deltaUs / 4);
+        timer->srttUs = timer->srttUs - (timer->srttUs / 8) + (rttUs / 8);
+    }
+
+    timeoutMs = ((timer->srttUs + 4 * timer->rttvarUs) / 1000) + 1;
+    if (timeoutMs < NODERETRY_ACK_TIMEOUT_MIN_MS)
+    {
+        timeoutMs = NODERETRY_ACK_TIMEOUT_MIN_MS;
+    }
+    else if (timeoutMs > NODERETRY_ACK_TIMEOUT_MAX_MS)
+    {
+        timeoutMs = NODERETRY_ACK_TIMEOUT_MAX_MS;
+    }
+    timer->timeoutMs = timeoutMs;
+}
+
+uint32_t NodeRetry_ackWindowMs(uint32_t firstWindowMs, uint8_t retriesDone)
+{
+    uint32_t windowMs = firstWindowMs << retriesDone;
+
+    if (windowMs > NODERETRY_ACK_TIMEOUT_MAX_MS)
+    {
+        windowMs = NODERETRY_ACK_TIMEOUT_MAX_MS;
+    }
+
+    return windowMs;
+}
+
+uint32_t NodeRetry_backoffMs(uint8_t retriesDone, uint32_t random)
+{
+    return 1 + (random % ((uint32_t)NODERETRY_BACKOFF_BASE_MS << retriesDone));
+}
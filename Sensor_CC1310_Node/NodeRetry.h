@@ -0,0 +1,53 @@
+/*
+ *  ======== NodeRetry.h ========
+ *
+ *  Ack window and retry backoff of the node radio, used by NodeRadioTask.c
+ *  and by the host retry simulation.
+ *
+ *  The ack window is sized from the measured round trip time, like the TCP
+ *  retransmission timer: smoothed RTT plus 4 times its variation, as in
+ *  RFC 6298. It starts at NODERETRY_ACK_TIMEOUT_MS and doubles on every
+ *  retry. Before a retry the node waits a random time of 1 to
+ *  NODERETRY_BACKOFF_BASE_MS << retry ms, so that nodes that collided once
+ *  do not collide again. Nothing here depends on the radio or TI-RTOS.
+ */
+
+#ifndef NODERETRY_H_
+#define NODERETRY_H_
+
+#include "stdint.h"
+
+#define NODERETRY_MAX_RETRIES           2
+#define NODERETRY_ACK_TIMEOUT_MS        160
+#define NODERETRY_ACK_TIMEOUT_MIN_MS    20
+#define NODERETRY_ACK_TIMEOUT_MAX_MS    640
+#define NODERETRY_BACKOFF_BASE_MS       20
+
+
+/***** Type declarations *****/
+struct NodeRetry_AckTimer {
+    uint32_t srttUs;        /* Smoothed round trip time, 0 until the first ack */
+    uint32_t rttvarUs;      /* Smoothed round trip time variation */
+    uint32_t lastRttUs;
+    uint32_t timeoutMs;     /* Ack window of the first attempt */
+};
+
+
+/***** Function declarations *****/
+
+/* Starts the timer over with the ack window of NODERETRY_ACK_TIMEOUT_MS */
+void NodeRetry_init(struct NodeRetry_AckTimer* timer);
+
+/* Updates the round trip estimate with the round trip time of an ack to a
+ * first attempt and sizes the ack window from it */
+void NodeRetry_updateAckTimer(struct NodeRetry_AckTimer* timer, uint32_t rttUs);
+
+/* Ack window of a retry, firstWindowMs doubled retriesDone times and at most
+ * NODERETRY_ACK_TIMEOUT_MAX_MS */
+uint32_t NodeRetry_ackWindowMs(uint32_t firstWindowMs, uint8_t retriesDone);
+
+/* Wait before retry number retriesDone, 1 to NODERETRY_BACKOFF_BASE_MS <<
+ * retriesDone ms picked with random */
+uint32_t NodeRetry_backoffMs(uint8_t retriesDone, uint32_t random);
+
+#endif /* NODERETRY_H_ */
@@ -31,6 +31,9 @@
  */
 
 /***** Includes *****/
+#include <string.h>
+#include <stdlib.h>
+
 /* XDCtools Header files */ 
 #include <xdc/std.h>
 #include <xdc/runtime/System.h>
@@ -41,6 +44,7 @@
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Event.h>
 #include <ti/sysbios/knl/Clock.h>
+#include <ti/sysbios/hal/Hwi.h>
 
 /* TI-RTOS Header files */ 
 #include <ti/drivers/PIN.h>
@@ -54,6 +58,8 @@
 #include "SceAdc.h"
 #include "NodeTask.h"
 #include "NodeRadioTask.h"
+#include "RadioProtocol.h"
+#include "TempConversion.h"
 
 #ifdef FEATURE_BLE_ADV
 #include "ble_adv/BleAdv.h"
@@ -92,9 +98,23 @@
     #define NODE_EVENT_NEW_TEMP_VALUE                       (uint32_t)(1 << 0)
     #define NODE_EVENT_MOTIONSENSE                          (uint32_t)(1 << 2)
     #define NODE_EVENT_UPDATE_LCD                           (uint32_t)(1 << 1)
+    #define NODE_EVENT_FLUSH_BATCH                          (uint32_t)(1 << 3)
+
+    // The SCE samples the temperature every second (16.16 format)
+    #define NODE_TEMPTASK_SAMPLING_TIME                      0x00010000
 
-    // A change mask of 0xFF0 means that changes in the lower 4 bits does not trigger a wakeup.
-    #define NODE_TEMPTASK_CHANGE_MASK                        0xFF0
+    // A reading is reported when the temperature moves more than a bin of 0.5 C, and has passed the
+    // threshold by 4 ADC counts, so a reading sitting on a threshold does not trigger a wakeup. The
+    // thresholds are spread evenly around NODE_TEMPTASK_THRESHOLD_CENTER (in 0.01 C), outside of
+    // them readings are only reported on the minimum report interval.
+    #define NODE_TEMPTASK_BIN_WIDTH                          50
+    #define NODE_TEMPTASK_HYSTERESIS                         4
+    #define NODE_TEMPTASK_THRESHOLD_CENTER                   2100
+
+    // Each sample averages 2^2 ADC readings and the IIR filter takes 1/2^2 of every new sample, so
+    // ADC noise at a threshold does not wake up the CM3
+    #define NODE_TEMPTASK_OVERSAMPLE_LOG2                    2
+    #define NODE_TEMPTASK_FILTER_SHIFT                       2
 
     /* Minimum slow Report interval is 50s (in units of samplingTime)*/
     #define NODE_TEMPTASK_REPORTINTERVAL_SLOW                50
@@ -102,6 +122,26 @@
     #define NODE_TEMPTASK_REPORTINTERVAL_FAST                5
     #define NODE_TEMPTASK_REPORTINTERVAL_FAST_DURIATION_MS   30000
 
+    // In slow report mode the SCE collects a full buffer of readings before waking up the CM3, in
+    // fast report mode every reading wakes it up
+    #define NODE_TEMPTASK_SAMPLES_PER_ALERT_SLOW             SCEADC_MAX_SAMPLES
+    #define NODE_TEMPTASK_SAMPLES_PER_ALERT_FAST             1
+
+    // In slow report mode the SCE halves its sampling rate each time the reading has stayed in its
+    // bin for 8 samples, down to one sample every 8s, and goes back to 1s as soon as it moves. In
+    // fast report mode it samples every second.
+    #define NODE_TEMPTASK_MAX_RATE_SHIFT_SLOW                3
+    #define NODE_TEMPTASK_MAX_RATE_SHIFT_FAST                0
+    #define NODE_TEMPTASK_FLAT_SAMPLES                       8
+
+    // Readings are sent in batches to save radio wake-ups. A batch is sent when it is full, when its
+    // oldest reading is NODE_BATCH_MAX_AGE_MS old, or straight away when the button is pressed.
+    // May be overridden from the build options, 1 sends every reading on its own.
+    #ifndef NODE_BATCH_MAX_SAMPLES
+    #define NODE_BATCH_MAX_SAMPLES                           RADIO_BATCH_MAX_SAMPLES
+    #endif
+    #define NODE_BATCH_MAX_AGE_MS                            60000
+
 
     #define NUM_EDDYSTONE_URLS      5
 
@@ -168,11 +208,32 @@
     Event_Struct nodeEvent;                                 // not static so you can see in ROV
     static Event_Handle nodeEventHandle;                    // Premade Event_Handle - possible that it doesn't allow for resetting
     static uint16_t latestTempValue;                        // Read Temperature Value
+    static struct NodeRadioSample newTempSamples[SCEADC_MAX_SAMPLES];  // Readings from the SCE not batched yet
+    static uint8_t newTempSampleCount;
+    uint32_t droppedTempCount;                              // not static so you can see in ROV
     static uint16_t latestMotionData;
 
     Clock_Struct fastReportTimeoutClock;                    // not static so you can see in ROV
     static Clock_Handle fastReportTimeoutClockHandle;       //
 
+    Clock_Struct batchAgeClock;                             // not static so you can see in ROV
+    static Clock_Handle batchAgeClockHandle;                //
+    static struct NodeRadioSample batchSamples[NODE_BATCH_MAX_SAMPLES];  // Readings not sent yet, oldest first
+    static uint8_t batchSampleCount;
+    uint32_t failedBatchCount;                              // not static so you can see in ROV
+
+    // Report settings, start from the defines and can be changed by the concentrator in its acks
+    struct NodeConfig nodeConfig = {                        // not static so you can see in ROV
+        RADIO_CONFIG_NO_VERSION,
+        0,
+        NODE_TEMPTASK_REPORTINTERVAL_SLOW,
+        NODE_TEMPTASK_REPORTINTERVAL_FAST,
+        NODE_TEMPTASK_REPORTINTERVAL_FAST_DURIATION_MS / 1000,
+        NODE_TEMPTASK_BIN_WIDTH,
+        NODE_BATCH_MAX_AGE_MS / 1000,
+        NODE_TEMPTASK_HYSTERESIS,
+    };
+
     /* Pin driver handle */
     static PIN_Handle buttonPinHandle;
     static PIN_Handle ledPinHandle;
@@ -207,7 +268,7 @@
         PIN_TERMINATE
     };
 
-    static uint8_t nodeAddress = 0;
+    static uint8_t nodeAddress = RADIO_ADDRESS_UNASSIGNED;
 
 
     #ifdef FEATURE_BLE_ADV
@@ -226,7 +287,14 @@
 static void NodeTaskFunction(UArg arg0, UArg arg1);
 static void updateLcd(void);
 static void fastReportTimeoutCallback(UArg arg0);
-static void TempCallback(uint16_t TempValue);
+static void batchAgeTimeoutCallback(UArg arg0);
+static void addBatchSample(uint16_t value, uint32_t ticks);
+static void flushBatch(void);
+static void batchSendDone(enum NodeRadioOperationStatus status, uint16_t messageId);
+static void configReceived(const struct NodeConfig* config);
+static void setTempThresholds(void);
+static uint32_t secondsToTicks(uint16_t seconds);
+static void TempCallback(const SceAdc_Sample* samples, uint8_t count);
 static void buttonCallback(PIN_Handle handle, PIN_Id pinId);
 
 /***** Function definitions *****/
@@ -530,6 +598,11 @@ void NodeTask_init(void)
     Clock_construct(&fastReportTimeoutClock, fastReportTimeoutCallback, 1, &clkParams);
     fastReportTimeoutClockHandle = Clock_handle(&fastReportTimeoutClock);
 
+    // Create clock object which limits how long a reading waits in the batch
+    Clock_construct(&batchAgeClock, batchAgeTimeoutCallback,
+            NODE_BATCH_MAX_AGE_MS * 1000 / Clock_tickPeriod, &clkParams);
+    batchAgeClockHandle = Clock_handle(&batchAgeClock);
+
     // Create Node Task
     Task_Params_init(&nodeTaskParams);
     nodeTaskParams.stackSize = NODE_TASK_STACK_SIZE;
@@ -581,13 +654,19 @@ static void NodeTaskFunction(UArg arg0, UArg arg1)
     // SCE - Sensor Controller Engine
     // Start the SCE Temp ADC task with 1s sample period and reacting to change in ADC value
     //SceAdc_init(sampling time, minimum report interval, TempChangeMask)
-    SceAdc_init(0x00010000, NODE_TEMPTASK_REPORTINTERVAL_FAST, NODE_TEMPTASK_CHANGE_MASK);
+    SceAdc_init(NODE_TEMPTASK_SAMPLING_TIME, nodeConfig.reportIntervalFast);
+    setTempThresholds();
+    SceAdc_setFilter(NODE_TEMPTASK_OVERSAMPLE_LOG2, NODE_TEMPTASK_FILTER_SHIFT);
+    SceAdc_setSamplesPerAlert(NODE_TEMPTASK_SAMPLES_PER_ALERT_FAST);
+    SceAdc_setAdaptiveRate(NODE_TEMPTASK_MAX_RATE_SHIFT_FAST, NODE_TEMPTASK_FLAT_SAMPLES);
     SceAdc_registerAdcCallback(TempCallback);
     SceAdc_start();
 
+    // Let the concentrator change the report settings from now on
+    NodeRadioTask_registerConfigCallback(configReceived);
+
     /* setup timeout for fast report timeout */
-    Clock_setTimeout(fastReportTimeoutClockHandle,
-            NODE_TEMPTASK_REPORTINTERVAL_FAST_DURIATION_MS * 1000 / Clock_tickPeriod);
+    Clock_setTimeout(fastReportTimeoutClockHandle, secondsToTicks(nodeConfig.fastDurationSec));
 
     /* start fast report and timeout */
     Clock_start(fastReportTimeoutClockHandle);
@@ -614,20 +693,43 @@ static void NodeTaskFunction(UArg arg0, UArg arg1)
 
         //--------------------------------------------------
         // Temperature Event
-        //      -If new Temp value, send data
+        //      -If new Temp values, send data
         //
         if (events & NODE_EVENT_NEW_TEMP_VALUE)
         {
+            struct NodeRadioSample tempSamples[SCEADC_MAX_SAMPLES];
+            uint8_t tempSampleCount;
+            uint8_t i;
+
+            // Take the readings over from the SCE callback
+            UInt key = Hwi_disable();
+            tempSampleCount = newTempSampleCount;
+            memcpy(tempSamples, newTempSamples, tempSampleCount * sizeof(struct NodeRadioSample));
+            newTempSampleCount = 0;
+            Hwi_restore(key);
+
             // Toggle activity LED
             PIN_setOutputValue(ledPinHandle, NODE_ACTIVITY_LED1,!PIN_getOutputValue(NODE_ACTIVITY_LED1));
 
-            /* Send ADC value to concentrator */
-            NodeRadioTask_sendAdcData(latestTempValue);
+            // Queue the values, they are sent to the concentrator with the batch
+            for (i = 0; i < tempSampleCount; i++)
+            {
+                addBatchSample(tempSamples[i].value, tempSamples[i].ticks);
+            }
 
             // Update LCD
             updateLcd();
         }
 
+        //--------------------------------------------------
+        // Flush Event
+        //      -Batch is old enough or urgent, send it now
+        //
+        if (events & NODE_EVENT_FLUSH_BATCH)
+        {
+            flushBatch();
+        }
+
         //--------------------------------------------------
         // Motion Event
         //      -If new Motion Ping, send data
@@ -656,15 +758,13 @@ static void NodeTaskFunction(UArg arg0, UArg arg1)
 static void updateLcd(void)
 
 {
+    int16_t tempCentiC;
 #ifdef FEATURE_BLE_ADV
     char advMode[16] = {0};
 #endif
 
-    /* get node address if not already done */
-    if (nodeAddress == 0)
-    {
-        nodeAddress = nodeRadioTask_getNodeAddr();
-    }
+    /* get node address, it changes if the node has to join again */
+    nodeAddress = nodeRadioTask_getNodeAddr();
 
 //    /* print to LCD */
 //    Display_clear(hDisplayLcd);
@@ -673,9 +773,19 @@ static void updateLcd(void)
 
     // print to UART clear screen, put cuser to beggining of terminal and print the header
     // \033[2J clears screen | \033[0 resets special formatting | %02x does 2 character hex output | https://www.student.cs.uwaterloo.ca/~cs452/terminal.html
-    Display_printf(hDisplaySerial, 0, 0, "\033[2J \033[0;0HNode ID: 0x%02x", nodeAddress);
+    if (nodeAddress == RADIO_ADDRESS_UNASSIGNED)
+    {
+        Display_printf(hDisplaySerial, 0, 0, "\033[2J \033[0;0HNode ID: joining");
+    }
+    else
+    {
+        Display_printf(hDisplaySerial, 0, 0, "\033[2J \033[0;0HNode ID: 0x%02x", nodeAddress);
+    }
     // %04d does 4 character integer output | http://www.cplusplus.com/reference/cstdio/printf/
     Display_printf(hDisplaySerial, 0, 0, "Node Temp Reading: %04d", latestTempValue);
+    tempCentiC = TempConversion_toCentiC(latestTempValue, TEMPCONV_BOARD_OFFSET);
+    Display_printf(hDisplaySerial, 0, 0, "Node Temperature: %s%d.%02d C", (tempCentiC < 0) ? "-" : "",
+                   abs(tempCentiC) / 100, abs(tempCentiC) % 100);
 
 #ifdef FEATURE_BLE_ADV
     if (advertisementType == BleAdv_AdertiserMs)
@@ -712,11 +822,27 @@ static void updateLcd(void)
 
 //------------------------------------------------------------------------------------------------------------------------
 // TempCallback
-static void TempCallback(uint16_t TempValue)
+static void TempCallback(const SceAdc_Sample* samples, uint8_t count)
 {
+    uint32_t now = Clock_getTicks();
+    uint8_t i;
+
+    // Keep the readings for the task, timed from their age. If the task has not taken the
+    // previous buffer yet the newest readings are dropped
+    for (i = 0; i < count; i++)
+    {
+        if (newTempSampleCount == SCEADC_MAX_SAMPLES)
+        {
+            droppedTempCount += count - i;
+            break;
+        }
+        newTempSamples[newTempSampleCount].value = samples[i].adcValue;
+        newTempSamples[newTempSampleCount].ticks = now - (uint32_t)((uint64_t)samples[i].ageMs * 1000 / Clock_tickPeriod);
+        newTempSampleCount++;
+    }
 
     // Save Latest Temp Value
-    latestTempValue = TempValue;
+    latestTempValue = samples[count - 1].adcValue;
 
     // Post Event
     Event_post(nodeEventHandle, NODE_EVENT_NEW_TEMP_VALUE);
@@ -734,8 +860,13 @@ static void buttonCallback(PIN_Handle handle, PIN_Id pinId)
    if (PIN_getInputValue(Board_PIN_BUTTON0) == 0)
    {
        //start fast report and timeout
-       SceAdc_setReportInterval(NODE_TEMPTASK_REPORTINTERVAL_FAST, NODE_TEMPTASK_CHANGE_MASK);
+       SceAdc_setReportInterval(nodeConfig.reportIntervalFast);
+       SceAdc_setSamplesPerAlert(NODE_TEMPTASK_SAMPLES_PER_ALERT_FAST);
+       SceAdc_setAdaptiveRate(NODE_TEMPTASK_MAX_RATE_SHIFT_FAST, NODE_TEMPTASK_FLAT_SAMPLES);
        Clock_start(fastReportTimeoutClockHandle);
+
+       //button press is urgent, send what is waiting in the batch now
+       Event_post(nodeEventHandle, NODE_EVENT_FLUSH_BATCH);
    }
 #ifdef FEATURE_BLE_ADV
    else if (PIN_getInputValue(Board_PIN_BUTTON1) == 0)
@@ -773,7 +904,9 @@ static void buttonCallback(PIN_Handle handle, PIN_Id pinId)
        Event_post(nodeEventHandle, NODE_EVENT_UPDATE_LCD);
 
        //start fast report and timeout
-       SceAdc_setReportInterval(NODE_TEMPTASK_REPORTINTERVAL_FAST, NODE_TEMPTASK_CHANGE_MASK);
+       SceAdc_setReportInterval(nodeConfig.reportIntervalFast);
+       SceAdc_setSamplesPerAlert(NODE_TEMPTASK_SAMPLES_PER_ALERT_FAST);
+       SceAdc_setAdaptiveRate(NODE_TEMPTASK_MAX_RATE_SHIFT_FAST, NODE_TEMPTASK_FLAT_SAMPLES);
        Clock_start(fastReportTimeoutClockHandle);
    }
 #endif
@@ -784,7 +917,174 @@ static void buttonCallback(PIN_Handle handle, PIN_Id pinId)
 static void fastReportTimeoutCallback(UArg arg0)
 {
     //stop fast report
-    SceAdc_setReportInterval(NODE_TEMPTASK_REPORTINTERVAL_SLOW, NODE_TEMPTASK_CHANGE_MASK);
+    SceAdc_setReportInterval(nodeConfig.reportIntervalSlow);
+    SceAdc_setSamplesPerAlert(NODE_TEMPTASK_SAMPLES_PER_ALERT_SLOW);
+    SceAdc_setAdaptiveRate(NODE_TEMPTASK_MAX_RATE_SHIFT_SLOW, NODE_TEMPTASK_FLAT_SAMPLES);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// batchAgeTimeoutCallback
+static void batchAgeTimeoutCallback(UArg arg0)
+{
+    //oldest reading has waited long enough
+    Event_post(nodeEventHandle, NODE_EVENT_FLUSH_BATCH);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// addBatchSample
+static void addBatchSample(uint16_t value, uint32_t ticks)
+{
+    // Start the age timeout with the first reading of a batch
+    if (batchSampleCount == 0)
+    {
+        Clock_start(batchAgeClockHandle);
+    }
+
+    batchSamples[batchSampleCount].value = value;
+    batchSamples[batchSampleCount].ticks = ticks;
+    batchSampleCount++;
+
+    // Send when full
+    if (batchSampleCount >= NODE_BATCH_MAX_SAMPLES)
+    {
+        flushBatch();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// flushBatch
+static void flushBatch(void)
+{
+    if (batchSampleCount == 0)
+    {
+        return;
+    }
+
+    Clock_stop(batchAgeClockHandle);
+
+    // Queue the batch for the concentrator and carry on sampling. If the queue is full the readings
+    // are dropped, counted in txQueue.rejectedCount
+    NodeRadioTask_submitBatchData(batchSamples, batchSampleCount, batchSendDone);
+    batchSampleCount = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// batchSendDone
+static void batchSendDone(enum NodeRadioOperationStatus status, uint16_t messageId)
+{
+    //called from the radio task, failed batches are dropped like single readings were
+    if (status != NodeRadioStatus_Success)
+    {
+        failedBatchCount++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// configReceived
+static void configReceived(const struct NodeConfig* config)
+{
+    UInt key;
+
+    //called from the radio task, the button and fast report callbacks must not see half a change
+    key = Hwi_disable();
+    if (config->fields & RADIO_CONFIG_REPORT_INTERVAL_SLOW)
+    {
+        nodeConfig.reportIntervalSlow = config->reportIntervalSlow;
+    }
+    if (config->fields & RADIO_CONFIG_REPORT_INTERVAL_FAST)
+    {
+        nodeConfig.reportIntervalFast = config->reportIntervalFast;
+    }
+    if (config->fields & RADIO_CONFIG_FAST_DURATION)
+    {
+        nodeConfig.fastDurationSec = config->fastDurationSec;
+    }
+    if (config->fields & RADIO_CONFIG_BIN_WIDTH)
+    {
+        nodeConfig.binWidth = config->binWidth;
+    }
+    if (config->fields & RADIO_CONFIG_BATCH_MAX_AGE)
+    {
+        nodeConfig.batchMaxAgeSec = config->batchMaxAgeSec;
+    }
+    if (config->fields & RADIO_CONFIG_HYSTERESIS)
+    {
+        nodeConfig.hysteresis = config->hysteresis;
+    }
+    nodeConfig.version = config->version;
+    nodeConfig.fields |= config->fields;
+
+    //carry on in the current report mode with the new settings
+    if (Clock_isActive(fastReportTimeoutClockHandle))
+    {
+        SceAdc_setReportInterval(nodeConfig.reportIntervalFast);
+    }
+    else
+    {
+        SceAdc_setReportInterval(nodeConfig.reportIntervalSlow);
+    }
+    Hwi_restore(key);
+
+    if (config->fields & (RADIO_CONFIG_BIN_WIDTH | RADIO_CONFIG_HYSTERESIS))
+    {
+        setTempThresholds();
+    }
+
+    //the timeouts are used from the next time the clocks are started
+    Clock_setTimeout(fastReportTimeoutClockHandle, secondsToTicks(nodeConfig.fastDurationSec));
+    Clock_setTimeout(batchAgeClockHandle, secondsToTicks(nodeConfig.batchMaxAgeSec));
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// setTempThresholds
+// Puts a report threshold every nodeConfig.binWidth hundredths of a degree, around NODE_TEMPTASK_THRESHOLD_CENTER
+static void setTempThresholds(void)
+{
+    uint16_t thresholds[SCEADC_MAX_THRESHOLDS];
+    uint16_t adcThreshold;
+    int32_t threshold;
+    uint8_t count = 0;
+    uint8_t i;
+
+    //a bin width of 0 leaves a single bin, only the minimum report interval reports then
+    if (nodeConfig.binWidth != 0)
+    {
+        //the ADC reading goes down as the temperature goes up, so going down in temperature keeps
+        //the thresholds in ascending order for the SCE
+        threshold = NODE_TEMPTASK_THRESHOLD_CENTER + (int32_t)(SCEADC_MAX_THRESHOLDS / 2) * nodeConfig.binWidth;
+        for (i = 0; i < SCEADC_MAX_THRESHOLDS; i++)
+        {
+            //wide bins do not all fit the conversion table, and narrow ones can fall on the same
+            //ADC reading
+            if ((threshold > TEMPCONV_MIN_CENTI_C) && (threshold < TEMPCONV_MAX_CENTI_C))
+            {
+                adcThreshold = TempConversion_toAdc((int16_t)threshold, TEMPCONV_BOARD_OFFSET);
+                if ((count == 0) || (adcThreshold > thresholds[count - 1]))
+                {
+                    thresholds[count++] = adcThreshold;
+                }
+            }
+            threshold -= nodeConfig.binWidth;
+        }
+    }
+
+    SceAdc_setThresholds(thresholds, count, nodeConfig.hysteresis);
+}
+
+//------------------------------------------------------------------------------------------------------------------------
+// secondsToTicks
+static uint32_t secondsToTicks(uint16_t seconds)
+{
+    //a clock timeout must not be 0, and the longest ones do not fit the tick count
+    if (seconds == 0)
+    {
+        seconds = 1;
+    }
+    if (seconds > 0xFFFFFFFF / (1000000 / Clock_tickPeriod))
+    {
+        return 0xFFFFFFFF;
+    }
+    return (uint32_t)seconds * (1000000 / Clock_tickPeriod);
 }
 
 //------------------------------------------------------------------------------------------------------------------------
@@ -34,14 +34,128 @@
 #define RADIOPROTOCOL_H_
 
 #include "stdint.h"
-#include "easylink/EasyLink.h"
+
+/* The packet definitions and RadioProtocol.c do not depend on the radio or
+ * TI-RTOS, so they can also be built for a host. RADIO_EASYLINK_MODULATION
+ * needs easylink/EasyLink.h where it is used. */
 
 #define RADIO_CONCENTRATOR_ADDRESS     0x00
+#define RADIO_UNJOINED_ADDRESS         0xFE
+#define RADIO_BROADCAST_ADDRESS        0xFF
+
+/* Address of a node that has not been given one by the concentrator yet */
+#define RADIO_ADDRESS_UNASSIGNED       RADIO_UNJOINED_ADDRESS
 #define RADIO_EASYLINK_MODULATION     EasyLink_Phy_Custom
 
 #define RADIO_PACKET_TYPE_ACK_PACKET             0
 #define RADIO_PACKET_TYPE_ADC_SENSOR_PACKET      1
 #define RADIO_PACKET_TYPE_DM_SENSOR_PACKET       2
+#define RADIO_PACKET_TYPE_BATCH_SENSOR_PACKET    3
+#define RADIO_PACKET_TYPE_BEACON_PACKET          4
+#define RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET    5
+#define RADIO_PACKET_TYPE_JOIN_RESPONSE_PACKET   6
+#define RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET   7
+
+#define RADIO_IEEE_ADDRESS_SIZE                  8
+
+/* Most samples in a BatchSensorPacket, 10 + 4 * 8 bytes fits well within
+ * EASYLINK_MAX_DATA_LENGTH while keeping the concentrator's queues small */
+#define RADIO_BATCH_MAX_SAMPLES                  8
+
+/* TDMA superframe, started by a BeaconPacket from the concentrator:
+ *
+ *   | beacon | offset | slot 0 | slot 1 | ... | slot n-1 | contention ... |
+ *
+ * Slots start RADIO_TDMA_FIRST_SLOT_OFFSET_MS after the beacon is received.
+ * A node sends in the slot it was given in an AckPacket. Nodes without a slot
+ * send with CCA in the contention period after the last slot, which ends
+ * RADIO_TDMA_GUARD_MS before the next beacon.
+ *
+ * Beacons are always sent on channel RADIO_CHANNEL_BEACON. The rest of the
+ * superframe is on the channel named in the beacon, the concentrator goes
+ * round the channels that are not blacklisted one superframe at a time. The
+ * ack gives a node a channel along with its slot, and the node sends in that
+ * slot of the superframes on its channel. Nodes without a slot, or whose
+ * channel has been blacklisted, send in the contention period of any
+ * superframe. Channel n is at RADIO_CHANNEL_SPACING_HZ * n above the
+ * frequency set in smartrf_settings, keep them inside the band in use. */
+#define RADIO_TDMA_FIRST_SLOT_OFFSET_MS          10
+#define RADIO_TDMA_GUARD_MS                      10
+#define RADIO_TDMA_NO_SLOT                       0xFF
+
+/* May be overridden from the build options, the same on the nodes and the
+ * concentrator */
+#ifndef RADIO_CHANNEL_COUNT
+#define RADIO_CHANNEL_COUNT                      3
+#endif
+#define RADIO_CHANNEL_SPACING_HZ                 200000
+#define RADIO_CHANNEL_BEACON                     0
+#define RADIO_CHANNEL_ANY                        0xFF
+
+#if RADIO_CHANNEL_COUNT > 8
+#error RADIO_CHANNEL_COUNT does not fit the beacon channel mask
+#endif
+
+/* Node settings the concentrator can push in an AckPacket. Only the fields
+ * set in NodeConfig.fields are sent, in the order of their bits. Every field
+ * is 2 bytes, so a node skips the fields it does not know. */
+#define RADIO_CONFIG_REPORT_INTERVAL_SLOW        (1 << 0)
+#define RADIO_CONFIG_REPORT_INTERVAL_FAST        (1 << 1)
+#define RADIO_CONFIG_FAST_DURATION               (1 << 2)
+#define RADIO_CONFIG_BIN_WIDTH                   (1 << 3)
+#define RADIO_CONFIG_BATCH_MAX_AGE               (1 << 4)
+#define RADIO_CONFIG_HYSTERESIS                  (1 << 5)
+#define RADIO_CONFIG_FIELD_COUNT                 6
+
+/* Config version of a node that has not been configured by the concentrator */
+#define RADIO_CONFIG_NO_VERSION                  0
+
+/* SensorReport, a compact and extensible replacement for the fixed layouts of
+ * the DualModeSensorPacket and BatchSensorPacket:
+ *
+ *   0     source address
+ *   1     packet type
+ *   2     format version (bits 7-4) | sample count (bits 3-0)
+ *   3     sequence (bits 7-4) | reference (bits 3-0)
+ *   4     fields present, varint, bit n for field n
+ *   ...   the values of the fields present, in field order
+ *
+ * Varints hold 7 bits per byte, least significant first, the top bit marks
+ * that more bytes follow. Every value is sent as the zigzag encoded
+ * difference to a reference, so a value that changed little takes one byte.
+ * Fields 0 to 7 have one value per report, sent against the value in the
+ * report named by reference. Fields 8 to 15 have one value per sample, oldest
+ * first, the first sent against the last sample of the reference and each
+ * other one against the sample before. A field left out keeps the value of
+ * the reference, in all samples.
+ *
+ * The sender uses its last acked report as the reference. With reference
+ * RADIO_REPORT_NO_REFERENCE the values are sent against 0 and a field left
+ * out is not reported. A new sensor type takes the next free field number,
+ * receivers skip the values of the fields they do not know. */
+#define RADIO_REPORT_FORMAT_VERSION              1
+#define RADIO_REPORT_NO_REFERENCE                0
+#define RADIO_REPORT_SEQUENCE_MASK               0x0F
+
+#define RADIO_FIELD_UPTIME                       0   /* Node uptime in 100 ms when sent */
+#define RADIO_FIELD_BATT                         1
+#define RADIO_FIELD_BUTTON                       2
+#define RADIO_FIELD_CONFIG_VERSION               3   /* Last NodeConfig applied by the node */
+#define RADIO_FIELD_AGE                          8   /* Taken this many 100 ms before uptime */
+#define RADIO_FIELD_ADC                          9
+#define RADIO_FIELD_HUMIDITY                     10
+#define RADIO_FIELD_MOTION                       11
+#define RADIO_FIELD_CO2                          12
+#define RADIO_FIELD_FIRST_SAMPLE_FIELD           8
+#define RADIO_FIELD_BIT(field)                   ((uint16_t)1 << (field))
+
+/* Fields kept in a SensorReport, others are skipped */
+#define RADIO_REPORT_VALUE_COUNT                 4
+#define RADIO_REPORT_SAMPLE_FIELD_COUNT          5
+
+#if RADIO_BATCH_MAX_SAMPLES > 15
+#error RADIO_BATCH_MAX_SAMPLES does not fit the report sample count
+#endif
 
 struct PacketHeader {
     uint8_t sourceAddress;
@@ -61,8 +175,136 @@ struct DualModeSensorPacket {
     uint8_t button;
 };
 
+struct BatchSample {
+    uint16_t adcValue;
+    uint16_t age100MiliSec;     /* Taken this long before time100MiliSec */
+};
+
+/* Several readings in one transmission, oldest sample first */
+struct BatchSensorPacket {
+    struct PacketHeader header;
+    uint16_t batt;
+    uint32_t time100MiliSec;    /* Node uptime when the packet was sent */
+    uint8_t button;
+    uint8_t sampleCount;
+    struct BatchSample samples[RADIO_BATCH_MAX_SAMPLES];
+    uint8_t configVersion;      /* Last NodeConfig applied by the node */
+};
+
+struct NodeConfig {
+    uint8_t version;            /* RADIO_CONFIG_NO_VERSION if nothing to push */
+    uint8_t fields;             /* RADIO_CONFIG_* of the fields below that are set */
+    uint16_t reportIntervalSlow;    /* In ADC sampling periods */
+    uint16_t reportIntervalFast;    /* In ADC sampling periods */
+    uint16_t fastDurationSec;       /* Time fast reporting lasts after a button press */
+    uint16_t binWidth;              /* Temperature between two report thresholds in 0.01 C, 0 for none */
+    uint16_t batchMaxAgeSec;        /* Longest a reading waits in a batch */
+    uint16_t hysteresis;            /* ADC counts a reading must pass a threshold by */
+};
+
 struct AckPacket {
     struct PacketHeader header;
+    uint8_t slot;               /* TDMA slot of the node, RADIO_TDMA_NO_SLOT if none */
+    uint8_t channel;            /* Channel of the slot, RADIO_CHANNEL_ANY if none */
+    struct NodeConfig config;   /* Only sent if config.version is set */
 };
 
+/* Sent to RADIO_BROADCAST_ADDRESS at the start of every superframe */
+struct BeaconPacket {
+    struct PacketHeader header;
+    uint8_t sequence;
+    uint8_t slotCount;
+    uint8_t slotMs;
+    uint16_t superframeMs;      /* Time from this beacon to the next one */
+    uint8_t channel;            /* Channel of this superframe */
+    uint8_t channelMask;        /* Channels that are not blacklisted */
+};
+
+/* Sent from RADIO_UNJOINED_ADDRESS by a node that has no address yet */
+struct JoinRequestPacket {
+    struct PacketHeader header;
+    uint8_t ieeeAddr[RADIO_IEEE_ADDRESS_SIZE];
+};
+
+/* Answers a JoinRequestPacket, sent to RADIO_UNJOINED_ADDRESS. Also answers a
+ * packet from an address the concentrator has not given out, with address
+ * RADIO_UNJOINED_ADDRESS, which tells the node to join again. */
+struct JoinResponsePacket {
+    struct PacketHeader header;
+    uint8_t ieeeAddr[RADIO_IEEE_ADDRESS_SIZE];
+    uint8_t address;
+};
+
+struct SensorReport {
+    struct PacketHeader header;
+    uint8_t sequence;           /* 1 to RADIO_REPORT_SEQUENCE_MASK */
+    uint8_t reference;          /* Sequence of the reference, set by unpack */
+    uint8_t sampleCount;
+    uint16_t fields;            /* RADIO_FIELD_BIT of the fields reported */
+    uint32_t values[RADIO_REPORT_VALUE_COUNT];
+    uint16_t samples[RADIO_REPORT_SAMPLE_FIELD_COUNT][RADIO_BATCH_MAX_SAMPLES];
+};
+
+/* The part of a report the next one is sent against */
+struct SensorReportReference {
+    uint8_t sequence;           /* RADIO_REPORT_NO_REFERENCE if there is none */
+    uint16_t fields;
+    uint32_t values[RADIO_REPORT_VALUE_COUNT];
+    uint16_t lastSamples[RADIO_REPORT_SAMPLE_FIELD_COUNT];
+};
+
+/* Size of the packets on air, the structs may be padded */
+#define RADIO_PACKET_HEADER_SIZE          2
+#define RADIO_ADC_SENSOR_PACKET_SIZE      4
+#define RADIO_DM_SENSOR_PACKET_SIZE      11
+#define RADIO_ACK_PACKET_SIZE             4
+#define RADIO_ACK_PACKET_MAX_SIZE         (RADIO_ACK_PACKET_SIZE + 2 + 2 * RADIO_CONFIG_FIELD_COUNT)
+#define RADIO_BEACON_PACKET_SIZE          9
+#define RADIO_JOIN_REQUEST_PACKET_SIZE   10
+#define RADIO_JOIN_RESPONSE_PACKET_SIZE  11
+#define RADIO_BATCH_SENSOR_PACKET_SIZE(sampleCount)  (11 + 4 * (sampleCount))
+
+/* Largest SensorReport with all value fields and sampleFields sample fields */
+#define RADIO_SENSOR_REPORT_MAX_SIZE(sampleFields) \
+    (7 + 5 * RADIO_REPORT_VALUE_COUNT + 3 * (sampleFields) * RADIO_BATCH_MAX_SAMPLES)
+
+/* Serializes the packet into buf, multi-byte fields big endian.
+ * Returns the number of bytes written. */
+uint8_t RadioProtocol_packAdcSensorPacket(const struct AdcSensorPacket* packet, uint8_t* buf);
+uint8_t RadioProtocol_packDmSensorPacket(const struct DualModeSensorPacket* packet, uint8_t* buf);
+uint8_t RadioProtocol_packAckPacket(const struct AckPacket* packet, uint8_t* buf);
+uint8_t RadioProtocol_packBatchSensorPacket(const struct BatchSensorPacket* packet, uint8_t* buf);
+uint8_t RadioProtocol_packBeaconPacket(const struct BeaconPacket* packet, uint8_t* buf);
+uint8_t RadioProtocol_packJoinRequestPacket(const struct JoinRequestPacket* packet, uint8_t* buf);
+uint8_t RadioProtocol_packJoinResponsePacket(const struct JoinResponsePacket* packet, uint8_t* buf);
+
+/* Parses a received payload of len bytes.
+ * Returns 0 if it is too short for the packet, or of another packet type. */
+uint8_t RadioProtocol_unpackHeader(const uint8_t* buf, uint8_t len, struct PacketHeader* header);
+uint8_t RadioProtocol_unpackAdcSensorPacket(const uint8_t* buf, uint8_t len, struct AdcSensorPacket* packet);
+uint8_t RadioProtocol_unpackDmSensorPacket(const uint8_t* buf, uint8_t len, struct DualModeSensorPacket* packet);
+uint8_t RadioProtocol_unpackBatchSensorPacket(const uint8_t* buf, uint8_t len, struct BatchSensorPacket* packet);
+uint8_t RadioProtocol_unpackBeaconPacket(const uint8_t* buf, uint8_t len, struct BeaconPacket* packet);
+uint8_t RadioProtocol_unpackJoinRequestPacket(const uint8_t* buf, uint8_t len, struct JoinRequestPacket* packet);
+uint8_t RadioProtocol_unpackJoinResponsePacket(const uint8_t* buf, uint8_t len, struct JoinResponsePacket* packet);
+
+/* Acks from concentrators without TDMA have no slot, they are accepted with
+ * slot RADIO_TDMA_NO_SLOT. Acks and beacons from concentrators on a single
+ * channel give RADIO_CHANNEL_ANY. Acks without config give config.version
+ * RADIO_CONFIG_NO_VERSION, as do batches from nodes that do not send one. */
+uint8_t RadioProtocol_unpackAckPacket(const uint8_t* buf, uint8_t len, struct AckPacket* packet);
+
+/* Packs the report against reference, or against 0 if reference is NULL or
+ * has no sequence. Only fields that differ from the reference are sent. */
+uint8_t RadioProtocol_packSensorReport(const struct SensorReport* packet, const struct SensorReportReference* reference,
+                                       uint8_t* buf);
+
+/* Unpacks a report sent against reference, which may be NULL if the receiver
+ * has none. Returns 0 if the report was sent against another reference. */
+uint8_t RadioProtocol_unpackSensorReport(const uint8_t* buf, uint8_t len, const struct SensorReportReference* reference,
+                                         struct SensorReport* packet);
+
+/* Makes the report the reference for the next one */
+void RadioProtocol_setSensorReportReference(const struct SensorReport* packet, struct SensorReportReference* reference);
+
 #endif /* RADIOPROTOCOL_H_ */
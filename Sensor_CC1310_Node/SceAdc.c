@@ -37,44 +37,150 @@
 #include <xdc/std.h>
 #include <xdc/runtime/System.h>
 
-/* SCE Header files */
+/* BIOS Header files */
+#include <ti/sysbios/hal/Hwi.h>
+
+/* SCE Header files, scif.c and scif.h are generated from sce/adc_sample.scp by Sensor Controller
+ * Studio */
 #include "sce/scif.h"
 #include "sce/scif_framework.h"
 #include "sce/scif_osal_tirtos.h"
 
+#if !defined(SCIF_ADC_SAMPLE_BUFFER_SIZE) || !defined(SCIF_ADC_SAMPLE_BIN_COUNT) || \
+    !defined(SCIF_ADC_SAMPLE_MAX_OVERSAMPLE_LOG2) || !defined(SCIF_ADC_SAMPLE_MAX_FILTER_SHIFT) || \
+    !defined(SCIF_ADC_SAMPLE_MAX_RATE_SHIFT)
+#error "sce/scif.c and sce/scif.h are older than sce/adc_sample.scp, generate them again with Sensor Controller Studio"
+#elif (SCIF_ADC_SAMPLE_BUFFER_SIZE != SCEADC_MAX_SAMPLES) || (SCIF_ADC_SAMPLE_BIN_COUNT != SCEADC_BIN_COUNT) || \
+    (SCIF_ADC_SAMPLE_MAX_OVERSAMPLE_LOG2 != SCEADC_MAX_OVERSAMPLE_LOG2) || \
+    (SCIF_ADC_SAMPLE_MAX_FILTER_SHIFT != SCEADC_MAX_FILTER_SHIFT) || \
+    (SCIF_ADC_SAMPLE_MAX_RATE_SHIFT != SCEADC_MAX_RATE_SHIFT)
+#error "The limits in SceAdc.h do not match the SCE task in sce/adc_sample.scp"
+#endif
+
 
 /***** Variable declarations *****/
 static SceAdc_adcCallback adcCallback;
+static SceAdc_Sample samples[SCEADC_MAX_SAMPLES];
+static uint32_t samplingTime;           /* Base sampling period the RTC runs at */
+static uint32_t requestedSamplingTime;  /* Set when the SCE acknowledges periodSeq */
+static uint16_t periodSeq;
+static uint16_t rtcRateShift;           /* The RTC runs at samplingTime << rtcRateShift */
+uint32_t sceAdcOverflowCount;  /* not static so you can see in ROV */
 
 
 /***** Prototypes *****/
 static void ctrlReadyCallback(void);
 static void taskAlertCallback(void);
+static void updateRtcPeriod(void);
 
 
 /***** Function definitions *****/
-void SceAdc_init(uint32_t samplingTime, uint32_t minReportInterval, uint16_t adcChangeMask) {
+void SceAdc_init(uint32_t newSamplingTime, uint32_t minReportInterval) {
     // Initialize the Sensor Controller
     scifOsalInit();
     scifOsalRegisterCtrlReadyCallback(ctrlReadyCallback);
     scifOsalRegisterTaskAlertCallback(taskAlertCallback);
     scifInit(&scifDriverSetup);
-    scifStartRtcTicksNow(samplingTime);
+    scifStartRtcTicksNow(newSamplingTime);
+    samplingTime = newSamplingTime;
+    requestedSamplingTime = newSamplingTime;
 
     SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
-    pCfg->changeMask = adcChangeMask;
     //Set minimum report interval in units of samplingTime
     pCfg->minReportInterval = minReportInterval;
+    //Wake up the CM3 for every sample until told otherwise
+    pCfg->samplesPerAlert = 1;
+    //Fixed sampling rate until told otherwise
+    pCfg->maxRateShift = 0;
+    //A single bin, until the application sets its thresholds
+    SceAdc_setThresholds(NULL, 0, 0);
 }
 
-void SceAdc_setReportInterval(uint32_t minReportInterval, uint16_t adcChangeMask) {
-    //Set the repot inteval and min change in the SC config structure
+void SceAdc_setReportInterval(uint32_t minReportInterval) {
+    //Set the repot inteval in the SC config structure
     SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
-    pCfg->changeMask = adcChangeMask;
     //Set minimum report interval in units of samplingTime
     pCfg->minReportInterval = minReportInterval;
 }
 
+void SceAdc_setSamplingTime(uint32_t newSamplingTime) {
+    //The RTC is only moved once the SCE has handed over the samples taken at the old period, see
+    //updateRtcPeriod
+    UInt key = Hwi_disable();
+    requestedSamplingTime = newSamplingTime;
+    periodSeq++;
+    SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
+    pCfg->periodSeq = periodSeq;
+    Hwi_restore(key);
+}
+
+void SceAdc_setAdaptiveRate(uint8_t maxRateShift, uint16_t flatSamples) {
+    if (maxRateShift > SCEADC_MAX_RATE_SHIFT) {
+        maxRateShift = SCEADC_MAX_RATE_SHIFT;
+    }
+    if (flatSamples == 0) {
+        flatSamples = 1;
+    }
+
+    SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
+    pCfg->flatSamples = flatSamples;
+    pCfg->maxRateShift = maxRateShift;
+}
+
+void SceAdc_setThresholds(const uint16_t* thresholds, uint8_t count, uint16_t hysteresis) {
+    SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
+    uint8_t i;
+
+    if (count > SCEADC_MAX_THRESHOLDS) {
+        count = SCEADC_MAX_THRESHOLDS;
+    }
+
+    //The SC expects the table to start at 0 and end at the largest ADC value, the bins that are
+    //not used are left empty at the top
+    pCfg->hysteresis = hysteresis;
+    pCfg->pThresholds[0] = 0;
+    for (i = 0; i < SCEADC_MAX_THRESHOLDS; i++) {
+        if ((i < count) && (thresholds[i] < SCEADC_MAX_ADC_VALUE)) {
+            pCfg->pThresholds[i + 1] = thresholds[i];
+        } else {
+            pCfg->pThresholds[i + 1] = SCEADC_MAX_ADC_VALUE;
+        }
+    }
+    pCfg->pThresholds[SCEADC_BIN_COUNT] = SCEADC_MAX_ADC_VALUE;
+}
+
+void SceAdc_setFilter(uint8_t oversampleLog2, uint8_t filterShift) {
+    //Keep the sum of the readings and the filter state within 16 bits on the SC
+    if (oversampleLog2 > SCEADC_MAX_OVERSAMPLE_LOG2) {
+        oversampleLog2 = SCEADC_MAX_OVERSAMPLE_LOG2;
+    }
+    if (filterShift > SCEADC_MAX_FILTER_SHIFT) {
+        filterShift = SCEADC_MAX_FILTER_SHIFT;
+    }
+
+    SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
+    pCfg->oversampleLog2 = oversampleLog2;
+    pCfg->filterShift = filterShift;
+}
+
+uint16_t SceAdc_getRawValue(void) {
+    //The output is owned by the SC until a buffer is full, the state is always up to date
+    SCIF_ADC_SAMPLE_STATE_T* pState = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_STATE);
+    return pState->rawAdcValue;
+}
+
+void SceAdc_setSamplesPerAlert(uint8_t samplesPerAlert) {
+    if (samplesPerAlert == 0) {
+        samplesPerAlert = 1;
+    }
+    if (samplesPerAlert > SCEADC_MAX_SAMPLES) {
+        samplesPerAlert = SCEADC_MAX_SAMPLES;
+    }
+
+    SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
+    pCfg->samplesPerAlert = samplesPerAlert;
+}
+
 void SceAdc_start(void) {
     // Start task
     scifStartTasksNbl((1 <<SCIF_ADC_SAMPLE_TASK_ID));
@@ -93,20 +199,72 @@ static void taskAlertCallback(void) {
     /* Clear the ALERT interrupt source */
     scifClearAlertIntSource();
 
-    /* Only handle the periodic event alert */
-    if (scifGetAlertEvents() & (1 << SCIF_ADC_SAMPLE_TASK_ID))
+    uint32_t alertEvents = scifGetAlertEvents();
+
+    /* Both buffers were full, the SCE has refilled one of them */
+    if (alertEvents & (1 << (SCIF_ADC_SAMPLE_TASK_ID + 8)))
     {
+        sceAdcOverflowCount++;
+    }
 
-        /* Get the SCE "output" structure */
-        SCIF_ADC_SAMPLE_OUTPUT_T* pOutput = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_OUTPUT);
+    /* Only handle the output buffer event alert */
+    if (alertEvents & (1 << SCIF_ADC_SAMPLE_TASK_ID))
+    {
+        uint32_t bufferCount = scifGetTaskIoStructAvailCount(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_OUTPUT);
 
-        /* Send new ADC value to application via callback */
-        if (adcCallback)
+        while (bufferCount--)
         {
-            adcCallback(pOutput->adcValue);
+            /* Get the SCE "output" buffer, and copy it out so it can go straight back to the SCE */
+            SCIF_ADC_SAMPLE_OUTPUT_T* pOutput = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_OUTPUT);
+            uint8_t count = pOutput->sampleCount;
+            uint8_t i;
+
+            if (count > SCEADC_MAX_SAMPLES)
+            {
+                count = SCEADC_MAX_SAMPLES;
+            }
+            for (i = 0; i < count; i++)
+            {
+                /* The ticks are in base sampling periods, samplingTime is in 1/65536 s */
+                uint16_t ticks = pOutput->pSampleTicks[count - 1] - pOutput->pSampleTicks[i];
+                samples[i].adcValue = pOutput->pSamples[i];
+                samples[i].ageMs = (uint32_t)(((uint64_t)ticks * samplingTime * 1000) >> 16);
+            }
+            scifHandoffTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_OUTPUT);
+
+            /* Send the whole buffer to application via callback */
+            if (adcCallback && (count > 0))
+            {
+                adcCallback(samples, count);
+            }
         }
+
+        /* The SCE also alerts when the sampling period has to change */
+        updateRtcPeriod();
     }
 
     /* Acknowledge the alert event */
     scifAckAlertEvents();
 }
+
+/* Moves the RTC to the sampling period the SCE has requested, and acknowledges the rate shift in
+ * cfg.rtcRateShift. The SCE times its samples with the acknowledged rate shift, and requests a new
+ * one, or acknowledges a new base period, in the execution that hands over the samples taken at the
+ * old period, so this is only done after those samples have been timed. */
+static void updateRtcPeriod(void) {
+    SCIF_ADC_SAMPLE_STATE_T* pState = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_STATE);
+    SCIF_ADC_SAMPLE_CFG_T* pCfg = scifGetTaskStruct(SCIF_ADC_SAMPLE_TASK_ID, SCIF_STRUCT_CFG);
+    uint32_t newSamplingTime = samplingTime;
+    uint16_t rateShift = pState->reqRateShift;
+
+    if (pState->periodSeq == periodSeq) {
+        newSamplingTime = requestedSamplingTime;
+    }
+
+    if ((newSamplingTime != samplingTime) || (rateShift != rtcRateShift)) {
+        samplingTime = newSamplingTime;
+        rtcRateShift = rateShift;
+        scifStartRtcTicksNow(samplingTime << rateShift);
+    }
+    pCfg->rtcRateShift = rateShift;
+}
@@ -34,35 +34,131 @@
 #define SCEADC_H_
 
 #include "stdint.h"
-#include "sce/scif.h"
 
 
-typedef void(*SceAdc_adcCallback)(uint16_t adcValue);
+/* The limits of the SCE task in sce/adc_sample.scp, SceAdc.c checks them against the driver
+ * generated from it */
+
+/* Largest number of samples in one callback, BUFFER_SIZE of the SCE task */
+#define SCEADC_MAX_SAMPLES 8
+
+/* Number of ADC value bins, BIN_COUNT of the SCE task */
+#define SCEADC_BIN_COUNT 16
+
+/* Largest number of thresholds given to SceAdc_setThresholds */
+#define SCEADC_MAX_THRESHOLDS (SCEADC_BIN_COUNT - 1)
+
+/* Largest oversampleLog2 and filterShift of SceAdc_setFilter */
+#define SCEADC_MAX_OVERSAMPLE_LOG2 4
+#define SCEADC_MAX_FILTER_SHIFT 6
+
+/* Largest maxRateShift of SceAdc_setAdaptiveRate */
+#define SCEADC_MAX_RATE_SHIFT 7
+
+/* Largest ADC value */
+#define SCEADC_MAX_ADC_VALUE 4095
+
+/* A filtered ADC value, see SceAdc_setFilter */
+typedef struct {
+    uint16_t adcValue;
+    uint32_t ageMs;     /* Time before the newest sample of the same callback */
+} SceAdc_Sample;
+
+/* Called with a full buffer of samples, oldest first. The newest sample was taken just before the
+ * callback. samples is only valid during the callback. */
+typedef void(*SceAdc_adcCallback)(const SceAdc_Sample* samples, uint8_t count);
 
 /* Intializes the SCE ADC sampling task.
  *
- * This loads the SCE with the ADC sampling task, sets the sampling time and the ADC change mask.
- * The ADC change mask can be used to mask the bits that needs to be changed for the ADC task to
- * signal, and potentially wake up, the CM3 with a new sensor value update.
+ * This loads the SCE with the ADC sampling task and sets the sampling time.
  * The Minimun Report Interval will be used to send sensor data on a minimum interval incase sensor
  * data does not change within this time. The Minimun Report Interval can be set to 0 if no minimum
  * report interval is required.
+ * No thresholds are set, so only the minimum report interval reports samples until
+ * SceAdc_setThresholds is called.
  *
  * Note that this does not start the task, see SceAdc_start for starting a task.
  */
-void SceAdc_init(uint32_t samplingTime, uint32_t minReportInterval, uint16_t adcChangeMask);
+void SceAdc_init(uint32_t samplingTime, uint32_t minReportInterval);
 
-/* Sets the SCE ADC sampling task report interval and minimum change.
+/* Sets the SCE ADC sampling task report interval.
  *
- * The ADC change mask can be used to mask the bits that needs to be changed for the ADC task to
- * signal, and potentially wake up, the CM3 with a new sensor value update.
  * The Minimun Report Interval will be used to send sensor data on a minimum interval incase sensor
  * data does not change within this time. The Minimun Report Interval can be set to 0 if no minimum
  * report interval is required.
  *
  * Note that this can be called after the task has been started.
  */
-void SceAdc_setReportInterval(uint32_t minReportInterval, uint16_t adcChangeMask);
+void SceAdc_setReportInterval(uint32_t minReportInterval);
+
+/* Changes the base sampling period while the task is running.
+ *
+ * samplingTime is in the format of SceAdc_init, seconds in bits 31:16 and 1/65536 seconds in bits
+ * 15:0. The SCE acknowledges the request with its next sample, handing over the samples taken at
+ * the old period, and only then is the RTC moved to the new period. The samples of one callback
+ * are therefore always timed with the period they were taken at. The minimum report interval is in
+ * base sampling periods, so it changes with the base period.
+ *
+ * Note that this can be called after the task has been started.
+ */
+void SceAdc_setSamplingTime(uint32_t samplingTime);
+
+/* Lets the SCE adapt the sampling rate to the signal.
+ *
+ * The SCE samples at the base sampling period while the filtered value moves across thresholds,
+ * and halves the sampling rate each time the value has stayed in its bin for flatSamples samples,
+ * down to 1/2^maxRateShift of the base rate. The first sample that moves to another bin takes it
+ * straight back to the base rate. Every rate change alerts the CM3 and hands over the output
+ * buffer early. The SCE keeps timing its samples with the old rate until the CM3 has moved the
+ * RTC to the new period and acknowledged it. The minimum report interval stays in base sampling
+ * periods. A maxRateShift of 0 keeps the base rate, maxRateShift is limited to
+ * SCEADC_MAX_RATE_SHIFT and samplingTime << maxRateShift must fit 32 bits.
+ *
+ * Note that this can be called after the task has been started.
+ */
+void SceAdc_setAdaptiveRate(uint8_t maxRateShift, uint16_t flatSamples);
+
+/* Sets the thresholds that split the ADC range into bins.
+ *
+ * A sample is reported, and potentially wakes up the CM3, when the filtered ADC value moves to
+ * another bin. To leave its bin the value must pass the threshold by hysteresis ADC counts, so a
+ * value sitting on a threshold is not reported again and again. thresholds holds count values in
+ * ascending order between 0 and SCEADC_MAX_ADC_VALUE, count is limited to SCEADC_MAX_THRESHOLDS.
+ * With a count of 0 only the minimum report interval reports samples.
+ *
+ * Note that this can be called after the task has been started. A sample taken while the table is
+ * written may be reported even though it did not cross a threshold.
+ */
+void SceAdc_setThresholds(const uint16_t* thresholds, uint8_t count, uint16_t hysteresis);
+
+/* Sets the SCE ADC sampling task filtering.
+ *
+ * Each sample is the average of 2^oversampleLog2 ADC readings taken back to back, then the sample
+ * goes through an IIR filter that moves the filtered value 1/2^filterShift of the way towards it.
+ * The thresholds and the callback work on the filtered value, so noise around a threshold does
+ * not wake up the CM3. A filterShift of 0 turns the filter off. oversampleLog2 is limited to
+ * SCEADC_MAX_OVERSAMPLE_LOG2 and filterShift to SCEADC_MAX_FILTER_SHIFT.
+ *
+ * Note that this can be called after the task has been started.
+ */
+void SceAdc_setFilter(uint8_t oversampleLog2, uint8_t filterShift);
+
+/* Returns the latest averaged ADC value, before the filter */
+uint16_t SceAdc_getRawValue(void);
+
+/* Sets the number of samples collected before the callback is called.
+ *
+ * Samples that cross a threshold or the minimum report interval are stored in a double-buffered
+ * output on the SCE, and the CM3 is only woken up when a buffer holds samplesPerAlert samples, so it
+ * can stay in standby for several reports. A value of 1 calls the callback with every sample.
+ * samplesPerAlert is limited to 1..SCEADC_MAX_SAMPLES. If the CM3 has not emptied the other buffer
+ * when one is full, the SCE refills the full buffer and the samples in it are lost, see
+ * sceAdcOverflowCount.
+ *
+ * Note that this can be called after the task has been started, a smaller value takes effect with
+ * the next sample.
+ */
+void SceAdc_setSamplesPerAlert(uint8_t samplesPerAlert);
 
 /* Register the callback used for receiving the updated ADC value.
  *
@@ -57,6 +57,13 @@ The following is true for receive operation:
 - EasyLink_receive() is blocking and EasyLink_receiveAsync() is nonblocking.
 - the EasyLink API does not queue messages so calling another API function
   while in EasyLink_receiveAsync() will return ::EasyLink_Status_Busy_Error
+- EasyLink_receiveContinuousAsync() keeps the radio in RX over a circular
+  queue of ::EASYLINK_RX_QUEUE_ENTRIES packets and calls the callback for
+  every packet without leaving RX. A transmit stops it and resumes it again
+  once the TX is done.
+- EasyLink_receiveContinuousLoanAsync() does the same, but lends the packets
+  to the application in place in the queue instead of copying them. Each
+  loan is given back with EasyLink_returnRxLoan().
 - an Async operation can be cancelled with EasyLink_abort()
 
 The following apply for transmit operation:
@@ -105,8 +112,16 @@ drive documentation for more details.
 | EasyLink_transmit()           | Blocking Transmit                                  |
 | EasyLink_transmitAsync()      | Non-blocking Transmit                              |
 | EasyLink_transmitCCAAsync()   | Non-blocking Transmit with Clear Channel Assessment|
+| EasyLink_reserveTxBuffer()    | Hands the Tx buffer to the application             |
+| EasyLink_commitTxBuffer()     | Completes the frame built in the Tx buffer         |
+| EasyLink_releaseTxBuffer()    | Returns the Tx buffer to EasyLink                  |
+| EasyLink_transmitCommittedAsync() | Non-blocking Transmit of the committed frame   |
+| EasyLink_transmitCommittedCCAAsync() | Non-blocking CCA Transmit of the committed frame |
 | EasyLink_receive()            | Blocking Receive                                   |
 | EasyLink_receiveAsync()       | Nonblocking Receive                                |
+| EasyLink_receiveContinuousAsync() | Nonblocking Receive that stays in RX           |
+| EasyLink_receiveContinuousLoanAsync() | Continuous Receive without copying         |
+| EasyLink_returnRxLoan()       | Gives a received packet back to the Rx queue       |
 | EasyLink_abort()              | Aborts a non blocking call                         |
 | EasyLink_EnableRxAddrFilter() | Enables/Disables RX filtering on the Addr          |
 | EasyLink_GetIeeeAddr()        | Gets the IEEE Address                              |
@@ -166,6 +181,12 @@ extern "C"
 //! \brief defines the Max number of Rx Address filters
 #define EASYLINK_MAX_ADDR_FILTERS           3
 
+#ifndef EASYLINK_RX_QUEUE_ENTRIES
+//! \brief defines the number of packets EasyLink_receiveContinuousAsync() can
+//! hold before the application has to consume them
+#define EASYLINK_RX_QUEUE_ENTRIES           4
+#endif
+
 #if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
 //! \brief Minimum CCA back-off window in units of
 //! EASYLINK_CCA_BACKOFF_TIMEUNITS, as a power of 2
@@ -239,6 +260,28 @@ typedef enum
 
     EasyLink_Ctrl_Test_Tone = 4,         //!< Enable/Disable Test mode for Tone
     EasyLink_Ctrl_Test_Signal = 5,       //!< Enable/Disable Test mode for Signal
+
+    EasyLink_Ctrl_Cca_MinBackoffWindow = 6, //!< Minimum CCA back-off window as a
+                                            //!< power of 2, defaults to
+                                            //!< EASYLINK_MIN_CCA_BACKOFF_WINDOW
+
+    EasyLink_Ctrl_Cca_MaxBackoffWindow = 7, //!< Maximum CCA back-off window as a
+                                            //!< power of 2, at most 15, defaults to
+                                            //!< EASYLINK_MAX_CCA_BACKOFF_WINDOW
+
+    EasyLink_Ctrl_Cca_BackoffTimeUnits = 8, //!< CCA back-off time unit in us, defaults
+                                            //!< to EASYLINK_CCA_BACKOFF_TIMEUNITS
+
+    EasyLink_Ctrl_Cca_RssiThreshold = 9,    //!< CCA busy threshold in dBm (int8_t),
+                                            //!< defaults to EASYLINK_CS_RSSI_THRESHOLD_DBM
+
+    EasyLink_Ctrl_Cca_BusyCount = 10,       //!< Number of times CCA found the channel
+                                            //!< busy and backed off, may be reset by
+                                            //!< setting it
+
+    EasyLink_Ctrl_Rx_ErrorCount = 11,       //!< Number of packets received with a CRC
+                                            //!< error, over all Rx commands, wraps at
+                                            //!< 2^32, may be reset by setting it
 } EasyLink_CtrlOption;
 
 //! \brief Structure for EasyLink_init_multimode() and EasyLink_Params_init()
@@ -278,6 +321,23 @@ typedef struct
 typedef void (*EasyLink_ReceiveCb)(EasyLink_RxPacket * rxPacket,
         EasyLink_Status status);
 
+//! \brief Packet lent from the continuous Rx queue, see
+//! EasyLink_receiveContinuousLoanAsync(). dstAddr and payload point into the
+//! queue entry, which belongs to the application until EasyLink_returnRxLoan().
+typedef struct
+{
+        uint8_t *dstAddr;                //!< Dst Address of RX'ed packet
+        uint8_t *payload;                //!< payload of RX'ed packet
+        uint8_t len;                     //!< length of RX'ed packet
+        int8_t rssi;                     //!< rssi of RX'ed packet
+        uint32_t absTime;                //!< Absolute time that packet was Rx
+} EasyLink_RxLoan;
+
+//! \brief EasyLink Callback function type for lent Received packets,
+//! registered with EasyLink_receiveContinuousLoanAsync()
+typedef void (*EasyLink_ReceiveLoanCb)(EasyLink_RxLoan * rxLoan,
+        EasyLink_Status status);
+
 //! \brief EasyLink Callback function type for Tx Done registered with EasyLink_TransmitAsync()
 typedef void (*EasyLink_TxDoneCb)(EasyLink_Status status);
 
@@ -405,7 +465,10 @@ extern EasyLink_Status EasyLink_transmitAsync(EasyLink_TxPacket *txPacket,
 //! for a random period, in time units of EASYLINK_CCA_BACKOFF_TIMEUNITS, before
 //! reassessing. It does this a certain number
 //! (EASYLINK_MAX_CCA_BACKOFF_WINDOW - EASYLINK_MIN_CCA_BACKOFF_WINDOW)
-//! of times before quitting unsuccessfully and running to the callback.
+//! of times before quitting unsuccessfully and running to the callback with
+//! ::EasyLink_Status_Busy_Error. The back-off windows, time unit and RSSI
+//! threshold can be changed at runtime with EasyLink_setCtrl(), they take
+//! effect with the next call.
 //! If the Tx is successfully scheduled then the callback will be called once
 //! the Tx is complete. 
 //!
@@ -420,6 +483,92 @@ extern EasyLink_Status EasyLink_transmitCCAAsync(EasyLink_TxPacket *txPacket,
         EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn);
 #endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
 
+//*****************************************************************************
+//
+//! \brief Reserves the Tx buffer for building frames in place.
+//!
+//! The other transmit functions copy the payload of an ::EasyLink_TxPacket
+//! into the Tx buffer. Instead, the application can reserve the buffer and
+//! write its payload straight into it, up to EASYLINK_MAX_DATA_LENGTH bytes,
+//! then complete the frame with EasyLink_commitTxBuffer() and send it with
+//! EasyLink_transmitCommittedAsync() or EasyLink_transmitCommittedCCAAsync().
+//! A committed frame stays in the buffer, so it can be sent again, e.g. as a
+//! retry, without building it again.
+//!
+//! The payload pointer stays valid until EasyLink_releaseTxBuffer(), so the
+//! buffer can be reserved once at startup. It must not be written while a
+//! transmission of it is in progress. While the buffer is reserved
+//! EasyLink_transmit(), EasyLink_transmitAsync() and
+//! EasyLink_transmitCCAAsync() return ::EasyLink_Status_Busy_Error.
+//!
+//! \param ppPayload Set to where the payload is to be written.
+//!
+//! \return ::EasyLink_Status
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_reserveTxBuffer(uint8_t **ppPayload);
+
+//*****************************************************************************
+//
+//! \brief Completes the frame written to the reserved Tx buffer.
+//!
+//! Adds the destination address in front of the payload, this is the only
+//! copy made. Must be called again after the payload is changed.
+//!
+//! \param dstAddr Destination address, of the size set with
+//!                ::EasyLink_Ctrl_AddSize
+//! \param len     Length of the payload written.
+//!
+//! \return ::EasyLink_Status
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_commitTxBuffer(uint8_t *dstAddr, uint8_t len);
+
+//*****************************************************************************
+//
+//! \brief Returns the reserved Tx buffer to EasyLink.
+//!
+//! The committed frame is discarded.
+//
+//*****************************************************************************
+extern void EasyLink_releaseTxBuffer(void);
+
+//*****************************************************************************
+//
+//! \brief Sends the committed frame with a non blocking call.
+//!
+//! Like EasyLink_transmitAsync(), for the frame completed with
+//! EasyLink_commitTxBuffer().
+//!
+//! \param absTime Absolute radio time to send at, 0 for now.
+//! \param cb      The tx done function pointer.
+//!
+//! \return ::EasyLink_Status
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_transmitCommittedAsync(uint32_t absTime,
+        EasyLink_TxDoneCb cb);
+
+#if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+//*****************************************************************************
+//
+//! \brief Sends the committed frame with a non blocking call if the channel
+//! is idle.
+//!
+//! Like EasyLink_transmitCCAAsync(), for the frame completed with
+//! EasyLink_commitTxBuffer().
+//!
+//! \param absTime Absolute radio time to start the CCA at, 0 for now.
+//! \param cb      The tx done function pointer.
+//! \param grn     The random number generator function pointer
+//!
+//! \return ::EasyLink_Status
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_transmitCommittedCCAAsync(uint32_t absTime,
+        EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn);
+#endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+
 //*****************************************************************************
 //
 //! \brief Blocking call that waits for an Rx Packet.
@@ -451,6 +600,80 @@ extern EasyLink_Status EasyLink_receive(EasyLink_RxPacket *rxPacket);
 //*****************************************************************************
 extern EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime);
 
+//*****************************************************************************
+//
+//! \brief Enables continuous Asynchronous Packet Rx with non blocking call.
+//!
+//! This function is a non blocking call to Rx packets without leaving Rx
+//! between them. The radio fills a circular queue of
+//! ::EASYLINK_RX_QUEUE_ENTRIES entries and the callback is called with
+//! ::EasyLink_Status_Success once for every received packet, in order, while
+//! the radio keeps listening. The rssi and absTime fields of the packet are
+//! those of that packet. The packet is only valid during the callback.
+//!
+//! Rx keeps running until EasyLink_abort() is called, in which case the
+//! callback is called once more with a status other than
+//! ::EasyLink_Status_Success. The ::EasyLink_Ctrl_AsyncRx_TimeOut does not
+//! apply.
+//!
+//! EasyLink_transmit(), EasyLink_transmitAsync(),
+//! EasyLink_transmitCCAAsync() and the committed frame variants may be called
+//! while continuous Rx is running.
+//! Rx is stopped after the packet currently being received and resumed on
+//! the same queue when the Tx is done. Other API functions that reconfigure
+//! the radio return ::EasyLink_Status_Busy_Error until Rx is aborted.
+//!
+//! \param cb        The rx function pointer.
+//! \param absTime   Start time of Rx (0: now !0: absolute radio time to
+//!                  start Rx)
+//!
+//! \return ::EasyLink_Status
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_receiveContinuousAsync(EasyLink_ReceiveCb cb, uint32_t absTime);
+
+//*****************************************************************************
+//
+//! \brief Enables continuous Asynchronous Packet Rx that lends the packets
+//! to the application.
+//!
+//! Like EasyLink_receiveContinuousAsync(), but the packets are not copied
+//! out of the Rx queue. The callback gets an ::EasyLink_RxLoan pointing into
+//! the queue entry the radio filled. From then on the entry belongs to the
+//! application, which may keep it past the callback, and the radio can not
+//! use it until it is given back with EasyLink_returnRxLoan(). Loans may be
+//! given back in any order. While all ::EASYLINK_RX_QUEUE_ENTRIES entries
+//! are lent out, further packets are lost, so an application that decodes
+//! in the callback should give the loan back before it returns.
+//!
+//! When Rx ends the callback is called with a status other than
+//! ::EasyLink_Status_Success and a NULL loan. Rx can only be started again
+//! once every loan has been given back, else ::EasyLink_Status_Busy_Error is
+//! returned.
+//!
+//! \param cb        The rx function pointer.
+//! \param absTime   Start time of Rx (0: now !0: absolute radio time to
+//!                  start Rx)
+//!
+//! \return ::EasyLink_Status
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_receiveContinuousLoanAsync(EasyLink_ReceiveLoanCb cb, uint32_t absTime);
+
+//*****************************************************************************
+//
+//! \brief Gives a packet lent by EasyLink_receiveContinuousLoanAsync() back
+//! to the Rx queue.
+//!
+//! The loan and the data it points to must not be used afterwards. Loans
+//! that were not handed out by EasyLink are ignored. May be called from the
+//! callback, a Swi or a task.
+//!
+//! \param rxLoan    The loan to give back.
+//
+//*****************************************************************************
+extern void EasyLink_returnRxLoan(EasyLink_RxLoan *rxLoan);
+
 //*****************************************************************************
 //
 //! \brief Abort a previously call Async Tx/Rx.
@@ -469,6 +692,8 @@ extern EasyLink_Status EasyLink_abort(void);
 //!
 //! This function set the radio to the specified frequency. Note that this will
 //! be rounded to the nearest frequency supported by the Frequency Synthesizer.
+//! Continuous Rx started with EasyLink_receiveContinuousAsync() is stopped for
+//! the retune and carries on at the new frequency.
 //!
 //! \param ui16Freq Frequency in units of kHz
 //!
@@ -493,6 +718,20 @@ extern EasyLink_Status EasyLink_setFrequency(uint32_t ui16Freq);
 //*****************************************************************************
 extern uint32_t EasyLink_getFrequency(void);
 
+//*****************************************************************************
+//
+//! \brief Gets the RSSI
+//!
+//! This function gets the current RSSI of the channel while the receiver is
+//! on, for example to measure the noise floor between packets.
+//!
+//! \param pRssi Pointer to the RSSI in dBm
+//!
+//! \return ::EasyLink_Status, ::EasyLink_Status_Rx_Error if not in Rx
+//
+//*****************************************************************************
+extern EasyLink_Status EasyLink_getRssi(int8_t *pRssi);
+
 //*****************************************************************************
 //
 //! \brief Enables the address filter
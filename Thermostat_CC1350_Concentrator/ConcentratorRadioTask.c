@@ -31,6 +31,8 @@
  */
 
 /***** Includes *****/
+#include <string.h>
+
 /* XDCtools Header files */ 
 #include <xdc/std.h>
 #include <xdc/runtime/System.h>
@@ -39,9 +41,11 @@
 
 /* BIOS Header files */ 
 #include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/hal/Hwi.h>
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Event.h>
+#include <ti/sysbios/knl/Clock.h>
 
 /* Drivers */
 #include <ti/drivers/rf/RF.h>
@@ -55,6 +59,13 @@
 
 /* Application Header files */ 
 #include "RadioProtocol.h"
+#include "PacketRing.h"
+#include "JoinTable.h"
+#include "TdmaSchedule.h"
+
+#ifdef CONCENTRATOR_LOADGEN
+#include "LoadGenerator.h"
+#endif
 
 
 /***** Defines *****/
@@ -63,15 +74,59 @@
 
 #define RADIO_EVENT_ALL                  0xFFFFFFFF
 #define RADIO_EVENT_VALID_PACKET_RECEIVED      (uint32_t)(1 << 0)
-#define RADIO_EVENT_INVALID_PACKET_RECEIVED (uint32_t)(1 << 1)
+#define RADIO_EVENT_RX_STOPPED                 (uint32_t)(1 << 1)
+#define RADIO_EVENT_TX_DONE                    (uint32_t)(1 << 2)
+#define RADIO_EVENT_SEND_BEACON                (uint32_t)(1 << 3)
 
 #define CONCENTRATORRADIO_MAX_RETRIES 2
 #define NORERADIO_ACK_TIMEOUT_TIME_MS (160)
 
+/* The channel of every superframe is measured just before the next beacon.
+ * A channel whose smoothed noise floor or share of packets with CRC errors
+ * gets too high is blacklisted, and tried again after
+ * CONCENTRATOR_CHANNEL_BLACKLIST_SUPERFRAMES. The beacon channel is never
+ * blacklisted. */
+#define CONCENTRATOR_CHANNEL_NOISE_DBM              (-90)
+#define CONCENTRATOR_CHANNEL_LOSS_PERCENT           20
+#define CONCENTRATOR_CHANNEL_BLACKLIST_SUPERFRAMES  600
+
+/* Noise floor a channel starts from, below the receiver's sensitivity */
+#define CONCENTRATOR_CHANNEL_INITIAL_NOISE_DBM      (-120)
+
 
 #define CONCENTRATOR_ACTIVITY_LED Board_PIN_LED0
 
 /***** Type declarations *****/
+struct ChannelStats {
+    int16_t noise;          /* Smoothed RSSI between packets, in 1/16 dBm */
+    int16_t loss;           /* Smoothed share of packets with CRC errors, in 1/16 % */
+    uint8_t blacklisted;
+    uint16_t blacklistedAt; /* Superframe it was blacklisted in */
+    uint32_t packetCount;
+    uint32_t errorCount;
+    uint32_t blacklistCount;
+};
+
+struct ChannelPlan {
+    struct ChannelStats channels[RADIO_CHANNEL_COUNT];
+    uint32_t baseFrequency; /* Frequency of channel 0 in Hz */
+    uint8_t current;        /* Channel of the running superframe */
+    uint8_t tuned;          /* Channel the radio is on */
+    uint8_t mask;           /* Channels not blacklisted */
+};
+
+struct NodeConfigEntry {
+    uint8_t address;
+    uint8_t used;
+    struct NodeConfig config;
+};
+
+struct NodeConfigTable {
+    struct NodeConfigEntry nodes[CONCENTRATOR_NODE_CONFIG_COUNT];
+    struct NodeConfig broadcast;    /* For nodes without their own entry */
+    uint8_t lastVersion;
+    uint32_t pushCount;             /* Acks sent with a config */
+};
 
 
 
@@ -85,18 +140,43 @@ static Event_Handle radioOperationEventHandle;
 
 
 static ConcentratorRadio_PacketReceivedCallback packetReceivedCallback;
-static union ConcentratorPacket latestRxPacket;
-static EasyLink_TxPacket txPacket;
+struct PacketRing rxPacketRing;  /* not static so you can see in ROV */
+static uint8_t* txPayload;  /* Reserved EasyLink Tx buffer, packets are built in place */
 static struct AckPacket ackPacket;
+static struct BeaconPacket beaconPacket;
+static struct JoinResponsePacket joinResponsePacket;
 static uint8_t concentratorAddress;
-static int8_t latestRssi;
+static volatile bool txInFlight;
+static bool beaconPending;
+struct TdmaSchedule tdmaSchedule;  /* not static so you can see in ROV */
+struct NodeConfigTable nodeConfigTable;  /* not static so you can see in ROV */
+struct ChannelPlan channelPlan;    /* not static so you can see in ROV */
+static volatile uint32_t superframePacketCount;
+static uint32_t lastRxErrorCount;
+struct JoinTable joinTable;        /* not static so you can see in ROV */
+static struct SensorReportReference reportReferences[JOINTABLE_MAX_NODES];
+uint32_t reportReferenceMissCount; /* not static so you can see in ROV */
+Clock_Struct beaconClock;          /* not static so you can see in ROV */
+static Clock_Handle beaconClockHandle;
 
 
 /***** Prototypes *****/
 static void concentratorRadioTaskFunction(UArg arg0, UArg arg1);
-static void rxDoneCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status);
-static void notifyPacketReceived(union ConcentratorPacket* latestRxPacket);
-static void sendAck(uint8_t latestSourceAddress);
+static void rxDoneCallback(EasyLink_RxLoan * rxLoan, EasyLink_Status status);
+static void queuePacket(const EasyLink_RxLoan* rxLoan);
+static void notifyPacketReceived(struct PacketRingEntry* rxEntry);
+static uint8_t unpackSensorReport(const EasyLink_RxLoan* rxLoan, struct SensorReport* report);
+static void sendAck(const union ConcentratorPacket* packet);
+static void sendJoinResponse(const union ConcentratorPacket* packet);
+static uint8_t isJoined(uint8_t address);
+static void sendBeacon(void);
+static void transmitPacket(uint8_t dstAddr, uint8_t len);
+static void endSuperframe(void);
+static void setChannel(uint8_t channel);
+static void getNodeConfig(uint8_t address, uint8_t reportedVersion, struct NodeConfig* config);
+static void mergeNodeConfig(struct NodeConfig* config, const struct NodeConfig* change, uint8_t version);
+static void txDoneCallback(EasyLink_Status status);
+static void beaconClockCallback(UArg arg0);
 
 /* Pin driver handle */
 static PIN_Handle ledPinHandle;
@@ -124,6 +204,18 @@ void ConcentratorRadioTask_init(void) {
     Event_construct(&radioOperationEvent, &eventParam);
     radioOperationEventHandle = Event_handle(&radioOperationEvent);
 
+    /* Set up the ring shared between rxDoneCallback and the task */
+    PacketRing_init(&rxPacketRing);
+
+    /* Create the periodic clock that starts the TDMA superframes, it is
+     * started once the radio is set up */
+    Clock_Params clkParams;
+    Clock_Params_init(&clkParams);
+    clkParams.period = CONCENTRATOR_TDMA_SUPERFRAME_MS * 1000 / Clock_tickPeriod;
+    clkParams.startFlag = FALSE;
+    Clock_construct(&beaconClock, beaconClockCallback, clkParams.period, &clkParams);
+    beaconClockHandle = Clock_handle(&beaconClock);
+
     /* Create the concentrator radio protocol task */
     Task_Params_init(&concentratorRadioTaskParams);
     concentratorRadioTaskParams.stackSize = CONCENTRATORRADIO_TASK_STACK_SIZE;
@@ -136,13 +228,26 @@ void ConcentratorRadioTask_registerPacketReceivedCallback(ConcentratorRadio_Pack
     packetReceivedCallback = callback;
 }
 
+#ifdef CONCENTRATOR_LOADGEN
+void ConcentratorRadioTask_injectPacket(EasyLink_RxLoan* rxLoan) {
+    rxDoneCallback(rxLoan, EasyLink_Status_Success);
+}
+#endif
+
 static void concentratorRadioTaskFunction(UArg arg0, UArg arg1)
 {
+    uint8_t i;
+
     /* Initialize EasyLink */
     if(EasyLink_init(RADIO_EASYLINK_MODULATION) != EasyLink_Status_Success) {
         System_abort("EasyLink_init failed");
     }
 
+    /* Acks, beacons and join responses are built in the radio's own Tx buffer */
+    if(EasyLink_reserveTxBuffer(&txPayload) != EasyLink_Status_Success) {
+        System_abort("EasyLink_reserveTxBuffer failed");
+    }
+
 
     /* If you wich to use a frequency other than the default use
      * the below API
@@ -157,26 +262,103 @@ static void concentratorRadioTaskFunction(UArg arg0, UArg arg1)
     ackPacket.header.sourceAddress = concentratorAddress;
     ackPacket.header.packetType = RADIO_PACKET_TYPE_ACK_PACKET;
 
-    /* Enter receive */
-    if(EasyLink_receiveAsync(rxDoneCallback, 0) != EasyLink_Status_Success) {
-        System_abort("EasyLink_receiveAsync failed");
+    /* Start on the beacon channel with all channels in use, the channels are
+     * spaced from the frequency in smartrf_settings */
+    channelPlan.baseFrequency = EasyLink_getFrequency();
+    channelPlan.current = RADIO_CHANNEL_BEACON;
+    channelPlan.tuned = RADIO_CHANNEL_BEACON;
+    channelPlan.mask = (1 << RADIO_CHANNEL_COUNT) - 1;
+    for (i = 0; i < RADIO_CHANNEL_COUNT; i++)
+    {
+        channelPlan.channels[i].noise = CONCENTRATOR_CHANNEL_INITIAL_NOISE_DBM * 16;
     }
 
+    /* Load the addresses given out before a reset */
+    JoinTable_init(&joinTable);
+
+    /* Set up join response packet */
+    joinResponsePacket.header.sourceAddress = concentratorAddress;
+    joinResponsePacket.header.packetType = RADIO_PACKET_TYPE_JOIN_RESPONSE_PACKET;
+
+    /* Set up beacon packet */
+    beaconPacket.header.sourceAddress = concentratorAddress;
+    beaconPacket.header.packetType = RADIO_PACKET_TYPE_BEACON_PACKET;
+    beaconPacket.slotCount = CONCENTRATOR_TDMA_SLOT_COUNT;
+    beaconPacket.slotMs = CONCENTRATOR_TDMA_SLOT_MS;
+    beaconPacket.superframeMs = CONCENTRATOR_TDMA_SUPERFRAME_MS;
+
+    /* Enter receive, the radio stays in RX between packets and only leaves
+     * it to send the acks */
+    if(EasyLink_receiveContinuousLoanAsync(rxDoneCallback, 0) != EasyLink_Status_Success) {
+        System_abort("EasyLink_receiveContinuousLoanAsync failed");
+    }
+
+    /* Start sending beacons */
+    Clock_start(beaconClockHandle);
+
+#ifdef CONCENTRATOR_LOADGEN
+    /* Start the synthetic traffic now that the radio is set up */
+    LoadGenerator_start();
+#endif
+
     while (1) {
         uint32_t events = Event_pend(radioOperationEventHandle, 0, RADIO_EVENT_ALL, BIOS_WAIT_FOREVER);
 
-        /* If valid packet received */
-        if(events & RADIO_EVENT_VALID_PACKET_RECEIVED) {
+        /* If a superframe starts */
+        if(events & RADIO_EVENT_SEND_BEACON) {
+            beaconPending = true;
+        }
 
-            /* Send ack packet */
-            sendAck(latestRxPacket.header.sourceAddress);
+        /* The beacon goes before any waiting ack, it is only held back by a
+         * TX already on air. Nodes time their slots from when they receive
+         * it, so a late beacon shifts the whole superframe with it. Acks
+         * still waiting then go out on the next superframe's channel, and
+         * are lost, but the guard period before the beacon keeps this rare. */
+        if(beaconPending && !txInFlight) {
+            beaconPending = false;
+            endSuperframe();
+            setChannel(RADIO_CHANNEL_BEACON);
+            sendBeacon();
+        }
 
-            /* Call packet received callback */
-            notifyPacketReceived(&latestRxPacket);
+        /* Once the beacon is out, move to the channel of the superframe */
+        if((channelPlan.tuned != channelPlan.current) && !txInFlight) {
+            setChannel(channelPlan.current);
+        }
 
-            /* Go back to RX */
-            if(EasyLink_receiveAsync(rxDoneCallback, 0) != EasyLink_Status_Success) {
-                System_abort("EasyLink_receiveAsync failed");
+        /* If valid packet received, or the previous TX is out of the way */
+        if(events & (RADIO_EVENT_VALID_PACKET_RECEIVED | RADIO_EVENT_TX_DONE)) {
+            struct PacketRingEntry* rxEntry;
+
+            /* Handle the queued packets one ack at a time, packets received
+             * meanwhile are picked up again on RADIO_EVENT_TX_DONE */
+            while ((!txInFlight) && ((rxEntry = PacketRing_peek(&rxPacketRing)) != NULL)) {
+
+                /* Join requests, and packets from addresses that were never
+                 * given out, only get a join response. The latter tells a
+                 * node that lost its address, or took one on its own, to
+                 * join again. */
+                if ((rxEntry->packet.header.packetType == RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET) ||
+                    (!isJoined(rxEntry->packet.header.sourceAddress)))
+                {
+                    sendJoinResponse(&rxEntry->packet);
+                }
+                else
+                {
+                    /* Start sending the ack packet, EasyLink goes back to RX as
+                     * soon as it is out */
+                    sendAck(&rxEntry->packet);
+
+#ifdef CONCENTRATOR_LOADGEN
+                    LoadGenerator_recordStage(LoadGenerator_Stage_RadioTask, rxEntry->rxTime);
+#endif
+
+                    /* Call packet received callback while the ack is on air */
+                    notifyPacketReceived(rxEntry);
+                }
+
+                /* Give the entry back to rxDoneCallback */
+                PacketRing_release(&rxPacketRing);
             }
 
             /* toggle Activity LED */
@@ -184,90 +366,531 @@ static void concentratorRadioTaskFunction(UArg arg0, UArg arg1)
                     !PIN_getOutputValue(CONCENTRATOR_ACTIVITY_LED));
         }
 
-        /* If invalid packet received */
-        if(events & RADIO_EVENT_INVALID_PACKET_RECEIVED) {
+        /* If RX was stopped by the radio */
+        if(events & RADIO_EVENT_RX_STOPPED) {
             /* Go back to RX */
-            if(EasyLink_receiveAsync(rxDoneCallback, 0) != EasyLink_Status_Success) {
-                System_abort("EasyLink_receiveAsync failed");
+            if(EasyLink_receiveContinuousLoanAsync(rxDoneCallback, 0) != EasyLink_Status_Success) {
+                System_abort("EasyLink_receiveContinuousLoanAsync failed");
             }
         }
     }
 }
 
-static void sendAck(uint8_t latestSourceAddress) {
+static void sendAck(const union ConcentratorPacket* packet) {
+    uint8_t latestSourceAddress = packet->header.sourceAddress;
 
-    /* Set destinationAdress, but use EasyLink layers destination adress capability */
-    txPacket.dstAddr[0] = latestSourceAddress;
+    /* Tell the node its TDMA slot */
+    ackPacket.slot = TdmaSchedule_getSlot(&tdmaSchedule, latestSourceAddress, channelPlan.mask,
+                                          &ackPacket.channel);
 
-    /* Copy ACK packet to payload, skipping the destination adress byte.
+    /* Add the node's config if it has not got it yet. Only batches and
+     * reports carry the node's config version, nodes sending other packets
+     * get none. */
+    if (packet->header.packetType == RADIO_PACKET_TYPE_BATCH_SENSOR_PACKET)
+    {
+        getNodeConfig(latestSourceAddress, packet->batchSensorPacket.configVersion, &ackPacket.config);
+    }
+    else if ((packet->header.packetType == RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET) &&
+             (packet->sensorReport.fields & RADIO_FIELD_BIT(RADIO_FIELD_CONFIG_VERSION)))
+    {
+        getNodeConfig(latestSourceAddress, packet->sensorReport.values[RADIO_FIELD_CONFIG_VERSION], &ackPacket.config);
+    }
+    else
+    {
+        ackPacket.config.version = RADIO_CONFIG_NO_VERSION;
+    }
+
+    /* Build the ACK packet in the Tx buffer, skipping the destination adress byte.
      * Note that the EasyLink API will implcitily both add the length byte and the destination address byte. */
-    memcpy(txPacket.payload, &ackPacket.header, sizeof(ackPacket));
-    txPacket.len = sizeof(ackPacket);
+    transmitPacket(latestSourceAddress, RadioProtocol_packAckPacket(&ackPacket, txPayload));
+}
 
-    /* Send packet  */
-    if (EasyLink_transmit(&txPacket) != EasyLink_Status_Success)
+static void sendJoinResponse(const union ConcentratorPacket* packet) {
+    uint8_t dstAddr;
+    UInt key;
+
+    /* Answer to the address the packet came from, which for a join request
+     * is RADIO_UNJOINED_ADDRESS, so every joining node hears it and picks its
+     * own by the IEEE address */
+    dstAddr = packet->header.sourceAddress;
+
+    if (packet->header.packetType == RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET)
     {
-        System_abort("EasyLink_transmit failed");
+        memcpy(joinResponsePacket.ieeeAddr, packet->joinRequestPacket.ieeeAddr, RADIO_IEEE_ADDRESS_SIZE);
+        joinResponsePacket.address = JoinTable_join(&joinTable, packet->joinRequestPacket.ieeeAddr);
+
+        /* The node starts its reports over against none. The Rx callback
+         * reads and replaces the same reference, so it is reset with
+         * interrupts off like the other state shared with the callback. */
+        if (joinResponsePacket.address != RADIO_UNJOINED_ADDRESS)
+        {
+            key = Hwi_disable();
+            reportReferences[joinResponsePacket.address - 1].sequence = RADIO_REPORT_NO_REFERENCE;
+            Hwi_restore(key);
+        }
     }
+    else
+    {
+        /* The sender is unknown, tell it to join again */
+        memset(joinResponsePacket.ieeeAddr, 0, RADIO_IEEE_ADDRESS_SIZE);
+        joinResponsePacket.address = RADIO_UNJOINED_ADDRESS;
+    }
+
+    transmitPacket(dstAddr, RadioProtocol_packJoinResponsePacket(&joinResponsePacket, txPayload));
 }
 
-static void notifyPacketReceived(union ConcentratorPacket* latestRxPacket)
+/* Returns 1 if the address was handed out by the join table */
+static uint8_t isJoined(uint8_t address)
 {
-    if (packetReceivedCallback)
+#ifdef CONCENTRATOR_LOADGEN
+    /* The synthetic nodes never join, they use the reserved addresses */
+    if (JoinTable_isReserved(address))
     {
-        packetReceivedCallback(latestRxPacket, latestRssi);
+        return 1;
     }
+#endif
+
+    return JoinTable_isJoined(&joinTable, address);
 }
 
-static void rxDoneCallback(EasyLink_RxPacket * rxPacket, EasyLink_Status status)
+static void sendBeacon(void) {
+
+    tdmaSchedule.superframe++;
+    beaconPacket.sequence++;
+    beaconPacket.channel = channelPlan.current;
+    beaconPacket.channelMask = channelPlan.mask;
+
+    /* Beacons go to all nodes */
+    transmitPacket(RADIO_BROADCAST_ADDRESS, RadioProtocol_packBeaconPacket(&beaconPacket, txPayload));
+}
+
+/* Sends the len byte packet built in txPayload to dstAddr. Nothing may be
+ * built in txPayload again until txDoneCallback has run. */
+static void transmitPacket(uint8_t dstAddr, uint8_t len) {
+
+    if (EasyLink_commitTxBuffer(&dstAddr, len) != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_commitTxBuffer failed");
+    }
+
+    /* Send packet, txDoneCallback is called when it is done */
+    txInFlight = true;
+    if (EasyLink_transmitCommittedAsync(0, txDoneCallback) != EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_transmitAsync failed");
+    }
+}
+
+/* Measures the channel of the superframe that is ending, updates the
+ * blacklist and moves on to the next channel in use */
+static void endSuperframe(void)
 {
-    union ConcentratorPacket* tmpRxPacket;
+    struct ChannelStats* stats = &channelPlan.channels[channelPlan.current];
+    uint32_t rxErrorCount = 0;
+    uint32_t errors;
+    uint32_t packets;
+    int16_t loss;
+    int8_t rssi;
+    uint8_t c;
+    UInt key;
+
+    key = Hwi_disable();
+    packets = superframePacketCount;
+    superframePacketCount = 0;
+    Hwi_restore(key);
+
+    /* The error counter is never reset, errors between reading and
+     * resetting it would be lost. The errors of the superframe are the
+     * difference to the last reading, which is wrap-safe. */
+    EasyLink_getCtrl(EasyLink_Ctrl_Rx_ErrorCount, &rxErrorCount);
+    errors = rxErrorCount - lastRxErrorCount;
+    lastRxErrorCount = rxErrorCount;
+
+    /* Nodes do not send in the guard period before the beacon, what is
+     * heard now is noise or another network */
+    if (EasyLink_getRssi(&rssi) == EasyLink_Status_Success)
+    {
+        stats->noise += ((int16_t)rssi * 16 - stats->noise) / 8;
+    }
+    if ((packets + errors) > 0)
+    {
+        loss = (int16_t)((errors * 100 * 16) / (packets + errors));
+        stats->loss += (loss - stats->loss) / 8;
+    }
+    stats->packetCount += packets;
+    stats->errorCount += errors;
 
-    /* If we received a packet successfully */
-    if (status == EasyLink_Status_Success)
+    if ((channelPlan.current != RADIO_CHANNEL_BEACON) &&
+        ((stats->noise > CONCENTRATOR_CHANNEL_NOISE_DBM * 16) ||
+         (stats->loss > CONCENTRATOR_CHANNEL_LOSS_PERCENT * 16)))
     {
-        /* Save the latest RSSI, which is later sent to the receive callback */
-        latestRssi = (int8_t)rxPacket->rssi;
+        /* The nodes on it get a slot on another channel with their next ack */
+        stats->blacklisted = 1;
+        stats->blacklistedAt = tdmaSchedule.superframe;
+        stats->blacklistCount++;
+        memset(tdmaSchedule.slots[channelPlan.current], 0, sizeof(tdmaSchedule.slots[0]));
+    }
 
-        /* Check that this is a valid packet */
-        tmpRxPacket = (union ConcentratorPacket*)(rxPacket->payload);
+    channelPlan.mask = 0;
+    for (c = 0; c < RADIO_CHANNEL_COUNT; c++)
+    {
+        stats = &channelPlan.channels[c];
+        if (stats->blacklisted &&
+            ((uint16_t)(tdmaSchedule.superframe - stats->blacklistedAt) > CONCENTRATOR_CHANNEL_BLACKLIST_SUPERFRAMES))
+        {
+            /* Try it again from scratch */
+            stats->blacklisted = 0;
+            stats->noise = CONCENTRATOR_CHANNEL_INITIAL_NOISE_DBM * 16;
+            stats->loss = 0;
+        }
+        if (!stats->blacklisted)
+        {
+            channelPlan.mask |= (1 << c);
+        }
+    }
+
+    /* Round robin over the channels in use, the beacon channel always is */
+    do
+    {
+        channelPlan.current = (channelPlan.current + 1) % RADIO_CHANNEL_COUNT;
+    } while (!(channelPlan.mask & (1 << channelPlan.current)));
+}
 
-        /* If this is a known packet */
-        if (tmpRxPacket->header.packetType == RADIO_PACKET_TYPE_ADC_SENSOR_PACKET)
+/* Tunes the radio to the channel, continuous RX carries on there. No TX may
+ * be in flight. */
+static void setChannel(uint8_t channel)
+{
+    if (EasyLink_setFrequency(channelPlan.baseFrequency + (uint32_t)channel * RADIO_CHANNEL_SPACING_HZ) !=
+        EasyLink_Status_Success)
+    {
+        System_abort("EasyLink_setFrequency failed");
+    }
+    channelPlan.tuned = channel;
+}
+
+uint8_t ConcentratorRadioTask_setNodeConfig(uint8_t address, const struct NodeConfig* config)
+{
+    struct NodeConfigEntry* entry = NULL;
+    uint8_t version;
+    uint8_t i;
+    UInt key;
+
+    key = Hwi_disable();
+
+    /* Versions count up from the last one given to any node, skipping
+     * RADIO_CONFIG_NO_VERSION */
+    version = nodeConfigTable.lastVersion + 1;
+    if (version == RADIO_CONFIG_NO_VERSION)
+    {
+        version++;
+    }
+
+    if (address == RADIO_BROADCAST_ADDRESS)
+    {
+        /* Nodes with their own config get the change too */
+        mergeNodeConfig(&nodeConfigTable.broadcast, config, version);
+        for (i = 0; i < CONCENTRATOR_NODE_CONFIG_COUNT; i++)
         {
-            /* Save packet */
-            latestRxPacket.header.sourceAddress = rxPacket->payload[0];
-            latestRxPacket.header.packetType = rxPacket->payload[1];
-            latestRxPacket.adcSensorPacket.adcValue = (rxPacket->payload[2] << 8) | rxPacket->payload[3];
+            if (nodeConfigTable.nodes[i].used)
+            {
+                mergeNodeConfig(&nodeConfigTable.nodes[i].config, config, version);
+            }
+        }
+        nodeConfigTable.lastVersion = version;
+        Hwi_restore(key);
+        return 1;
+    }
 
-            /* Signal packet received */
-            Event_post(radioOperationEventHandle, RADIO_EVENT_VALID_PACKET_RECEIVED);
+    for (i = 0; i < CONCENTRATOR_NODE_CONFIG_COUNT; i++)
+    {
+        if (nodeConfigTable.nodes[i].used && (nodeConfigTable.nodes[i].address == address))
+        {
+            entry = &nodeConfigTable.nodes[i];
+            break;
         }
-        else if (tmpRxPacket->header.packetType == RADIO_PACKET_TYPE_DM_SENSOR_PACKET)
+        if ((entry == NULL) && (!nodeConfigTable.nodes[i].used))
         {
-            /* Save packet */
-            latestRxPacket.header.sourceAddress = rxPacket->payload[0];
-            latestRxPacket.header.packetType = rxPacket->payload[1];
-            latestRxPacket.dmSensorPacket.adcValue = (rxPacket->payload[2] << 8) | rxPacket->payload[3];
-            latestRxPacket.dmSensorPacket.batt = (rxPacket->payload[4] << 8) | rxPacket->payload[5];
-            latestRxPacket.dmSensorPacket.time100MiliSec = (rxPacket->payload[6] << 24) |
-                                                           (rxPacket->payload[7] << 16) |
-                                                           (rxPacket->payload[8] << 8) |
-                                                            rxPacket->payload[9];
-            latestRxPacket.dmSensorPacket.button = rxPacket->payload[10];
-
-            /* Signal packet received */
-            Event_post(radioOperationEventHandle, RADIO_EVENT_VALID_PACKET_RECEIVED);
+            entry = &nodeConfigTable.nodes[i];
+        }
+    }
+
+    if (entry == NULL)
+    {
+        Hwi_restore(key);
+        return 0;
+    }
+
+    /* A new entry starts from what the node already has from the broadcast */
+    if (!entry->used)
+    {
+        entry->address = address;
+        entry->used = 1;
+        entry->config = nodeConfigTable.broadcast;
+    }
+    mergeNodeConfig(&entry->config, config, version);
+    nodeConfigTable.lastVersion = version;
+
+    Hwi_restore(key);
+    return 1;
+}
+
+/* Gets the config to send to the node, config->version is
+ * RADIO_CONFIG_NO_VERSION if the node already has it */
+static void getNodeConfig(uint8_t address, uint8_t reportedVersion, struct NodeConfig* config)
+{
+    uint8_t i;
+    UInt key;
+
+    key = Hwi_disable();
+
+    *config = nodeConfigTable.broadcast;
+    for (i = 0; i < CONCENTRATOR_NODE_CONFIG_COUNT; i++)
+    {
+        if (nodeConfigTable.nodes[i].used && (nodeConfigTable.nodes[i].address == address))
+        {
+            *config = nodeConfigTable.nodes[i].config;
+            break;
+        }
+    }
+
+    Hwi_restore(key);
+
+    if (config->version == reportedVersion)
+    {
+        config->version = RADIO_CONFIG_NO_VERSION;
+    }
+    else if (config->version != RADIO_CONFIG_NO_VERSION)
+    {
+        nodeConfigTable.pushCount++;
+    }
+}
+
+/* Sets the fields of change that are set in change->fields */
+static void mergeNodeConfig(struct NodeConfig* config, const struct NodeConfig* change, uint8_t version)
+{
+    if (change->fields & RADIO_CONFIG_REPORT_INTERVAL_SLOW)
+    {
+        config->reportIntervalSlow = change->reportIntervalSlow;
+    }
+    if (change->fields & RADIO_CONFIG_REPORT_INTERVAL_FAST)
+    {
+        config->reportIntervalFast = change->reportIntervalFast;
+    }
+    if (change->fields & RADIO_CONFIG_FAST_DURATION)
+    {
+        config->fastDurationSec = change->fastDurationSec;
+    }
+    if (change->fields & RADIO_CONFIG_BIN_WIDTH)
+    {
+        config->binWidth = change->binWidth;
+    }
+    if (change->fields & RADIO_CONFIG_BATCH_MAX_AGE)
+    {
+        config->batchMaxAgeSec = change->batchMaxAgeSec;
+    }
+    if (change->fields & RADIO_CONFIG_HYSTERESIS)
+    {
+        config->hysteresis = change->hysteresis;
+    }
+    config->fields |= change->fields;
+    config->version = version;
+}
+
+static void txDoneCallback(EasyLink_Status status)
+{
+    /* A lost ack is retried by the node and a lost beacon only makes the
+     * nodes listen a bit longer, so the status is not checked. RX is already
+     * resumed by EasyLink at this point. */
+    txInFlight = false;
+    Event_post(radioOperationEventHandle, RADIO_EVENT_TX_DONE);
+}
+
+static void beaconClockCallback(UArg arg0)
+{
+    Event_post(radioOperationEventHandle, RADIO_EVENT_SEND_BEACON);
+}
+
+static void notifyPacketReceived(struct PacketRingEntry* rxEntry)
+{
+    struct BatchSensorPacket* batch;
+    struct SensorReport* report;
+    union ConcentratorPacket sample;
+    uint16_t age;
+    uint8_t i;
+
+    if (!packetReceivedCallback)
+    {
+        return;
+    }
+
+    if (rxEntry->packet.header.packetType == RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET)
+    {
+        /* Passed on like a batch. Reports from nodes without an ADC have no
+         * reading for the application. */
+        report = &rxEntry->packet.sensorReport;
+        if (!(report->fields & RADIO_FIELD_BIT(RADIO_FIELD_ADC)))
+        {
+            return;
+        }
+        sample.dmSensorPacket.header = report->header;
+        sample.dmSensorPacket.header.packetType = RADIO_PACKET_TYPE_DM_SENSOR_PACKET;
+        sample.dmSensorPacket.batt = report->values[RADIO_FIELD_BATT];
+        sample.dmSensorPacket.button = report->values[RADIO_FIELD_BUTTON];
+
+        for (i = 0; i < report->sampleCount; i++)
+        {
+            age = report->samples[RADIO_FIELD_AGE - RADIO_FIELD_FIRST_SAMPLE_FIELD][i];
+            sample.dmSensorPacket.adcValue = report->samples[RADIO_FIELD_ADC - RADIO_FIELD_FIRST_SAMPLE_FIELD][i];
+            sample.dmSensorPacket.time100MiliSec = report->values[RADIO_FIELD_UPTIME] - age;
+            packetReceivedCallback(&sample, rxEntry->rssi, rxEntry->rxTime, age);
+        }
+        return;
+    }
+
+    if (rxEntry->packet.header.packetType != RADIO_PACKET_TYPE_BATCH_SENSOR_PACKET)
+    {
+        packetReceivedCallback(&rxEntry->packet, rxEntry->rssi, rxEntry->rxTime, 0);
+        return;
+    }
+
+    /* A batch is passed on as one DualMode packet per sample, oldest first.
+     * Each sample comes with its age so that the application sees when it
+     * was taken, not when the batch arrived. */
+    batch = &rxEntry->packet.batchSensorPacket;
+    sample.dmSensorPacket.header = batch->header;
+    sample.dmSensorPacket.header.packetType = RADIO_PACKET_TYPE_DM_SENSOR_PACKET;
+    sample.dmSensorPacket.batt = batch->batt;
+    sample.dmSensorPacket.button = batch->button;
+
+    for (i = 0; i < batch->sampleCount; i++)
+    {
+        sample.dmSensorPacket.adcValue = batch->samples[i].adcValue;
+        sample.dmSensorPacket.time100MiliSec = batch->time100MiliSec - batch->samples[i].age100MiliSec;
+        packetReceivedCallback(&sample, rxEntry->rssi, rxEntry->rxTime, batch->samples[i].age100MiliSec);
+    }
+}
+
+/* Unpacks a report against the node's last one, which it then replaces.
+ * Returns 0 if the node sent it against another one, the report is then not
+ * acked and the node's retry is sent against none. */
+static uint8_t unpackSensorReport(const EasyLink_RxLoan* rxLoan, struct SensorReport* report)
+{
+    struct SensorReportReference* reference = NULL;
+    uint8_t address = rxLoan->payload[0];
+
+    /* References are only kept for the addresses the join table gives out */
+    if ((address != RADIO_CONCENTRATOR_ADDRESS) && (address <= JOINTABLE_MAX_NODES))
+    {
+        reference = &reportReferences[address - 1];
+    }
+
+    if (!RadioProtocol_unpackSensorReport(rxLoan->payload, rxLoan->len, reference, report))
+    {
+        reportReferenceMissCount++;
+        return 0;
+    }
+
+    if (reference != NULL)
+    {
+        /* A retry of the report already taken as the reference, its ack got
+         * lost. It is acked again but its samples are not passed on twice. */
+        if (report->sequence == reference->sequence)
+        {
+            report->sampleCount = 0;
         }
         else
         {
-            /* Signal invalid packet received */
-            Event_post(radioOperationEventHandle, RADIO_EVENT_INVALID_PACKET_RECEIVED);
+            RadioProtocol_setSensorReportReference(report, reference);
         }
     }
+
+    return 1;
+}
+
+static void rxDoneCallback(EasyLink_RxLoan * rxLoan, EasyLink_Status status)
+{
+    /* If we received a packet successfully */
+    if (status == EasyLink_Status_Success)
+    {
+        /* Counted for the channel quality, whatever the packet is */
+        superframePacketCount++;
+
+        /* The packet is decoded straight from the EasyLink Rx queue entry,
+         * which goes back to the radio as soon as that is done */
+        queuePacket(rxLoan);
+        EasyLink_returnRxLoan(rxLoan);
+    }
     else
     {
-        /* Signal invalid packet received */
-        Event_post(radioOperationEventHandle, RADIO_EVENT_INVALID_PACKET_RECEIVED);
+        /* Continuous RX has ended, signal the task to restart it */
+        Event_post(radioOperationEventHandle, RADIO_EVENT_RX_STOPPED);
+    }
+}
+
+/* Decodes a received packet into rxPacketRing for the task */
+static void queuePacket(const EasyLink_RxLoan* rxLoan)
+{
+    struct PacketHeader header;
+    struct PacketRingEntry* rxEntry;
+    uint8_t valid;
+
+    /* Unknown packet types are dropped, the radio is still in RX */
+    if ((!RadioProtocol_unpackHeader(rxLoan->payload, rxLoan->len, &header)) ||
+        ((header.packetType != RADIO_PACKET_TYPE_ADC_SENSOR_PACKET) &&
+         (header.packetType != RADIO_PACKET_TYPE_DM_SENSOR_PACKET) &&
+         (header.packetType != RADIO_PACKET_TYPE_BATCH_SENSOR_PACKET) &&
+         (header.packetType != RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET) &&
+         (header.packetType != RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET)))
+    {
+        return;
+    }
+
+    /* Get a free slot, if the task has fallen behind the packet is dropped
+     * and counted in rxPacketRing.overflowCount. A full ring means a
+     * RADIO_EVENT_VALID_PACKET_RECEIVED is already pending, so nothing
+     * more needs to be posted. */
+    rxEntry = PacketRing_reserve(&rxPacketRing);
+    if (rxEntry == NULL)
+    {
+        return;
+    }
+
+    /* Save the RSSI and timestamp, which are later sent to the receive callback */
+    rxEntry->rssi = (int8_t)rxLoan->rssi;
+    rxEntry->rxTime = rxLoan->absTime;
+    rxEntry->age100MiliSec = 0;
+
+    /* Save packet, a truncated one is dropped by not committing the entry */
+    if (header.packetType == RADIO_PACKET_TYPE_ADC_SENSOR_PACKET)
+    {
+        valid = RadioProtocol_unpackAdcSensorPacket(rxLoan->payload, rxLoan->len,
+                                                    &rxEntry->packet.adcSensorPacket);
     }
+    else if (header.packetType == RADIO_PACKET_TYPE_DM_SENSOR_PACKET)
+    {
+        valid = RadioProtocol_unpackDmSensorPacket(rxLoan->payload, rxLoan->len,
+                                                   &rxEntry->packet.dmSensorPacket);
+    }
+    else if (header.packetType == RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET)
+    {
+        valid = unpackSensorReport(rxLoan, &rxEntry->packet.sensorReport);
+    }
+    else if (header.packetType == RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET)
+    {
+        valid = RadioProtocol_unpackJoinRequestPacket(rxLoan->payload, rxLoan->len,
+                                                      &rxEntry->packet.joinRequestPacket);
+    }
+    else
+    {
+        valid = RadioProtocol_unpackBatchSensorPacket(rxLoan->payload, rxLoan->len,
+                                                      &rxEntry->packet.batchSensorPacket);
+    }
+    if (!valid)
+    {
+        return;
+    }
+
+    /* Publish the entry and signal packet received */
+    PacketRing_commit(&rxPacketRing);
+    Event_post(radioOperationEventHandle, RADIO_EVENT_VALID_PACKET_RECEIVED);
 }
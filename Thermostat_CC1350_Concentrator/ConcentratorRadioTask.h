@@ -43,13 +43,29 @@ enum ConcentratorRadioOperationStatus {
     ConcentratorRadioStatus_FailedNotConnected,
 };
 
+/* Nodes that can have their own config, the others get the one set for
+ * RADIO_BROADCAST_ADDRESS */
+#ifndef CONCENTRATOR_NODE_CONFIG_COUNT
+#define CONCENTRATOR_NODE_CONFIG_COUNT 8
+#endif
+
 union ConcentratorPacket {
     struct PacketHeader header;
     struct AdcSensorPacket adcSensorPacket;
     struct DualModeSensorPacket dmSensorPacket;
+    struct BatchSensorPacket batchSensorPacket;
+    struct JoinRequestPacket joinRequestPacket;
+    struct SensorReport sensorReport;
 };
 
-typedef void (*ConcentratorRadio_PacketReceivedCallback)(union ConcentratorPacket* packet, int8_t rssi);
+/* Called from the ConcentratorRadioTask once per received packet. rxTime is the
+ * RAT timestamp at which the packet was received, age100MiliSec how old the
+ * reading already was then, non-zero for the samples of a batch. The age is
+ * kept apart because it can be longer than the RAT wraps, 17.9 minutes. The
+ * packet is only valid for the duration of the call, it may be a sample split
+ * off a batch on the stack, so the callee copies what it keeps. */
+typedef void (*ConcentratorRadio_PacketReceivedCallback)(union ConcentratorPacket* packet, int8_t rssi, uint32_t rxTime,
+                                                         uint16_t age100MiliSec);
 
 /* Create the ConcentratorRadioTask and creates all TI-RTOS objects */
 void ConcentratorRadioTask_init(void);
@@ -57,4 +73,22 @@ void ConcentratorRadioTask_init(void);
 /* Register the packet received callback */
 void ConcentratorRadioTask_registerPacketReceivedCallback(ConcentratorRadio_PacketReceivedCallback callback);
 
+/* Changes the settings of a node, or of all nodes with RADIO_BROADCAST_ADDRESS.
+ *
+ * Only the fields set in config->fields are changed, on top of those set
+ * before. The result gets a new version and is sent in the node's acks until
+ * the node reports that version in its batches, so acks are only longer until
+ * the config has arrived. Returns 0 if there is no room for another node.
+ * Can be called from any task.
+ */
+uint8_t ConcentratorRadioTask_setNodeConfig(uint8_t address, const struct NodeConfig* config);
+
+#ifdef CONCENTRATOR_LOADGEN
+#include "easylink/EasyLink.h"
+
+/* Feeds a synthetic packet into the receive path as if it came from the radio.
+ * The loan is not EasyLink's, so giving it back does nothing. */
+void ConcentratorRadioTask_injectPacket(EasyLink_RxLoan* rxLoan);
+#endif
+
 #endif /* TASKS_CONCENTRATORRADIOTASKTASK_H_ */
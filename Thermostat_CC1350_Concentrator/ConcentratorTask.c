@@ -31,6 +31,8 @@
  */
 
 /***** Includes *****/
+#include <stdlib.h>
+
 /* XDCtools Header files */ 
 #include <xdc/std.h>
 #include <xdc/runtime/System.h>
@@ -40,9 +42,11 @@
 #include <ti/sysbios/knl/Task.h>
 #include <ti/sysbios/knl/Semaphore.h>
 #include <ti/sysbios/knl/Event.h>
+#include <ti/sysbios/knl/Clock.h>
 
 /* TI-RTOS Header files */
 #include <ti/drivers/PIN.h>
+#include <ti/drivers/rf/RF.h>
 #include <ti/display/Display.h>
 #include <ti/display/DisplayExt.h>
 
@@ -53,6 +57,15 @@
 #include "ConcentratorRadioTask.h"
 #include "ConcentratorTask.h"
 #include "RadioProtocol.h"
+#include "PacketRing.h"
+#include "NodeTable.h"
+#include "NodeHistory.h"
+#include "Telemetry.h"
+#include "TempConversion.h"
+
+#ifdef CONCENTRATOR_LOADGEN
+#include "LoadGenerator.h"
+#endif
 
 
 /***** Defines *****/
@@ -61,17 +74,24 @@
 
 #define CONCENTRATOR_EVENT_ALL                         0xFFFFFFFF
 #define CONCENTRATOR_EVENT_NEW_ADC_SENSOR_VALUE    (uint32_t)(1 << 0)
-
-#define CONCENTRATOR_MAX_NODES 7
+#define CONCENTRATOR_EVENT_UPDATE_DISPLAY          (uint32_t)(1 << 1)
 
 #define CONCENTRATOR_DISPLAY_LINES 8
 
+/* Changed lines are redrawn at most once per period, 4 Hz */
+#define CONCENTRATOR_DISPLAY_PERIOD_MS 250
+
+/* Calibration offsets of the nodes in 0.01 C, as {address, offset} pairs. The
+ * JoinTable keeps the address of a board, so the offset stays with it. Nodes
+ * not listed have no offset. May be overridden from the build options. */
+#ifndef CONCENTRATOR_TEMP_OFFSETS
+#define CONCENTRATOR_TEMP_OFFSETS { RADIO_CONCENTRATOR_ADDRESS, 0 }
+#endif
+
 /***** Type declarations *****/
-struct AdcSensorNode {
+struct TempOffset {
     uint8_t address;
-    uint16_t latestAdcValue;
-    uint8_t button;
-    int8_t latestRssi;
+    int16_t offsetCentiC;
 };
 
 
@@ -81,20 +101,31 @@ Task_Struct concentratorTask;    /* not static so you can see in ROV */
 static uint8_t concentratorTaskStack[CONCENTRATOR_TASK_STACK_SIZE];
 Event_Struct concentratorEvent;  /* not static so you can see in ROV */
 static Event_Handle concentratorEventHandle;
-static struct AdcSensorNode latestActiveAdcSensorNode;
-struct AdcSensorNode knownSensorNodes[CONCENTRATOR_MAX_NODES];
-static struct AdcSensorNode* lastAddedSensorNode = knownSensorNodes;
+struct PacketRing concentratorPacketRing;  /* not static so you can see in ROV */
+struct NodeTable knownSensorNodes;  /* not static so you can see in ROV */
+struct NodeHistory sensorNodeHistory;  /* not static so you can see in ROV */
+static uint32_t uptimeSeconds;
+static uint32_t uptimeLastTicks;
+static uint32_t uptimeTickRemainder;
 static Display_Handle hDisplayLcd;
-static Display_Handle hDisplaySerial;
+Clock_Struct displayRefreshClock;  /* not static so you can see in ROV */
+static Clock_Handle displayRefreshClockHandle;
+static uint8_t dirtyLcdLines;  /* Bit per LCD line that needs to be redrawn */
+static const struct TempOffset tempOffsets[] = { CONCENTRATOR_TEMP_OFFSETS };
+static int32_t tempSumCentiC;  /* Sum of the latest temperatures of all nodes */
+int16_t averageTempCentiC;  /* not static so you can see in ROV */
 
 
 /***** Prototypes *****/
 static void concentratorTaskFunction(UArg arg0, UArg arg1);
-static void packetReceivedCallback(union ConcentratorPacket* packet, int8_t rssi);
+static void packetReceivedCallback(union ConcentratorPacket* packet, int8_t rssi, uint32_t rxTime,
+                                   uint16_t age100MiliSec);
+static void processPacket(struct PacketRingEntry* entry);
 static void updateLcd(void);
-static void addNewNode(struct AdcSensorNode* node);
-static void updateNode(struct AdcSensorNode* node);
-static uint8_t isKnownNodeAddress(uint8_t address);
+static void markLcdLineDirty(uint8_t line);
+static void displayRefreshCallback(UArg arg0);
+static uint32_t getUptimeSeconds(void);
+static int16_t getTempOffset(uint8_t address);
 
 
 /***** Function definitions *****/
@@ -106,6 +137,22 @@ void ConcentratorTask_init(void) {
     Event_construct(&concentratorEvent, &eventParam);
     concentratorEventHandle = Event_handle(&concentratorEvent);
 
+    /* Set up the ring shared with the radio task */
+    PacketRing_init(&concentratorPacketRing);
+
+    /* Start without any known nodes */
+    NodeTable_init(&knownSensorNodes);
+    NodeHistory_init(&sensorNodeHistory);
+
+    /* Create the one shot clock that paces the display refresh */
+    Clock_Params clkParams;
+    Clock_Params_init(&clkParams);
+    clkParams.period = 0;
+    clkParams.startFlag = FALSE;
+    Clock_construct(&displayRefreshClock, displayRefreshCallback,
+            CONCENTRATOR_DISPLAY_PERIOD_MS * 1000 / Clock_tickPeriod, &clkParams);
+    displayRefreshClockHandle = Clock_handle(&displayRefreshClock);
+
     /* Create the concentrator radio protocol task */
     Task_Params_init(&concentratorTaskParams);
     concentratorTaskParams.stackSize = CONCENTRATOR_TASK_STACK_SIZE;
@@ -116,28 +163,22 @@ void ConcentratorTask_init(void) {
 
 static void concentratorTaskFunction(UArg arg0, UArg arg1)
 {
-    /* Initialize display and try to open both UART and LCD types of display. */
+    /* Initialize display and try to open the LCD type of display. */
     Display_Params params;
     Display_Params_init(&params);
     params.lineClearMode = DISPLAY_CLEAR_BOTH;
 
-    /* Open both an available LCD display and an UART display.
+    /* Open an available LCD display.
      * Whether the open call is successful depends on what is present in the
      * Display_config[] array of the board file.
      *
-     * Note that for SensorTag evaluation boards combined with the SHARP96x96
-     * Watch DevPack, there is a pin conflict with UART such that one must be
-     * excluded, and UART is preferred by default. To display on the Watch
-     * DevPack, add the precompiler define BOARD_DISPLAY_EXCLUDE_UART.
+     * The UART is not used as a display, it carries the binary telemetry
+     * stream described in Telemetry.h instead.
      */
     hDisplayLcd = Display_open(Display_Type_LCD, &params);
-    hDisplaySerial = Display_open(Display_Type_UART, &params);
 
-    /* Check if the selected Display type was found and successfully opened */
-    if (hDisplaySerial)
-    {
-        Display_printf(hDisplaySerial, 0, 0, "Waiting for nodes...");
-    }
+    /* Open the UART for the readings, without it they are only shown on the LCD */
+    Telemetry_init();
 
     /* Check if the selected Display type was found and successfully opened */
     if (hDisplayLcd)
@@ -155,117 +196,229 @@ static void concentratorTaskFunction(UArg arg0, UArg arg1)
 
         /* If we got a new ADC sensor value */
         if(events & CONCENTRATOR_EVENT_NEW_ADC_SENSOR_VALUE) {
-            /* If we knew this node from before, update the value */
-            if(isKnownNodeAddress(latestActiveAdcSensorNode.address)) {
-                updateNode(&latestActiveAdcSensorNode);
-            }
-            else {
-                /* Else add it */
-                addNewNode(&latestActiveAdcSensorNode);
+            struct PacketRingEntry* entry;
+
+            /* Apply every queued packet, the LCD follows on the next refresh */
+            while ((entry = PacketRing_peek(&concentratorPacketRing)) != NULL) {
+                processPacket(entry);
+                PacketRing_release(&concentratorPacketRing);
             }
+        }
 
-            /* Update the values on the LCD */
+        /* If it is time to redraw the changed LCD lines */
+        if(events & CONCENTRATOR_EVENT_UPDATE_DISPLAY) {
             updateLcd();
         }
     }
 }
 
-static void packetReceivedCallback(union ConcentratorPacket* packet, int8_t rssi)
+static void packetReceivedCallback(union ConcentratorPacket* packet, int8_t rssi, uint32_t rxTime,
+                                   uint16_t age100MiliSec)
 {
-    /* If we recived an ADC sensor packet, for backward compatibility */
-    if (packet->header.packetType == RADIO_PACKET_TYPE_ADC_SENSOR_PACKET)
+    struct PacketRingEntry* entry;
+
+    /* Only sensor packets are of interest */
+    if ((packet->header.packetType != RADIO_PACKET_TYPE_ADC_SENSOR_PACKET) &&
+        (packet->header.packetType != RADIO_PACKET_TYPE_DM_SENSOR_PACKET))
+    {
+        return;
+    }
+
+    /* Queue the packet, if the task has fallen behind the packet is dropped
+     * and counted in concentratorPacketRing.overflowCount */
+    entry = PacketRing_reserve(&concentratorPacketRing);
+    if (entry == NULL)
     {
-        /* Save the values */
-        latestActiveAdcSensorNode.address = packet->header.sourceAddress;
-        latestActiveAdcSensorNode.latestAdcValue = packet->adcSensorPacket.adcValue;
-        latestActiveAdcSensorNode.button = 0; //no button value in ADC packet
-        latestActiveAdcSensorNode.latestRssi = rssi;
+        return;
+    }
 
-        Event_post(concentratorEventHandle, CONCENTRATOR_EVENT_NEW_ADC_SENSOR_VALUE);
+    /* Only the sensor packet is copied, not the whole union */
+    if (packet->header.packetType == RADIO_PACKET_TYPE_ADC_SENSOR_PACKET)
+    {
+        entry->packet.adcSensorPacket = packet->adcSensorPacket;
     }
-    /* If we recived an DualMode ADC sensor packet*/
-    else if(packet->header.packetType == RADIO_PACKET_TYPE_DM_SENSOR_PACKET)
+    else
     {
+        entry->packet.dmSensorPacket = packet->dmSensorPacket;
+    }
+    entry->rssi = rssi;
+    entry->rxTime = rxTime;
+    entry->age100MiliSec = age100MiliSec;
+    PacketRing_commit(&concentratorPacketRing);
 
-        /* Save the values */
-        latestActiveAdcSensorNode.address = packet->header.sourceAddress;
-        latestActiveAdcSensorNode.latestAdcValue = packet->dmSensorPacket.adcValue;
-        latestActiveAdcSensorNode.button = packet->dmSensorPacket.button;
-        latestActiveAdcSensorNode.latestRssi = rssi;
+    Event_post(concentratorEventHandle, CONCENTRATOR_EVENT_NEW_ADC_SENSOR_VALUE);
+}
 
-        Event_post(concentratorEventHandle, CONCENTRATOR_EVENT_NEW_ADC_SENSOR_VALUE);
+static void processPacket(struct PacketRingEntry* entry)
+{
+    struct AdcSensorNode* node;
+    struct NodeHistorySample sample;
+    struct TelemetryReading reading;
+    struct AdcSensorNode previous;
+    uint32_t age;
+    uint16_t position;
+    uint8_t isNew;
+
+    /* Look the node up, or add it if it is new, in one pass */
+    node = NodeTable_findOrAdd(&knownSensorNodes, entry->packet.header.sourceAddress, &isNew);
+    if (node == NULL)
+    {
+        /* Table full, counted in knownSensorNodes.rejectedCount */
+        return;
     }
-}
+    previous = *node;
 
-static uint8_t isKnownNodeAddress(uint8_t address) {
-    uint8_t found = 0;
-    uint8_t i;
-    for (i = 0; i < CONCENTRATOR_MAX_NODES; i++)
+    /* If we recived an ADC sensor packet, for backward compatibility */
+    if (entry->packet.header.packetType == RADIO_PACKET_TYPE_ADC_SENSOR_PACKET)
+    {
+        node->latestAdcValue = entry->packet.adcSensorPacket.adcValue;
+        node->button = 0; //no button value in ADC packet
+        node->latestRssi = entry->rssi;
+        reading.batt = 0; //no battery value in ADC packet
+    }
+    /* Else it is a DualMode ADC sensor packet */
+    else
+    {
+        node->latestAdcValue = entry->packet.dmSensorPacket.adcValue;
+        node->button = entry->packet.dmSensorPacket.button;
+        node->latestRssi = entry->rssi;
+        reading.batt = entry->packet.dmSensorPacket.batt;
+    }
+
+    /* Keep the average of all nodes up to date without walking the table */
+    node->latestTempCentiC = TempConversion_toCentiC(node->latestAdcValue, getTempOffset(node->address));
+    tempSumCentiC += node->latestTempCentiC - (isNew ? 0 : previous.latestTempCentiC);
+    averageTempCentiC = (int16_t)(tempSumCentiC / knownSensorNodes.count);
+
+    /* Keep the reading in the node history, timed by when it was taken. The
+     * radio timer runs at 4 MHz and wraps after 17.9 minutes, so it only
+     * times the short wait since the packet arrived. Samples from a batch
+     * were taken earlier by their age, which can be longer than that. */
+    sample.time = getUptimeSeconds();
+    age = (RF_getCurrentTime() - entry->rxTime) / 4000000 + entry->age100MiliSec / 10;
+    sample.time = (age < sample.time) ? (sample.time - age) : 0;
+    sample.value = node->latestAdcValue;
+    sample.rssi = node->latestRssi;
+    position = NodeTable_indexOf(&knownSensorNodes, node);
+    NodeHistory_append(&sensorNodeHistory, position, &sample);
+
+    /* Only redraw the node's line if something shown on it changed. The first
+     * node also replaces the waiting message with the header. */
+    if (isNew || (previous.latestTempCentiC != node->latestTempCentiC) ||
+        (previous.button != node->button) || (previous.latestRssi != node->latestRssi))
     {
-        if (knownSensorNodes[i].address == address)
+        if (position == 0)
         {
-            found = 1;
-            break;
+            markLcdLineDirty(0);
+        }
+        if (position < (CONCENTRATOR_DISPLAY_LINES - 1))
+        {
+            markLcdLineDirty(position + 1);
         }
     }
-    return found;
+
+    /* Stream the reading, this only queues it for the UART */
+    reading.address = node->address;
+    reading.value = node->latestAdcValue;
+    reading.button = node->button;
+    reading.rssi = node->latestRssi;
+    reading.time = sample.time;
+    Telemetry_sendReading(&reading);
+
+#ifdef CONCENTRATOR_LOADGEN
+    LoadGenerator_recordStage(LoadGenerator_Stage_NodeTable, entry->rxTime);
+#endif
 }
 
-static void updateNode(struct AdcSensorNode* node) {
+/* Calibration offset of the node at address, from CONCENTRATOR_TEMP_OFFSETS */
+static int16_t getTempOffset(uint8_t address)
+{
     uint8_t i;
-    for (i = 0; i < CONCENTRATOR_MAX_NODES; i++) {
-        if (knownSensorNodes[i].address == node->address)
+
+    for (i = 0; i < sizeof(tempOffsets) / sizeof(tempOffsets[0]); i++)
+    {
+        if (tempOffsets[i].address == address)
         {
-            knownSensorNodes[i].latestAdcValue = node->latestAdcValue;
-            knownSensorNodes[i].latestRssi = node->latestRssi;
-            knownSensorNodes[i].button = node->button;
-            break;
+            return tempOffsets[i].offsetCentiC;
         }
     }
+
+    return 0;
 }
 
-static void addNewNode(struct AdcSensorNode* node) {
-    *lastAddedSensorNode = *node;
+/* Seconds since start, for the history. Clock ticks wrap after about 12 hours
+ * so they are accumulated here, which works as long as packets arrive more
+ * often than that. */
+static uint32_t getUptimeSeconds(void)
+{
+    uint32_t ticksPerSecond = 1000000 / Clock_tickPeriod;
+    uint32_t now = Clock_getTicks();
+    uint32_t elapsed = now - uptimeLastTicks;
+
+    uptimeLastTicks = now;
+    uptimeSeconds += elapsed / ticksPerSecond;
+    uptimeTickRemainder += elapsed % ticksPerSecond;
+    if (uptimeTickRemainder >= ticksPerSecond)
+    {
+        uptimeSeconds++;
+        uptimeTickRemainder -= ticksPerSecond;
+    }
+
+    return uptimeSeconds;
+}
 
-    /* Increment and wrap */
-    lastAddedSensorNode++;
-    if (lastAddedSensorNode > &knownSensorNodes[CONCENTRATOR_MAX_NODES-1])
+static void markLcdLineDirty(uint8_t line)
+{
+    dirtyLcdLines |= (1 << line);
+
+    /* Start a refresh period unless one is already pending, so a burst of
+     * packets results in one redraw */
+    if (!Clock_isActive(displayRefreshClockHandle))
     {
-        lastAddedSensorNode = knownSensorNodes;
+        Clock_start(displayRefreshClockHandle);
     }
 }
 
+static void displayRefreshCallback(UArg arg0)
+{
+    Event_post(concentratorEventHandle, CONCENTRATOR_EVENT_UPDATE_DISPLAY);
+}
+
 static void updateLcd(void) {
-    struct AdcSensorNode* nodePointer = knownSensorNodes;
+    struct AdcSensorNode* nodePointer;
     uint8_t currentLcdLine;
+    int16_t tenthsC;
 
-    /* Clear the display and write header on first line */
-    Display_clear(hDisplayLcd);
-    Display_printf(hDisplayLcd, 0, 0, "Nodes Value SW  RSSI");
-
-    //clear screen, put cuser to beggining of terminal and print the header
-    Display_printf(hDisplaySerial, 0, 0, "\033[2J \033[0;0HNodes   Value   SW    RSSI");
+    if (!hDisplayLcd)
+    {
+        dirtyLcdLines = 0;
+        return;
+    }
 
-    /* Start on the second line */
-    currentLcdLine = 1;
+    /* Header on the first line */
+    if (dirtyLcdLines & 1)
+    {
+        Display_printf(hDisplayLcd, 0, 0, "Nodes  Temp SW  RSSI");
+    }
 
-    /* Write one line per node */
-    while ((nodePointer < &knownSensorNodes[CONCENTRATOR_MAX_NODES]) &&
-          (nodePointer->address != 0) &&
-          (currentLcdLine < CONCENTRATOR_DISPLAY_LINES))
+    /* One line per node, in the order they joined. Only the changed lines are
+     * rewritten, the display clears each line before writing it. */
+    for (currentLcdLine = 1; currentLcdLine < CONCENTRATOR_DISPLAY_LINES; currentLcdLine++)
     {
-        /* print to LCD */
-        Display_printf(hDisplayLcd, currentLcdLine, 0, "0x%02x  %04d  %d   %04d",
-                nodePointer->address, nodePointer->latestAdcValue, nodePointer->button,
-                nodePointer->latestRssi);
-
-        /* print to UART */
-        Display_printf(hDisplaySerial, 0, 0, "0x%02x    %04d    %d    %04d",
-                nodePointer->address, nodePointer->latestAdcValue, nodePointer->button,
-                nodePointer->latestRssi);
-        printf("Address: 0x%02x\n   Latest ADC Value: 0x%02x\n    Button: %d\n    Latest Rssi: %04d\n", nodePointer->address, nodePointer->latestAdcValue, nodePointer->button, nodePointer->latestRssi); nodePointer++;
-
-        nodePointer++;
-        currentLcdLine++;
+        if (dirtyLcdLines & (1 << currentLcdLine))
+        {
+            nodePointer = NodeTable_get(&knownSensorNodes, currentLcdLine - 1);
+
+            /* Temperature with one decimal, the sign is printed on its own so
+             * readings just below 0 C keep it */
+            tenthsC = (nodePointer->latestTempCentiC + ((nodePointer->latestTempCentiC < 0) ? -5 : 5)) / 10;
+
+            /* print to LCD */
+            Display_printf(hDisplayLcd, currentLcdLine, 0, "0x%02x %c%3d.%d %d   %04d",
+                    nodePointer->address, (tenthsC < 0) ? '-' : ' ', abs(tenthsC) / 10, abs(tenthsC) % 10,
+                    nodePointer->button, nodePointer->latestRssi);
+        }
     }
+
+    dirtyLcdLines = 0;
 }
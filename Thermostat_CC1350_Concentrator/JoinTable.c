@@ -0,0 +1,149 @@
+/*
+ *  ======== JoinTable.c ========
+ */
+
+/***** Includes *****/
+#include <string.h>
+
+/* TI-RTOS Header files */
+#include <ti/drivers/NVS.h>
+
+/* Board Header files */
+#include "Board.h"
+
+#include "JoinTable.h"
+
+
+/***** Defines *****/
+/* "JNT1", marks a formatted flash region */
+#define JOINTABLE_MAGIC         0x4A4E5431
+#define JOINTABLE_MAGIC_SIZE    4
+
+/* Offset of the IEEE address of short address n in flash */
+#define JOINTABLE_RECORD_OFFSET(n) (JOINTABLE_MAGIC_SIZE + ((n) - 1) * RADIO_IEEE_ADDRESS_SIZE)
+
+#if JOINTABLE_RESERVED_ADDRESSES >= RADIO_UNJOINED_ADDRESS
+#error JOINTABLE_RESERVED_ADDRESSES leaves no address to hand out
+#endif
+
+#if JOINTABLE_MAX_NODES >= JOINTABLE_FIRST_RESERVED_ADDRESS
+#error JOINTABLE_MAX_NODES does not fit the short addresses below the reserved ones
+#endif
+
+
+/***** Variable declarations *****/
+static NVS_Handle nvsHandle;
+
+
+/***** Prototypes *****/
+static uint8_t isErased(const uint8_t* record);
+
+
+/***** Function definitions *****/
+void JoinTable_init(struct JoinTable* table)
+{
+    NVS_Params params;
+    NVS_Attrs attrs;
+    uint8_t magic[JOINTABLE_MAGIC_SIZE];
+    uint8_t* record;
+
+    memset(table, 0, sizeof(struct JoinTable));
+
+    NVS_Params_init(&params);
+    nvsHandle = NVS_open(Board_NVS0, &params);
+    if (nvsHandle == NULL)
+    {
+        return;
+    }
+
+    if ((NVS_read(nvsHandle, 0, magic, JOINTABLE_MAGIC_SIZE) != NVS_STATUS_SUCCESS) ||
+        (((uint32_t)magic[0] << 24 | (uint32_t)magic[1] << 16 | (uint32_t)magic[2] << 8 | magic[3]) != JOINTABLE_MAGIC))
+    {
+        /* No table yet, the whole table fits in the first sector */
+        NVS_getAttrs(nvsHandle, &attrs);
+        magic[0] = (JOINTABLE_MAGIC >> 24) & 0xFF;
+        magic[1] = (JOINTABLE_MAGIC >> 16) & 0xFF;
+        magic[2] = (JOINTABLE_MAGIC >> 8) & 0xFF;
+        magic[3] = JOINTABLE_MAGIC & 0xFF;
+        if ((NVS_erase(nvsHandle, 0, attrs.sectorSize) != NVS_STATUS_SUCCESS) ||
+            (NVS_write(nvsHandle, 0, magic, JOINTABLE_MAGIC_SIZE, NVS_WRITE_POST_VERIFY) != NVS_STATUS_SUCCESS))
+        {
+            NVS_close(nvsHandle);
+            nvsHandle = NULL;
+            return;
+        }
+    }
+    table->persistent = 1;
+
+    /* Records are appended in address order, the first erased one ends the table */
+    while (table->count < JOINTABLE_MAX_NODES)
+    {
+        record = table->ieeeAddrs[table->count];
+        if ((NVS_read(nvsHandle, JOINTABLE_RECORD_OFFSET(table->count + 1), record, RADIO_IEEE_ADDRESS_SIZE) != NVS_STATUS_SUCCESS) ||
+            isErased(record))
+        {
+            break;
+        }
+        table->count++;
+    }
+    memset(table->ieeeAddrs[table->count], 0, (JOINTABLE_MAX_NODES - table->count) * RADIO_IEEE_ADDRESS_SIZE);
+}
+
+uint8_t JoinTable_join(struct JoinTable* table, const uint8_t* ieeeAddr)
+{
+    uint8_t i;
+
+    for (i = 0; i < table->count; i++)
+    {
+        if (memcmp(table->ieeeAddrs[i], ieeeAddr, RADIO_IEEE_ADDRESS_SIZE) == 0)
+        {
+            return i + 1;
+        }
+    }
+
+    /* An all 0xFF address would read back as the end of the table */
+    if ((table->count == JOINTABLE_MAX_NODES) || isErased(ieeeAddr))
+    {
+        table->rejectedCount++;
+        return RADIO_UNJOINED_ADDRESS;
+    }
+
+    memcpy(table->ieeeAddrs[table->count], ieeeAddr, RADIO_IEEE_ADDRESS_SIZE);
+    table->count++;
+
+    /* Keep the address even if it can not be saved, it is then only lost on a reset */
+    if ((nvsHandle == NULL) ||
+        (NVS_write(nvsHandle, JOINTABLE_RECORD_OFFSET(table->count), table->ieeeAddrs[table->count - 1],
+                   RADIO_IEEE_ADDRESS_SIZE, NVS_WRITE_POST_VERIFY) != NVS_STATUS_SUCCESS))
+    {
+        table->saveFailCount++;
+    }
+
+    return table->count;
+}
+
+uint8_t JoinTable_isJoined(const struct JoinTable* table, uint8_t address)
+{
+    return (address != RADIO_CONCENTRATOR_ADDRESS) && (address <= table->count);
+}
+
+uint8_t JoinTable_isReserved(uint8_t address)
+{
+    return (address >= JOINTABLE_FIRST_RESERVED_ADDRESS) && (address < RADIO_UNJOINED_ADDRESS);
+}
+
+/* Returns 1 if the flash record has never been written */
+static uint8_t isErased(const uint8_t* record)
+{
+    uint8_t i;
+
+    for (i = 0; i < RADIO_IEEE_ADDRESS_SIZE; i++)
+    {
+        if (record[i] != 0xFF)
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
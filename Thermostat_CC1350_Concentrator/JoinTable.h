@@ -0,0 +1,74 @@
+/*
+ *  ======== JoinTable.h ========
+ *
+ *  Short addresses handed out to the nodes, keyed on their IEEE address.
+ *
+ *  A node without an address sends a join request carrying its 64-bit IEEE
+ *  address. The first join of a node takes the next free short address, a
+ *  node that joins again gets the address it had before, so no two nodes can
+ *  end up with the same address.
+ *
+ *  Short address n belongs to the IEEE address at position n-1. The table is
+ *  kept in internal flash (Board_NVS0) as a magic word followed by the 8 byte
+ *  IEEE addresses in joining order, so appending a node is a single write and
+ *  the addresses survive a reset of the concentrator. If the flash can not be
+ *  used the table still works, but only until the next reset.
+ *
+ *  The JOINTABLE_RESERVED_ADDRESSES addresses just below RADIO_UNJOINED_ADDRESS
+ *  are never handed out. The LoadGenerator sends from them, so its synthetic
+ *  nodes can never share an address with a node that joined.
+ */
+
+#ifndef JOINTABLE_H_
+#define JOINTABLE_H_
+
+#include "stdint.h"
+#include "NodeTable.h"
+#include "RadioProtocol.h"
+
+/* Number of addresses kept out of joining, may be overridden from the build options */
+#ifndef JOINTABLE_RESERVED_ADDRESSES
+#ifdef CONCENTRATOR_LOADGEN
+#define JOINTABLE_RESERVED_ADDRESSES 200
+#else
+#define JOINTABLE_RESERVED_ADDRESSES 0
+#endif
+#endif
+
+#define JOINTABLE_FIRST_RESERVED_ADDRESS (RADIO_UNJOINED_ADDRESS - JOINTABLE_RESERVED_ADDRESSES)
+
+/* Number of addresses that can be handed out, may be overridden from the
+ * build options. By default one per NodeTable entry, as far as the addresses
+ * below the reserved ones go. */
+#ifndef JOINTABLE_MAX_NODES
+#if NODETABLE_MAX_NODES < JOINTABLE_FIRST_RESERVED_ADDRESS
+#define JOINTABLE_MAX_NODES NODETABLE_MAX_NODES
+#else
+#define JOINTABLE_MAX_NODES (JOINTABLE_FIRST_RESERVED_ADDRESS - 1)
+#endif
+#endif
+
+struct JoinTable {
+    uint8_t ieeeAddrs[JOINTABLE_MAX_NODES][RADIO_IEEE_ADDRESS_SIZE];
+    uint8_t count;           /* Addresses 1..count are in use */
+    uint8_t persistent;      /* 0 if the flash could not be opened */
+    uint32_t rejectedCount;  /* Joins refused because the table is full */
+    uint32_t saveFailCount;  /* Joins that could not be written to flash */
+};
+
+/* Loads the table from flash, formatting the flash region if it does not hold
+ * a table yet. Must be called from a task, after NVS_init. */
+void JoinTable_init(struct JoinTable* table);
+
+/* Returns the short address of the node with the given IEEE address, assigning
+ * the next free one on its first join. Returns RADIO_UNJOINED_ADDRESS if the
+ * table is full. */
+uint8_t JoinTable_join(struct JoinTable* table, const uint8_t* ieeeAddr);
+
+/* Returns 1 if address has been handed out */
+uint8_t JoinTable_isJoined(const struct JoinTable* table, uint8_t address);
+
+/* Returns 1 if address is one of the reserved ones, which are never handed out */
+uint8_t JoinTable_isReserved(uint8_t address);
+
+#endif /* JOINTABLE_H_ */
@@ -0,0 +1,148 @@
+/*
+ *  ======== LoadGenerator.c ========
+ */
+
+/* Only part of the build when the load generator is enabled */
+#ifdef CONCENTRATOR_LOADGEN
+
+/***** Includes *****/
+/* XDCtools Header files */
+#include <xdc/std.h>
+
+/* BIOS Header files */
+#include <ti/sysbios/knl/Clock.h>
+
+/* Drivers */
+#include <ti/drivers/rf/RF.h>
+
+#include <ti/devices/DeviceFamily.h>
+#include DeviceFamily_constructPath(inc/hw_types.h)
+#include DeviceFamily_constructPath(inc/hw_memmap.h)
+#include DeviceFamily_constructPath(inc/hw_cpu_dwt.h)
+#include DeviceFamily_constructPath(inc/hw_cpu_scs.h)
+
+/* EasyLink API Header files */
+#include "easylink/EasyLink.h"
+
+/* Application Header files */
+#include "RadioProtocol.h"
+#include "ConcentratorRadioTask.h"
+#include "LoadGenerator.h"
+
+
+/***** Defines *****/
+#if LOADGEN_NODE_COUNT < 1
+#error The load generator needs JOINTABLE_RESERVED_ADDRESSES set
+#endif
+
+#define LOADGEN_PERIOD_US ((1000000 / LOADGEN_PACKETS_PER_SECOND) * LOADGEN_BURST_SIZE)
+
+
+/***** Variable declarations *****/
+Clock_Struct loadGeneratorClock;  /* not static so you can see in ROV */
+static Clock_Handle loadGeneratorClockHandle;
+struct LoadGeneratorStats loadGeneratorStats;  /* not static so you can see in ROV */
+static uint32_t sequence;
+
+
+/***** Prototypes *****/
+static void injectCallback(UArg arg0);
+static void injectPacket(void);
+
+
+/***** Function definitions *****/
+void LoadGenerator_init(void)
+{
+    Clock_Params clkParams;
+    Clock_Params_init(&clkParams);
+    clkParams.period = LOADGEN_PERIOD_US / Clock_tickPeriod;
+    clkParams.startFlag = FALSE;
+    Clock_construct(&loadGeneratorClock, injectCallback, clkParams.period, &clkParams);
+    loadGeneratorClockHandle = Clock_handle(&loadGeneratorClock);
+
+    /* Start the DWT cycle counter for rxCycles */
+    HWREG(CPU_SCS_BASE + CPU_SCS_O_DEMCR) |= CPU_SCS_DEMCR_TRCENA;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) = 0;
+    HWREG(CPU_DWT_BASE + CPU_DWT_O_CTRL) |= CPU_DWT_CTRL_CYCCNTENA;
+}
+
+void LoadGenerator_start(void)
+{
+    Clock_start(loadGeneratorClockHandle);
+}
+
+void LoadGenerator_recordStage(enum LoadGenerator_Stage stage, uint32_t rxTime)
+{
+    uint32_t latency = RF_getCurrentTime() - rxTime;
+    uint8_t bucket = 0;
+
+    /* Bucket n holds latencies below 2^n ticks */
+    while ((latency != 0) && (bucket < (LOADGEN_LATENCY_BUCKETS - 1)))
+    {
+        latency >>= 1;
+        bucket++;
+    }
+
+    loadGeneratorStats.reached[stage]++;
+    loadGeneratorStats.latency[stage][bucket]++;
+}
+
+static void injectCallback(UArg arg0)
+{
+    uint8_t i;
+
+    for (i = 0; i < LOADGEN_BURST_SIZE; i++)
+    {
+        injectPacket();
+    }
+}
+
+static void injectPacket(void)
+{
+    static uint8_t dstAddr = RADIO_CONCENTRATOR_ADDRESS;
+    static uint8_t payload[EASYLINK_MAX_DATA_LENGTH];
+    EasyLink_RxLoan rxLoan;
+    struct AdcSensorPacket adcSensorPacket;
+    struct DualModeSensorPacket dmSensorPacket;
+    uint8_t address = LOADGEN_FIRST_ADDRESS + (sequence % LOADGEN_NODE_COUNT);
+    uint32_t cycles;
+
+    /* Spread the packet types evenly over the nodes and time */
+    if (((sequence / LOADGEN_NODE_COUNT) * 37 + address) % 100 < LOADGEN_DM_PERCENT)
+    {
+        dmSensorPacket.header.sourceAddress = address;
+        dmSensorPacket.header.packetType = RADIO_PACKET_TYPE_DM_SENSOR_PACKET;
+        dmSensorPacket.adcValue = (uint16_t)(sequence * 7);
+        dmSensorPacket.batt = 3000;
+        dmSensorPacket.time100MiliSec = sequence;
+        dmSensorPacket.button = sequence & 1;
+        rxLoan.len = RadioProtocol_packDmSensorPacket(&dmSensorPacket, payload);
+    }
+    else
+    {
+        adcSensorPacket.header.sourceAddress = address;
+        adcSensorPacket.header.packetType = RADIO_PACKET_TYPE_ADC_SENSOR_PACKET;
+        adcSensorPacket.adcValue = (uint16_t)(sequence * 7);
+        rxLoan.len = RadioProtocol_packAdcSensorPacket(&adcSensorPacket, payload);
+    }
+
+    rxLoan.dstAddr = &dstAddr;
+    rxLoan.payload = payload;
+    rxLoan.rssi = -40 - (int8_t)(address % 50);
+    rxLoan.absTime = RF_getCurrentTime();
+
+    sequence++;
+    loadGeneratorStats.injected++;
+
+    cycles = HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT);
+    ConcentratorRadioTask_injectPacket(&rxLoan);
+    cycles = HWREG(CPU_DWT_BASE + CPU_DWT_O_CYCCNT) - cycles;
+
+    loadGeneratorStats.rxCycles += cycles;
+    if (cycles > loadGeneratorStats.rxCyclesMax)
+    {
+        loadGeneratorStats.rxCyclesMax = cycles;
+    }
+}
+
+#endif /* CONCENTRATOR_LOADGEN */
@@ -0,0 +1,78 @@
+/*
+ *  ======== LoadGenerator.h ========
+ *
+ *  Synthetic traffic for measuring how many nodes the concentrator can serve.
+ *
+ *  Only built with CONCENTRATOR_LOADGEN defined. A clock injects well formed
+ *  ADC and DualMode sensor packets from LOADGEN_NODE_COUNT synthetic
+ *  addresses into the radio task's rxDoneCallback, so they take the same path
+ *  as packets from the air: packet ring, ack, packet received callback,
+ *  concentrator packet ring and node table. Acks are really sent, their
+ *  airtime is part of the cost of a packet.
+ *
+ *  Results are kept in loadGeneratorStats for ROV: packets injected,
+ *  packets that reached each stage, and a histogram of the latency from
+ *  injection to each stage in log2 buckets of radio timer ticks (0.25 us),
+ *  from which the percentiles can be read. Packets dropped are the injected
+ *  ones that never reached the node table, the rings count where.
+ *
+ *  The CPU cycles the receive callback takes per packet, decoding it from
+ *  the EasyLink Rx entry into the packet ring, are counted with the DWT cycle
+ *  counter: rxCycles / injected is the mean, rxCyclesMax the worst case.
+ */
+
+#ifndef LOADGENERATOR_H_
+#define LOADGENERATOR_H_
+
+#include "stdint.h"
+#include "JoinTable.h"
+
+/* Number of synthetic nodes. They send from the addresses the JoinTable
+ * reserves, starting at LOADGEN_FIRST_ADDRESS, so they never clash with
+ * nodes that joined. For the node table to hold them all next to the joined
+ * nodes, build with NODETABLE_MAX_NODES=255 and NODETABLE_INDEX_SIZE=512. */
+#define LOADGEN_NODE_COUNT JOINTABLE_RESERVED_ADDRESSES
+#define LOADGEN_FIRST_ADDRESS JOINTABLE_FIRST_RESERVED_ADDRESS
+
+/* Average packets per second over all nodes */
+#ifndef LOADGEN_PACKETS_PER_SECOND
+#define LOADGEN_PACKETS_PER_SECOND 100
+#endif
+
+/* Packets injected back to back every period, higher values are burstier at
+ * the same average rate */
+#ifndef LOADGEN_BURST_SIZE
+#define LOADGEN_BURST_SIZE 1
+#endif
+
+/* Share of DualMode sensor packets, the rest are ADC sensor packets */
+#ifndef LOADGEN_DM_PERCENT
+#define LOADGEN_DM_PERCENT 50
+#endif
+
+#define LOADGEN_LATENCY_BUCKETS 24
+
+enum LoadGenerator_Stage {
+    LoadGenerator_Stage_RadioTask,  /* Handed to the packet received callback */
+    LoadGenerator_Stage_NodeTable,  /* Applied to the node table */
+    LoadGenerator_Stage_Count,
+};
+
+struct LoadGeneratorStats {
+    uint32_t injected;
+    uint32_t reached[LoadGenerator_Stage_Count];
+    uint32_t latency[LoadGenerator_Stage_Count][LOADGEN_LATENCY_BUCKETS];
+    uint32_t rxCycles;     /* Receive callback cycles, summed over all packets */
+    uint32_t rxCyclesMax;
+};
+
+/* Creates the injection clock, call before BIOS_start */
+void LoadGenerator_init(void);
+
+/* Starts injecting, the radio must be set up */
+void LoadGenerator_start(void);
+
+/* Records that a packet received at rxTime (RAT) reached the stage */
+void LoadGenerator_recordStage(enum LoadGenerator_Stage stage, uint32_t rxTime);
+
+#endif /* LOADGENERATOR_H_ */
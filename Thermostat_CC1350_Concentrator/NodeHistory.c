@@ -0,0 +1,255 @@
+/*
+ *  ======== NodeHistory.c ========
+ */
+
+/***** Includes *****/
+#include <string.h>
+
+#include "NodeHistory.h"
+
+
+/***** Defines *****/
+/* Largest encoded sample: time delta (5B), value delta (3B), rssi delta (2B) */
+#define NODEHISTORY_MAX_RECORD_SIZE 10
+
+/* Read position meaning the block header sample is next */
+#define NODEHISTORY_POS_HEADER 0xFF
+
+#if NODEHISTORY_BLOCK_COUNT >= NODEHISTORY_NO_BLOCK
+#error NODEHISTORY_BLOCK_COUNT does not fit the block links
+#endif
+
+#if NODETABLE_MAX_NODES > 0xFF
+#error NODETABLE_MAX_NODES does not fit NodeHistoryBlock.owner
+#endif
+
+#if (NODEHISTORY_BLOCK_DATA_SIZE < NODEHISTORY_MAX_RECORD_SIZE) || (NODEHISTORY_BLOCK_DATA_SIZE >= NODEHISTORY_POS_HEADER)
+#error NODEHISTORY_BLOCK_DATA_SIZE out of range
+#endif
+
+
+/***** Prototypes *****/
+static uint8_t allocBlock(struct NodeHistory* history);
+static uint8_t encodeSample(uint8_t* buf, const struct NodeHistorySample* prev, const struct NodeHistorySample* sample);
+static uint8_t putVarint(uint8_t* buf, uint32_t value);
+static uint32_t getVarint(const uint8_t* buf, uint8_t* pos);
+
+
+/***** Function definitions *****/
+void NodeHistory_init(struct NodeHistory* history)
+{
+    uint16_t i;
+
+    memset(history, 0, sizeof(struct NodeHistory));
+    for (i = 0; i < NODETABLE_MAX_NODES; i++)
+    {
+        history->nodes[i].oldest = NODEHISTORY_NO_BLOCK;
+        history->nodes[i].newest = NODEHISTORY_NO_BLOCK;
+    }
+    history->freeBlocks = NODEHISTORY_BLOCK_COUNT;
+}
+
+void NodeHistory_append(struct NodeHistory* history, uint16_t n, const struct NodeHistorySample* newSample)
+{
+    struct NodeHistoryNode* node = &history->nodes[n];
+    struct NodeHistoryBlock* block;
+    uint8_t record[NODEHISTORY_MAX_RECORD_SIZE];
+    uint8_t recordSize;
+    uint8_t b;
+    struct NodeHistorySample sampleCopy = *newSample;
+    struct NodeHistorySample* sample = &sampleCopy;
+
+    /* Samples timed from different clocks can come out slightly out of order,
+     * the time deltas must never be negative */
+    if ((node->newest != NODEHISTORY_NO_BLOCK) && (sample->time < node->last.time))
+    {
+        sample->time = node->last.time;
+    }
+
+    /* Append to the newest block if the deltas still fit */
+    if (node->newest != NODEHISTORY_NO_BLOCK)
+    {
+        block = &history->blocks[node->newest];
+        recordSize = encodeSample(record, &node->last, sample);
+        if (block->used + recordSize <= NODEHISTORY_BLOCK_DATA_SIZE)
+        {
+            memcpy(&block->data[block->used], record, recordSize);
+            block->used += recordSize;
+            node->last = *sample;
+            return;
+        }
+    }
+
+    /* Start a new block with the sample in full. This may reuse the oldest
+     * block of this node, which then unlinks itself first. */
+    b = allocBlock(history);
+    block = &history->blocks[b];
+    block->startTime = sample->time;
+    block->startValue = sample->value;
+    block->startRssi = sample->rssi;
+    block->owner = (uint8_t)n;
+    block->next = NODEHISTORY_NO_BLOCK;
+    block->used = 0;
+
+    if (node->newest != NODEHISTORY_NO_BLOCK)
+    {
+        history->blocks[node->newest].next = b;
+    }
+    else
+    {
+        node->oldest = b;
+    }
+    node->newest = b;
+    node->last = *sample;
+}
+
+void NodeHistory_iterate(struct NodeHistory* history, uint16_t n, uint32_t fromTime, uint32_t toTime,
+                         struct NodeHistoryIterator* it)
+{
+    uint8_t b = history->nodes[n].oldest;
+
+    /* Skip whole blocks whose successor still starts before the range */
+    while ((b != NODEHISTORY_NO_BLOCK) &&
+           (history->blocks[b].next != NODEHISTORY_NO_BLOCK) &&
+           (history->blocks[history->blocks[b].next].startTime <= fromTime))
+    {
+        b = history->blocks[b].next;
+    }
+
+    it->history = history;
+    it->block = b;
+    it->pos = NODEHISTORY_POS_HEADER;
+    it->fromTime = fromTime;
+    it->toTime = toTime;
+}
+
+uint8_t NodeHistory_next(struct NodeHistoryIterator* it, struct NodeHistorySample* sample)
+{
+    struct NodeHistoryBlock* block;
+    uint32_t zigzag;
+
+    while (it->block != NODEHISTORY_NO_BLOCK)
+    {
+        block = &it->history->blocks[it->block];
+
+        if (it->pos == NODEHISTORY_POS_HEADER)
+        {
+            it->sample.time = block->startTime;
+            it->sample.value = block->startValue;
+            it->sample.rssi = block->startRssi;
+            it->pos = 0;
+        }
+        else if (it->pos < block->used)
+        {
+            it->sample.time += getVarint(block->data, &it->pos);
+            zigzag = getVarint(block->data, &it->pos);
+            it->sample.value += (uint16_t)((zigzag >> 1) ^ -(zigzag & 1));
+            zigzag = getVarint(block->data, &it->pos);
+            it->sample.rssi += (int8_t)((zigzag >> 1) ^ -(zigzag & 1));
+        }
+        else
+        {
+            it->block = block->next;
+            it->pos = NODEHISTORY_POS_HEADER;
+            continue;
+        }
+
+        if (it->sample.time > it->toTime)
+        {
+            /* Past the range, stop here */
+            it->block = NODEHISTORY_NO_BLOCK;
+            break;
+        }
+
+        if (it->sample.time >= it->fromTime)
+        {
+            *sample = it->sample;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Returns a block to write to, reusing the oldest block of all nodes when the
+ * pool is used up */
+static uint8_t allocBlock(struct NodeHistory* history)
+{
+    struct NodeHistoryNode* owner;
+    uint8_t oldest = 0;
+    uint8_t i;
+
+    if (history->freeBlocks > 0)
+    {
+        history->freeBlocks--;
+        return (NODEHISTORY_BLOCK_COUNT - 1) - history->freeBlocks;
+    }
+
+    /* The block with the oldest start time is always the oldest of its node */
+    for (i = 1; i < NODEHISTORY_BLOCK_COUNT; i++)
+    {
+        if (history->blocks[i].startTime < history->blocks[oldest].startTime)
+        {
+            oldest = i;
+        }
+    }
+
+    /* Unlink it from its node */
+    owner = &history->nodes[history->blocks[oldest].owner];
+    owner->oldest = history->blocks[oldest].next;
+    if (owner->oldest == NODEHISTORY_NO_BLOCK)
+    {
+        owner->newest = NODEHISTORY_NO_BLOCK;
+    }
+    history->evictedCount++;
+
+    return oldest;
+}
+
+/* Encodes the sample as deltas to prev, returns the number of bytes written */
+static uint8_t encodeSample(uint8_t* buf, const struct NodeHistorySample* prev, const struct NodeHistorySample* sample)
+{
+    int32_t valueDelta = (int32_t)sample->value - (int32_t)prev->value;
+    int32_t rssiDelta = (int32_t)sample->rssi - (int32_t)prev->rssi;
+    uint8_t size;
+
+    /* Time deltas are never negative, signed deltas are zigzag encoded so
+     * small changes either way take one byte */
+    size = putVarint(buf, sample->time - prev->time);
+    size += putVarint(&buf[size], ((uint32_t)valueDelta << 1) ^ (uint32_t)(valueDelta >> 31));
+    size += putVarint(&buf[size], ((uint32_t)rssiDelta << 1) ^ (uint32_t)(rssiDelta >> 31));
+
+    return size;
+}
+
+/* Writes value 7 bits per byte, least significant first, the top bit marks
+ * that more bytes follow */
+static uint8_t putVarint(uint8_t* buf, uint32_t value)
+{
+    uint8_t size = 0;
+
+    while (value >= 0x80)
+    {
+        buf[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[size++] = (uint8_t)value;
+
+    return size;
+}
+
+static uint32_t getVarint(const uint8_t* buf, uint8_t* pos)
+{
+    uint32_t value = 0;
+    uint8_t shift = 0;
+    uint8_t byte;
+
+    do
+    {
+        byte = buf[(*pos)++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return value;
+}
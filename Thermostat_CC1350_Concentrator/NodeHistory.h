@@ -0,0 +1,129 @@
+/*
+ *  ======== NodeHistory.h ========
+ *
+ *  Reading history of the nodes in the NodeTable.
+ *
+ *  Samples are stored in fixed size blocks taken from a pool shared by all
+ *  nodes. Each block holds its first sample in full in the block header and
+ *  every following sample as varint encoded deltas to the previous one, which
+ *  is about 3 bytes per sample for a node reporting regularly. The blocks of
+ *  a node are chained from oldest to newest. When the pool runs out, the
+ *  oldest block of all nodes is reused, so the history always covers the most
+ *  recent samples.
+ *
+ *  Because every block starts with a full sample, a time range is found by
+ *  walking the block headers and only the blocks inside the range are
+ *  decoded.
+ */
+
+#ifndef NODEHISTORY_H_
+#define NODEHISTORY_H_
+
+#include "stdint.h"
+#include "NodeTable.h"
+
+/* Bytes of delta encoded samples in a block, the 12 byte header comes on top */
+#ifndef NODEHISTORY_BLOCK_DATA_SIZE
+#define NODEHISTORY_BLOCK_DATA_SIZE 52
+#endif
+
+/* Retention target the pool is sized for: NODEHISTORY_RETENTION_S seconds of
+ * history for each of NODEHISTORY_RETAINED_NODES nodes reporting every
+ * NODEHISTORY_SAMPLE_PERIOD_S seconds, the slow report interval of the
+ * nodes. The default of one hour for 8 nodes takes 40 blocks, 2.5 KB. A day
+ * of history takes 97 blocks, 6 KB, per node. The pool is shared, so fewer
+ * reporting nodes get a longer history each.
+ *
+ * NODEHISTORY_BYTES_PER_SAMPLE is the encoded size of a regular sample,
+ * see tests/NodeHistoryBench.c of the host build. */
+#ifndef NODEHISTORY_RETENTION_S
+#define NODEHISTORY_RETENTION_S 3600
+#endif
+
+#ifndef NODEHISTORY_RETAINED_NODES
+#define NODEHISTORY_RETAINED_NODES 8
+#endif
+
+#ifndef NODEHISTORY_SAMPLE_PERIOD_S
+#define NODEHISTORY_SAMPLE_PERIOD_S 50
+#endif
+
+#ifndef NODEHISTORY_BYTES_PER_SAMPLE
+#define NODEHISTORY_BYTES_PER_SAMPLE 3
+#endif
+
+/* Samples in a block: the header sample and the delta encoded ones */
+#define NODEHISTORY_SAMPLES_PER_BLOCK (1 + (NODEHISTORY_BLOCK_DATA_SIZE / NODEHISTORY_BYTES_PER_SAMPLE))
+
+/* Number of blocks in the pool, by default from the retention target. Each
+ * node gets one block more than its samples fill, as its oldest block is
+ * evicted while its newest one is still filling up. */
+#ifndef NODEHISTORY_BLOCK_COUNT
+#define NODEHISTORY_BLOCK_COUNT (NODEHISTORY_RETAINED_NODES * \
+    (1 + (NODEHISTORY_RETENTION_S / NODEHISTORY_SAMPLE_PERIOD_S + NODEHISTORY_SAMPLES_PER_BLOCK - 1) / \
+         NODEHISTORY_SAMPLES_PER_BLOCK))
+#endif
+
+/* Marks the end of a block chain */
+#define NODEHISTORY_NO_BLOCK 0xFF
+
+struct NodeHistorySample {
+    uint32_t time;      /* Seconds since the concentrator started */
+    uint16_t value;
+    int8_t rssi;
+};
+
+struct NodeHistoryBlock {
+    uint32_t startTime;  /* First sample, stored in full */
+    uint16_t startValue;
+    int8_t startRssi;
+    uint8_t owner;       /* Position of the node in the NodeTable */
+    uint8_t next;        /* Next newer block of the same node */
+    uint8_t used;        /* Bytes used in data */
+    uint8_t data[NODEHISTORY_BLOCK_DATA_SIZE];
+};
+
+struct NodeHistoryNode {
+    struct NodeHistorySample last;  /* Newest sample, the base for the next delta */
+    uint8_t oldest;
+    uint8_t newest;
+};
+
+struct NodeHistory {
+    struct NodeHistoryBlock blocks[NODEHISTORY_BLOCK_COUNT];
+    struct NodeHistoryNode nodes[NODETABLE_MAX_NODES];
+    uint8_t freeBlocks;     /* Blocks never used yet, taken from the end of the pool */
+    uint32_t evictedCount;  /* Blocks reused while still holding samples */
+};
+
+struct NodeHistoryIterator {
+    struct NodeHistory* history;
+    uint8_t block;
+    uint8_t pos;                      /* Read position in the block data */
+    uint32_t fromTime;
+    uint32_t toTime;
+    struct NodeHistorySample sample;  /* Last decoded sample */
+};
+
+/* Empties the history of all nodes */
+void NodeHistory_init(struct NodeHistory* history);
+
+/* Adds a sample to the history of node n, n is the node position in the NodeTable.
+ *
+ * The samples of a node are expected in time order, a sample older than the
+ * previous one is stored with the previous one's time.
+ */
+void NodeHistory_append(struct NodeHistory* history, uint16_t n, const struct NodeHistorySample* newSample);
+
+/* Starts iterating over the samples of node n with fromTime <= time <= toTime.
+ *
+ * Blocks before fromTime are skipped by their header only. The iterator is
+ * invalid once NodeHistory_append is called again.
+ */
+void NodeHistory_iterate(struct NodeHistory* history, uint16_t n, uint32_t fromTime, uint32_t toTime,
+                         struct NodeHistoryIterator* it);
+
+/* Gets the next sample of the range, returns 0 when there are no more */
+uint8_t NodeHistory_next(struct NodeHistoryIterator* it, struct NodeHistorySample* sample);
+
+#endif /* NODEHISTORY_H_ */
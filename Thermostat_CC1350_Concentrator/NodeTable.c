@@ -0,0 +1,117 @@
+/*
+ *  ======== NodeTable.c ========
+ */
+
+/***** Includes *****/
+#include <stddef.h>
+#include <string.h>
+
+#include "NodeTable.h"
+
+
+/***** Defines *****/
+#define NODETABLE_INDEX_MASK (NODETABLE_INDEX_SIZE - 1)
+
+#if (NODETABLE_INDEX_SIZE & NODETABLE_INDEX_MASK) != 0
+#error NODETABLE_INDEX_SIZE must be a power of two
+#endif
+
+#if NODETABLE_INDEX_SIZE < (2 * NODETABLE_MAX_NODES)
+#error NODETABLE_INDEX_SIZE must be at least twice NODETABLE_MAX_NODES
+#endif
+
+#if NODETABLE_MAX_NODES > 0xFFFE
+#error NODETABLE_MAX_NODES does not fit the index entries
+#endif
+
+
+/***** Prototypes *****/
+static uint16_t hashAddress(NodeTable_Address address);
+static uint16_t* findSlot(struct NodeTable* table, NodeTable_Address address);
+
+
+/***** Function definitions *****/
+void NodeTable_init(struct NodeTable* table)
+{
+    memset(table, 0, sizeof(struct NodeTable));
+}
+
+struct AdcSensorNode* NodeTable_findOrAdd(struct NodeTable* table, NodeTable_Address address, uint8_t* isNew)
+{
+    uint16_t* slot = findSlot(table, address);
+    struct AdcSensorNode* node;
+
+    *isNew = 0;
+
+    /* Known node */
+    if (*slot != 0)
+    {
+        return &table->nodes[*slot - 1];
+    }
+
+    /* New node, keep the known ones rather than overwriting one */
+    if (table->count >= NODETABLE_MAX_NODES)
+    {
+        table->rejectedCount++;
+        return NULL;
+    }
+
+    node = &table->nodes[table->count];
+    memset(node, 0, sizeof(struct AdcSensorNode));
+    node->address = address;
+
+    table->count++;
+    *slot = table->count;
+    *isNew = 1;
+
+    return node;
+}
+
+struct AdcSensorNode* NodeTable_find(struct NodeTable* table, NodeTable_Address address)
+{
+    uint16_t* slot = findSlot(table, address);
+
+    if (*slot == 0)
+    {
+        return NULL;
+    }
+
+    return &table->nodes[*slot - 1];
+}
+
+uint16_t NodeTable_count(struct NodeTable* table)
+{
+    return table->count;
+}
+
+struct AdcSensorNode* NodeTable_get(struct NodeTable* table, uint16_t n)
+{
+    return &table->nodes[n];
+}
+
+uint16_t NodeTable_indexOf(struct NodeTable* table, struct AdcSensorNode* node)
+{
+    return (uint16_t)(node - table->nodes);
+}
+
+/* Fibonacci hashing, spreads nearby addresses over the whole index */
+static uint16_t hashAddress(NodeTable_Address address)
+{
+    return (uint16_t)(((uint32_t)address * 2654435769u) >> 16) & NODETABLE_INDEX_MASK;
+}
+
+/* Returns the index slot holding the address, or the free slot where it
+ * belongs. The index is never more than half full, so a free slot always
+ * ends the linear probe. */
+static uint16_t* findSlot(struct NodeTable* table, NodeTable_Address address)
+{
+    uint16_t i = hashAddress(address);
+
+    while ((table->index[i] != 0) &&
+           (table->nodes[table->index[i] - 1].address != address))
+    {
+        i = (i + 1) & NODETABLE_INDEX_MASK;
+    }
+
+    return &table->index[i];
+}
@@ -0,0 +1,83 @@
+/*
+ *  ======== NodeTable.h ========
+ *
+ *  Table of the sensor nodes known to the concentrator.
+ *
+ *  Nodes are stored compactly, in the order they were first heard, so the
+ *  display can walk them directly. An open-addressing hash index over the
+ *  node addresses finds or adds a node in a single probe sequence, so the
+ *  cost per packet does not grow with the number of nodes. Nodes are never
+ *  evicted: when the table is full new nodes are rejected and counted in
+ *  rejectedCount instead of overwriting a known node.
+ */
+
+#ifndef NODETABLE_H_
+#define NODETABLE_H_
+
+#include "stdint.h"
+
+/* Maximum number of nodes, may be overridden from the build options.
+ *
+ * Every node slot costs about 32 bytes of RAM whether it is used or not: 8 in
+ * nodes, 4 in index, 8 in the JoinTable and 12 in the NodeHistory. The
+ * default of 64 nodes takes 2 KB. All 255 addresses of the radio protocol
+ * would take 8 KB, more than the CC1350 image leaves free next to the
+ * history pool. Builds that need them set NODETABLE_MAX_NODES=255 and
+ * NODETABLE_INDEX_SIZE=512 and shrink NODEHISTORY_RETAINED_NODES. */
+#ifndef NODETABLE_MAX_NODES
+#define NODETABLE_MAX_NODES 64
+#endif
+
+/* Number of hash index slots, must be a power of two and at least twice
+ * NODETABLE_MAX_NODES to keep the probe sequences short */
+#ifndef NODETABLE_INDEX_SIZE
+#define NODETABLE_INDEX_SIZE 128
+#endif
+
+/* Type of the node addresses, may be widened from the build options to test
+ * the table beyond the 8-bit addresses of the radio protocol */
+#ifndef NODETABLE_ADDRESS_TYPE
+#define NODETABLE_ADDRESS_TYPE uint8_t
+#endif
+
+typedef NODETABLE_ADDRESS_TYPE NodeTable_Address;
+
+struct AdcSensorNode {
+    NodeTable_Address address;
+    uint16_t latestAdcValue;
+    int16_t latestTempCentiC;  /* latestAdcValue in 0.01 C, with the node's calibration offset */
+    uint8_t button;
+    int8_t latestRssi;
+};
+
+struct NodeTable {
+    struct AdcSensorNode nodes[NODETABLE_MAX_NODES];
+    uint16_t index[NODETABLE_INDEX_SIZE];   /* Position in nodes + 1, 0 if free */
+    uint16_t count;                         /* Number of used entries in nodes */
+    uint32_t rejectedCount;                 /* New nodes dropped because the table was full */
+};
+
+/* Empties the table */
+void NodeTable_init(struct NodeTable* table);
+
+/* Returns the node with the given address, adding it if it is not known yet.
+ *
+ * A newly added node only has its address set and *isNew is set to 1.
+ * Returns NULL, and counts the node in rejectedCount, if the node is new and
+ * the table is full.
+ */
+struct AdcSensorNode* NodeTable_findOrAdd(struct NodeTable* table, NodeTable_Address address, uint8_t* isNew);
+
+/* Returns the node with the given address, or NULL if it is not known */
+struct AdcSensorNode* NodeTable_find(struct NodeTable* table, NodeTable_Address address);
+
+/* Returns the number of known nodes */
+uint16_t NodeTable_count(struct NodeTable* table);
+
+/* Returns the n-th known node in the order they were added, n < NodeTable_count */
+struct AdcSensorNode* NodeTable_get(struct NodeTable* table, uint16_t n);
+
+/* Returns the position of a node returned by the table, as used by NodeTable_get */
+uint16_t NodeTable_indexOf(struct NodeTable* table, struct AdcSensorNode* node);
+
+#endif /* NODETABLE_H_ */
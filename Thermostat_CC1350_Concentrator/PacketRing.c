@@ -0,0 +1,86 @@
+/*
+ *  ======== PacketRing.c ========
+ */
+
+/***** Includes *****/
+#include <stddef.h>
+
+#include "PacketRing.h"
+
+
+/***** Defines *****/
+#define PACKETRING_INDEX_MASK (PACKETRING_SIZE - 1)
+
+#if (PACKETRING_SIZE & PACKETRING_INDEX_MASK) != 0
+#error PACKETRING_SIZE must be a power of two
+#endif
+
+/* An index is read with acquire and written with release ordering, so an
+ * entry is completely written before the other side can see it */
+#ifdef PACKETRING_ATOMIC_INDEXES
+#define PACKETRING_LOAD(index)          atomic_load_explicit(&(index), memory_order_acquire)
+#define PACKETRING_STORE(index, value)  atomic_store_explicit(&(index), (value), memory_order_release)
+#else
+#define PACKETRING_LOAD(index)          (index)
+#define PACKETRING_STORE(index, value)  ((index) = (value))
+#endif
+
+
+/***** Function definitions *****/
+void PacketRing_init(struct PacketRing* ring)
+{
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overflowCount = 0;
+    ring->highWaterMark = 0;
+}
+
+struct PacketRingEntry* PacketRing_reserve(struct PacketRing* ring)
+{
+    /* head and tail are free running, so the difference is the fill level */
+    uint16_t head = PACKETRING_LOAD(ring->head);
+    uint16_t used = (uint16_t)(head - PACKETRING_LOAD(ring->tail));
+
+    if (used >= PACKETRING_SIZE)
+    {
+        ring->overflowCount++;
+        return NULL;
+    }
+
+    if (used + 1 > ring->highWaterMark)
+    {
+        ring->highWaterMark = used + 1;
+    }
+
+    return &ring->entries[head & PACKETRING_INDEX_MASK];
+}
+
+void PacketRing_commit(struct PacketRing* ring)
+{
+    /* The entry is completely written before head moves, so the consumer can
+     * never observe a half written entry */
+    PACKETRING_STORE(ring->head, (uint16_t)(PACKETRING_LOAD(ring->head) + 1));
+}
+
+struct PacketRingEntry* PacketRing_peek(struct PacketRing* ring)
+{
+    uint16_t tail = PACKETRING_LOAD(ring->tail);
+
+    if (PACKETRING_LOAD(ring->head) == tail)
+    {
+        return NULL;
+    }
+
+    return &ring->entries[tail & PACKETRING_INDEX_MASK];
+}
+
+void PacketRing_release(struct PacketRing* ring)
+{
+    /* The entry has been read completely before the producer can reuse it */
+    PACKETRING_STORE(ring->tail, (uint16_t)(PACKETRING_LOAD(ring->tail) + 1));
+}
+
+uint16_t PacketRing_count(struct PacketRing* ring)
+{
+    return (uint16_t)(PACKETRING_LOAD(ring->head) - PACKETRING_LOAD(ring->tail));
+}
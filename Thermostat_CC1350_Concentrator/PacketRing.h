@@ -0,0 +1,71 @@
+/*
+ *  ======== PacketRing.h ========
+ *
+ *  Fixed capacity single-producer/single-consumer ring of parsed concentrator
+ *  packets.
+ *
+ *  The ring is lock-free: the producer only ever writes the head index and
+ *  the consumer only ever writes the tail index, so one side may run in the
+ *  RF driver callback (SWI) context while the other runs in a task without
+ *  disabling interrupts. Entries are filled in place through
+ *  PacketRing_reserve/PacketRing_commit and read in place through
+ *  PacketRing_peek/PacketRing_release, so no extra copy is made on either side.
+ */
+
+#ifndef PACKETRING_H_
+#define PACKETRING_H_
+
+#include "stdint.h"
+#include "ConcentratorRadioTask.h"
+
+/* On the single-core CM3 a volatile index is enough to publish an entry. The
+ * host build runs the two sides in threads, where PACKETRING_ATOMIC_INDEXES
+ * makes the indexes C11 atomics with release/acquire ordering. */
+#ifdef PACKETRING_ATOMIC_INDEXES
+#include <stdatomic.h>
+typedef _Atomic uint16_t PacketRing_Index;
+#else
+typedef volatile uint16_t PacketRing_Index;
+#endif
+
+/* Number of entries in the ring, must be a power of two */
+#define PACKETRING_SIZE 8
+
+struct PacketRingEntry {
+    union ConcentratorPacket packet;
+    uint32_t rxTime;    /* RAT timestamp of the packet, from EasyLink_RxLoan.absTime */
+    uint16_t age100MiliSec;  /* Age of the reading at rxTime, for samples of a batch */
+    int8_t rssi;
+};
+
+struct PacketRing {
+    struct PacketRingEntry entries[PACKETRING_SIZE];
+    PacketRing_Index head;           /* Only written by the producer */
+    PacketRing_Index tail;           /* Only written by the consumer */
+    volatile uint32_t overflowCount; /* Packets dropped because the ring was full */
+    uint16_t highWaterMark;          /* Largest number of entries seen queued */
+};
+
+/* Empties the ring and clears the statistics */
+void PacketRing_init(struct PacketRing* ring);
+
+/* Producer side: returns the next free entry, or NULL if the ring is full.
+ *
+ * A NULL return is counted in overflowCount. The entry is not visible to the
+ * consumer until PacketRing_commit is called.
+ */
+struct PacketRingEntry* PacketRing_reserve(struct PacketRing* ring);
+
+/* Producer side: publishes the entry returned by the last PacketRing_reserve */
+void PacketRing_commit(struct PacketRing* ring);
+
+/* Consumer side: returns the oldest queued entry, or NULL if the ring is empty */
+struct PacketRingEntry* PacketRing_peek(struct PacketRing* ring);
+
+/* Consumer side: frees the entry returned by the last PacketRing_peek */
+void PacketRing_release(struct PacketRing* ring);
+
+/* Returns the number of queued entries */
+uint16_t PacketRing_count(struct PacketRing* ring);
+
+#endif /* PACKETRING_H_ */
@@ -0,0 +1,563 @@
+/*
+ *  ======== RadioProtocol.c ========
+ */
+
+/***** Includes *****/
+#include <stddef.h>
+#include <string.h>
+
+#include "RadioProtocol.h"
+
+
+/***** Defines *****/
+/* Fixed part of a BatchSensorPacket in front of the samples */
+#define RADIO_BATCH_HEADER_SIZE 10
+
+/* Fixed part of a SensorReport in front of the fields present */
+#define RADIO_REPORT_HEADER_SIZE 4
+
+/* Longest varint of a 32 bit value */
+#define RADIO_VARINT_MAX_SIZE 5
+
+
+/***** Variable declarations *****/
+/* Where the config field of each RADIO_CONFIG_* bit is kept in a NodeConfig */
+static const uint8_t configFieldOffsets[RADIO_CONFIG_FIELD_COUNT] = {
+    offsetof(struct NodeConfig, reportIntervalSlow),
+    offsetof(struct NodeConfig, reportIntervalFast),
+    offsetof(struct NodeConfig, fastDurationSec),
+    offsetof(struct NodeConfig, binWidth),
+    offsetof(struct NodeConfig, batchMaxAgeSec),
+    offsetof(struct NodeConfig, hysteresis),
+};
+
+
+/***** Prototypes *****/
+static uint8_t putVarint(uint8_t* buf, uint32_t value);
+static uint8_t getVarint(const uint8_t* buf, uint8_t len, uint8_t* pos, uint32_t* value);
+
+
+/***** Function definitions *****/
+uint8_t RadioProtocol_packAdcSensorPacket(const struct AdcSensorPacket* packet, uint8_t* buf)
+{
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    buf[2] = (packet->adcValue & 0xFF00) >> 8;
+    buf[3] = (packet->adcValue & 0xFF);
+
+    return RADIO_ADC_SENSOR_PACKET_SIZE;
+}
+
+uint8_t RadioProtocol_packDmSensorPacket(const struct DualModeSensorPacket* packet, uint8_t* buf)
+{
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    buf[2] = (packet->adcValue & 0xFF00) >> 8;
+    buf[3] = (packet->adcValue & 0xFF);
+    buf[4] = (packet->batt & 0xFF00) >> 8;
+    buf[5] = (packet->batt & 0xFF);
+    buf[6] = (packet->time100MiliSec & 0xFF000000) >> 24;
+    buf[7] = (packet->time100MiliSec & 0x00FF0000) >> 16;
+    buf[8] = (packet->time100MiliSec & 0xFF00) >> 8;
+    buf[9] = (packet->time100MiliSec & 0xFF);
+    buf[10] = packet->button;
+
+    return RADIO_DM_SENSOR_PACKET_SIZE;
+}
+
+uint8_t RadioProtocol_packAckPacket(const struct AckPacket* packet, uint8_t* buf)
+{
+    uint8_t len = RADIO_ACK_PACKET_SIZE;
+    uint16_t value;
+    uint8_t i;
+
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    buf[2] = packet->slot;
+    buf[3] = packet->channel;
+
+    /* Most acks carry no config and stay at the short size */
+    if (packet->config.version == RADIO_CONFIG_NO_VERSION)
+    {
+        return len;
+    }
+
+    buf[len++] = packet->config.version;
+    buf[len++] = packet->config.fields;
+    for (i = 0; i < RADIO_CONFIG_FIELD_COUNT; i++)
+    {
+        if (packet->config.fields & (1 << i))
+        {
+            value = *(const uint16_t*)((const uint8_t*)&packet->config + configFieldOffsets[i]);
+            buf[len++] = (value & 0xFF00) >> 8;
+            buf[len++] = (value & 0xFF);
+        }
+    }
+
+    return len;
+}
+
+uint8_t RadioProtocol_packBeaconPacket(const struct BeaconPacket* packet, uint8_t* buf)
+{
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    buf[2] = packet->sequence;
+    buf[3] = packet->slotCount;
+    buf[4] = packet->slotMs;
+    buf[5] = (packet->superframeMs & 0xFF00) >> 8;
+    buf[6] = (packet->superframeMs & 0xFF);
+    buf[7] = packet->channel;
+    buf[8] = packet->channelMask;
+
+    return RADIO_BEACON_PACKET_SIZE;
+}
+
+uint8_t RadioProtocol_packJoinRequestPacket(const struct JoinRequestPacket* packet, uint8_t* buf)
+{
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    memcpy(&buf[2], packet->ieeeAddr, RADIO_IEEE_ADDRESS_SIZE);
+
+    return RADIO_JOIN_REQUEST_PACKET_SIZE;
+}
+
+uint8_t RadioProtocol_packJoinResponsePacket(const struct JoinResponsePacket* packet, uint8_t* buf)
+{
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    memcpy(&buf[2], packet->ieeeAddr, RADIO_IEEE_ADDRESS_SIZE);
+    buf[10] = packet->address;
+
+    return RADIO_JOIN_RESPONSE_PACKET_SIZE;
+}
+
+uint8_t RadioProtocol_packBatchSensorPacket(const struct BatchSensorPacket* packet, uint8_t* buf)
+{
+    uint8_t i;
+    uint8_t* sample = &buf[RADIO_BATCH_HEADER_SIZE];
+
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    buf[2] = (packet->batt & 0xFF00) >> 8;
+    buf[3] = (packet->batt & 0xFF);
+    buf[4] = (packet->time100MiliSec & 0xFF000000) >> 24;
+    buf[5] = (packet->time100MiliSec & 0x00FF0000) >> 16;
+    buf[6] = (packet->time100MiliSec & 0xFF00) >> 8;
+    buf[7] = (packet->time100MiliSec & 0xFF);
+    buf[8] = packet->button;
+    buf[9] = packet->sampleCount;
+
+    for (i = 0; i < packet->sampleCount; i++)
+    {
+        sample[0] = (packet->samples[i].adcValue & 0xFF00) >> 8;
+        sample[1] = (packet->samples[i].adcValue & 0xFF);
+        sample[2] = (packet->samples[i].age100MiliSec & 0xFF00) >> 8;
+        sample[3] = (packet->samples[i].age100MiliSec & 0xFF);
+        sample += 4;
+    }
+    sample[0] = packet->configVersion;
+
+    return RADIO_BATCH_SENSOR_PACKET_SIZE(packet->sampleCount);
+}
+
+uint8_t RadioProtocol_unpackHeader(const uint8_t* buf, uint8_t len, struct PacketHeader* header)
+{
+    if (len < RADIO_PACKET_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    header->sourceAddress = buf[0];
+    header->packetType = buf[1];
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackAdcSensorPacket(const uint8_t* buf, uint8_t len, struct AdcSensorPacket* packet)
+{
+    if ((len < RADIO_ADC_SENSOR_PACKET_SIZE) || (buf[1] != RADIO_PACKET_TYPE_ADC_SENSOR_PACKET))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    packet->adcValue = (buf[2] << 8) | buf[3];
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackDmSensorPacket(const uint8_t* buf, uint8_t len, struct DualModeSensorPacket* packet)
+{
+    if ((len < RADIO_DM_SENSOR_PACKET_SIZE) || (buf[1] != RADIO_PACKET_TYPE_DM_SENSOR_PACKET))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    packet->adcValue = (buf[2] << 8) | buf[3];
+    packet->batt = (buf[4] << 8) | buf[5];
+    packet->time100MiliSec = ((uint32_t)buf[6] << 24) |
+                             ((uint32_t)buf[7] << 16) |
+                             ((uint32_t)buf[8] << 8) |
+                              buf[9];
+    packet->button = buf[10];
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackBatchSensorPacket(const uint8_t* buf, uint8_t len, struct BatchSensorPacket* packet)
+{
+    const uint8_t* sample = &buf[RADIO_BATCH_HEADER_SIZE];
+    uint8_t i;
+
+    /* Batches from nodes without config support end after the samples */
+    if ((len < RADIO_BATCH_HEADER_SIZE) || (buf[1] != RADIO_PACKET_TYPE_BATCH_SENSOR_PACKET) ||
+        (buf[9] > RADIO_BATCH_MAX_SAMPLES) || (len < RADIO_BATCH_HEADER_SIZE + 4 * buf[9]))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    packet->batt = (buf[2] << 8) | buf[3];
+    packet->time100MiliSec = ((uint32_t)buf[4] << 24) |
+                             ((uint32_t)buf[5] << 16) |
+                             ((uint32_t)buf[6] << 8) |
+                              buf[7];
+    packet->button = buf[8];
+    packet->sampleCount = buf[9];
+
+    for (i = 0; i < packet->sampleCount; i++)
+    {
+        packet->samples[i].adcValue = (sample[0] << 8) | sample[1];
+        packet->samples[i].age100MiliSec = (sample[2] << 8) | sample[3];
+        sample += 4;
+    }
+    packet->configVersion = (len >= RADIO_BATCH_SENSOR_PACKET_SIZE(packet->sampleCount)) ?
+                            sample[0] : RADIO_CONFIG_NO_VERSION;
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackBeaconPacket(const uint8_t* buf, uint8_t len, struct BeaconPacket* packet)
+{
+    /* Beacons of single channel concentrators end after superframeMs */
+    if ((len < RADIO_BEACON_PACKET_SIZE - 2) || (buf[1] != RADIO_PACKET_TYPE_BEACON_PACKET))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    packet->sequence = buf[2];
+    packet->slotCount = buf[3];
+    packet->slotMs = buf[4];
+    packet->superframeMs = (buf[5] << 8) | buf[6];
+    if (len >= RADIO_BEACON_PACKET_SIZE)
+    {
+        packet->channel = buf[7];
+        packet->channelMask = buf[8];
+    }
+    else
+    {
+        packet->channel = RADIO_CHANNEL_ANY;
+        packet->channelMask = (1 << RADIO_CHANNEL_BEACON);
+    }
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackJoinRequestPacket(const uint8_t* buf, uint8_t len, struct JoinRequestPacket* packet)
+{
+    if ((len < RADIO_JOIN_REQUEST_PACKET_SIZE) || (buf[1] != RADIO_PACKET_TYPE_JOIN_REQUEST_PACKET))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    memcpy(packet->ieeeAddr, &buf[2], RADIO_IEEE_ADDRESS_SIZE);
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackJoinResponsePacket(const uint8_t* buf, uint8_t len, struct JoinResponsePacket* packet)
+{
+    if ((len < RADIO_JOIN_RESPONSE_PACKET_SIZE) || (buf[1] != RADIO_PACKET_TYPE_JOIN_RESPONSE_PACKET))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    memcpy(packet->ieeeAddr, &buf[2], RADIO_IEEE_ADDRESS_SIZE);
+    packet->address = buf[10];
+
+    return 1;
+}
+
+uint8_t RadioProtocol_unpackAckPacket(const uint8_t* buf, uint8_t len, struct AckPacket* packet)
+{
+    uint8_t pos = RADIO_ACK_PACKET_SIZE + 2;
+    uint8_t i;
+
+    if ((len < RADIO_PACKET_HEADER_SIZE) || (buf[1] != RADIO_PACKET_TYPE_ACK_PACKET))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    packet->slot = (len >= RADIO_ACK_PACKET_SIZE - 1) ? buf[2] : RADIO_TDMA_NO_SLOT;
+    packet->channel = (len >= RADIO_ACK_PACKET_SIZE) ? buf[3] : RADIO_CHANNEL_ANY;
+    packet->config.version = RADIO_CONFIG_NO_VERSION;
+    packet->config.fields = 0;
+
+    if (len < pos)
+    {
+        return 1;
+    }
+
+    /* Take the fields this node knows, skipping the others. A config cut
+     * short is ignored as a whole rather than applied in part. */
+    for (i = 0; i < 8; i++)
+    {
+        if (buf[RADIO_ACK_PACKET_SIZE + 1] & (1 << i))
+        {
+            if (len < pos + 2)
+            {
+                packet->config.fields = 0;
+                return 1;
+            }
+            if (i < RADIO_CONFIG_FIELD_COUNT)
+            {
+                *(uint16_t*)((uint8_t*)&packet->config + configFieldOffsets[i]) = (buf[pos] << 8) | buf[pos + 1];
+                packet->config.fields |= (1 << i);
+            }
+            pos += 2;
+        }
+    }
+    packet->config.version = buf[RADIO_ACK_PACKET_SIZE];
+
+    return 1;
+}
+
+uint8_t RadioProtocol_packSensorReport(const struct SensorReport* packet, const struct SensorReportReference* reference,
+                                       uint8_t* buf)
+{
+    static const struct SensorReportReference none;
+    uint8_t len = RADIO_REPORT_HEADER_SIZE;
+    uint16_t fields = 0;
+    uint16_t previous;
+    int32_t delta;
+    uint8_t f;
+    uint8_t i;
+
+    if ((reference == NULL) || (reference->sequence == RADIO_REPORT_NO_REFERENCE))
+    {
+        reference = &none;
+    }
+
+    /* Leave out the fields the reference already has, in every sample */
+    for (f = 0; f < RADIO_REPORT_VALUE_COUNT; f++)
+    {
+        if ((packet->fields & RADIO_FIELD_BIT(f)) &&
+            (!(reference->fields & RADIO_FIELD_BIT(f)) || (packet->values[f] != reference->values[f])))
+        {
+            fields |= RADIO_FIELD_BIT(f);
+        }
+    }
+    for (f = 0; f < RADIO_REPORT_SAMPLE_FIELD_COUNT; f++)
+    {
+        if (!(packet->fields & RADIO_FIELD_BIT(RADIO_FIELD_FIRST_SAMPLE_FIELD + f)))
+        {
+            continue;
+        }
+        i = 0;
+        while ((i < packet->sampleCount) && (packet->samples[f][i] == reference->lastSamples[f]))
+        {
+            i++;
+        }
+        if (!(reference->fields & RADIO_FIELD_BIT(RADIO_FIELD_FIRST_SAMPLE_FIELD + f)) || (i < packet->sampleCount))
+        {
+            fields |= RADIO_FIELD_BIT(RADIO_FIELD_FIRST_SAMPLE_FIELD + f);
+        }
+    }
+
+    buf[0] = packet->header.sourceAddress;
+    buf[1] = packet->header.packetType;
+    buf[2] = (RADIO_REPORT_FORMAT_VERSION << 4) | packet->sampleCount;
+    buf[3] = ((packet->sequence & RADIO_REPORT_SEQUENCE_MASK) << 4) | reference->sequence;
+    len += putVarint(&buf[len], fields);
+
+    for (f = 0; f < RADIO_REPORT_VALUE_COUNT; f++)
+    {
+        if (fields & RADIO_FIELD_BIT(f))
+        {
+            delta = (int32_t)(packet->values[f] - reference->values[f]);
+            len += putVarint(&buf[len], ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+        }
+    }
+    for (f = 0; f < RADIO_REPORT_SAMPLE_FIELD_COUNT; f++)
+    {
+        if (fields & RADIO_FIELD_BIT(RADIO_FIELD_FIRST_SAMPLE_FIELD + f))
+        {
+            previous = reference->lastSamples[f];
+            for (i = 0; i < packet->sampleCount; i++)
+            {
+                delta = (int16_t)(packet->samples[f][i] - previous);
+                len += putVarint(&buf[len], ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31));
+                previous = packet->samples[f][i];
+            }
+        }
+    }
+
+    return len;
+}
+
+uint8_t RadioProtocol_unpackSensorReport(const uint8_t* buf, uint8_t len, const struct SensorReportReference* reference,
+                                         struct SensorReport* packet)
+{
+    static const struct SensorReportReference none;
+    uint8_t pos = RADIO_REPORT_HEADER_SIZE;
+    uint32_t fields;
+    uint32_t value;
+    uint16_t previous;
+    uint8_t count;
+    uint8_t f;
+    uint8_t i;
+
+    if ((len < RADIO_REPORT_HEADER_SIZE) || (buf[1] != RADIO_PACKET_TYPE_SENSOR_REPORT_PACKET) ||
+        ((buf[2] >> 4) != RADIO_REPORT_FORMAT_VERSION) || ((buf[2] & 0x0F) > RADIO_BATCH_MAX_SAMPLES))
+    {
+        return 0;
+    }
+
+    packet->header.sourceAddress = buf[0];
+    packet->header.packetType = buf[1];
+    packet->sampleCount = buf[2] & 0x0F;
+    packet->sequence = buf[3] >> 4;
+    packet->reference = buf[3] & RADIO_REPORT_SEQUENCE_MASK;
+
+    /* The deltas are only of use against the same reference as the sender's */
+    if (packet->reference == RADIO_REPORT_NO_REFERENCE)
+    {
+        reference = &none;
+    }
+    else if ((reference == NULL) || (reference->sequence != packet->reference))
+    {
+        return 0;
+    }
+
+    if ((!getVarint(buf, len, &pos, &fields)) || (fields > 0xFFFF))
+    {
+        return 0;
+    }
+
+    /* Start from the reference, the fields sent replace its values */
+    packet->fields = reference->fields | (uint16_t)fields;
+    memcpy(packet->values, reference->values, sizeof(packet->values));
+    for (f = 0; f < RADIO_REPORT_SAMPLE_FIELD_COUNT; f++)
+    {
+        for (i = 0; i < packet->sampleCount; i++)
+        {
+            packet->samples[f][i] = reference->lastSamples[f];
+        }
+    }
+
+    for (f = 0; f < 16; f++)
+    {
+        if (!(fields & RADIO_FIELD_BIT(f)))
+        {
+            continue;
+        }
+
+        if (f < RADIO_FIELD_FIRST_SAMPLE_FIELD)
+        {
+            if (!getVarint(buf, len, &pos, &value))
+            {
+                return 0;
+            }
+            if (f < RADIO_REPORT_VALUE_COUNT)
+            {
+                packet->values[f] += (value >> 1) ^ -(value & 1);
+            }
+        }
+        else
+        {
+            count = f - RADIO_FIELD_FIRST_SAMPLE_FIELD;
+            previous = (count < RADIO_REPORT_SAMPLE_FIELD_COUNT) ? reference->lastSamples[count] : 0;
+            for (i = 0; i < packet->sampleCount; i++)
+            {
+                if (!getVarint(buf, len, &pos, &value))
+                {
+                    return 0;
+                }
+                previous += (uint16_t)((value >> 1) ^ -(value & 1));
+                if (count < RADIO_REPORT_SAMPLE_FIELD_COUNT)
+                {
+                    packet->samples[count][i] = previous;
+                }
+            }
+        }
+    }
+
+    return 1;
+}
+
+void RadioProtocol_setSensorReportReference(const struct SensorReport* packet, struct SensorReportReference* reference)
+{
+    uint8_t f;
+
+    reference->sequence = packet->sequence;
+    reference->fields = packet->fields;
+    memcpy(reference->values, packet->values, sizeof(reference->values));
+
+    /* A report without samples leaves the last samples as they were */
+    if (packet->sampleCount > 0)
+    {
+        for (f = 0; f < RADIO_REPORT_SAMPLE_FIELD_COUNT; f++)
+        {
+            reference->lastSamples[f] = packet->samples[f][packet->sampleCount - 1];
+        }
+    }
+}
+
+/* Writes value 7 bits per byte, least significant first, the top bit marks
+ * that more bytes follow */
+static uint8_t putVarint(uint8_t* buf, uint32_t value)
+{
+    uint8_t size = 0;
+
+    while (value >= 0x80)
+    {
+        buf[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    buf[size++] = (uint8_t)value;
+
+    return size;
+}
+
+/* Reads a varint at *pos, returns 0 if it runs past len or is too long */
+static uint8_t getVarint(const uint8_t* buf, uint8_t len, uint8_t* pos, uint32_t* value)
+{
+    uint8_t shift = 0;
+    uint8_t byte;
+
+    *value = 0;
+    do
+    {
+        if ((*pos >= len) || (shift >= 7 * RADIO_VARINT_MAX_SIZE))
+        {
+            return 0;
+        }
+        byte = buf[(*pos)++];
+        *value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+
+    return 1;
+}
@@ -0,0 +1,73 @@
+/*
+ *  ======== TdmaSchedule.c ========
+ */
+
+/***** Includes *****/
+#include "TdmaSchedule.h"
+
+
+/***** Function definitions *****/
+uint8_t TdmaSchedule_getSlot(struct TdmaSchedule* schedule, uint8_t address, uint8_t channelMask,
+                             uint8_t* channel)
+{
+    struct TdmaSlot* slot;
+    uint8_t freeSlot = RADIO_TDMA_NO_SLOT;
+    uint8_t freeChannel = RADIO_CHANNEL_ANY;
+    uint8_t mostFree = 0;
+    uint8_t firstFree;
+    uint8_t freeCount;
+    uint8_t c;
+    uint8_t i;
+
+    for (c = 0; c < RADIO_CHANNEL_COUNT; c++)
+    {
+        /* Blacklisted channels have no slots */
+        if (!(channelMask & (1 << c)))
+        {
+            continue;
+        }
+
+        freeCount = 0;
+        firstFree = RADIO_TDMA_NO_SLOT;
+        for (i = 0; i < CONCENTRATOR_TDMA_SLOT_COUNT; i++)
+        {
+            slot = &schedule->slots[c][i];
+            if (slot->assigned && (slot->owner == address))
+            {
+                slot->lastHeard = schedule->superframe;
+                *channel = c;
+                return i;
+            }
+            if ((!slot->assigned) ||
+                ((uint16_t)(schedule->superframe - slot->lastHeard) > CONCENTRATOR_TDMA_SLOT_EXPIRY))
+            {
+                if (firstFree == RADIO_TDMA_NO_SLOT)
+                {
+                    firstFree = i;
+                }
+                freeCount++;
+            }
+        }
+
+        if (freeCount > mostFree)
+        {
+            mostFree = freeCount;
+            freeSlot = firstFree;
+            freeChannel = c;
+        }
+    }
+
+    *channel = freeChannel;
+    if (freeSlot == RADIO_TDMA_NO_SLOT)
+    {
+        schedule->fullCount++;
+        return RADIO_TDMA_NO_SLOT;
+    }
+
+    slot = &schedule->slots[freeChannel][freeSlot];
+    slot->owner = address;
+    slot->assigned = 1;
+    slot->lastHeard = schedule->superframe;
+
+    return freeSlot;
+}
@@ -0,0 +1,70 @@
+/*
+ *  ======== TdmaSchedule.h ========
+ *
+ *  TDMA slots of the concentrator, see RadioProtocol.h.
+ *
+ *  Every channel has CONCENTRATOR_TDMA_SLOT_COUNT slots. A node is given a
+ *  slot with the ack to its first packet, on the channel with the most free
+ *  slots, and keeps it as long as it is heard from. A slot whose owner has
+ *  not been heard from for CONCENTRATOR_TDMA_SLOT_EXPIRY superframes is
+ *  given to the next node that needs one. Nothing here depends on the radio
+ *  or TI-RTOS.
+ */
+
+#ifndef TDMASCHEDULE_H_
+#define TDMASCHEDULE_H_
+
+#include "stdint.h"
+#include "RadioProtocol.h"
+
+/* TDMA superframe, a beacon starts every superframe, the slots are given to
+ * the nodes in the acks. May be overridden from the build options. */
+#ifndef CONCENTRATOR_TDMA_SUPERFRAME_MS
+#define CONCENTRATOR_TDMA_SUPERFRAME_MS 1000
+#endif
+
+#ifndef CONCENTRATOR_TDMA_SLOT_COUNT
+#define CONCENTRATOR_TDMA_SLOT_COUNT    32
+#endif
+
+/* Room for the longest sensor packet and its ack */
+#define CONCENTRATOR_TDMA_SLOT_MS       20
+
+/* A slot is given to another node after this many superframes without a
+ * packet from its owner */
+#define CONCENTRATOR_TDMA_SLOT_EXPIRY   600
+
+#if (RADIO_TDMA_FIRST_SLOT_OFFSET_MS + CONCENTRATOR_TDMA_SLOT_COUNT * CONCENTRATOR_TDMA_SLOT_MS + \
+     CONCENTRATOR_TDMA_SLOT_MS + RADIO_TDMA_GUARD_MS) > CONCENTRATOR_TDMA_SUPERFRAME_MS
+#error No contention period left in the TDMA superframe
+#endif
+
+#if CONCENTRATOR_TDMA_SLOT_COUNT >= RADIO_TDMA_NO_SLOT
+#error CONCENTRATOR_TDMA_SLOT_COUNT does not fit the ack slot field
+#endif
+
+
+/***** Type declarations *****/
+struct TdmaSlot {
+    uint8_t owner;          /* Node address */
+    uint8_t assigned;
+    uint16_t lastHeard;     /* Superframe of the owner's last packet */
+};
+
+struct TdmaSchedule {
+    struct TdmaSlot slots[RADIO_CHANNEL_COUNT][CONCENTRATOR_TDMA_SLOT_COUNT];
+    uint16_t superframe;    /* Beacons sent, wraps */
+    uint32_t fullCount;     /* Nodes left without a slot because all were taken */
+};
+
+
+/***** Function declarations *****/
+
+/* Returns the slot of the node and its channel, giving it a free or expired
+ * one on the channel in channelMask with the most free ones if it has none
+ * yet. Returns RADIO_TDMA_NO_SLOT and channel RADIO_CHANNEL_ANY if all slots
+ * are taken, the node then keeps sending in the contention period. */
+uint8_t TdmaSchedule_getSlot(struct TdmaSchedule* schedule, uint8_t address, uint8_t channelMask,
+                             uint8_t* channel);
+
+#endif /* TDMASCHEDULE_H_ */
@@ -0,0 +1,211 @@
+/*
+ *  ======== Telemetry.c ========
+ */
+
+/***** Includes *****/
+/* XDCtools Header files */
+#include <xdc/std.h>
+
+/* BIOS Header files */
+#include <ti/sysbios/hal/Hwi.h>
+
+/* TI-RTOS Header files */
+#include <ti/drivers/UART.h>
+
+/* Board Header files */
+#include "Board.h"
+
+/* Application Header files */
+#include "Telemetry.h"
+
+
+/***** Defines *****/
+#define TELEMETRY_TX_BUFFER_MASK (TELEMETRY_TX_BUFFER_SIZE - 1)
+
+#if (TELEMETRY_TX_BUFFER_SIZE & TELEMETRY_TX_BUFFER_MASK) != 0
+#error TELEMETRY_TX_BUFFER_SIZE must be a power of two
+#endif
+
+#define TELEMETRY_RECORD_SIZE 12
+#define TELEMETRY_CRC_SIZE    2
+
+/* COBS adds one byte per started 254 bytes, plus the 0x00 delimiter */
+#define TELEMETRY_FRAME_MAX_SIZE (TELEMETRY_RECORD_SIZE + TELEMETRY_CRC_SIZE + 2)
+
+
+/***** Type declarations *****/
+struct TelemetryTx {
+    uint8_t buffer[TELEMETRY_TX_BUFFER_SIZE];
+    volatile uint16_t head;          /* Only written by Telemetry_sendReading */
+    volatile uint16_t tail;          /* Only written by the write callback */
+    volatile uint16_t writeLength;   /* Bytes handed to the UART driver, 0 if idle */
+    uint32_t queuedCount;
+    uint32_t droppedCount;
+};
+
+
+/***** Variable declarations *****/
+struct TelemetryTx telemetryTx;  /* not static so you can see in ROV */
+static UART_Handle uartHandle;
+
+
+/***** Prototypes *****/
+static void startWrite(void);
+static void writeCallback(UART_Handle handle, void *buf, size_t count);
+static uint16_t crc16(const uint8_t* data, uint8_t length);
+static uint8_t cobsEncode(const uint8_t* data, uint8_t length, uint8_t* out);
+
+
+/***** Function definitions *****/
+uint8_t Telemetry_init(void)
+{
+    UART_Params params;
+
+    telemetryTx.head = 0;
+    telemetryTx.tail = 0;
+    telemetryTx.writeLength = 0;
+
+    UART_Params_init(&params);
+    params.writeMode = UART_MODE_CALLBACK;
+    params.writeCallback = writeCallback;
+    params.writeDataMode = UART_DATA_BINARY;
+    params.readDataMode = UART_DATA_BINARY;
+    params.readEcho = UART_ECHO_OFF;
+    params.baudRate = TELEMETRY_BAUD_RATE;
+
+    uartHandle = UART_open(Board_UART0, &params);
+
+    return (uartHandle != NULL);
+}
+
+uint8_t Telemetry_sendReading(const struct TelemetryReading* reading)
+{
+    uint8_t record[TELEMETRY_RECORD_SIZE + TELEMETRY_CRC_SIZE];
+    uint8_t frame[TELEMETRY_FRAME_MAX_SIZE];
+    uint8_t frameLength;
+    uint16_t crc;
+    uint16_t head;
+    uint8_t i;
+    UInt key;
+
+    if (uartHandle == NULL)
+    {
+        return 0;
+    }
+
+    record[0] = TELEMETRY_RECORD_READING;
+    record[1] = reading->address;
+    record[2] = (reading->value & 0xFF00) >> 8;
+    record[3] = (reading->value & 0xFF);
+    record[4] = reading->button;
+    record[5] = (reading->batt & 0xFF00) >> 8;
+    record[6] = (reading->batt & 0xFF);
+    record[7] = (uint8_t)reading->rssi;
+    record[8] = (reading->time & 0xFF000000) >> 24;
+    record[9] = (reading->time & 0x00FF0000) >> 16;
+    record[10] = (reading->time & 0xFF00) >> 8;
+    record[11] = (reading->time & 0xFF);
+
+    crc = crc16(record, TELEMETRY_RECORD_SIZE);
+    record[12] = (crc & 0xFF00) >> 8;
+    record[13] = (crc & 0xFF);
+
+    frameLength = cobsEncode(record, sizeof(record), frame);
+    frame[frameLength++] = 0x00;
+
+    /* Drop the whole frame rather than block or send half of it */
+    if ((uint16_t)(telemetryTx.head - telemetryTx.tail) > (TELEMETRY_TX_BUFFER_SIZE - frameLength))
+    {
+        telemetryTx.droppedCount++;
+        return 0;
+    }
+
+    head = telemetryTx.head;
+    for (i = 0; i < frameLength; i++)
+    {
+        telemetryTx.buffer[(head + i) & TELEMETRY_TX_BUFFER_MASK] = frame[i];
+    }
+    telemetryTx.head = head + frameLength;
+    telemetryTx.queuedCount++;
+
+    /* Kick the UART if the write callback is not already draining the buffer */
+    key = Hwi_disable();
+    if (telemetryTx.writeLength == 0)
+    {
+        startWrite();
+    }
+    Hwi_restore(key);
+
+    return 1;
+}
+
+/* Hands the next contiguous part of the buffer to the UART driver */
+static void startWrite(void)
+{
+    uint16_t tail = telemetryTx.tail & TELEMETRY_TX_BUFFER_MASK;
+    uint16_t length = telemetryTx.head - telemetryTx.tail;
+
+    if (length > (TELEMETRY_TX_BUFFER_SIZE - tail))
+    {
+        length = TELEMETRY_TX_BUFFER_SIZE - tail;
+    }
+
+    telemetryTx.writeLength = length;
+    if (length != 0)
+    {
+        UART_write(uartHandle, &telemetryTx.buffer[tail], length);
+    }
+}
+
+static void writeCallback(UART_Handle handle, void *buf, size_t count)
+{
+    /* Free what was sent and continue with the rest */
+    telemetryTx.tail += telemetryTx.writeLength;
+    startWrite();
+}
+
+/* CRC-16/CCITT-FALSE, bitwise as the frames are short */
+static uint16_t crc16(const uint8_t* data, uint8_t length)
+{
+    uint16_t crc = 0xFFFF;
+    uint8_t i;
+
+    while (length--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+/* Consistent Overhead Byte Stuffing, removes all 0x00 bytes so that 0x00 can
+ * delimit the frames. length must be below 254, returns the encoded length. */
+static uint8_t cobsEncode(const uint8_t* data, uint8_t length, uint8_t* out)
+{
+    uint8_t codePos = 0;
+    uint8_t outPos = 1;
+    uint8_t code = 1;
+    uint8_t i;
+
+    for (i = 0; i < length; i++)
+    {
+        if (data[i] == 0)
+        {
+            out[codePos] = code;
+            codePos = outPos++;
+            code = 1;
+        }
+        else
+        {
+            out[outPos++] = data[i];
+            code++;
+        }
+    }
+    out[codePos] = code;
+
+    return outPos;
+}
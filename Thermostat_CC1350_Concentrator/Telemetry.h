@@ -0,0 +1,56 @@
+/*
+ *  ======== Telemetry.h ========
+ *
+ *  Binary stream of sensor readings on the UART.
+ *
+ *  Every reading is sent as one frame: the record below followed by a
+ *  CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF) over the record, COBS encoded
+ *  and terminated by a 0x00 byte. A receiver can resynchronise on any 0x00.
+ *  Multi-byte fields are big endian, as in the radio packets.
+ *
+ *   Offset  Size  Field
+ *   0       1     Record type, TELEMETRY_RECORD_READING
+ *   1       1     Node address
+ *   2       2     ADC value
+ *   4       1     Button state
+ *   5       2     Battery voltage, 0 for nodes that do not send it
+ *   7       1     RSSI (int8_t)
+ *   8       4     Seconds since the concentrator started
+ *   12      2     CRC
+ *
+ *  Frames are queued in a buffer that the UART driver drains from its write
+ *  callback, so sending never blocks the caller. Frames that do not fit are
+ *  dropped whole and counted in droppedCount.
+ */
+
+#ifndef TELEMETRY_H_
+#define TELEMETRY_H_
+
+#include "stdint.h"
+
+/* Size of the transmit buffer, must be a power of two */
+#ifndef TELEMETRY_TX_BUFFER_SIZE
+#define TELEMETRY_TX_BUFFER_SIZE 256
+#endif
+
+#define TELEMETRY_BAUD_RATE 115200
+
+#define TELEMETRY_RECORD_READING 1
+
+struct TelemetryReading {
+    uint8_t address;
+    uint16_t value;
+    uint8_t button;
+    uint16_t batt;
+    int8_t rssi;
+    uint32_t time;
+};
+
+/* Opens the UART, must be called from a task before the first reading.
+ * Returns 0 if the UART could not be opened, readings are then discarded. */
+uint8_t Telemetry_init(void);
+
+/* Queues one reading for sending, returns 0 if it was dropped */
+uint8_t Telemetry_sendReading(const struct TelemetryReading* reading);
+
+#endif /* TELEMETRY_H_ */
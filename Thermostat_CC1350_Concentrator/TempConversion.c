@@ -0,0 +1,130 @@
+/*
+ *  ======== TempConversion.c ========
+ */
+
+/***** Includes *****/
+#include "TempConversion.h"
+
+
+/***** Defines *****/
+/* ADC reading for a thermistor resistance of r ohms, rounded. 64-bit so the
+ * coldest end of the curve does not overflow while the compiler works it out */
+#define TEMPCONV_OHMS_TO_ADC(r) \
+    (uint16_t)(((uint64_t)TEMPCONV_ADC_MAX * TEMPCONV_SUPPLY_MV * (r) + \
+                ((uint64_t)((r) + TEMPCONV_SERIES_OHMS) * TEMPCONV_ADC_REF_MV) / 2) / \
+               ((uint64_t)((r) + TEMPCONV_SERIES_OHMS) * TEMPCONV_ADC_REF_MV))
+
+#define TEMPCONV_POINT(centiC, ohms) { centiC, TEMPCONV_OHMS_TO_ADC(ohms) },
+
+#define TEMPCONV_POINT_COUNT (sizeof(tempConvTable) / sizeof(tempConvTable[0]))
+
+#if TEMPCONV_SUPPLY_MV > TEMPCONV_ADC_REF_MV
+#error TEMPCONV_SUPPLY_MV is above the ADC range
+#endif
+
+
+/***** Type declarations *****/
+struct TempConvPoint {
+    int16_t centiC;
+    uint16_t adcValue;
+};
+
+
+/***** Variable declarations *****/
+static const struct TempConvPoint tempConvTable[] = {
+    TEMPCONV_CURVE(TEMPCONV_POINT)
+};
+
+
+/***** Prototypes *****/
+static int32_t divRound(int32_t num, int32_t den);
+
+
+/***** Function definitions *****/
+int16_t TempConversion_toCentiC(uint16_t adcValue, int16_t offsetCentiC)
+{
+    const struct TempConvPoint* lo;
+    const struct TempConvPoint* hi;
+    uint8_t first = 0;
+    uint8_t last = TEMPCONV_POINT_COUNT - 1;
+    uint8_t mid;
+    int32_t centiC;
+
+    if (adcValue <= tempConvTable[first].adcValue)
+    {
+        return tempConvTable[first].centiC + offsetCentiC;
+    }
+    if (adcValue >= tempConvTable[last].adcValue)
+    {
+        return tempConvTable[last].centiC + offsetCentiC;
+    }
+
+    /* Narrow down to the two points around the reading */
+    while (last - first > 1)
+    {
+        mid = (first + last) / 2;
+        if (adcValue < tempConvTable[mid].adcValue)
+        {
+            last = mid;
+        }
+        else
+        {
+            first = mid;
+        }
+    }
+    lo = &tempConvTable[first];
+    hi = &tempConvTable[last];
+
+    centiC = lo->centiC + divRound((int32_t)(hi->centiC - lo->centiC) * (adcValue - lo->adcValue),
+                                   hi->adcValue - lo->adcValue);
+
+    return (int16_t)(centiC + offsetCentiC);
+}
+
+uint16_t TempConversion_toAdc(int16_t centiC, int16_t offsetCentiC)
+{
+    const struct TempConvPoint* lo;
+    const struct TempConvPoint* hi;
+    uint8_t first = 0;
+    uint8_t last = TEMPCONV_POINT_COUNT - 1;
+    uint8_t mid;
+    int32_t sensorCentiC = (int32_t)centiC - offsetCentiC;
+
+    if (sensorCentiC >= tempConvTable[first].centiC)
+    {
+        return tempConvTable[first].adcValue;
+    }
+    if (sensorCentiC <= tempConvTable[last].centiC)
+    {
+        return tempConvTable[last].adcValue;
+    }
+
+    /* The temperatures go down along the table */
+    while (last - first > 1)
+    {
+        mid = (first + last) / 2;
+        if (sensorCentiC > tempConvTable[mid].centiC)
+        {
+            last = mid;
+        }
+        else
+        {
+            first = mid;
+        }
+    }
+    lo = &tempConvTable[first];
+    hi = &tempConvTable[last];
+
+    return (uint16_t)(lo->adcValue + divRound((int32_t)(hi->adcValue - lo->adcValue) * (lo->centiC - sensorCentiC),
+                                              lo->centiC - hi->centiC));
+}
+
+/* Divides, rounding half away from zero, den must be positive */
+static int32_t divRound(int32_t num, int32_t den)
+{
+    if (num < 0)
+    {
+        return (num - den / 2) / den;
+    }
+    return (num + den / 2) / den;
+}
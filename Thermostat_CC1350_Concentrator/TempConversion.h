@@ -0,0 +1,96 @@
+/*
+ *  ======== TempConversion.h ========
+ *
+ *  Conversion between the ADC readings of the sensor nodes and temperatures
+ *  in 0.01 C, shared by the node and the concentrator.
+ *
+ *  The sensor is an NTC thermistor (10k at 25 C, B = 3380) from the ADC input
+ *  to ground, with a TEMPCONV_SERIES_OHMS resistor to the supply. The table
+ *  below lists the thermistor resistance every 5 C from its data sheet, the
+ *  matching ADC readings are worked out by the compiler from the divider and
+ *  the ADC reference, so a different circuit only needs the defines changed.
+ *  Readings between two table points are interpolated linearly, which stays
+ *  within 0.2 C of the thermistor curve. Only integer arithmetic is used.
+ *
+ *  The thermistor tolerance is taken out with an offset per board, added to
+ *  every temperature read.
+ */
+
+#ifndef TEMPCONVERSION_H_
+#define TEMPCONVERSION_H_
+
+#include "stdint.h"
+
+/* Divider and ADC setup, may be overridden from the build options */
+#ifndef TEMPCONV_SERIES_OHMS
+#define TEMPCONV_SERIES_OHMS 10000
+#endif
+
+#ifndef TEMPCONV_SUPPLY_MV
+#define TEMPCONV_SUPPLY_MV 3300
+#endif
+
+/* Full scale input of the ADC with the fixed internal reference and input scaling */
+#ifndef TEMPCONV_ADC_REF_MV
+#define TEMPCONV_ADC_REF_MV 4300
+#endif
+
+#define TEMPCONV_ADC_MAX 4095
+
+/* Calibration offset of this board in 0.01 C, may be overridden from the build options */
+#ifndef TEMPCONV_BOARD_OFFSET
+#define TEMPCONV_BOARD_OFFSET 0
+#endif
+
+/* Thermistor curve as X(temperature in 0.01 C, resistance in ohms), hottest
+ * first so the ADC readings go up along the table */
+#define TEMPCONV_CURVE(X) \
+    X( 12500,    580) \
+    X( 12000,    646) \
+    X( 11500,    722) \
+    X( 11000,    809) \
+    X( 10500,    909) \
+    X( 10000,   1024) \
+    X(  9500,   1158) \
+    X(  9000,   1315) \
+    X(  8500,   1497) \
+    X(  8000,   1711) \
+    X(  7500,   1963) \
+    X(  7000,   2261) \
+    X(  6500,   2616) \
+    X(  6000,   3039) \
+    X(  5500,   3547) \
+    X(  5000,   4160) \
+    X(  4500,   4903) \
+    X(  4000,   5810) \
+    X(  3500,   6922) \
+    X(  3000,   8295) \
+    X(  2500,  10000) \
+    X(  2000,  12133) \
+    X(  1500,  14820) \
+    X(  1000,  18231) \
+    X(   500,  22595) \
+    X(     0,  28224) \
+    X(  -500,  35548) \
+    X( -1000,  45168) \
+    X( -1500,  57926) \
+    X( -2000,  75022) \
+    X( -2500,  98180) \
+    X( -3000, 129917) \
+    X( -3500, 173946) \
+    X( -4000, 235831)
+
+/* Range of the table, temperatures outside of it are clamped */
+#define TEMPCONV_MAX_CENTI_C 12500
+#define TEMPCONV_MIN_CENTI_C (-4000)
+
+/* Converts an ADC reading to a temperature in 0.01 C, offsetCentiC is added
+ * to the result (TEMPCONV_BOARD_OFFSET on the node, the offset of the sending
+ * node on the concentrator) */
+int16_t TempConversion_toCentiC(uint16_t adcValue, int16_t offsetCentiC);
+
+/* Converts a temperature in 0.01 C to the ADC reading it gives on a board
+ * with calibration offset offsetCentiC, the inverse of TempConversion_toCentiC */
+uint16_t TempConversion_toAdc(int16_t centiC, int16_t offsetCentiC);
+
+#endif /* TEMPCONVERSION_H_ */
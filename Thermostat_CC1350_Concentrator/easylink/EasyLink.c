@@ -40,6 +40,7 @@
 /* BIOS Header files */
 #include <ti/sysbios/knl/Clock.h>
 #include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/hal/Hwi.h>
 #include <ti/sysbios/BIOS.h>
 #include <ti/sysbios/knl/Task.h>
 
@@ -73,6 +74,20 @@ union setupCmd_t{
 
 #define EASYLINK_RF_CMD_HANDLE_INVALID -1
 
+//Continuous Rx additionally needs to be told about every finished data entry
+#define EASYLINK_RF_RX_CONTINUOUS_EVENT_MASK  ( EASYLINK_RF_EVENT_MASK | \
+             RF_EventRxEntryDone )
+
+//Bytes the radio appends after the payload in continuous Rx: RSSI (1B) and
+//timestamp (4B)
+#define EASYLINK_RX_CONTINUOUS_APPENDED_SIZE  5
+
+//Continuous Rx data entry length, including the appended RSSI and timestamp,
+//rounded up so that each entry stays 4B aligned
+#define EASYLINK_RX_CONTINUOUS_ENTRY_SIZE     ((sizeof(rfc_dataEntryGeneral_t) + \
+             1 + EASYLINK_MAX_ADDR_SIZE + EASYLINK_MAX_DATA_LENGTH + \
+             EASYLINK_RX_CONTINUOUS_APPENDED_SIZE + 3) & ~3)
+
 #define EasyLink_CmdHandle_isValid(handle) (handle >= 0)
 
 /***** Prototypes *****/
@@ -103,10 +118,44 @@ static RF_Handle rfHandle;
 
 static dataQueue_t dataQueue;
 static rfc_propRxOutput_t rxStatistics;
+/* CRC errors of the Rx commands before the current one, whose 8-bit
+ * rxStatistics.nRxNok are cleared with every start */
+static uint32_t rxErrorCount;
+
+//Circular queue of data entries used by EasyLink_receiveContinuousAsync(), the
+//radio keeps filling entries while the application consumes them
+#if defined(__TI_COMPILER_VERSION__)
+    #pragma DATA_ALIGN (rxContinuousBuffer, 4);
+        static uint8_t rxContinuousBuffer[EASYLINK_RX_QUEUE_ENTRIES * EASYLINK_RX_CONTINUOUS_ENTRY_SIZE];
+#elif defined(__IAR_SYSTEMS_ICC__)
+    #pragma data_alignment = 4
+        static uint8_t rxContinuousBuffer[EASYLINK_RX_QUEUE_ENTRIES * EASYLINK_RX_CONTINUOUS_ENTRY_SIZE];
+#elif defined(__GNUC__)
+        static uint8_t rxContinuousBuffer[EASYLINK_RX_QUEUE_ENTRIES * EASYLINK_RX_CONTINUOUS_ENTRY_SIZE]
+            __attribute__ ((aligned (4)));
+#else
+    #error This compiler is not supported.
+#endif
+
+//Next entry to hand to the application in continuous Rx
+static rfc_dataEntryGeneral_t *rxContinuousReadEntry;
+
+//Loans of EasyLink_receiveContinuousLoanAsync(), one per queue entry. A lent
+//entry has a non NULL payload and stays DATA_ENTRY_FINISHED until returned.
+static EasyLink_RxLoan rxLoans[EASYLINK_RX_QUEUE_ENTRIES];
+static uint8_t rxLoanCount = 0;
 
 //Tx buffer includes hdr (len=1byte), dst addr (max of 8 bytes) and data
 static uint8_t txBuffer[1 + EASYLINK_MAX_ADDR_SIZE + EASYLINK_MAX_DATA_LENGTH];
 
+//Zero copy Tx, see EasyLink_reserveTxBuffer(). The reserved payload always
+//starts right after the largest address, so it does not move when the addr
+//size changes, and the frame is sent from where the address begins.
+#define EASYLINK_TX_PAYLOAD_OFFSET EASYLINK_MAX_ADDR_SIZE
+static bool txBufferReserved = false;
+static uint8_t *txCommittedPkt = NULL;
+static uint8_t txCommittedLen = 0;
+
 //Addr size for Filter and Tx/Rx operations
 //Set default to 1 byte addr to work with SmartRF
 //studio default settings
@@ -136,6 +185,14 @@ static rfc_CMD_PROP_TX_t EasyLink_cmdPropTx;
 static rfc_CMD_PROP_RX_ADV_t EasyLink_cmdPropRxAdv;
 #if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
 static rfc_CMD_PROP_CS_t EasyLink_cmdPropCs;
+
+//CCA back-off settings, see EasyLink_Ctrl_Cca_*
+static uint8_t ccaMinBackoffWindow = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
+static uint8_t ccaMaxBackoffWindow = EASYLINK_MAX_CCA_BACKOFF_WINDOW;
+static uint32_t ccaBackoffTimeUnits = EASYLINK_CCA_BACKOFF_TIMEUNITS;
+static int8_t ccaRssiThreshold = EASYLINK_CS_RSSI_THRESHOLD_DBM;
+static uint8_t ccaBackoffExponent;
+static uint32_t ccaBusyCount;
 #endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
 
 // The table for setting the Rx Address Filters
@@ -147,6 +204,14 @@ static Semaphore_Handle busyMutex;
 //Handle for last Async command, which is needed by EasyLink_abort
 static RF_CmdHandle asyncCmdHndl = EASYLINK_RF_CMD_HANDLE_INVALID;
 
+//Continuous Rx runs in the background and does not hold the busyMutex, so Tx
+//can stop it, send and resume it again
+static RF_CmdHandle rxContinuousCmdHndl = EASYLINK_RF_CMD_HANDLE_INVALID;
+static EasyLink_ReceiveCb rxContinuousCb;
+static EasyLink_ReceiveLoanCb rxContinuousLoanCb;
+static bool rxContinuousActive = false;
+static bool rxContinuousSuspended = false;
+
 /* Set Default parameters structure */
 static const EasyLink_Params EasyLink_defaultParams = {
     .ui32ModType            = EasyLink_Phy_50kbps2gfsk,
@@ -155,6 +220,13 @@ static const EasyLink_Params EasyLink_defaultParams = {
 };
 
 EasyLink_Status EasyLink_configure(EasyLink_PhyType ui32ModType);
+static void rxContinuousSuspend(void);
+static void rxContinuousResume(void);
+static EasyLink_Status rxContinuousStart(uint32_t absTime);
+static EasyLink_Status postTxAsync(uint32_t absTime, EasyLink_TxDoneCb cb);
+#if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+static EasyLink_Status postCcaTxAsync(uint32_t absTime, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn);
+#endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
 
 void EasyLink_Params_init(EasyLink_Params *params)
 {
@@ -183,6 +255,9 @@ static void txDoneCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
         status = EasyLink_Status_Tx_Error;
     }
 
+    //Go back to continuous Rx if the Tx interrupted it
+    rxContinuousResume();
+
     if (txCb != NULL)
     {
         txCb(status);
@@ -197,8 +272,7 @@ static void ccaDoneCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
     RF_ScheduleCmdParams schParams_prop;
     RF_Op* pCmd                   = RF_getCmdOp(h, ch);
     bool bCCARunAgain             = false;
-    static uint8_t be             = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
-    static uint32_t backOffTime;
+    uint32_t backOffTime;
 
     asyncCmdHndl = EASYLINK_RF_CMD_HANDLE_INVALID;
 
@@ -208,36 +282,37 @@ static void ccaDoneCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
         {
             // Carrier Sense operation ended with an idle channel,
             // and the next op (TX) should have already taken place
+            //Release now so user callback can call EasyLink API's
+            Semaphore_post(busyMutex);
             if(pCmd->pNextOp->status == PROP_DONE_OK)
             {
-                //Release now so user callback can call EasyLink API's
-                Semaphore_post(busyMutex);
                 status = EasyLink_Status_Success;
-                // Reset the number of retries
-                be = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
+            }
+            else
+            {
+                status = EasyLink_Status_Tx_Error;
             }
         }
         else if(pCmd->status == PROP_DONE_BUSY)
         {
-            if(be > EASYLINK_MAX_CCA_BACKOFF_WINDOW)
+            ccaBusyCount++;
+            if(ccaBackoffExponent > ccaMaxBackoffWindow)
             {
                 //Release now so user callback can call EasyLink API's
                 Semaphore_post(busyMutex);
-                // Reset the number of retries
-                be = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
                 // CCA failed max number of retries
                 status = EasyLink_Status_Busy_Error;
             }
             else
             {
                 // The back-off time is a random number chosen from 0 to 2^be,
-                // where 'be' goes from EASYLINK_MIN_CCA_BACKOFF_WINDOW
-                // to EASYLINK_MAX_CCA_BACKOFF_WINDOW. This number is then converted
-                // into EASYLINK_CCA_BACKOFF_TIMEUNITS units, and subsequently used to
+                // where 'be' (ccaBackoffExponent) goes from ccaMinBackoffWindow
+                // to ccaMaxBackoffWindow. This number is then converted
+                // into ccaBackoffTimeUnits units, and subsequently used to
                 // schedule the next CCA sequence. The variable 'be' is incremented each
                 // time, up to a pre-configured maximum, the back-off algorithm is run.
-                backOffTime = (getRN() & ((1 << be++)-1)) *
-                        EasyLink_us_To_RadioTime(EASYLINK_CCA_BACKOFF_TIMEUNITS);
+                backOffTime = (getRN() & ((1 << ccaBackoffExponent++)-1)) *
+                        EasyLink_us_To_RadioTime(ccaBackoffTimeUnits);
                 // running CCA again
                 bCCARunAgain = true;
                 // The random number generator function returns a value in the range
@@ -263,8 +338,6 @@ static void ccaDoneCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
         {
             //Release now so user callback can call EasyLink API's
             Semaphore_post(busyMutex);
-            // Reset the number of retries
-            be = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
             // The CS command status should be either IDLE or BUSY.
             // All other status codes can be considered errors
             status = EasyLink_Status_Tx_Error;
@@ -276,19 +349,21 @@ static void ccaDoneCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
     {
         //Release now so user callback can call EasyLink API's
         Semaphore_post(busyMutex);
-        // Reset the number of retries
-        be = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
         status = EasyLink_Status_Aborted;
     }
     else
     {
         //Release now so user callback can call EasyLink API's
         Semaphore_post(busyMutex);
-        // Reset the number of retries
-        be = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
         status = EasyLink_Status_Tx_Error;
     }
 
+    if (!bCCARunAgain)
+    {
+        //Go back to continuous Rx if the Tx interrupted it
+        rxContinuousResume();
+    }
+
     if ((txCb != NULL) && (!bCCARunAgain))
     {
         txCb(status);
@@ -369,6 +444,170 @@ static void rxDoneCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
     }
 }
 
+//Hands every finished continuous Rx entry to the application, in order. A
+//copied entry is given back to the radio right away, a lent one once the
+//application returns it.
+static void rxContinuousDrainEntries(void)
+{
+    //create rxPacket as a static so that the large payload buffer it is not
+    //allocated from the stack
+    static EasyLink_RxPacket rxPacket;
+    EasyLink_RxLoan *rxLoan;
+    uint8_t *pData;
+    uint8_t pktLen;
+
+    while (rxContinuousReadEntry->status == DATA_ENTRY_FINISHED)
+    {
+        rxLoan = &rxLoans[((uint8_t*)rxContinuousReadEntry - rxContinuousBuffer) /
+                          EASYLINK_RX_CONTINUOUS_ENTRY_SIZE];
+        if (rxLoan->payload != NULL)
+        {
+            //Still lent out, the radio has wrapped around and stopped here
+            break;
+        }
+
+        pData = &rxContinuousReadEntry->data;
+        //length byte from the hdr includes the addr
+        pktLen = *pData;
+
+        if ((pktLen >= addrSize) && (rxContinuousLoanCb != NULL))
+        {
+            rxLoan->dstAddr = pData + 1;
+            rxLoan->payload = pData + 1 + addrSize;
+            rxLoan->len = pktLen - addrSize;
+            //RSSI and timestamp are appended by the radio after the packet
+            rxLoan->rssi = (int8_t)pData[1 + pktLen];
+            memcpy(&rxLoan->absTime, pData + 1 + pktLen + 1, sizeof(uint32_t));
+            rxLoanCount++;
+
+            //Move on first, the callback may return the loan straight away
+            rxContinuousReadEntry = (rfc_dataEntryGeneral_t*)rxContinuousReadEntry->pNextEntry;
+            rxContinuousLoanCb(rxLoan, EasyLink_Status_Success);
+            continue;
+        }
+
+        if ((pktLen >= addrSize) && (rxContinuousCb != NULL))
+        {
+            rxPacket.len = pktLen - addrSize;
+            memcpy(rxPacket.dstAddr, pData + 1, addrSize);
+            memcpy(rxPacket.payload, pData + 1 + addrSize, rxPacket.len);
+            //RSSI and timestamp are appended by the radio after the packet
+            rxPacket.rssi = (int8_t)pData[1 + pktLen];
+            memcpy(&rxPacket.absTime, pData + 1 + pktLen + 1, sizeof(uint32_t));
+
+            rxContinuousCb(&rxPacket, EasyLink_Status_Success);
+        }
+
+        //Return the entry to the radio and move on
+        rxContinuousReadEntry->status = DATA_ENTRY_PENDING;
+        rxContinuousReadEntry = (rfc_dataEntryGeneral_t*)rxContinuousReadEntry->pNextEntry;
+    }
+}
+
+//Callback for continuous Rx, called per finished entry and when the command ends
+static void rxContinuousCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
+{
+    EasyLink_Status status = EasyLink_Status_Rx_Error;
+
+    rxContinuousDrainEntries();
+
+    if (!(e & (RF_EventLastCmdDone | RF_EventCmdAborted | RF_EventCmdStopped |
+               RF_EventCmdCancelled | RF_EventCmdPreempted)))
+    {
+        //Still receiving
+        return;
+    }
+
+    rxContinuousCmdHndl = EASYLINK_RF_CMD_HANDLE_INVALID;
+
+    if (rxContinuousSuspended)
+    {
+        //Stopped to make room for a Tx, rxContinuousResume() restarts it
+        return;
+    }
+
+    rxContinuousActive = false;
+
+    if ( (e & RF_EventCmdAborted) || (e & RF_EventCmdStopped) ||
+         (e & RF_EventCmdCancelled) || (e & RF_EventCmdPreempted) )
+    {
+        status = EasyLink_Status_Aborted;
+    }
+    else if (EasyLink_cmdPropRxAdv.status == PROP_DONE_RXTIMEOUT)
+    {
+        status = EasyLink_Status_Rx_Timeout;
+    }
+    else if ( (EasyLink_cmdPropRxAdv.status == PROP_DONE_STOPPED) ||
+              (EasyLink_cmdPropRxAdv.status == PROP_DONE_ABORT) )
+    {
+        status = EasyLink_Status_Aborted;
+    }
+
+    //Tell the application that Rx has ended
+    if (rxContinuousCb != NULL)
+    {
+        static EasyLink_RxPacket rxPacket;
+        rxContinuousCb(&rxPacket, status);
+    }
+    else if (rxContinuousLoanCb != NULL)
+    {
+        rxContinuousLoanCb(NULL, status);
+    }
+}
+
+//Posts the continuous Rx command, which repeats until stopped
+static RF_CmdHandle rxContinuousPost(void)
+{
+    RF_ScheduleCmdParams schParams_prop;
+
+    if(rfModeMultiClient)
+    {
+        /* assume high priority */
+        schParams_prop.priority = RF_PriorityHigh;
+        schParams_prop.endTime = 0;
+
+        return RF_scheduleCmd(rfHandle, (RF_Op*)&EasyLink_cmdPropRxAdv,
+                    &schParams_prop, rxContinuousCallback, EASYLINK_RF_RX_CONTINUOUS_EVENT_MASK);
+    }
+
+    return RF_postCmd(rfHandle, (RF_Op*)&EasyLink_cmdPropRxAdv,
+            RF_PriorityHigh, rxContinuousCallback, EASYLINK_RF_RX_CONTINUOUS_EVENT_MASK);
+}
+
+//Gracefully stops continuous Rx so a Tx can be queued behind it. The packet
+//being received, if any, is completed first.
+static void rxContinuousSuspend(void)
+{
+    if (rxContinuousActive && !rxContinuousSuspended)
+    {
+        rxContinuousSuspended = true;
+        if (EasyLink_CmdHandle_isValid(rxContinuousCmdHndl))
+        {
+            RF_cancelCmd(rfHandle, rxContinuousCmdHndl, 1);
+        }
+    }
+}
+
+//Restarts continuous Rx after a Tx, on the same queue so no received entry is
+//lost
+static void rxContinuousResume(void)
+{
+    if (rxContinuousActive && rxContinuousSuspended)
+    {
+        rxContinuousSuspended = false;
+
+        EasyLink_cmdPropRxAdv.startTrigger.triggerType = TRIG_NOW;
+        EasyLink_cmdPropRxAdv.startTrigger.pastTrig = 1;
+        EasyLink_cmdPropRxAdv.startTime = 0;
+
+        rxContinuousCmdHndl = rxContinuousPost();
+        if (!EasyLink_CmdHandle_isValid(rxContinuousCmdHndl))
+        {
+            rxContinuousActive = false;
+        }
+    }
+}
+
 //Callback for Async TX Test mode
 static void asyncCmdCallback(RF_Handle h, RF_CmdHandle ch, RF_EventMask e)
 {
@@ -394,7 +633,8 @@ static EasyLink_Status enableTestMode(EasyLink_CtrlOption mode)
     }
     
     //Check and take the busyMutex
-    if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) ||
+         (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
     {
         return EasyLink_Status_Busy_Error;
     }
@@ -529,7 +769,7 @@ EasyLink_Status EasyLink_configure(EasyLink_PhyType ui32ModType)
     // Configure the EasyLink Carrier Sense Command
     memset(&EasyLink_cmdPropCs, 0, sizeof(rfc_CMD_PROP_CS_t));
     EasyLink_cmdPropCs.commandNo                = CMD_PROP_CS;
-    EasyLink_cmdPropCs.rssiThr                  = EASYLINK_CS_RSSI_THRESHOLD_DBM;
+    EasyLink_cmdPropCs.rssiThr                  = ccaRssiThreshold;
     EasyLink_cmdPropCs.startTrigger.triggerType = TRIG_NOW;
     EasyLink_cmdPropCs.condition.rule           = COND_STOP_ON_TRUE;  // Stop next command if this command returned TRUE,
                                                             // End causes for the CMD_PROP_CS command:
@@ -686,6 +926,9 @@ EasyLink_Status EasyLink_setFrequency(uint32_t ui32Freq)
         return EasyLink_Status_Busy_Error;
     }
 
+    // Stop continuous Rx, if running, so the synthesizer can be retuned
+    rxContinuousSuspend();
+
     /* Set the frequency */
     EasyLink_cmdFs.frequency = (uint16_t)(ui32Freq / 1000000);
     EasyLink_cmdFs.fractFreq = (uint16_t) (((uint64_t)ui32Freq -
@@ -700,6 +943,9 @@ EasyLink_Status EasyLink_setFrequency(uint32_t ui32Freq)
         status = EasyLink_Status_Success;
     }
 
+    // Continuous Rx carries on at the new frequency
+    rxContinuousResume();
+
     Semaphore_post(busyMutex);
 
     return status;
@@ -720,6 +966,23 @@ uint32_t EasyLink_getFrequency(void)
     return freq_khz;
 }
 
+EasyLink_Status EasyLink_getRssi(int8_t *pRssi)
+{
+    if ( (!configured) || suspended)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    //Only valid while the receiver is on
+    *pRssi = RF_getRssi(rfHandle);
+    if (*pRssi == RF_GET_RSSI_ERROR_VAL)
+    {
+        return EasyLink_Status_Rx_Error;
+    }
+
+    return EasyLink_Status_Success;
+}
+
 EasyLink_Status EasyLink_setRfPwr(int8_t i8txPowerdBm)
 {
     EasyLink_Status status = EasyLink_Status_Cmd_Error;
@@ -731,8 +994,8 @@ EasyLink_Status EasyLink_setRfPwr(int8_t i8txPowerdBm)
     {
         return EasyLink_Status_Config_Error;
     }
-    //Check and take the busyMutex
-    if (Semaphore_pend(busyMutex, 0) == FALSE)
+    //Check and take the busyMutex, continuous Rx must be aborted first
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) )
     {
         return EasyLink_Status_Busy_Error;
     }
@@ -843,15 +1106,19 @@ EasyLink_Status EasyLink_transmit(EasyLink_TxPacket *txPacket)
     {
         return EasyLink_Status_Config_Error;
     }
-    //Check and take the busyMutex
-    if (Semaphore_pend(busyMutex, 0) == FALSE)
+    if (txPacket->len > EASYLINK_MAX_DATA_LENGTH)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+    //The Tx buffer belongs to the application while it is reserved
+    if (txBufferReserved)
     {
         return EasyLink_Status_Busy_Error;
     }
-
-    if (txPacket->len > EASYLINK_MAX_DATA_LENGTH)
+    //Check and take the busyMutex
+    if (Semaphore_pend(busyMutex, 0) == FALSE)
     {
-        return EasyLink_Status_Param_Error;
+        return EasyLink_Status_Busy_Error;
     }
 
     memcpy(txBuffer, txPacket->dstAddr, addrSize);
@@ -878,6 +1145,9 @@ EasyLink_Status EasyLink_transmit(EasyLink_TxPacket *txPacket)
         schParams_prop.endTime = RF_getCurrentTime() + EasyLink_ms_To_RadioTime(1);
     }
 
+    // Stop continuous Rx, if running, so the Tx is queued right behind it
+    rxContinuousSuspend();
+
     // Send packet
     if(rfModeMultiClient)
     {
@@ -899,6 +1169,9 @@ EasyLink_Status EasyLink_transmit(EasyLink_TxPacket *txPacket)
         status = EasyLink_Status_Success;
     }
 
+    // Go back to continuous Rx if the Tx interrupted it
+    rxContinuousResume();
+
     //Release the busyMutex
     Semaphore_post(busyMutex);
 
@@ -907,27 +1180,58 @@ EasyLink_Status EasyLink_transmit(EasyLink_TxPacket *txPacket)
 
 EasyLink_Status EasyLink_transmitAsync(EasyLink_TxPacket *txPacket, EasyLink_TxDoneCb cb)
 {
-    EasyLink_Status status = EasyLink_Status_Tx_Error;
-    RF_ScheduleCmdParams schParams_prop;
-
     //Check if not configure or already an Async command being performed
     if ( (!configured) || suspended)
     {
         return EasyLink_Status_Config_Error;
     }
+    if (txPacket->len > EASYLINK_MAX_DATA_LENGTH)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+    //The Tx buffer belongs to the application while it is reserved
+    if (txBufferReserved)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
     //Check and take the busyMutex
     if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
     {
         return EasyLink_Status_Busy_Error;
     }
 
+    memcpy(txBuffer, txPacket->dstAddr, addrSize);
+    memcpy(txBuffer + addrSize, txPacket->payload, txPacket->len);
+
+    //packet length to Tx includes address
+    EasyLink_cmdPropTx.pktLen = txPacket->len + addrSize;
+    EasyLink_cmdPropTx.pPkt = txBuffer;
+
+    return postTxAsync(txPacket->absTime, cb);
+}
+
+#if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+EasyLink_Status EasyLink_transmitCCAAsync(EasyLink_TxPacket *txPacket, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn)
+{
+    //Check if not configure or already an Async command being performed
+    if ( (!configured) || suspended)
+    {
+        return EasyLink_Status_Config_Error;
+    }
     if (txPacket->len > EASYLINK_MAX_DATA_LENGTH)
     {
         return EasyLink_Status_Param_Error;
     }
-
-    //store application callback
-    txCb = cb;
+    //The Tx buffer belongs to the application while it is reserved
+    if (txBufferReserved)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+    //Check and take the busyMutex
+    if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    {
+        return EasyLink_Status_Busy_Error;
+    }
 
     memcpy(txBuffer, txPacket->dstAddr, addrSize);
     memcpy(txBuffer + addrSize, txPacket->payload, txPacket->len);
@@ -936,11 +1240,118 @@ EasyLink_Status EasyLink_transmitAsync(EasyLink_TxPacket *txPacket, EasyLink_TxD
     EasyLink_cmdPropTx.pktLen = txPacket->len + addrSize;
     EasyLink_cmdPropTx.pPkt = txBuffer;
 
-    if (txPacket->absTime != 0)
+    return postCcaTxAsync(txPacket->absTime, cb, grn);
+}
+#endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+
+EasyLink_Status EasyLink_reserveTxBuffer(uint8_t **ppPayload)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (ppPayload == NULL)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    txBufferReserved = true;
+    *ppPayload = txBuffer + EASYLINK_TX_PAYLOAD_OFFSET;
+
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_commitTxBuffer(uint8_t *dstAddr, uint8_t len)
+{
+    if (!txBufferReserved)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (len > EASYLINK_MAX_DATA_LENGTH)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    //Only the address is copied, in front of the payload
+    txCommittedPkt = txBuffer + EASYLINK_TX_PAYLOAD_OFFSET - addrSize;
+    memcpy(txCommittedPkt, dstAddr, addrSize);
+
+    //packet length to Tx includes address
+    txCommittedLen = len + addrSize;
+
+    return EasyLink_Status_Success;
+}
+
+void EasyLink_releaseTxBuffer(void)
+{
+    txBufferReserved = false;
+    txCommittedPkt = NULL;
+    txCommittedLen = 0;
+}
+
+EasyLink_Status EasyLink_transmitCommittedAsync(uint32_t absTime, EasyLink_TxDoneCb cb)
+{
+    //Check if not configure or already an Async command being performed
+    if ( (!configured) || suspended)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (txCommittedPkt == NULL)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+    //Check and take the busyMutex
+    if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    EasyLink_cmdPropTx.pktLen = txCommittedLen;
+    EasyLink_cmdPropTx.pPkt = txCommittedPkt;
+
+    return postTxAsync(absTime, cb);
+}
+
+#if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+EasyLink_Status EasyLink_transmitCommittedCCAAsync(uint32_t absTime, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn)
+{
+    //Check if not configure or already an Async command being performed
+    if ( (!configured) || suspended)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (txCommittedPkt == NULL)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+    //Check and take the busyMutex
+    if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    EasyLink_cmdPropTx.pktLen = txCommittedLen;
+    EasyLink_cmdPropTx.pPkt = txCommittedPkt;
+
+    return postCcaTxAsync(absTime, cb, grn);
+}
+#endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+
+//Posts EasyLink_cmdPropTx, which must already point to the packet. The caller
+//holds the busyMutex, which the callback releases.
+static EasyLink_Status postTxAsync(uint32_t absTime, EasyLink_TxDoneCb cb)
+{
+    EasyLink_Status status = EasyLink_Status_Tx_Error;
+    RF_ScheduleCmdParams schParams_prop;
+
+    //store application callback
+    txCb = cb;
+
+    if (absTime != 0)
     {
         EasyLink_cmdPropTx.startTrigger.triggerType = TRIG_ABSTIME;
         EasyLink_cmdPropTx.startTrigger.pastTrig = 1;
-        EasyLink_cmdPropTx.startTime = txPacket->absTime;
+        EasyLink_cmdPropTx.startTime = absTime;
         /* in case rfMultiMode is used estimate endtime for start time + 1ms */
         schParams_prop.endTime = EasyLink_cmdPropTx.startTime + EasyLink_ms_To_RadioTime(1);
     }
@@ -953,6 +1364,10 @@ EasyLink_Status EasyLink_transmitAsync(EasyLink_TxPacket *txPacket, EasyLink_TxD
         schParams_prop.endTime = RF_getCurrentTime() + EasyLink_ms_To_RadioTime(1);
     }
 
+    // Stop continuous Rx, if running, so the Tx is queued right behind it,
+    // txDoneCallback resumes it
+    rxContinuousSuspend();
+
     // Send packet
     if(rfModeMultiClient)
     {
@@ -977,7 +1392,9 @@ EasyLink_Status EasyLink_transmitAsync(EasyLink_TxPacket *txPacket, EasyLink_TxD
 }
 
 #if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
-EasyLink_Status EasyLink_transmitCCAAsync(EasyLink_TxPacket *txPacket, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn)
+//Posts a carrier sense with EasyLink_cmdPropTx chained behind it, see
+//postTxAsync()
+static EasyLink_Status postCcaTxAsync(uint32_t absTime, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn)
 {
     EasyLink_Status status = EasyLink_Status_Tx_Error;
     RF_ScheduleCmdParams schParams_prop;
@@ -988,43 +1405,25 @@ EasyLink_Status EasyLink_transmitCCAAsync(EasyLink_TxPacket *txPacket, EasyLink_
         grn = (EasyLink_GetRandomNumber)rand;
     }
 
-    //Check if not configure or already an Async command being performed
-    if ( (!configured) || suspended)
-    {
-        return EasyLink_Status_Config_Error;
-    }
-    //Check and take the busyMutex
-    if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
-    {
-        return EasyLink_Status_Busy_Error;
-    }
-    if (txPacket->len > EASYLINK_MAX_DATA_LENGTH)
-    {
-        return EasyLink_Status_Param_Error;
-    }
-
     //store application callback
     txCb = cb;
 
     // store random number generator
     getRN = grn;
 
-    memcpy(txBuffer, txPacket->dstAddr, addrSize);
-    memcpy(txBuffer + addrSize, txPacket->payload, txPacket->len);
+    // Start with the smallest back-off window and the current threshold
+    ccaBackoffExponent = ccaMinBackoffWindow;
+    EasyLink_cmdPropCs.rssiThr = ccaRssiThreshold;
 
     // Set the Carrier Sense command attributes
     // Chain the TX command to run after the CS command
     EasyLink_cmdPropCs.pNextOp        = (rfc_radioOp_t *)&EasyLink_cmdPropTx;
 
-    //packet length to Tx includes address
-    EasyLink_cmdPropTx.pktLen = txPacket->len + addrSize;
-    EasyLink_cmdPropTx.pPkt = txBuffer;
-
-    if (txPacket->absTime != 0)
+    if (absTime != 0)
     {
         EasyLink_cmdPropCs.startTrigger.triggerType = TRIG_ABSTIME;
         EasyLink_cmdPropCs.startTrigger.pastTrig = 1;
-        EasyLink_cmdPropCs.startTime = txPacket->absTime;
+        EasyLink_cmdPropCs.startTime = absTime;
         /* in case rfMultiMode is used estimate endtime for start time + 1ms */
         schParams_prop.endTime = EasyLink_cmdPropCs.startTime + EasyLink_ms_To_RadioTime(1);
     }
@@ -1037,6 +1436,10 @@ EasyLink_Status EasyLink_transmitCCAAsync(EasyLink_TxPacket *txPacket, EasyLink_
         schParams_prop.endTime = RF_getCurrentTime() + EasyLink_ms_To_RadioTime(1);
     }
 
+    // Stop continuous Rx, if running, so the CCA is queued right behind it,
+    // ccaDoneCallback resumes it
+    rxContinuousSuspend();
+
     // Check for a clear channel (CCA) before sending a packet
     if(rfModeMultiClient)
     {
@@ -1073,8 +1476,8 @@ EasyLink_Status EasyLink_receive(EasyLink_RxPacket *rxPacket)
     {
         return EasyLink_Status_Config_Error;
     }
-    //Check and take the busyMutex
-    if (Semaphore_pend(busyMutex, 0) == FALSE)
+    //Check and take the busyMutex, continuous Rx must be aborted first
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) )
     {
         return EasyLink_Status_Busy_Error;
     }
@@ -1087,6 +1490,12 @@ EasyLink_Status EasyLink_receive(EasyLink_RxPacket *rxPacket)
     dataQueue.pLastEntry = NULL;
     EasyLink_cmdPropRxAdv.pQueue = &dataQueue;               /* Set the Data Entity queue for received data */
     EasyLink_cmdPropRxAdv.pOutput = (uint8_t*)&rxStatistics;
+    /* Single packet Rx, the buffer has no room for appended RSSI or timestamp */
+    EasyLink_cmdPropRxAdv.pktConf.bRepeatOk = 0;
+    EasyLink_cmdPropRxAdv.pktConf.bRepeatNok = 0;
+    EasyLink_cmdPropRxAdv.rxConf.bAutoFlushCrcErr = 0;
+    EasyLink_cmdPropRxAdv.rxConf.bAppendRssi = 0;
+    EasyLink_cmdPropRxAdv.rxConf.bAppendTimestamp = 0;
 
     if (rxPacket->absTime != 0)
     {
@@ -1112,7 +1521,8 @@ EasyLink_Status EasyLink_receive(EasyLink_RxPacket *rxPacket)
         EasyLink_cmdPropRxAdv.endTime = 0;
     }
 
-    //Clear the Rx statistics structure
+    //Clear the Rx statistics structure, keeping the error count
+    rxErrorCount += rxStatistics.nRxNok;
     memset(&rxStatistics, 0, sizeof(rfc_propRxOutput_t));
 
     if(rfModeMultiClient)
@@ -1201,7 +1611,8 @@ EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
         return EasyLink_Status_Config_Error;
     }
     //Check and take the busyMutex
-    if ( (Semaphore_pend(busyMutex, 0) == FALSE) || (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) ||
+         (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
     {
         return EasyLink_Status_Busy_Error;
     }
@@ -1216,6 +1627,12 @@ EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
     dataQueue.pLastEntry = NULL;
     EasyLink_cmdPropRxAdv.pQueue = &dataQueue;               /* Set the Data Entity queue for received data */
     EasyLink_cmdPropRxAdv.pOutput = (uint8_t*)&rxStatistics;
+    /* Single packet Rx, the buffer has no room for appended RSSI or timestamp */
+    EasyLink_cmdPropRxAdv.pktConf.bRepeatOk = 0;
+    EasyLink_cmdPropRxAdv.pktConf.bRepeatNok = 0;
+    EasyLink_cmdPropRxAdv.rxConf.bAutoFlushCrcErr = 0;
+    EasyLink_cmdPropRxAdv.rxConf.bAppendRssi = 0;
+    EasyLink_cmdPropRxAdv.rxConf.bAppendTimestamp = 0;
 
     if (absTime != 0)
     {
@@ -1232,9 +1649,10 @@ EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
 
     if (asyncRxTimeOut != 0)
     {
+        //The timeout counts from the Rx start, which may be in the future
         EasyLink_cmdPropRxAdv.endTrigger.triggerType = TRIG_ABSTIME;
         EasyLink_cmdPropRxAdv.endTrigger.pastTrig = 1;
-        EasyLink_cmdPropRxAdv.endTime = RF_getCurrentTime() + asyncRxTimeOut;
+        EasyLink_cmdPropRxAdv.endTime = ((absTime != 0) ? absTime : RF_getCurrentTime()) + asyncRxTimeOut;
     }
     else
     {
@@ -1243,7 +1661,8 @@ EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
         EasyLink_cmdPropRxAdv.endTime = 0;
     }
 
-    //Clear the Rx statistics structure
+    //Clear the Rx statistics structure, keeping the error count
+    rxErrorCount += rxStatistics.nRxNok;
     memset(&rxStatistics, 0, sizeof(rfc_propRxOutput_t));
 
     if(rfModeMultiClient)
@@ -1271,6 +1690,157 @@ EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
     return status;
 }
 
+EasyLink_Status EasyLink_receiveContinuousAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
+{
+    //Check if not configure of already an Async command being performed
+    if ( (!configured) || suspended)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    //The queue is set up again, which the lent entries must not be part of
+    if (rxLoanCount != 0)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+    //Check and take the busyMutex
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) ||
+         (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    rxContinuousCb = cb;
+    rxContinuousLoanCb = NULL;
+
+    return rxContinuousStart(absTime);
+}
+
+EasyLink_Status EasyLink_receiveContinuousLoanAsync(EasyLink_ReceiveLoanCb cb, uint32_t absTime)
+{
+    //Check if not configure of already an Async command being performed
+    if ( (!configured) || suspended)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    //The queue is set up again, which the lent entries must not be part of
+    if (rxLoanCount != 0)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+    //Check and take the busyMutex
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) ||
+         (EasyLink_CmdHandle_isValid(asyncCmdHndl)) )
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    rxContinuousCb = NULL;
+    rxContinuousLoanCb = cb;
+
+    return rxContinuousStart(absTime);
+}
+
+void EasyLink_returnRxLoan(EasyLink_RxLoan *rxLoan)
+{
+    rfc_dataEntryGeneral_t *pDataEntry;
+    UInt key;
+
+    if ( (rxLoan < rxLoans) || (rxLoan >= &rxLoans[EASYLINK_RX_QUEUE_ENTRIES]) ||
+         (rxLoan->payload == NULL) )
+    {
+        return;
+    }
+
+    pDataEntry = (rfc_dataEntryGeneral_t*)
+            &rxContinuousBuffer[(rxLoan - rxLoans) * EASYLINK_RX_CONTINUOUS_ENTRY_SIZE];
+
+    //The Rx callback must not see the entry free before the radio can use it
+    key = Hwi_disable();
+    rxLoan->payload = NULL;
+    rxLoanCount--;
+    pDataEntry->status = DATA_ENTRY_PENDING;
+    Hwi_restore(key);
+}
+
+//Sets up the circular queue and starts continuous Rx, the caller holds the
+//busyMutex
+static EasyLink_Status rxContinuousStart(uint32_t absTime)
+{
+    EasyLink_Status status = EasyLink_Status_Rx_Error;
+    rfc_dataEntryGeneral_t *pDataEntry;
+    uint8_t i;
+
+    //Link the data entries into a circular queue, each entry holds hdr (len-1Byte),
+    //addr (max 8Bytes), data and the appended RSSI and timestamp
+    for (i = 0; i < EASYLINK_RX_QUEUE_ENTRIES; i++)
+    {
+        pDataEntry = (rfc_dataEntryGeneral_t*)
+                &rxContinuousBuffer[i * EASYLINK_RX_CONTINUOUS_ENTRY_SIZE];
+        pDataEntry->pNextEntry = &rxContinuousBuffer[((i + 1) % EASYLINK_RX_QUEUE_ENTRIES) *
+                                                     EASYLINK_RX_CONTINUOUS_ENTRY_SIZE];
+        pDataEntry->config.type = DATA_ENTRY_TYPE_GEN;
+        pDataEntry->config.lenSz = 0;
+        pDataEntry->config.irqIntv = 0;
+        pDataEntry->length = 1 + EASYLINK_MAX_ADDR_SIZE + EASYLINK_MAX_DATA_LENGTH +
+                             EASYLINK_RX_CONTINUOUS_APPENDED_SIZE;
+        pDataEntry->status = DATA_ENTRY_PENDING;
+    }
+    rxContinuousReadEntry = (rfc_dataEntryGeneral_t*)rxContinuousBuffer;
+    dataQueue.pCurrEntry = rxContinuousBuffer;
+    dataQueue.pLastEntry = NULL;
+    EasyLink_cmdPropRxAdv.pQueue = &dataQueue;
+    EasyLink_cmdPropRxAdv.pOutput = (uint8_t*)&rxStatistics;
+
+    //Stay in Rx after each packet, good or bad, and do not let packets with a
+    //CRC error take up an entry. RSSI and timestamp are stored with each packet
+    //because the Rx statistics only hold the latest ones.
+    EasyLink_cmdPropRxAdv.pktConf.bRepeatOk = 1;
+    EasyLink_cmdPropRxAdv.pktConf.bRepeatNok = 1;
+    EasyLink_cmdPropRxAdv.rxConf.bAutoFlushCrcErr = 1;
+    EasyLink_cmdPropRxAdv.rxConf.bAppendRssi = 1;
+    EasyLink_cmdPropRxAdv.rxConf.bAppendTimestamp = 1;
+
+    if (absTime != 0)
+    {
+        EasyLink_cmdPropRxAdv.startTrigger.triggerType = TRIG_ABSTIME;
+        EasyLink_cmdPropRxAdv.startTrigger.pastTrig = 1;
+        EasyLink_cmdPropRxAdv.startTime = absTime;
+    }
+    else
+    {
+        EasyLink_cmdPropRxAdv.startTrigger.triggerType = TRIG_NOW;
+        EasyLink_cmdPropRxAdv.startTrigger.pastTrig = 1;
+        EasyLink_cmdPropRxAdv.startTime = 0;
+    }
+
+    //Runs until aborted, the Async Rx timeout does not apply
+    EasyLink_cmdPropRxAdv.endTrigger.triggerType = TRIG_NEVER;
+    EasyLink_cmdPropRxAdv.endTrigger.pastTrig = 1;
+    EasyLink_cmdPropRxAdv.endTime = 0;
+
+    //Clear the Rx statistics structure, keeping the error count
+    rxErrorCount += rxStatistics.nRxNok;
+    memset(&rxStatistics, 0, sizeof(rfc_propRxOutput_t));
+
+    rxContinuousSuspended = false;
+    rxContinuousActive = true;
+    rxContinuousCmdHndl = rxContinuousPost();
+
+    if (EasyLink_CmdHandle_isValid(rxContinuousCmdHndl))
+    {
+        status = EasyLink_Status_Success;
+    }
+    else
+    {
+        rxContinuousActive = false;
+    }
+
+    //Continuous Rx does not hold the busyMutex so that Tx can interrupt it
+    Semaphore_post(busyMutex);
+
+    return status;
+}
+
 EasyLink_Status EasyLink_abort(void)
 {
     EasyLink_Status status = EasyLink_Status_Cmd_Error;
@@ -1279,6 +1849,27 @@ EasyLink_Status EasyLink_abort(void)
     {
         return EasyLink_Status_Config_Error;
     }
+    //Stop continuous Rx if no other Async command is running
+    if ( (!EasyLink_CmdHandle_isValid(asyncCmdHndl)) && rxContinuousActive )
+    {
+        RF_CmdHandle cmdHndl = rxContinuousCmdHndl;
+
+        //Also cancels the resume after a Tx that is still queued
+        rxContinuousSuspended = false;
+
+        //force abort, the callback may already have run if it was cancelled
+        //immediately, in that case no need to pend
+        if ( EasyLink_CmdHandle_isValid(cmdHndl) &&
+             (RF_cancelCmd(rfHandle, cmdHndl, 0) == RF_StatSuccess) &&
+             EasyLink_CmdHandle_isValid(rxContinuousCmdHndl) )
+        {
+            RF_pendCmd(rfHandle, cmdHndl, (RF_EventLastCmdDone |
+                    RF_EventCmdAborted | RF_EventCmdCancelled | RF_EventCmdStopped));
+        }
+        rxContinuousActive = false;
+
+        return EasyLink_Status_Success;
+    }
     //check an Async command is running, if not return success
     if (!EasyLink_CmdHandle_isValid(asyncCmdHndl))
     {
@@ -1323,7 +1914,8 @@ EasyLink_Status EasyLink_enableRxAddrFilter(uint8_t* pui8AddrFilterTable, uint8_
     {
         return EasyLink_Status_Config_Error;
     }
-    if ( Semaphore_pend(busyMutex, 0) == FALSE )
+    //Continuous Rx must be aborted before the filter can be changed
+    if ( rxContinuousActive || (Semaphore_pend(busyMutex, 0) == FALSE) )
     {
         return EasyLink_Status_Busy_Error;
     }
@@ -1357,6 +1949,7 @@ EasyLink_Status EasyLink_enableRxAddrFilter(uint8_t* pui8AddrFilterTable, uint8_
 EasyLink_Status EasyLink_setCtrl(EasyLink_CtrlOption Ctrl, uint32_t ui32Value)
 {
     EasyLink_Status status = EasyLink_Status_Param_Error;
+    UInt key;
     switch(Ctrl)
     {
         case EasyLink_Ctrl_AddSize:
@@ -1386,6 +1979,41 @@ EasyLink_Status EasyLink_setCtrl(EasyLink_CtrlOption Ctrl, uint32_t ui32Value)
         case EasyLink_Ctrl_Test_Signal:
             status = enableTestMode(EasyLink_Ctrl_Test_Signal);
             break;
+        case EasyLink_Ctrl_Rx_ErrorCount:
+            key = Hwi_disable();
+            rxErrorCount = ui32Value - rxStatistics.nRxNok;
+            Hwi_restore(key);
+            status = EasyLink_Status_Success;
+            break;
+#if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+        case EasyLink_Ctrl_Cca_MinBackoffWindow:
+            if (ui32Value <= ccaMaxBackoffWindow)
+            {
+                ccaMinBackoffWindow = (uint8_t) ui32Value;
+                status = EasyLink_Status_Success;
+            }
+            break;
+        case EasyLink_Ctrl_Cca_MaxBackoffWindow:
+            //getRN only provides 15 random bits
+            if ((ui32Value >= ccaMinBackoffWindow) && (ui32Value <= 15))
+            {
+                ccaMaxBackoffWindow = (uint8_t) ui32Value;
+                status = EasyLink_Status_Success;
+            }
+            break;
+        case EasyLink_Ctrl_Cca_BackoffTimeUnits:
+            ccaBackoffTimeUnits = ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_RssiThreshold:
+            ccaRssiThreshold = (int8_t) ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_BusyCount:
+            ccaBusyCount = ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+#endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
     }
 
     return status;
@@ -1394,6 +2022,7 @@ EasyLink_Status EasyLink_setCtrl(EasyLink_CtrlOption Ctrl, uint32_t ui32Value)
 EasyLink_Status EasyLink_getCtrl(EasyLink_CtrlOption Ctrl, uint32_t* pui32Value)
 {
     EasyLink_Status status = EasyLink_Status_Cmd_Error;
+    UInt key;
 
     switch(Ctrl)
     {
@@ -1418,6 +2047,34 @@ EasyLink_Status EasyLink_getCtrl(EasyLink_CtrlOption Ctrl, uint32_t* pui32Value)
             *pui32Value = 0;
             status = EasyLink_Status_Success;
             break;
+        case EasyLink_Ctrl_Rx_ErrorCount:
+            key = Hwi_disable();
+            *pui32Value = rxErrorCount + rxStatistics.nRxNok;
+            Hwi_restore(key);
+            status = EasyLink_Status_Success;
+            break;
+#if (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
+        case EasyLink_Ctrl_Cca_MinBackoffWindow:
+            *pui32Value = ccaMinBackoffWindow;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_MaxBackoffWindow:
+            *pui32Value = ccaMaxBackoffWindow;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_BackoffTimeUnits:
+            *pui32Value = ccaBackoffTimeUnits;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_RssiThreshold:
+            *pui32Value = (uint32_t)(int32_t) ccaRssiThreshold;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_BusyCount:
+            *pui32Value = ccaBusyCount;
+            status = EasyLink_Status_Success;
+            break;
+#endif // (defined(DeviceFamily_CC13X0) || defined(DeviceFamily_CC13X2))
     }
 
     return status;
@@ -47,6 +47,7 @@
 #include <ti/drivers/PIN.h>
 #include <ti/drivers/UART.h>
 #include <ti/drivers/SPI.h>
+#include <ti/drivers/NVS.h>
 
 /* Board Header files */
 #include "Board.h"
@@ -55,6 +56,10 @@
 #include "ConcentratorRadioTask.h"
 #include "ConcentratorTask.h"
 
+#ifdef CONCENTRATOR_LOADGEN
+#include "LoadGenerator.h"
+#endif
+
 /*
  *  ======== main ========
  */
@@ -68,10 +73,18 @@ int main(void)
     UART_init();
     SPI_init();
 
+    /* Internal flash for the join table */
+    NVS_init();
+
     /* Initialize concentrator tasks */
     ConcentratorRadioTask_init();
     ConcentratorTask_init();
 
+#ifdef CONCENTRATOR_LOADGEN
+    /* Synthetic traffic instead of real nodes, see LoadGenerator.h */
+    LoadGenerator_init();
+#endif
+
     /* Start BIOS */
     BIOS_start();
 
@@ -0,0 +1,23 @@
+/*
+ *  ======== HostBoard.c ========
+ *
+ *  Host build: the board functions of CC1310_LAUNCHXL.c and CC1350_LAUNCHXL.c,
+ *  the shim drivers need no setup.
+ */
+
+/***** Function definitions *****/
+void CC1310_LAUNCHXL_initGeneral(void)
+{
+}
+
+void CC1350_LAUNCHXL_initGeneral(void)
+{
+}
+
+void CC1310_LAUNCHXL_shutDownExtFlash(void)
+{
+}
+
+void CC1350_LAUNCHXL_shutDownExtFlash(void)
+{
+}
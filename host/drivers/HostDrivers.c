@@ -0,0 +1,588 @@
+/*
+ *  ======== HostDrivers.c ========
+ *
+ *  POSIX implementation of the TI drivers and driverlib functions the
+ *  application uses, see the shim headers for what each one does.
+ */
+
+/***** Includes *****/
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <x86intrin.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/drivers/PIN.h>
+#include <ti/drivers/NVS.h>
+#include <ti/drivers/UART.h>
+#include <ti/display/Display.h>
+#include <ti/devices/cc13x0/driverlib/aon_batmon.h>
+#include <ti/devices/cc13x0/driverlib/trng.h>
+#include <ti/devices/cc13x0/inc/hw_types.h>
+#include <ti/devices/cc13x0/inc/hw_memmap.h>
+#include <ti/devices/cc13x0/inc/hw_cpu_dwt.h>
+
+#include "HostKernel.h"
+
+
+/***** Defines *****/
+#define HOST_PIN_COUNT          32
+
+/* How long a button pressed with a signal is held down */
+#define HOST_BUTTON_PRESS_MS    100
+
+/* Same layout as the internal flash region of the board files */
+#define HOST_NVS_SECTOR_SIZE    0x1000
+#define HOST_NVS_REGION_SIZE    (4 * HOST_NVS_SECTOR_SIZE)
+
+/* Start, 8 data bits and stop bit */
+#define HOST_UART_BITS_PER_BYTE 10
+
+/* 3.3 V in the 8.8 format of the battery monitor */
+#define HOST_BATTERY_VOLTAGE    ((3 << 8) | 0x4D)
+
+#define HOST_REGISTER_COUNT     16
+
+
+/***** Type declarations *****/
+struct NVS_Config_s {
+    uint8_t flash[HOST_NVS_REGION_SIZE];
+    FILE* file;
+    uint8_t initialized;
+    uint8_t open;
+};
+
+struct UART_Config_s {
+    FILE* file;
+    UART_Params params;
+    HostTimer writeDone;
+    const void* buffer;
+    size_t size;
+    uint8_t open;
+};
+
+struct Display_Config_s {
+    FILE* file;
+    uint32_t type;
+};
+
+struct HostRegister {
+    uint32_t address;
+    uint32_t value;
+};
+
+
+/***** Variable declarations *****/
+static uint8_t pinValues[HOST_PIN_COUNT];
+static PIN_State* pinStates;
+static HostTimer buttonPoll;
+static HostTimer buttonReleases[HOST_PIN_COUNT];
+static volatile sig_atomic_t buttonsSignalled;
+
+static struct NVS_Config_s nvsConfig;
+static struct UART_Config_s uartConfig;
+static struct Display_Config_s displayConfigs[2];
+
+static struct HostRegister registers[HOST_REGISTER_COUNT];
+static uint8_t registerCount;
+
+
+/***** Prototypes *****/
+static void signalButton(int signal);
+static void buttonTimeout(uintptr_t arg);
+static void releaseButton(uintptr_t arg);
+static void uartWriteDone(uintptr_t arg);
+
+
+/***** Function definitions *****/
+/*
+ *  ======== PIN ========
+ */
+PIN_Handle PIN_open(PIN_State* state, const PIN_Config pinList[])
+{
+    PIN_Id id;
+    uint8_t i;
+
+    memset(state, 0, sizeof(PIN_State));
+
+    for (i = 0; (pinList[i] != PIN_TERMINATE) && (i < PIN_MAX_CONFIGS); i++)
+    {
+        id = PIN_ID(pinList[i]);
+        if (id >= HOST_PIN_COUNT)
+        {
+            continue;
+        }
+
+        state->configs[state->count++] = pinList[i];
+        if (pinList[i] & PIN_GPIO_OUTPUT_EN)
+        {
+            pinValues[id] = (pinList[i] & PIN_GPIO_HIGH) ? 1 : 0;
+        }
+        else
+        {
+            pinValues[id] = 1;
+        }
+    }
+
+    state->next = pinStates;
+    pinStates = state;
+
+    /* The first input with an interrupt gets SIGUSR1, the second SIGUSR2 */
+    signal(SIGUSR1, signalButton);
+    signal(SIGUSR2, signalButton);
+
+    return state;
+}
+
+void PIN_close(PIN_Handle handle)
+{
+    PIN_State** link = &pinStates;
+
+    while (*link != NULL)
+    {
+        if (*link == handle)
+        {
+            *link = handle->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+}
+
+PIN_Status PIN_registerIntCb(PIN_Handle handle, PIN_IntCb callback)
+{
+    handle->callback = callback;
+
+    /* Signals are only looked at from a timer, the handler can not take the
+     * CPU lock */
+    if (!buttonPoll.active)
+    {
+        HostKernel_startTimer(&buttonPoll, HostKernel_now() + HOST_BUTTON_PRESS_MS * 1000, buttonTimeout, 0);
+    }
+
+    return PIN_SUCCESS;
+}
+
+uint32_t PIN_getInputValue(PIN_Id pinId)
+{
+    return (pinId < HOST_PIN_COUNT) ? pinValues[pinId] : 0;
+}
+
+uint32_t PIN_getOutputValue(PIN_Id pinId)
+{
+    return (pinId < HOST_PIN_COUNT) ? pinValues[pinId] : 0;
+}
+
+PIN_Status PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t value)
+{
+    if (pinId < HOST_PIN_COUNT)
+    {
+        pinValues[pinId] = (value != 0);
+    }
+
+    return PIN_SUCCESS;
+}
+
+static void signalButton(int signal)
+{
+    buttonsSignalled |= (signal == SIGUSR1) ? 1 : 2;
+}
+
+/* Polls the button signals every press length */
+static void buttonTimeout(uintptr_t arg)
+{
+    PIN_State* state;
+    uint8_t button = 0;
+    uint8_t i;
+    PIN_Id id;
+
+    HostKernel_startTimer(&buttonPoll, HostKernel_now() + HOST_BUTTON_PRESS_MS * 1000, buttonTimeout, 0);
+
+    for (state = pinStates; state != NULL; state = state->next)
+    {
+        for (i = 0; (i < state->count) && (state->callback != NULL); i++)
+        {
+            if (!(state->configs[i] & PIN_IRQ_NEGEDGE))
+            {
+                continue;
+            }
+
+            id = PIN_ID(state->configs[i]);
+            button++;
+            if (buttonsSignalled & button)
+            {
+                buttonsSignalled &= ~button;
+                pinValues[id] = 0;
+                HostKernel_startTimer(&buttonReleases[id], HostKernel_now() + HOST_BUTTON_PRESS_MS * 1000,
+                                      releaseButton, id);
+                state->callback(state, id);
+            }
+        }
+    }
+}
+
+static void releaseButton(uintptr_t arg)
+{
+    pinValues[arg] = 1;
+}
+
+/*
+ *  ======== NVS ========
+ */
+void NVS_init(void)
+{
+}
+
+void NVS_Params_init(NVS_Params* params)
+{
+    params->unused = 0;
+}
+
+NVS_Handle NVS_open(uint_least8_t index, NVS_Params* params)
+{
+    const char* fileName = HostKernel_getEnv("HOST_NVS", NULL);
+
+    /* Only the internal flash */
+    if ((index != 0) || nvsConfig.open)
+    {
+        return NULL;
+    }
+
+    /* Without a file the flash keeps its contents in RAM between opens */
+    if (!nvsConfig.initialized)
+    {
+        memset(nvsConfig.flash, 0xFF, sizeof(nvsConfig.flash));
+        nvsConfig.initialized = 1;
+    }
+
+    nvsConfig.file = NULL;
+    if (fileName != NULL)
+    {
+        nvsConfig.file = fopen(fileName, "r+b");
+        if (nvsConfig.file == NULL)
+        {
+            nvsConfig.file = fopen(fileName, "w+b");
+        }
+        if (nvsConfig.file != NULL)
+        {
+            fread(nvsConfig.flash, 1, sizeof(nvsConfig.flash), nvsConfig.file);
+        }
+    }
+
+    nvsConfig.open = 1;
+    return &nvsConfig;
+}
+
+void NVS_close(NVS_Handle handle)
+{
+    if (handle->file != NULL)
+    {
+        fclose(handle->file);
+        handle->file = NULL;
+    }
+    handle->open = 0;
+}
+
+void NVS_getAttrs(NVS_Handle handle, NVS_Attrs* attrs)
+{
+    attrs->regionBase = handle->flash;
+    attrs->regionSize = HOST_NVS_REGION_SIZE;
+    attrs->sectorSize = HOST_NVS_SECTOR_SIZE;
+}
+
+int_fast16_t NVS_read(NVS_Handle handle, size_t offset, void* buffer, size_t bufferSize)
+{
+    if ((offset + bufferSize) > HOST_NVS_REGION_SIZE)
+    {
+        return NVS_STATUS_INV_OFFSET;
+    }
+
+    memcpy(buffer, &handle->flash[offset], bufferSize);
+    return NVS_STATUS_SUCCESS;
+}
+
+/* Keeps the file in step with the flash */
+static void nvsSync(NVS_Handle handle, size_t offset, size_t size)
+{
+    if (handle->file != NULL)
+    {
+        fseek(handle->file, offset, SEEK_SET);
+        fwrite(&handle->flash[offset], 1, size, handle->file);
+        fflush(handle->file);
+    }
+}
+
+int_fast16_t NVS_write(NVS_Handle handle, size_t offset, void* buffer, size_t bufferSize, uint_fast16_t flags)
+{
+    const uint8_t* data = (const uint8_t*)buffer;
+    size_t i;
+
+    if ((offset + bufferSize) > HOST_NVS_REGION_SIZE)
+    {
+        return NVS_STATUS_INV_OFFSET;
+    }
+
+    if (flags & NVS_WRITE_ERASE)
+    {
+        NVS_erase(handle, offset & ~(HOST_NVS_SECTOR_SIZE - 1),
+                  ((offset + bufferSize + HOST_NVS_SECTOR_SIZE - 1) & ~(HOST_NVS_SECTOR_SIZE - 1)) -
+                  (offset & ~(HOST_NVS_SECTOR_SIZE - 1)));
+    }
+
+    if (flags & NVS_WRITE_PRE_VERIFY)
+    {
+        for (i = 0; i < bufferSize; i++)
+        {
+            if ((handle->flash[offset + i] & data[i]) != data[i])
+            {
+                return NVS_STATUS_INV_WRITE;
+            }
+        }
+    }
+
+    /* Programming can only clear bits */
+    for (i = 0; i < bufferSize; i++)
+    {
+        handle->flash[offset + i] &= data[i];
+    }
+    nvsSync(handle, offset, bufferSize);
+
+    if ((flags & NVS_WRITE_POST_VERIFY) && (memcmp(&handle->flash[offset], data, bufferSize) != 0))
+    {
+        return NVS_STATUS_ERROR;
+    }
+
+    return NVS_STATUS_SUCCESS;
+}
+
+int_fast16_t NVS_erase(NVS_Handle handle, size_t offset, size_t size)
+{
+    if (((offset % HOST_NVS_SECTOR_SIZE) != 0) || ((size % HOST_NVS_SECTOR_SIZE) != 0) ||
+        ((offset + size) > HOST_NVS_REGION_SIZE))
+    {
+        return NVS_STATUS_INV_OFFSET;
+    }
+
+    memset(&handle->flash[offset], 0xFF, size);
+    nvsSync(handle, offset, size);
+
+    return NVS_STATUS_SUCCESS;
+}
+
+/*
+ *  ======== UART ========
+ */
+void UART_init(void)
+{
+}
+
+void UART_Params_init(UART_Params* params)
+{
+    memset(params, 0, sizeof(UART_Params));
+    params->readMode = UART_MODE_BLOCKING;
+    params->writeMode = UART_MODE_BLOCKING;
+    params->readTimeout = ~0u;
+    params->writeTimeout = ~0u;
+    params->readDataMode = UART_DATA_TEXT;
+    params->writeDataMode = UART_DATA_TEXT;
+    params->readEcho = UART_ECHO_ON;
+    params->baudRate = 115200;
+}
+
+UART_Handle UART_open(uint_least8_t index, UART_Params* params)
+{
+    const char* fileName = HostKernel_getEnv("HOST_UART", NULL);
+
+    if ((index != 0) || uartConfig.open || (fileName == NULL))
+    {
+        return NULL;
+    }
+
+    uartConfig.file = (strcmp(fileName, "-") == 0) ? stdout : fopen(fileName, "wb");
+    if (uartConfig.file == NULL)
+    {
+        return NULL;
+    }
+
+    uartConfig.params = *params;
+    uartConfig.open = 1;
+    return &uartConfig;
+}
+
+void UART_close(UART_Handle handle)
+{
+    HostKernel_stopTimer(&handle->writeDone);
+    if (handle->file != stdout)
+    {
+        fclose(handle->file);
+    }
+    handle->open = 0;
+}
+
+int_fast32_t UART_write(UART_Handle handle, const void* buffer, size_t size)
+{
+    uint64_t durationUs = ((uint64_t)size * HOST_UART_BITS_PER_BYTE * 1000000) / handle->params.baudRate;
+
+    if (handle->params.writeMode == UART_MODE_BLOCKING)
+    {
+        fwrite(buffer, 1, size, handle->file);
+        fflush(handle->file);
+        return size;
+    }
+
+    /* One write at a time, as on the target */
+    if (handle->writeDone.active)
+    {
+        return UART_ERROR;
+    }
+
+    handle->buffer = buffer;
+    handle->size = size;
+    HostKernel_startTimer(&handle->writeDone, HostKernel_now() + durationUs, uartWriteDone, (uintptr_t)handle);
+
+    return 0;
+}
+
+/* The bytes go out once they have taken their time on the line */
+static void uartWriteDone(uintptr_t arg)
+{
+    UART_Handle handle = (UART_Handle)arg;
+
+    fwrite(handle->buffer, 1, handle->size, handle->file);
+    fflush(handle->file);
+
+    if (handle->params.writeCallback != NULL)
+    {
+        handle->params.writeCallback(handle, (void*)handle->buffer, handle->size);
+    }
+}
+
+/*
+ *  ======== Display ========
+ */
+void Display_init(void)
+{
+}
+
+void Display_Params_init(Display_Params* params)
+{
+    params->lineClearMode = DISPLAY_CLEAR_NONE;
+}
+
+Display_Handle Display_open(uint32_t id, Display_Params* params)
+{
+    static FILE* file;
+    const char* fileName = HostKernel_getEnv("HOST_DISPLAY", NULL);
+    Display_Handle handle;
+
+    if ((fileName == NULL) || ((id != Display_Type_LCD) && (id != Display_Type_UART)))
+    {
+        return NULL;
+    }
+
+    /* Both displays share the file */
+    if (file == NULL)
+    {
+        file = (strcmp(fileName, "-") == 0) ? stdout : fopen(fileName, "w");
+        if (file == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    handle = &displayConfigs[id - Display_Type_LCD];
+    handle->file = file;
+    handle->type = id;
+    return handle;
+}
+
+void Display_close(Display_Handle handle)
+{
+}
+
+void Display_clear(Display_Handle handle)
+{
+    if (handle != NULL)
+    {
+        fprintf(handle->file, "%s: clear\n", (handle->type == Display_Type_LCD) ? "LCD" : "UART");
+        fflush(handle->file);
+    }
+}
+
+void Display_printf(Display_Handle handle, uint8_t line, uint8_t column, const char* fmt, ...)
+{
+    va_list args;
+
+    if (handle == NULL)
+    {
+        return;
+    }
+
+    fprintf(handle->file, "%s %u.%u: ", (handle->type == Display_Type_LCD) ? "LCD" : "UART", line, column);
+    va_start(args, fmt);
+    vfprintf(handle->file, fmt, args);
+    va_end(args);
+    fputc('\n', handle->file);
+    fflush(handle->file);
+}
+
+/*
+ *  ======== driverlib ========
+ */
+uint32_t AONBatMonBatteryVoltageGet(void)
+{
+    return HOST_BATTERY_VOLTAGE;
+}
+
+uint32_t TRNGNumberGet(uint32_t word)
+{
+    static int randomFile = -1;
+    uint32_t number = 0;
+
+    if (randomFile < 0)
+    {
+        randomFile = open("/dev/urandom", O_RDONLY);
+    }
+    if ((randomFile < 0) || (read(randomFile, &number, sizeof(number)) != sizeof(number)))
+    {
+        number = (uint32_t)rand();
+    }
+
+    return number;
+}
+
+volatile uint32_t* HostHw_register(uint32_t address)
+{
+    uint8_t i;
+
+    /* The DWT cycle counter counts host cycles */
+    if (address == (CPU_DWT_BASE + CPU_DWT_O_CYCCNT))
+    {
+        static uint32_t cycles;
+
+        cycles = (uint32_t)__rdtsc();
+        return &cycles;
+    }
+
+    for (i = 0; i < registerCount; i++)
+    {
+        if (registers[i].address == address)
+        {
+            return &registers[i].value;
+        }
+    }
+
+    if (registerCount == HOST_REGISTER_COUNT)
+    {
+        System_abort("HostHw_register: too many registers");
+    }
+    registers[registerCount].address = address;
+    registers[registerCount].value = 0;
+
+    return &registers[registerCount++].value;
+}
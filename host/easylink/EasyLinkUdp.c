@@ -0,0 +1,1250 @@
+/*
+ *  ======== EasyLinkUdp.c ========
+ *
+ *  Host build: the EasyLink API of easylink/EasyLink.h over UDP on the
+ *  loopback interface, so a concentrator and its nodes can run as separate
+ *  processes on one machine.
+ *
+ *  Every radio binds HOST_RADIO_PORT_BASE + HOST_RADIO_ID and sends each
+ *  frame to all other ports of the HOST_RADIO_COUNT radios when the frame
+ *  starts, with its frequency and the simulated time it starts and ends at
+ *  from its length at 50 kbps. A receiver keeps the frames on air to sense
+ *  the channel and to find collisions: frames on the same frequency that
+ *  overlap in time are both lost. A frame is received at its end if the
+ *  radio has been in Rx on its frequency since before the end of its
+ *  preamble, and passes the address filter. Lost frames, collided or dropped with the probability
+ *  HOST_RADIO_LOSS (percent), count as Rx errors.
+ *
+ *  Environment variables:
+ *   HOST_RADIO_ID         Radio of this process, 0 to HOST_RADIO_COUNT - 1, default 0
+ *   HOST_RADIO_COUNT      Number of radios, default 16
+ *   HOST_RADIO_PORT_BASE  UDP port of radio 0, default 47000
+ *   HOST_RADIO_LOSS       Percent of frames lost on top of collisions, default 0
+ *   HOST_IEEE_ADDR        IEEE address, 16 hex digits, default 00124B00000000 and the id
+ *   HOST_RADIO_TRACE      Set to 1 to print every frame sent and heard to stderr
+ *   HOST_RADIO_STATS      Set to 1 to print the Tx and Rx time to stderr at the exit
+ */
+
+/***** Includes *****/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <x86intrin.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Semaphore.h>
+
+#include "easylink/EasyLink.h"
+#include "HostKernel.h"
+
+
+/***** Defines *****/
+#define HOST_RADIO_MAGIC            0x454C5544
+
+#define HOST_RADIO_DEFAULT_COUNT    16
+#define HOST_RADIO_DEFAULT_PORT     47000
+#define HOST_RADIO_DEFAULT_FREQUENCY 868000000
+
+/* 50 kbps, 4 preamble and 4 sync word bytes, length byte and CRC as in the
+ * radio settings of the projects */
+#define HOST_RADIO_BIT_TIME_US      20
+#define HOST_RADIO_PREAMBLE_BYTES   4
+#define HOST_RADIO_SYNC_BYTES       4
+#define HOST_RADIO_OVERHEAD_BYTES   (HOST_RADIO_PREAMBLE_BYTES + HOST_RADIO_SYNC_BYTES + 1 + 2)
+
+/* The receiver has to be on before the preamble ends to find the sync word,
+ * and knows a frame is coming once the sync word is through */
+#define HOST_RADIO_PREAMBLE_US      (HOST_RADIO_PREAMBLE_BYTES * 8 * HOST_RADIO_BIT_TIME_US)
+#define HOST_RADIO_SYNC_END_US      ((HOST_RADIO_PREAMBLE_BYTES + HOST_RADIO_SYNC_BYTES) * 8 * HOST_RADIO_BIT_TIME_US)
+
+#define HOST_RADIO_NOISE_FLOOR_DBM  (-110)
+
+/* Frames kept to sense the channel and find collisions with */
+#define HOST_RADIO_AIR_FRAMES       64
+
+/* How long a frame is kept after it ended */
+#define HOST_RADIO_AIR_KEEP_US      100000
+
+#define HOST_RADIO_PKT_SIZE         (EASYLINK_MAX_ADDR_SIZE + EASYLINK_MAX_DATA_LENGTH)
+
+
+/***** Type declarations *****/
+/* What goes into a datagram, the packet follows the header */
+struct HostRadioHeader {
+    uint32_t magic;
+    uint32_t frequency;
+    uint64_t startUs;
+    uint64_t endUs;
+    uint16_t source;
+    uint8_t pktLen;
+} __attribute__((packed));
+
+struct HostRadioFrame {
+    struct HostRadioHeader header;
+    uint8_t pkt[HOST_RADIO_PKT_SIZE];
+    HostTimer end;
+    uint8_t used;
+    uint8_t lost;
+};
+
+enum TxState {
+    TxState_Idle,
+    TxState_Waiting,           /* For the start time or the end of a back-off */
+    TxState_Sending,
+};
+
+struct RxEntry {
+    uint8_t pkt[HOST_RADIO_PKT_SIZE];
+    uint8_t pktLen;
+    int8_t rssi;
+    uint32_t absTime;
+};
+
+
+/***** Variable declarations *****/
+static uint8_t configured;
+static uint16_t radioId;
+static uint16_t radioCount;
+static uint16_t portBase;
+static uint32_t lossPercent;
+static uint32_t trace;
+static int radioSocket = -1;
+static pthread_t receiveThread;
+
+static uint32_t frequency = HOST_RADIO_DEFAULT_FREQUENCY;
+static int8_t rfPower = 14;
+static uint8_t addrSize = 1;
+static uint8_t addrFilterTable[EASYLINK_MAX_ADDR_FILTERS * EASYLINK_MAX_ADDR_SIZE];
+static uint8_t addrFilterCount;
+static uint32_t asyncRxTimeOut;
+
+/* Set while a Tx or single Rx runs, as the busyMutex of EasyLink.c */
+static uint8_t busy;
+
+/* The receiver hears frames whose preamble ends at or after this time */
+static uint64_t listeningSinceUs;
+
+static struct HostRadioFrame airFrames[HOST_RADIO_AIR_FRAMES];
+
+/* Tx */
+static uint8_t txBuffer[HOST_RADIO_PKT_SIZE];
+static uint8_t txBufferReserved;
+static uint8_t txCommittedLen;
+static enum TxState txState;
+static HostTimer txTimer;
+static EasyLink_TxDoneCb txCb;
+static EasyLink_GetRandomNumber getRN;
+static uint8_t txCca;
+static uint8_t ccaMinBackoffWindow = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
+static uint8_t ccaMaxBackoffWindow = EASYLINK_MAX_CCA_BACKOFF_WINDOW;
+static uint32_t ccaBackoffTimeUnits = EASYLINK_CCA_BACKOFF_TIMEUNITS;
+static int8_t ccaRssiThreshold = EASYLINK_CS_RSSI_THRESHOLD_DBM;
+static uint8_t ccaBackoffExponent;
+static uint32_t ccaBusyCount;
+
+/* Single Rx */
+static uint8_t rxSingleActive;
+static uint64_t rxSingleEndUs;
+static HostTimer rxTimer;
+static EasyLink_ReceiveCb rxCb;
+
+/* Continuous Rx */
+static uint8_t rxContinuousActive;
+static uint8_t rxContinuousSuspended;
+static EasyLink_ReceiveCb rxContinuousCb;
+static EasyLink_ReceiveLoanCb rxContinuousLoanCb;
+static struct RxEntry rxEntries[EASYLINK_RX_QUEUE_ENTRIES];
+static EasyLink_RxLoan rxLoans[EASYLINK_RX_QUEUE_ENTRIES];
+static uint8_t rxLoanCount;
+static uint8_t rxWriteEntry;
+
+/* CRC errors over all Rx commands, EasyLink_Ctrl_Rx_ErrorCount */
+static uint32_t rxErrorCount;
+
+struct HostRadioRxCycles hostRadioRxCycles;
+
+/* End of the last frame received since the Rx was last armed, 0 if none */
+static uint64_t rxEndUs;
+struct HostRadioRxBlind hostRadioRxBlind;
+
+/* Start of the Rx running now, 0 if none */
+static uint64_t rxOnSinceUs;
+struct HostRadioOnTime hostRadioOnTime;
+
+/* Blocking calls */
+static Semaphore_Struct blockingSem;
+static EasyLink_Status blockingStatus;
+static EasyLink_RxPacket* blockingRxPacket;
+
+
+/***** Prototypes *****/
+static void* receiveThreadFunction(void* arg);
+static void frameEnd(uintptr_t arg);
+static void txTimeout(uintptr_t arg);
+static void rxTimeout(uintptr_t arg);
+static uint64_t radioTimeToUs(uint32_t absTime);
+static uint8_t isListening(void);
+static uint8_t isChannelBusy(int8_t* pRssi);
+static int8_t frameRssi(const struct HostRadioFrame* frame);
+static void sendFrame(uint64_t startUs, uint64_t endUs);
+static EasyLink_Status postTx(uint32_t absTime, EasyLink_TxDoneCb cb, uint8_t cca, EasyLink_GetRandomNumber grn);
+static void rxContinuousSuspend(void);
+static void rxContinuousResume(void);
+static void rxArmed(uint64_t startUs);
+static void rxStopped(void);
+static void printStats(void);
+static EasyLink_Status rxContinuousStart(uint32_t absTime);
+static void blockingTxDone(EasyLink_Status status);
+static void blockingRxDone(EasyLink_RxPacket* rxPacket, EasyLink_Status status);
+
+
+/***** Function definitions *****/
+void EasyLink_Params_init(EasyLink_Params* params)
+{
+    params->ui32ModType = EasyLink_Phy_50kbps2gfsk;
+    params->pClientEventCb = NULL;
+    params->nClientEventMask = 0;
+}
+
+EasyLink_Status EasyLink_init(EasyLink_PhyType ui32ModType)
+{
+    struct sockaddr_in address;
+
+    if (configured)
+    {
+        return EasyLink_Status_Success;
+    }
+
+    radioId = HostKernel_getEnvInt("HOST_RADIO_ID", 0);
+    radioCount = HostKernel_getEnvInt("HOST_RADIO_COUNT", HOST_RADIO_DEFAULT_COUNT);
+    portBase = HostKernel_getEnvInt("HOST_RADIO_PORT_BASE", HOST_RADIO_DEFAULT_PORT);
+    lossPercent = HostKernel_getEnvInt("HOST_RADIO_LOSS", 0);
+    trace = HostKernel_getEnvInt("HOST_RADIO_TRACE", 0);
+    if (HostKernel_getEnvInt("HOST_RADIO_STATS", 0))
+    {
+        atexit(printStats);
+    }
+
+    radioSocket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (radioSocket < 0)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(portBase + radioId);
+    if (bind(radioSocket, (struct sockaddr*)&address, sizeof(address)) != 0)
+    {
+        fprintf(stderr, "EasyLink: radio %u can not bind UDP port %u\n", radioId, portBase + radioId);
+        close(radioSocket);
+        radioSocket = -1;
+        return EasyLink_Status_Config_Error;
+    }
+
+    Semaphore_construct(&blockingSem, 0, NULL);
+
+    if (pthread_create(&receiveThread, NULL, receiveThreadFunction, NULL) != 0)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    configured = 1;
+    return EasyLink_Status_Success;
+}
+
+uint32_t EasyLink_getAbsTime(void)
+{
+    return RF_getCurrentTime();
+}
+
+EasyLink_Status EasyLink_setFrequency(uint32_t ui32Freq)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    /* Continuous Rx carries on at the new frequency, but nothing that started
+     * before the retune is heard */
+    frequency = ui32Freq;
+    if (listeningSinceUs < HostKernel_now())
+    {
+        listeningSinceUs = HostKernel_now();
+    }
+
+    return EasyLink_Status_Success;
+}
+
+uint32_t EasyLink_getFrequency(void)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    return frequency;
+}
+
+EasyLink_Status EasyLink_getRssi(int8_t* pRssi)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    /* Only valid while the receiver is on */
+    if (!isListening())
+    {
+        return EasyLink_Status_Rx_Error;
+    }
+
+    isChannelBusy(pRssi);
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_setRfPwr(int8_t i8Power)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    rfPower = i8Power;
+    return EasyLink_Status_Success;
+}
+
+int8_t EasyLink_getRfPwr(void)
+{
+    return rfPower;
+}
+
+EasyLink_Status EasyLink_reserveTxBuffer(uint8_t** ppPayload)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (ppPayload == NULL)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    txBufferReserved = 1;
+    *ppPayload = txBuffer + EASYLINK_MAX_ADDR_SIZE;
+
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_commitTxBuffer(uint8_t* dstAddr, uint8_t len)
+{
+    if (!txBufferReserved)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (len > EASYLINK_MAX_DATA_LENGTH)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    /* Only the address is copied, in front of the payload */
+    memcpy(txBuffer + EASYLINK_MAX_ADDR_SIZE - addrSize, dstAddr, addrSize);
+    txCommittedLen = len + addrSize;
+
+    return EasyLink_Status_Success;
+}
+
+void EasyLink_releaseTxBuffer(void)
+{
+    txBufferReserved = 0;
+    txCommittedLen = 0;
+}
+
+EasyLink_Status EasyLink_transmitCommittedAsync(uint32_t absTime, EasyLink_TxDoneCb cb)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (txCommittedLen == 0)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+    if (busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    return postTx(absTime, cb, 0, NULL);
+}
+
+EasyLink_Status EasyLink_transmitCommittedCCAAsync(uint32_t absTime, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (txCommittedLen == 0)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+    if (busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    return postTx(absTime, cb, 1, grn);
+}
+
+/* The packet is copied into the Tx buffer, which then holds it as committed */
+static EasyLink_Status commitPacket(EasyLink_TxPacket* txPacket)
+{
+    if (txPacket->len > EASYLINK_MAX_DATA_LENGTH)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    memcpy(txBuffer + EASYLINK_MAX_ADDR_SIZE - addrSize, txPacket->dstAddr, addrSize);
+    memcpy(txBuffer + EASYLINK_MAX_ADDR_SIZE, txPacket->payload, txPacket->len);
+    txCommittedLen = txPacket->len + addrSize;
+
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_transmitAsync(EasyLink_TxPacket* txPacket, EasyLink_TxDoneCb cb)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+    if (commitPacket(txPacket) != EasyLink_Status_Success)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    return postTx(txPacket->absTime, cb, 0, NULL);
+}
+
+EasyLink_Status EasyLink_transmitCCAAsync(EasyLink_TxPacket* txPacket, EasyLink_TxDoneCb cb, EasyLink_GetRandomNumber grn)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+    if (commitPacket(txPacket) != EasyLink_Status_Success)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    return postTx(txPacket->absTime, cb, 1, grn);
+}
+
+EasyLink_Status EasyLink_transmit(EasyLink_TxPacket* txPacket)
+{
+    EasyLink_Status status = EasyLink_transmitAsync(txPacket, blockingTxDone);
+
+    if (status != EasyLink_Status_Success)
+    {
+        return status;
+    }
+
+    Semaphore_pend(&blockingSem, BIOS_WAIT_FOREVER);
+    return blockingStatus;
+}
+
+static void blockingTxDone(EasyLink_Status status)
+{
+    blockingStatus = status;
+    Semaphore_post(&blockingSem);
+}
+
+/* Starts a Tx, with or without CCA, the caller has checked that the radio is
+ * not busy */
+static EasyLink_Status postTx(uint32_t absTime, EasyLink_TxDoneCb cb, uint8_t cca, EasyLink_GetRandomNumber grn)
+{
+    uint64_t startUs = (absTime != 0) ? radioTimeToUs(absTime) : HostKernel_now();
+
+    busy = 1;
+    txCb = cb;
+    txCca = cca;
+    getRN = (grn != NULL) ? grn : (EasyLink_GetRandomNumber)rand;
+    ccaBackoffExponent = ccaMinBackoffWindow;
+
+    /* As on the target, continuous Rx stops until the Tx is done */
+    rxContinuousSuspend();
+
+    txState = TxState_Waiting;
+    HostKernel_startTimer(&txTimer, startUs, txTimeout, 0);
+
+    return EasyLink_Status_Success;
+}
+
+/* Runs at the Tx start time, after a back-off and at the end of the frame */
+static void txTimeout(uintptr_t arg)
+{
+    uint64_t now = HostKernel_now();
+    uint64_t endUs;
+    uint32_t backOffUs;
+    EasyLink_Status status = EasyLink_Status_Success;
+    int8_t rssi;
+
+    if (txState == TxState_Waiting)
+    {
+        if (txCca && isChannelBusy(&rssi))
+        {
+            ccaBusyCount++;
+            if (ccaBackoffExponent <= ccaMaxBackoffWindow)
+            {
+                /* Same back-off as EasyLink.c, a random number of time units
+                 * in a window that doubles each time */
+                backOffUs = (getRN() & ((1 << ccaBackoffExponent++) - 1)) * ccaBackoffTimeUnits;
+                HostKernel_startTimer(&txTimer, now + backOffUs, txTimeout, 0);
+                return;
+            }
+            status = EasyLink_Status_Busy_Error;
+        }
+        else
+        {
+            endUs = now + (uint64_t)(HOST_RADIO_OVERHEAD_BYTES + txCommittedLen) * 8 * HOST_RADIO_BIT_TIME_US;
+            sendFrame(now, endUs);
+            txState = TxState_Sending;
+            HostKernel_startTimer(&txTimer, endUs, txTimeout, 0);
+            return;
+        }
+    }
+
+    txState = TxState_Idle;
+    busy = 0;
+
+    /* Go back to continuous Rx if the Tx interrupted it */
+    rxContinuousResume();
+
+    if (txCb != NULL)
+    {
+        txCb(status);
+    }
+}
+
+static void sendFrame(uint64_t startUs, uint64_t endUs)
+{
+    uint8_t datagram[sizeof(struct HostRadioHeader) + HOST_RADIO_PKT_SIZE];
+    struct HostRadioHeader header;
+    struct sockaddr_in address;
+    uint16_t i;
+
+    header.magic = HOST_RADIO_MAGIC;
+    header.frequency = frequency;
+    header.startUs = startUs;
+    header.endUs = endUs;
+    header.source = radioId;
+    header.pktLen = txCommittedLen;
+    memcpy(datagram, &header, sizeof(header));
+    hostRadioOnTime.txFrames++;
+    hostRadioOnTime.txUs += endUs - startUs;
+    memcpy(datagram + sizeof(header), txBuffer + EASYLINK_MAX_ADDR_SIZE - addrSize, txCommittedLen);
+
+    if (trace)
+    {
+        fprintf(stderr, "%llu radio %u: tx %u bytes to 0x%02x at %u Hz\n", (unsigned long long)startUs, radioId,
+                txCommittedLen, datagram[sizeof(header)], frequency);
+    }
+
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    for (i = 0; i < radioCount; i++)
+    {
+        if (i != radioId)
+        {
+            address.sin_port = htons(portBase + i);
+            sendto(radioSocket, datagram, sizeof(header) + txCommittedLen, 0,
+                   (struct sockaddr*)&address, sizeof(address));
+        }
+    }
+}
+
+EasyLink_Status EasyLink_receiveAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
+{
+    uint64_t startUs = (absTime != 0) ? radioTimeToUs(absTime) : HostKernel_now();
+
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if (rxContinuousActive || busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    busy = 1;
+    rxCb = cb;
+    rxSingleActive = 1;
+    listeningSinceUs = (startUs > HostKernel_now()) ? startUs : HostKernel_now();
+    rxArmed(listeningSinceUs);
+
+    /* The timeout counts from the Rx start, which may be in the future */
+    if (asyncRxTimeOut != 0)
+    {
+        rxSingleEndUs = startUs + asyncRxTimeOut / 4;
+        HostKernel_startTimer(&rxTimer, rxSingleEndUs, rxTimeout, 0);
+    }
+
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_receive(EasyLink_RxPacket* rxPacket)
+{
+    EasyLink_Status status;
+
+    blockingRxPacket = rxPacket;
+    status = EasyLink_receiveAsync(blockingRxDone, rxPacket->absTime);
+    if (status != EasyLink_Status_Success)
+    {
+        return status;
+    }
+
+    Semaphore_pend(&blockingSem, BIOS_WAIT_FOREVER);
+    return blockingStatus;
+}
+
+static void blockingRxDone(EasyLink_RxPacket* rxPacket, EasyLink_Status status)
+{
+    if (status == EasyLink_Status_Success)
+    {
+        *blockingRxPacket = *rxPacket;
+    }
+    blockingStatus = status;
+    Semaphore_post(&blockingSem);
+}
+
+/* Ends a single Rx and tells the application */
+static void rxSingleDone(EasyLink_Status status, const struct HostRadioFrame* frame)
+{
+    static EasyLink_RxPacket rxPacket;
+
+    HostKernel_stopTimer(&rxTimer);
+    rxStopped();
+    rxSingleActive = 0;
+    busy = 0;
+
+    if (frame != NULL)
+    {
+        rxPacket.len = frame->header.pktLen - addrSize;
+        memcpy(rxPacket.dstAddr, frame->pkt, addrSize);
+        memcpy(rxPacket.payload, frame->pkt + addrSize, rxPacket.len);
+        rxPacket.rssi = frameRssi(frame);
+        rxPacket.absTime = (uint32_t)(frame->header.startUs * 4);
+    }
+
+    if (rxCb != NULL)
+    {
+        rxCb(&rxPacket, status);
+    }
+}
+
+static void rxTimeout(uintptr_t arg)
+{
+    uint64_t now = HostKernel_now();
+    uint8_t i;
+
+    /* A packet whose sync word has been found when the end trigger comes is
+     * still received */
+    for (i = 0; i < HOST_RADIO_AIR_FRAMES; i++)
+    {
+        if (airFrames[i].used && airFrames[i].end.active &&
+            (airFrames[i].header.frequency == frequency) &&
+            ((airFrames[i].header.startUs + HOST_RADIO_PREAMBLE_US) >= listeningSinceUs) &&
+            ((airFrames[i].header.startUs + HOST_RADIO_SYNC_END_US) <= now))
+        {
+            HostKernel_startTimer(&rxTimer, airFrames[i].header.endUs + 1, rxTimeout, 0);
+            return;
+        }
+    }
+
+    rxSingleDone(EasyLink_Status_Rx_Timeout, NULL);
+}
+
+EasyLink_Status EasyLink_receiveContinuousAsync(EasyLink_ReceiveCb cb, uint32_t absTime)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if ((rxLoanCount != 0) || rxContinuousActive || busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    rxContinuousCb = cb;
+    rxContinuousLoanCb = NULL;
+
+    return rxContinuousStart(absTime);
+}
+
+EasyLink_Status EasyLink_receiveContinuousLoanAsync(EasyLink_ReceiveLoanCb cb, uint32_t absTime)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    if ((rxLoanCount != 0) || rxContinuousActive || busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    rxContinuousCb = NULL;
+    rxContinuousLoanCb = cb;
+
+    return rxContinuousStart(absTime);
+}
+
+static EasyLink_Status rxContinuousStart(uint32_t absTime)
+{
+    uint64_t startUs = (absTime != 0) ? radioTimeToUs(absTime) : HostKernel_now();
+
+    memset(rxLoans, 0, sizeof(rxLoans));
+    rxWriteEntry = 0;
+    rxContinuousSuspended = 0;
+    rxContinuousActive = 1;
+    listeningSinceUs = (startUs > HostKernel_now()) ? startUs : HostKernel_now();
+    rxArmed(listeningSinceUs);
+
+    return EasyLink_Status_Success;
+}
+
+void EasyLink_returnRxLoan(EasyLink_RxLoan* rxLoan)
+{
+    if ((rxLoan < rxLoans) || (rxLoan >= &rxLoans[EASYLINK_RX_QUEUE_ENTRIES]) ||
+        (rxLoan->payload == NULL))
+    {
+        return;
+    }
+
+    rxLoan->payload = NULL;
+    rxLoanCount--;
+}
+
+static void rxContinuousSuspend(void)
+{
+    if (rxContinuousActive && !rxContinuousSuspended)
+    {
+        rxContinuousSuspended = 1;
+        rxStopped();
+    }
+}
+
+static void rxContinuousResume(void)
+{
+    if (rxContinuousActive && rxContinuousSuspended)
+    {
+        rxContinuousSuspended = 0;
+        listeningSinceUs = HostKernel_now();
+        rxArmed(listeningSinceUs);
+    }
+}
+
+/* Closes the blind window of the last frame received, if any, and starts
+ * counting the Rx time */
+static void rxArmed(uint64_t startUs)
+{
+    uint64_t blindUs;
+
+    rxOnSinceUs = startUs;
+    if (rxEndUs == 0)
+    {
+        return;
+    }
+
+    blindUs = (startUs > rxEndUs) ? (startUs - rxEndUs) : 0;
+    rxEndUs = 0;
+    hostRadioRxBlind.windows++;
+    hostRadioRxBlind.blindUs += blindUs;
+    if (blindUs > hostRadioRxBlind.blindMaxUs)
+    {
+        hostRadioRxBlind.blindMaxUs = (uint32_t)blindUs;
+    }
+}
+
+/* Adds the Rx that ends now to the Rx time */
+static void rxStopped(void)
+{
+    uint64_t now = HostKernel_now();
+
+    if ((rxOnSinceUs != 0) && (now > rxOnSinceUs))
+    {
+        hostRadioOnTime.rxUs += now - rxOnSinceUs;
+    }
+    rxOnSinceUs = 0;
+}
+
+/* Runs at the exit with HOST_RADIO_STATS, with the Rx still running counted */
+static void printStats(void)
+{
+    uint64_t now = HostKernel_now();
+    uint64_t rxUs = hostRadioOnTime.rxUs;
+
+    if ((rxOnSinceUs != 0) && (now > rxOnSinceUs))
+    {
+        rxUs += now - rxOnSinceUs;
+    }
+    fprintf(stderr, "radio %u: %u frames sent, tx %llu us, rx %llu us\n", radioId, hostRadioOnTime.txFrames,
+            (unsigned long long)hostRadioOnTime.txUs, (unsigned long long)rxUs);
+}
+
+/* Puts a received frame in the next queue entry and hands it over */
+static void rxContinuousReceived(const struct HostRadioFrame* frame)
+{
+    static EasyLink_RxPacket rxPacket;
+    struct RxEntry* entry = &rxEntries[rxWriteEntry];
+    EasyLink_RxLoan* rxLoan = &rxLoans[rxWriteEntry];
+    uint64_t cycles;
+
+    /* Still lent out, the radio has wrapped around and the packet is lost */
+    if (rxLoan->payload != NULL)
+    {
+        return;
+    }
+
+    cycles = __rdtsc();
+
+    memcpy(entry->pkt, frame->pkt, frame->header.pktLen);
+    entry->pktLen = frame->header.pktLen;
+    entry->rssi = frameRssi(frame);
+    entry->absTime = (uint32_t)(frame->header.startUs * 4);
+    rxWriteEntry = (rxWriteEntry + 1) % EASYLINK_RX_QUEUE_ENTRIES;
+
+    if (rxContinuousLoanCb != NULL)
+    {
+        rxLoan->dstAddr = entry->pkt;
+        rxLoan->payload = entry->pkt + addrSize;
+        rxLoan->len = entry->pktLen - addrSize;
+        rxLoan->rssi = entry->rssi;
+        rxLoan->absTime = entry->absTime;
+        rxLoanCount++;
+        rxContinuousLoanCb(rxLoan, EasyLink_Status_Success);
+    }
+    else if (rxContinuousCb != NULL)
+    {
+        rxPacket.len = entry->pktLen - addrSize;
+        memcpy(rxPacket.dstAddr, entry->pkt, addrSize);
+        memcpy(rxPacket.payload, entry->pkt + addrSize, rxPacket.len);
+        rxPacket.rssi = entry->rssi;
+        rxPacket.absTime = entry->absTime;
+        rxContinuousCb(&rxPacket, EasyLink_Status_Success);
+    }
+
+    cycles = __rdtsc() - cycles;
+    hostRadioRxCycles.frames++;
+    hostRadioRxCycles.cycles += cycles;
+    if ((cycles < hostRadioRxCycles.cyclesMin) || (hostRadioRxCycles.cyclesMin == 0))
+    {
+        hostRadioRxCycles.cyclesMin = (uint32_t)cycles;
+    }
+    if (cycles > hostRadioRxCycles.cyclesMax)
+    {
+        hostRadioRxCycles.cyclesMax = (uint32_t)cycles;
+    }
+}
+
+EasyLink_Status EasyLink_abort(void)
+{
+    static EasyLink_RxPacket rxPacket;
+
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+
+    /* Stop continuous Rx if no other Async command is running */
+    if (!busy && rxContinuousActive)
+    {
+        if (!rxContinuousSuspended)
+        {
+            rxStopped();
+        }
+        rxContinuousActive = 0;
+        rxContinuousSuspended = 0;
+        if (rxContinuousCb != NULL)
+        {
+            rxContinuousCb(&rxPacket, EasyLink_Status_Aborted);
+        }
+        else if (rxContinuousLoanCb != NULL)
+        {
+            rxContinuousLoanCb(NULL, EasyLink_Status_Aborted);
+        }
+        return EasyLink_Status_Success;
+    }
+
+    if (!busy)
+    {
+        return EasyLink_Status_Aborted;
+    }
+
+    if (rxSingleActive)
+    {
+        rxSingleDone(EasyLink_Status_Aborted, NULL);
+    }
+    else
+    {
+        HostKernel_stopTimer(&txTimer);
+        txState = TxState_Idle;
+        busy = 0;
+        rxContinuousResume();
+        if (txCb != NULL)
+        {
+            txCb(EasyLink_Status_Aborted);
+        }
+    }
+
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_enableRxAddrFilter(uint8_t* pui8AddrFilterTable, uint8_t ui8AddrSize, uint8_t ui8NumAddrs)
+{
+    if (!configured)
+    {
+        return EasyLink_Status_Config_Error;
+    }
+    /* Continuous Rx must be aborted before the filter can be changed */
+    if (rxContinuousActive || busy)
+    {
+        return EasyLink_Status_Busy_Error;
+    }
+
+    if ((pui8AddrFilterTable != NULL) && (ui8AddrSize != 0) && (ui8NumAddrs != 0) &&
+        (ui8AddrSize == addrSize) && (ui8NumAddrs <= EASYLINK_MAX_ADDR_FILTERS))
+    {
+        memcpy(addrFilterTable, pui8AddrFilterTable, ui8AddrSize * ui8NumAddrs);
+        addrFilterCount = ui8NumAddrs;
+        return EasyLink_Status_Success;
+    }
+    else if (pui8AddrFilterTable == NULL)
+    {
+        addrFilterCount = 0;
+        return EasyLink_Status_Success;
+    }
+
+    return EasyLink_Status_Param_Error;
+}
+
+EasyLink_Status EasyLink_getIeeeAddr(uint8_t* ieeeAddr)
+{
+    const char* text = HostKernel_getEnv("HOST_IEEE_ADDR", NULL);
+    unsigned int byte;
+    uint8_t i;
+
+    if (ieeeAddr == NULL)
+    {
+        return EasyLink_Status_Param_Error;
+    }
+
+    ieeeAddr[0] = 0x00;
+    ieeeAddr[1] = 0x12;
+    ieeeAddr[2] = 0x4B;
+    ieeeAddr[3] = 0x00;
+    ieeeAddr[4] = 0x00;
+    ieeeAddr[5] = 0x00;
+    ieeeAddr[6] = radioId >> 8;
+    ieeeAddr[7] = radioId & 0xFF;
+
+    for (i = 0; (text != NULL) && (i < 8) && (sscanf(text + 2 * i, "%2x", &byte) == 1); i++)
+    {
+        ieeeAddr[i] = byte;
+    }
+
+    return EasyLink_Status_Success;
+}
+
+EasyLink_Status EasyLink_setCtrl(EasyLink_CtrlOption Ctrl, uint32_t ui32Value)
+{
+    EasyLink_Status status = EasyLink_Status_Param_Error;
+
+    switch (Ctrl)
+    {
+        case EasyLink_Ctrl_AddSize:
+            if ((ui32Value != 0) && (ui32Value <= EASYLINK_MAX_ADDR_SIZE))
+            {
+                addrSize = (uint8_t)ui32Value;
+                status = EasyLink_Status_Success;
+            }
+            break;
+        case EasyLink_Ctrl_Idle_TimeOut:
+        case EasyLink_Ctrl_MultiClient_Mode:
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_AsyncRx_TimeOut:
+            asyncRxTimeOut = ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Test_Tone:
+        case EasyLink_Ctrl_Test_Signal:
+            status = EasyLink_Status_Config_Error;
+            break;
+        case EasyLink_Ctrl_Rx_ErrorCount:
+            rxErrorCount = ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_MinBackoffWindow:
+            if (ui32Value <= ccaMaxBackoffWindow)
+            {
+                ccaMinBackoffWindow = (uint8_t)ui32Value;
+                status = EasyLink_Status_Success;
+            }
+            break;
+        case EasyLink_Ctrl_Cca_MaxBackoffWindow:
+            if ((ui32Value >= ccaMinBackoffWindow) && (ui32Value <= 15))
+            {
+                ccaMaxBackoffWindow = (uint8_t)ui32Value;
+                status = EasyLink_Status_Success;
+            }
+            break;
+        case EasyLink_Ctrl_Cca_BackoffTimeUnits:
+            ccaBackoffTimeUnits = ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_RssiThreshold:
+            ccaRssiThreshold = (int8_t)ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+        case EasyLink_Ctrl_Cca_BusyCount:
+            ccaBusyCount = ui32Value;
+            status = EasyLink_Status_Success;
+            break;
+    }
+
+    return status;
+}
+
+EasyLink_Status EasyLink_getCtrl(EasyLink_CtrlOption Ctrl, uint32_t* pui32Value)
+{
+    EasyLink_Status status = EasyLink_Status_Success;
+
+    switch (Ctrl)
+    {
+        case EasyLink_Ctrl_AddSize:
+            *pui32Value = addrSize;
+            break;
+        case EasyLink_Ctrl_AsyncRx_TimeOut:
+            *pui32Value = asyncRxTimeOut;
+            break;
+        case EasyLink_Ctrl_Rx_ErrorCount:
+            *pui32Value = rxErrorCount;
+            break;
+        case EasyLink_Ctrl_Cca_MinBackoffWindow:
+            *pui32Value = ccaMinBackoffWindow;
+            break;
+        case EasyLink_Ctrl_Cca_MaxBackoffWindow:
+            *pui32Value = ccaMaxBackoffWindow;
+            break;
+        case EasyLink_Ctrl_Cca_BackoffTimeUnits:
+            *pui32Value = ccaBackoffTimeUnits;
+            break;
+        case EasyLink_Ctrl_Cca_RssiThreshold:
+            *pui32Value = (uint32_t)(int32_t)ccaRssiThreshold;
+            break;
+        case EasyLink_Ctrl_Cca_BusyCount:
+            *pui32Value = ccaBusyCount;
+            break;
+        default:
+            *pui32Value = 0;
+            break;
+    }
+
+    return status;
+}
+
+/* Receives the frames of the other radios */
+static void* receiveThreadFunction(void* arg)
+{
+    uint8_t datagram[sizeof(struct HostRadioHeader) + HOST_RADIO_PKT_SIZE];
+    struct HostRadioFrame* frame;
+    struct HostRadioHeader header;
+    uint64_t now;
+    ssize_t length;
+    uint8_t i;
+
+    while (1)
+    {
+        length = recv(radioSocket, datagram, sizeof(datagram), 0);
+        if (length < (ssize_t)sizeof(header))
+        {
+            continue;
+        }
+        memcpy(&header, datagram, sizeof(header));
+        if ((header.magic != HOST_RADIO_MAGIC) || (length != (ssize_t)(sizeof(header) + header.pktLen)))
+        {
+            continue;
+        }
+
+        HostKernel_lock();
+        now = HostKernel_now();
+
+        /* Find room, forgetting frames that ended long enough ago */
+        frame = NULL;
+        for (i = 0; i < HOST_RADIO_AIR_FRAMES; i++)
+        {
+            if (airFrames[i].used && !airFrames[i].end.active &&
+                ((airFrames[i].header.endUs + HOST_RADIO_AIR_KEEP_US) < now))
+            {
+                airFrames[i].used = 0;
+            }
+            if (!airFrames[i].used && (frame == NULL))
+            {
+                frame = &airFrames[i];
+            }
+        }
+
+        if (frame != NULL)
+        {
+            frame->header = header;
+            memcpy(frame->pkt, datagram + sizeof(header), header.pktLen);
+            frame->used = 1;
+            frame->lost = (lossPercent != 0) && ((uint32_t)(rand() % 100) < lossPercent);
+
+            /* Frames on the same frequency that overlap destroy each other */
+            for (i = 0; i < HOST_RADIO_AIR_FRAMES; i++)
+            {
+                if (airFrames[i].used && (&airFrames[i] != frame) &&
+                    (airFrames[i].header.frequency == header.frequency) &&
+                    (airFrames[i].header.startUs < header.endUs) &&
+                    (header.startUs < airFrames[i].header.endUs))
+                {
+                    airFrames[i].lost = 1;
+                    frame->lost = 1;
+                }
+            }
+
+            HostKernel_startTimer(&frame->end, (header.endUs > now) ? header.endUs : now, frameEnd,
+                                  (uintptr_t)frame);
+        }
+
+        HostKernel_unlock();
+    }
+
+    return NULL;
+}
+
+/* A frame has been on air until its end, receives it if the radio heard it */
+static void frameEnd(uintptr_t arg)
+{
+    const struct HostRadioFrame* frame = (const struct HostRadioFrame*)arg;
+    uint8_t i;
+
+    if (trace)
+    {
+        fprintf(stderr, "%llu radio %u: frame from %u to 0x%02x at %u Hz%s, radio at %u Hz %s since %llu\n",
+                (unsigned long long)HostKernel_now(), radioId, frame->header.source, frame->pkt[0],
+                frame->header.frequency, frame->lost ? " lost" : "", frequency,
+                isListening() ? "listening" : "not listening", (unsigned long long)listeningSinceUs);
+    }
+
+    if ((frame->header.frequency != frequency) || !isListening() ||
+        ((frame->header.startUs + HOST_RADIO_PREAMBLE_US) < listeningSinceUs) ||
+        (frame->header.pktLen < addrSize))
+    {
+        return;
+    }
+
+    if (frame->lost)
+    {
+        rxErrorCount++;
+        if (rxSingleActive)
+        {
+            rxSingleDone(EasyLink_Status_Rx_Error, NULL);
+        }
+        return;
+    }
+
+    if (addrFilterCount != 0)
+    {
+        for (i = 0; i < addrFilterCount; i++)
+        {
+            if (memcmp(frame->pkt, &addrFilterTable[i * addrSize], addrSize) == 0)
+            {
+                break;
+            }
+        }
+        if (i == addrFilterCount)
+        {
+            return;
+        }
+    }
+
+    rxEndUs = frame->header.endUs;
+    if (rxSingleActive)
+    {
+        rxSingleDone(EasyLink_Status_Success, frame);
+    }
+    else
+    {
+        rxContinuousReceived(frame);
+    }
+}
+
+/* Converts an absolute radio time, at most half the timer range away, to
+ * simulated time */
+static uint64_t radioTimeToUs(uint32_t absTime)
+{
+    uint64_t now = HostKernel_now();
+    int32_t delta = (int32_t)(absTime - RF_getCurrentTime());
+
+    /* Times in the past start now */
+    if (delta <= 0)
+    {
+        return now;
+    }
+
+    return now + (uint32_t)delta / 4;
+}
+
+static uint8_t isListening(void)
+{
+    return (rxSingleActive || (rxContinuousActive && !rxContinuousSuspended)) &&
+           (HostKernel_now() >= listeningSinceUs);
+}
+
+/* Strongest frame on air on the current frequency, or the noise floor */
+static uint8_t isChannelBusy(int8_t* pRssi)
+{
+    uint64_t now = HostKernel_now();
+    uint8_t i;
+
+    *pRssi = HOST_RADIO_NOISE_FLOOR_DBM;
+    for (i = 0; i < HOST_RADIO_AIR_FRAMES; i++)
+    {
+        if (airFrames[i].used && (airFrames[i].header.frequency == frequency) &&
+            (airFrames[i].header.startUs <= now) && (now < airFrames[i].header.endUs) &&
+            (frameRssi(&airFrames[i]) > *pRssi))
+        {
+            *pRssi = frameRssi(&airFrames[i]);
+        }
+    }
+
+    return *pRssi > ccaRssiThreshold;
+}
+
+/* Every radio is heard at its own fixed level */
+static int8_t frameRssi(const struct HostRadioFrame* frame)
+{
+    return -40 - (frame->header.source % 40);
+}
@@ -0,0 +1,113 @@
+/*
+ *  ======== HostKernel.h ========
+ *
+ *  Host build: the part of the POSIX TI-RTOS shim that is not TI-RTOS API.
+ *
+ *  The application runs on one simulated CPU. Every thread that runs
+ *  application code (the tasks, the timer thread that runs the Clock and
+ *  radio callbacks, and the radio receive thread) holds the CPU lock while
+ *  it does so, and a task gives it up only when it blocks in Event_pend,
+ *  Semaphore_pend or Task_sleep. Callbacks therefore never interrupt a task
+ *  half way, so Hwi_disable has nothing left to do, and a task that is made
+ *  ready runs once the running one blocks rather than preempting it.
+ *
+ *  Time is taken from CLOCK_MONOTONIC, which all processes on the machine
+ *  share, so the radio timers of a concentrator and its nodes running as
+ *  separate processes agree. HOST_TIME_SCALE (environment, default 1) runs
+ *  the simulated time that many times faster than the wall clock, the same
+ *  value must be given to all processes of a network.
+ *
+ *  Environment variables read by the shim:
+ *   HOST_TIME_SCALE     Simulated seconds per wall clock second
+ *   HOST_RUN_SECONDS    Simulated seconds after which BIOS_start exits, 0 for never
+ *   HOST_DISPLAY        File the displays print to, "-" for stdout, unset for none
+ *   HOST_UART           File the UART writes to, unset for no UART
+ *   HOST_NVS            File backing the internal flash, unset for RAM only
+ *   HOST_RADIO_*        See EasyLinkUdp.c
+ */
+
+#ifndef HOSTKERNEL_H_
+#define HOSTKERNEL_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*HostTimer_Fxn)(uintptr_t arg);
+
+/* One shot timer, its callback runs on the timer thread with the CPU lock held */
+typedef struct HostTimer {
+    struct HostTimer* next;
+    uint64_t expiryUs;
+    HostTimer_Fxn fxn;
+    uintptr_t arg;
+    uint8_t active;
+} HostTimer;
+
+/* Simulated time in us, shared by all processes with the same HOST_TIME_SCALE */
+uint64_t HostKernel_now(void);
+
+/* Starts or restarts a timer to run at the simulated time expiryUs, the CPU
+ * lock must be held */
+void HostKernel_startTimer(HostTimer* timer, uint64_t expiryUs, HostTimer_Fxn fxn, uintptr_t arg);
+
+/* Stops a timer, the CPU lock must be held */
+void HostKernel_stopTimer(HostTimer* timer);
+
+/* Takes and gives back the CPU lock, for threads of the shim and of host
+ * tests that call into the application */
+void HostKernel_lock(void);
+void HostKernel_unlock(void);
+
+/* Starts the tasks like BIOS_start, runs the application for ms of simulated
+ * time and returns with the CPU lock held, so the application state can be
+ * read while nothing runs */
+void HostKernel_runFor(uint32_t ms);
+
+/* Host cycles spent by EasyLinkUdp.c on the frames received in continuous Rx,
+ * from filling the Rx queue entry to the return of the application's
+ * callback. Read and cleared with the CPU lock held. */
+struct HostRadioRxCycles {
+    uint32_t frames;
+    uint64_t cycles;
+    uint32_t cyclesMin;     /* 0 until the first frame */
+    uint32_t cyclesMax;
+};
+
+extern struct HostRadioRxCycles hostRadioRxCycles;
+
+/* Time the radio of EasyLinkUdp.c was deaf after receiving a frame, from the
+ * end of the frame to the next time the Rx was armed again, by
+ * EasyLink_receiveAsync or by continuous Rx resuming after a Tx. A window
+ * is counted for the last frame received before each re-arm. Read and
+ * cleared with the CPU lock held. */
+struct HostRadioRxBlind {
+    uint32_t windows;
+    uint64_t blindUs;
+    uint32_t blindMaxUs;
+};
+
+extern struct HostRadioRxBlind hostRadioRxBlind;
+
+/* Time the radio of EasyLinkUdp.c spent on air and in Rx. rxUs is closed
+ * when an Rx ends or is suspended, one still running is not in it yet.
+ * Printed to stderr at the exit if HOST_RADIO_STATS is set. */
+struct HostRadioOnTime {
+    uint32_t txFrames;
+    uint64_t txUs;
+    uint64_t rxUs;
+};
+
+extern struct HostRadioOnTime hostRadioOnTime;
+
+/* Returns the value of the environment variable, or defaultValue if unset */
+const char* HostKernel_getEnv(const char* name, const char* defaultValue);
+uint32_t HostKernel_getEnvInt(const char* name, uint32_t defaultValue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOSTKERNEL_H_ */
@@ -0,0 +1,16 @@
+/*
+ *  ======== ti/devices/DeviceFamily.h ========
+ *
+ *  Host build: the driverlib headers of the shim stand in for the CC13x0 ones.
+ */
+
+#ifndef HOST_TI_DEVICES_DEVICEFAMILY_H_
+#define HOST_TI_DEVICES_DEVICEFAMILY_H_
+
+#ifndef DeviceFamily_CC13X0
+#define DeviceFamily_CC13X0
+#endif
+
+#define DeviceFamily_constructPath(x) <ti/devices/cc13x0/x>
+
+#endif /* HOST_TI_DEVICES_DEVICEFAMILY_H_ */
@@ -0,0 +1,21 @@
+/*
+ *  ======== driverlib/aon_batmon.h ========
+ */
+
+#ifndef HOST_DRIVERLIB_AON_BATMON_H_
+#define HOST_DRIVERLIB_AON_BATMON_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Battery voltage in V, integer part in bits 10:8 and fraction in bits 7:0 */
+uint32_t AONBatMonBatteryVoltageGet(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_DRIVERLIB_AON_BATMON_H_ */
@@ -0,0 +1,13 @@
+/*
+ *  ======== driverlib/cpu.h ========
+ */
+
+#ifndef HOST_DRIVERLIB_CPU_H_
+#define HOST_DRIVERLIB_CPU_H_
+
+#include <stdint.h>
+
+/* Busy waits on the target, the host build does not hold up the simulated CPU */
+#define CPUdelay(count) ((void)(count))
+
+#endif /* HOST_DRIVERLIB_CPU_H_ */
@@ -0,0 +1,30 @@
+/*
+ *  ======== driverlib/trng.h ========
+ *
+ *  Host build: the random numbers come from the operating system.
+ */
+
+#ifndef HOST_DRIVERLIB_TRNG_H_
+#define HOST_DRIVERLIB_TRNG_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRNG_NUMBER_READY   0x00000001
+#define TRNG_HI_WORD        0x00000001
+#define TRNG_LOW_WORD       0x00000002
+
+#define TRNGEnable()
+#define TRNGDisable()
+#define TRNGStatusGet() TRNG_NUMBER_READY
+
+uint32_t TRNGNumberGet(uint32_t word);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_DRIVERLIB_TRNG_H_ */
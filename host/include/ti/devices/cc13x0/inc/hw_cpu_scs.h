@@ -0,0 +1,12 @@
+/*
+ *  ======== inc/hw_cpu_scs.h ========
+ */
+
+#ifndef HOST_INC_HW_CPU_SCS_H_
+#define HOST_INC_HW_CPU_SCS_H_
+
+#define CPU_SCS_O_DEMCR         0x00000DFC
+
+#define CPU_SCS_DEMCR_TRCENA    0x01000000
+
+#endif /* HOST_INC_HW_CPU_SCS_H_ */
@@ -0,0 +1,11 @@
+/*
+ *  ======== inc/hw_memmap.h ========
+ */
+
+#ifndef HOST_INC_HW_MEMMAP_H_
+#define HOST_INC_HW_MEMMAP_H_
+
+#define CPU_DWT_BASE            0xE0001000
+#define CPU_SCS_BASE            0xE000E000
+
+#endif /* HOST_INC_HW_MEMMAP_H_ */
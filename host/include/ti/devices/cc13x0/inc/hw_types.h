@@ -0,0 +1,26 @@
+/*
+ *  ======== inc/hw_types.h ========
+ *
+ *  Host build: HWREG goes through HostHw_register, which only knows the DWT
+ *  cycle counter. Reading it gives the host's cycle counter, writes to it and
+ *  to every other register are kept but do nothing.
+ */
+
+#ifndef HOST_INC_HW_TYPES_H_
+#define HOST_INC_HW_TYPES_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+volatile uint32_t* HostHw_register(uint32_t address);
+
+#define HWREG(x) (*HostHw_register((uint32_t)(x)))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_INC_HW_TYPES_H_ */
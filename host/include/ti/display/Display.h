@@ -0,0 +1,45 @@
+/*
+ *  ======== ti/display/Display.h ========
+ *
+ *  Host build: every display prints its lines to the file named by
+ *  HOST_DISPLAY, "-" for stdout. Without HOST_DISPLAY Display_open returns
+ *  NULL, as when the board has no such display.
+ */
+
+#ifndef HOST_TI_DISPLAY_DISPLAY_H_
+#define HOST_TI_DISPLAY_DISPLAY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define Display_Type_LCD        0x1
+#define Display_Type_UART       0x2
+
+typedef enum {
+    DISPLAY_CLEAR_NONE = 0,
+    DISPLAY_CLEAR_LEFT,
+    DISPLAY_CLEAR_RIGHT,
+    DISPLAY_CLEAR_BOTH
+} Display_LineClearMode;
+
+typedef struct {
+    Display_LineClearMode lineClearMode;
+} Display_Params;
+
+typedef struct Display_Config_s* Display_Handle;
+
+void Display_init(void);
+void Display_Params_init(Display_Params* params);
+Display_Handle Display_open(uint32_t id, Display_Params* params);
+void Display_close(Display_Handle handle);
+void Display_clear(Display_Handle handle);
+void Display_printf(Display_Handle handle, uint8_t line, uint8_t column, const char* fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_DISPLAY_DISPLAY_H_ */
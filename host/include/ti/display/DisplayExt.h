@@ -0,0 +1,10 @@
+/*
+ *  ======== ti/display/DisplayExt.h ========
+ */
+
+#ifndef HOST_TI_DISPLAY_DISPLAYEXT_H_
+#define HOST_TI_DISPLAY_DISPLAYEXT_H_
+
+#include <ti/display/Display.h>
+
+#endif /* HOST_TI_DISPLAY_DISPLAYEXT_H_ */
@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/ADC.h ========
+ *
+ *  Host build: only here for Board.h, the application does not use it.
+ */
+
+#ifndef HOST_TI_DRIVERS_ADC_H_
+#define HOST_TI_DRIVERS_ADC_H_
+
+#define ADC_init()
+
+#endif /* HOST_TI_DRIVERS_ADC_H_ */
@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/ADCBuf.h ========
+ *
+ *  Host build: only here for Board.h, the application does not use it.
+ */
+
+#ifndef HOST_TI_DRIVERS_ADCBUF_H_
+#define HOST_TI_DRIVERS_ADCBUF_H_
+
+#define ADCBuf_init()
+
+#endif /* HOST_TI_DRIVERS_ADCBUF_H_ */
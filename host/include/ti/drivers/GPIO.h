@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/GPIO.h ========
+ *
+ *  Host build: only here for Board.h, the application does not use it.
+ */
+
+#ifndef HOST_TI_DRIVERS_GPIO_H_
+#define HOST_TI_DRIVERS_GPIO_H_
+
+#define GPIO_init()
+
+#endif /* HOST_TI_DRIVERS_GPIO_H_ */
@@ -0,0 +1,52 @@
+/*
+ *  ======== ti/drivers/NVS.h ========
+ *
+ *  Host build: one flash region, kept in the file named by HOST_NVS if set.
+ *  Writes can only clear bits, like the flash, and erase sets them again.
+ */
+
+#ifndef HOST_TI_DRIVERS_NVS_H_
+#define HOST_TI_DRIVERS_NVS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NVS_STATUS_SUCCESS          0
+#define NVS_STATUS_ERROR            (-1)
+#define NVS_STATUS_INV_OFFSET       (-3)
+#define NVS_STATUS_INV_WRITE        (-6)
+
+#define NVS_WRITE_ERASE             0x1
+#define NVS_WRITE_PRE_VERIFY        0x2
+#define NVS_WRITE_POST_VERIFY       0x4
+
+typedef struct {
+    int unused;
+} NVS_Params;
+
+typedef struct {
+    void* regionBase;
+    size_t regionSize;
+    size_t sectorSize;
+} NVS_Attrs;
+
+typedef struct NVS_Config_s* NVS_Handle;
+
+void NVS_init(void);
+void NVS_Params_init(NVS_Params* params);
+NVS_Handle NVS_open(uint_least8_t index, NVS_Params* params);
+void NVS_close(NVS_Handle handle);
+void NVS_getAttrs(NVS_Handle handle, NVS_Attrs* attrs);
+int_fast16_t NVS_read(NVS_Handle handle, size_t offset, void* buffer, size_t bufferSize);
+int_fast16_t NVS_write(NVS_Handle handle, size_t offset, void* buffer, size_t bufferSize, uint_fast16_t flags);
+int_fast16_t NVS_erase(NVS_Handle handle, size_t offset, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_DRIVERS_NVS_H_ */
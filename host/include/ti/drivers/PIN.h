@@ -0,0 +1,67 @@
+/*
+ *  ======== ti/drivers/PIN.h ========
+ *
+ *  Host build: pins are values in memory. An output keeps what was set, an
+ *  input reads high (pulled up) until the shim drives it low. SIGUSR1 presses
+ *  the first input with PIN_IRQ_NEGEDGE and a callback, SIGUSR2 the second,
+ *  for 100 ms.
+ */
+
+#ifndef HOST_TI_DRIVERS_PIN_H_
+#define HOST_TI_DRIVERS_PIN_H_
+
+#include <stdint.h>
+#include <ti/devices/cc13x0/driverlib/ioc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t PIN_Config;
+typedef uint8_t PIN_Id;
+typedef int PIN_Status;
+
+#define PIN_SUCCESS         0
+#define PIN_ALREADY_ALLOCATED 1
+
+#define PIN_ID(config)      ((PIN_Id)((config) & 0xFF))
+#define PIN_TERMINATE       0xFE
+#define PIN_UNASSIGNED      0xFF
+
+#define PIN_INPUT_EN        (1 << 8)
+#define PIN_PULLUP          (1 << 9)
+#define PIN_PULLDOWN        (1 << 10)
+#define PIN_IRQ_NEGEDGE     (1 << 11)
+#define PIN_IRQ_POSEDGE     (1 << 12)
+#define PIN_GPIO_OUTPUT_EN  (1 << 13)
+#define PIN_GPIO_LOW        (1 << 14)
+#define PIN_GPIO_HIGH       (1 << 15)
+#define PIN_PUSHPULL        (1 << 16)
+#define PIN_DRVSTR_MAX      (1 << 17)
+
+#define PIN_MAX_CONFIGS     8
+
+struct PIN_State_s;
+typedef struct PIN_State_s* PIN_Handle;
+
+typedef void (*PIN_IntCb)(PIN_Handle handle, PIN_Id pinId);
+
+typedef struct PIN_State_s {
+    PIN_Config configs[PIN_MAX_CONFIGS];
+    uint8_t count;
+    PIN_IntCb callback;
+    struct PIN_State_s* next;
+} PIN_State;
+
+PIN_Handle PIN_open(PIN_State* state, const PIN_Config pinList[]);
+void PIN_close(PIN_Handle handle);
+PIN_Status PIN_registerIntCb(PIN_Handle handle, PIN_IntCb callback);
+uint32_t PIN_getInputValue(PIN_Id pinId);
+uint32_t PIN_getOutputValue(PIN_Id pinId);
+PIN_Status PIN_setOutputValue(PIN_Handle handle, PIN_Id pinId, uint32_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_DRIVERS_PIN_H_ */
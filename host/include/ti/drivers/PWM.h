@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/PWM.h ========
+ *
+ *  Host build: only here for Board.h, the application does not use it.
+ */
+
+#ifndef HOST_TI_DRIVERS_PWM_H_
+#define HOST_TI_DRIVERS_PWM_H_
+
+#define PWM_init()
+
+#endif /* HOST_TI_DRIVERS_PWM_H_ */
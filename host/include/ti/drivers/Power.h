@@ -0,0 +1,15 @@
+/*
+ *  ======== ti/drivers/Power.h ========
+ *
+ *  Host build: there is nothing to power up or down.
+ */
+
+#ifndef HOST_TI_DRIVERS_POWER_H_
+#define HOST_TI_DRIVERS_POWER_H_
+
+#define Power_SOK 0
+
+#define Power_setDependency(resourceId) ((void)(resourceId), Power_SOK)
+#define Power_releaseDependency(resourceId) ((void)(resourceId), Power_SOK)
+
+#endif /* HOST_TI_DRIVERS_POWER_H_ */
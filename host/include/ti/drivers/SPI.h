@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/SPI.h ========
+ *
+ *  Host build: only here for Board.h, the application does not use it.
+ */
+
+#ifndef HOST_TI_DRIVERS_SPI_H_
+#define HOST_TI_DRIVERS_SPI_H_
+
+#define SPI_init()
+
+#endif /* HOST_TI_DRIVERS_SPI_H_ */
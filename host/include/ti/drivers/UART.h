@@ -0,0 +1,62 @@
+/*
+ *  ======== ti/drivers/UART.h ========
+ *
+ *  Host build: the UART writes to the file named by HOST_UART, at the baud
+ *  rate in simulated time. Only writes are supported.
+ */
+
+#ifndef HOST_TI_DRIVERS_UART_H_
+#define HOST_TI_DRIVERS_UART_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct UART_Config_s* UART_Handle;
+
+typedef void (*UART_Callback)(UART_Handle handle, void* buf, size_t count);
+
+typedef enum {
+    UART_MODE_BLOCKING,
+    UART_MODE_CALLBACK
+} UART_Mode;
+
+typedef enum {
+    UART_DATA_BINARY,
+    UART_DATA_TEXT
+} UART_DataMode;
+
+typedef enum {
+    UART_ECHO_OFF,
+    UART_ECHO_ON
+} UART_Echo;
+
+typedef struct {
+    UART_Mode readMode;
+    UART_Mode writeMode;
+    uint32_t readTimeout;
+    uint32_t writeTimeout;
+    UART_Callback readCallback;
+    UART_Callback writeCallback;
+    UART_DataMode readDataMode;
+    UART_DataMode writeDataMode;
+    UART_Echo readEcho;
+    uint32_t baudRate;
+} UART_Params;
+
+#define UART_ERROR (-1)
+
+void UART_init(void);
+void UART_Params_init(UART_Params* params);
+UART_Handle UART_open(uint_least8_t index, UART_Params* params);
+void UART_close(UART_Handle handle);
+int_fast32_t UART_write(UART_Handle handle, const void* buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_DRIVERS_UART_H_ */
@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/Watchdog.h ========
+ *
+ *  Host build: only here for Board.h, the application does not use it.
+ */
+
+#ifndef HOST_TI_DRIVERS_WATCHDOG_H_
+#define HOST_TI_DRIVERS_WATCHDOG_H_
+
+#define Watchdog_init()
+
+#endif /* HOST_TI_DRIVERS_WATCHDOG_H_ */
@@ -0,0 +1,12 @@
+/*
+ *  ======== ti/drivers/power/PowerCC26XX.h ========
+ */
+
+#ifndef HOST_TI_DRIVERS_POWER_POWERCC26XX_H_
+#define HOST_TI_DRIVERS_POWER_POWERCC26XX_H_
+
+#include <ti/drivers/Power.h>
+
+#define PowerCC26XX_PERIPH_TRNG 11
+
+#endif /* HOST_TI_DRIVERS_POWER_POWERCC26XX_H_ */
@@ -0,0 +1,32 @@
+/*
+ *  ======== ti/drivers/rf/RF.h ========
+ *
+ *  Host build: only the radio timer, the radio itself is EasyLinkUdp.c. The
+ *  radio timer runs at 4 MHz from the simulated time of HostKernel.h, so it
+ *  agrees between processes.
+ */
+
+#ifndef HOST_TI_DRIVERS_RF_RF_H_
+#define HOST_TI_DRIVERS_RF_RF_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct RF_Object_s* RF_Handle;
+typedef uint32_t RF_ClientEventMask;
+typedef uint32_t RF_ClientEvent;
+typedef void (*RF_ClientCallback)(RF_Handle h, RF_ClientEvent event, void* arg);
+
+#define RF_ClientEventSwitchClientEntered (1 << 1)
+
+/* Radio timer, 4 MHz */
+uint32_t RF_getCurrentTime(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_DRIVERS_RF_RF_H_ */
@@ -0,0 +1,26 @@
+/*
+ *  ======== ti/sysbios/BIOS.h ========
+ *
+ *  Host build, see HostKernel.h.
+ */
+
+#ifndef HOST_TI_SYSBIOS_BIOS_H_
+#define HOST_TI_SYSBIOS_BIOS_H_
+
+#include <xdc/std.h>
+
+#define BIOS_WAIT_FOREVER (~(UInt32)0)
+#define BIOS_NO_WAIT      ((UInt32)0)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Starts the tasks and does not return, unless HOST_RUN_SECONDS is set */
+void BIOS_start(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_SYSBIOS_BIOS_H_ */
@@ -0,0 +1,16 @@
+/*
+ *  ======== ti/sysbios/hal/Hwi.h ========
+ *
+ *  Host build: callbacks never interrupt application code, see HostKernel.h,
+ *  so disabling interrupts has nothing to do.
+ */
+
+#ifndef HOST_TI_SYSBIOS_HAL_HWI_H_
+#define HOST_TI_SYSBIOS_HAL_HWI_H_
+
+#include <xdc/std.h>
+
+#define Hwi_disable() ((UInt)0)
+#define Hwi_restore(key) ((void)(key))
+
+#endif /* HOST_TI_SYSBIOS_HAL_HWI_H_ */
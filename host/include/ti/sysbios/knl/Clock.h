@@ -0,0 +1,55 @@
+/*
+ *  ======== ti/sysbios/knl/Clock.h ========
+ *
+ *  Host build: the clock functions run on the timer thread, see HostKernel.h.
+ *  A tick is 10 us, as in the TI-RTOS configuration of the projects.
+ */
+
+#ifndef HOST_TI_SYSBIOS_KNL_CLOCK_H_
+#define HOST_TI_SYSBIOS_KNL_CLOCK_H_
+
+#include <xdc/std.h>
+#include "HostKernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*Clock_FuncPtr)(UArg arg);
+
+typedef struct {
+    UInt32 period;
+    Bool startFlag;
+    UArg arg;
+} Clock_Params;
+
+typedef struct {
+    HostTimer timer;
+    Clock_FuncPtr fxn;
+    UArg arg;
+    UInt32 timeout;
+    UInt32 period;
+} Clock_Struct;
+
+typedef Clock_Struct* Clock_Handle;
+
+/* Length of a Clock tick in us */
+extern const UInt32 Clock_tickPeriod;
+
+void Clock_Params_init(Clock_Params* params);
+void Clock_construct(Clock_Struct* clock, Clock_FuncPtr fxn, UInt timeout, const Clock_Params* params);
+void Clock_start(Clock_Handle clock);
+void Clock_stop(Clock_Handle clock);
+void Clock_setTimeout(Clock_Handle clock, UInt32 timeout);
+void Clock_setPeriod(Clock_Handle clock, UInt32 period);
+UInt32 Clock_getTimeout(Clock_Handle clock);
+Bool Clock_isActive(Clock_Handle clock);
+UInt32 Clock_getTicks(void);
+
+#define Clock_handle(clock) (clock)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_SYSBIOS_KNL_CLOCK_H_ */
@@ -0,0 +1,41 @@
+/*
+ *  ======== ti/sysbios/knl/Event.h ========
+ *
+ *  Host build, see HostKernel.h.
+ */
+
+#ifndef HOST_TI_SYSBIOS_KNL_EVENT_H_
+#define HOST_TI_SYSBIOS_KNL_EVENT_H_
+
+#include <pthread.h>
+#include <xdc/std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int unused;
+} Event_Params;
+
+typedef struct {
+    pthread_cond_t cond;
+    UInt posted;
+} Event_Struct;
+
+typedef Event_Struct* Event_Handle;
+
+void Event_Params_init(Event_Params* params);
+void Event_construct(Event_Struct* event, const Event_Params* params);
+
+/* Waits for all of andMask or any of orMask, see the TI-RTOS documentation */
+UInt Event_pend(Event_Handle event, UInt andMask, UInt orMask, UInt32 timeout);
+void Event_post(Event_Handle event, UInt eventMask);
+
+#define Event_handle(event) (event)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_SYSBIOS_KNL_EVENT_H_ */
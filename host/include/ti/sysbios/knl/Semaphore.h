@@ -0,0 +1,40 @@
+/*
+ *  ======== ti/sysbios/knl/Semaphore.h ========
+ *
+ *  Host build, see HostKernel.h. Only counting semaphores.
+ */
+
+#ifndef HOST_TI_SYSBIOS_KNL_SEMAPHORE_H_
+#define HOST_TI_SYSBIOS_KNL_SEMAPHORE_H_
+
+#include <pthread.h>
+#include <xdc/std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int unused;
+} Semaphore_Params;
+
+typedef struct {
+    pthread_cond_t cond;
+    Int count;
+} Semaphore_Struct;
+
+typedef Semaphore_Struct* Semaphore_Handle;
+
+void Semaphore_Params_init(Semaphore_Params* params);
+void Semaphore_construct(Semaphore_Struct* sem, Int count, const Semaphore_Params* params);
+Bool Semaphore_pend(Semaphore_Handle sem, UInt32 timeout);
+void Semaphore_post(Semaphore_Handle sem);
+Int Semaphore_getCount(Semaphore_Handle sem);
+
+#define Semaphore_handle(sem) (sem)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_SYSBIOS_KNL_SEMAPHORE_H_ */
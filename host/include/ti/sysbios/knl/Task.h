@@ -0,0 +1,50 @@
+/*
+ *  ======== ti/sysbios/knl/Task.h ========
+ *
+ *  Host build: every task is a thread, see HostKernel.h. The stack given in
+ *  the params is not used.
+ */
+
+#ifndef HOST_TI_SYSBIOS_KNL_TASK_H_
+#define HOST_TI_SYSBIOS_KNL_TASK_H_
+
+#include <pthread.h>
+#include <xdc/std.h>
+#include <xdc/runtime/Error.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*Task_FuncPtr)(UArg arg0, UArg arg1);
+
+typedef struct {
+    size_t stackSize;
+    void* stack;
+    Int priority;
+    UArg arg0;
+    UArg arg1;
+} Task_Params;
+
+typedef struct {
+    pthread_t thread;
+    Task_FuncPtr fxn;
+    UArg arg0;
+    UArg arg1;
+    Int priority;
+} Task_Struct;
+
+typedef Task_Struct* Task_Handle;
+
+void Task_Params_init(Task_Params* params);
+void Task_construct(Task_Struct* task, Task_FuncPtr fxn, const Task_Params* params, Error_Block* eb);
+void Task_sleep(UInt32 ticks);
+void Task_yield(void);
+
+#define Task_handle(task) (task)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_TI_SYSBIOS_KNL_TASK_H_ */
@@ -0,0 +1,16 @@
+/*
+ *  ======== xdc/runtime/Error.h ========
+ */
+
+#ifndef HOST_XDC_RUNTIME_ERROR_H_
+#define HOST_XDC_RUNTIME_ERROR_H_
+
+#include <xdc/std.h>
+
+typedef struct {
+    int unused;
+} Error_Block;
+
+#define Error_init(eb) ((void)(eb))
+
+#endif /* HOST_XDC_RUNTIME_ERROR_H_ */
@@ -0,0 +1,26 @@
+/*
+ *  ======== xdc/runtime/System.h ========
+ *
+ *  Host build: System_abort ends the process, System_printf goes to stdout.
+ */
+
+#ifndef HOST_XDC_RUNTIME_SYSTEM_H_
+#define HOST_XDC_RUNTIME_SYSTEM_H_
+
+#include <stdio.h>
+#include <xdc/std.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void System_abort(const char* message);
+
+#define System_printf printf
+#define System_flush() fflush(stdout)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HOST_XDC_RUNTIME_SYSTEM_H_ */
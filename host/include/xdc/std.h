@@ -0,0 +1,35 @@
+/*
+ *  ======== xdc/std.h ========
+ *
+ *  Host build: the XDCtools base types used by the application.
+ */
+
+#ifndef HOST_XDC_STD_H_
+#define HOST_XDC_STD_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+typedef uintptr_t UArg;
+typedef int Int;
+typedef unsigned int UInt;
+typedef int32_t Int32;
+typedef uint32_t UInt32;
+typedef uint16_t UInt16;
+typedef uint8_t UInt8;
+typedef char Char;
+typedef unsigned char Bits8;
+typedef bool Bool;
+typedef void* Ptr;
+typedef void Void;
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+#ifndef FALSE
+#define FALSE 0
+#endif
+
+#endif /* HOST_XDC_STD_H_ */
@@ -0,0 +1,514 @@
+/*
+ *  ======== HostKernel.c ========
+ *
+ *  POSIX implementation of the TI-RTOS kernel objects the application uses,
+ *  see HostKernel.h for the execution model.
+ */
+
+/***** Includes *****/
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <xdc/std.h>
+#include <xdc/runtime/System.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Event.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Clock.h>
+#include <ti/drivers/rf/RF.h>
+
+#include "HostKernel.h"
+
+
+/***** Defines *****/
+/* Same as the TI-RTOS configuration of the projects */
+#define HOST_CLOCK_TICK_US      10
+
+#define HOST_RAT_TICKS_PER_US   4
+
+
+/***** Variable declarations *****/
+const UInt32 Clock_tickPeriod = HOST_CLOCK_TICK_US;
+
+static pthread_mutex_t cpuLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t timerCond;
+static pthread_cond_t startCond;
+static pthread_t timerThread;
+static HostTimer* timers;           /* Active timers, soonest first */
+static uint8_t started;             /* BIOS_start has been called */
+static uint32_t timeScale = 1;
+static uint64_t startUs;            /* Simulated time of Clock tick 0 */
+
+
+/***** Prototypes *****/
+static void setup(void) __attribute__((constructor));
+static void initCond(pthread_cond_t* cond);
+static int waitUntil(pthread_cond_t* cond, uint64_t deadlineUs);
+static uint64_t deadlineFromTicks(UInt32 timeout);
+static void* timerThreadFunction(void* arg);
+static void* taskThreadFunction(void* arg);
+static void clockTimeout(uintptr_t arg);
+static void startTasks(void);
+
+
+/***** Function definitions *****/
+/* Runs before main, which holds the CPU lock until BIOS_start like the target
+ * runs main with interrupts off */
+static void setup(void)
+{
+    timeScale = HostKernel_getEnvInt("HOST_TIME_SCALE", 1);
+    if (timeScale == 0)
+    {
+        timeScale = 1;
+    }
+
+    initCond(&timerCond);
+    initCond(&startCond);
+    startUs = HostKernel_now();
+
+    pthread_mutex_lock(&cpuLock);
+    if (pthread_create(&timerThread, NULL, timerThreadFunction, NULL) != 0)
+    {
+        System_abort("HostKernel: timer thread could not be started");
+    }
+}
+
+uint64_t HostKernel_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec) * timeScale) / 1000;
+}
+
+void HostKernel_lock(void)
+{
+    pthread_mutex_lock(&cpuLock);
+}
+
+void HostKernel_unlock(void)
+{
+    pthread_mutex_unlock(&cpuLock);
+}
+
+const char* HostKernel_getEnv(const char* name, const char* defaultValue)
+{
+    const char* value = getenv(name);
+
+    return ((value != NULL) && (value[0] != '\0')) ? value : defaultValue;
+}
+
+uint32_t HostKernel_getEnvInt(const char* name, uint32_t defaultValue)
+{
+    const char* value = HostKernel_getEnv(name, NULL);
+
+    return (value != NULL) ? (uint32_t)strtoul(value, NULL, 0) : defaultValue;
+}
+
+void HostKernel_startTimer(HostTimer* timer, uint64_t expiryUs, HostTimer_Fxn fxn, uintptr_t arg)
+{
+    HostTimer** link = &timers;
+
+    HostKernel_stopTimer(timer);
+
+    timer->expiryUs = expiryUs;
+    timer->fxn = fxn;
+    timer->arg = arg;
+    timer->active = 1;
+
+    /* Keep the list sorted, timers with the same expiry run in start order */
+    while ((*link != NULL) && ((*link)->expiryUs <= expiryUs))
+    {
+        link = &(*link)->next;
+    }
+    timer->next = *link;
+    *link = timer;
+
+    /* The timer thread sleeps until the first timer, wake it up if this one
+     * is sooner */
+    if (timers == timer)
+    {
+        pthread_cond_signal(&timerCond);
+    }
+}
+
+void HostKernel_stopTimer(HostTimer* timer)
+{
+    HostTimer** link = &timers;
+
+    if (!timer->active)
+    {
+        return;
+    }
+
+    while (*link != NULL)
+    {
+        if (*link == timer)
+        {
+            *link = timer->next;
+            break;
+        }
+        link = &(*link)->next;
+    }
+    timer->active = 0;
+}
+
+void HostKernel_runFor(uint32_t ms)
+{
+    uint64_t endUs = HostKernel_now() + (uint64_t)ms * 1000;
+
+    startTasks();
+
+    /* Sleeping on a condition nobody signals gives up the CPU until then */
+    while (HostKernel_now() < endUs)
+    {
+        waitUntil(&startCond, endUs);
+    }
+}
+
+void BIOS_start(void)
+{
+    uint32_t runSeconds = HostKernel_getEnvInt("HOST_RUN_SECONDS", 0);
+
+    if (runSeconds != 0)
+    {
+        HostKernel_runFor(runSeconds * 1000);
+        fflush(NULL);
+        exit(0);
+    }
+
+    startTasks();
+    while (1)
+    {
+        pthread_cond_wait(&startCond, &cpuLock);
+    }
+}
+
+static void startTasks(void)
+{
+    startUs = HostKernel_now();
+    started = 1;
+    pthread_cond_broadcast(&startCond);
+}
+
+void System_abort(const char* message)
+{
+    fprintf(stderr, "System_abort: %s\n", message);
+    fflush(NULL);
+    abort();
+}
+
+uint32_t RF_getCurrentTime(void)
+{
+    return (uint32_t)(HostKernel_now() * HOST_RAT_TICKS_PER_US);
+}
+
+/* Timer thread, runs the expired timers with the CPU lock held */
+static void* timerThreadFunction(void* arg)
+{
+    HostTimer* timer;
+
+    pthread_mutex_lock(&cpuLock);
+    while (!started)
+    {
+        pthread_cond_wait(&startCond, &cpuLock);
+    }
+
+    while (1)
+    {
+        while ((timers != NULL) && (timers->expiryUs <= HostKernel_now()))
+        {
+            timer = timers;
+            timers = timer->next;
+            timer->active = 0;
+            timer->fxn(timer->arg);
+        }
+
+        if (timers != NULL)
+        {
+            waitUntil(&timerCond, timers->expiryUs);
+        }
+        else
+        {
+            pthread_cond_wait(&timerCond, &cpuLock);
+        }
+    }
+
+    return NULL;
+}
+
+/* Conditions wait on CLOCK_MONOTONIC, the clock HostKernel_now is based on */
+static void initCond(pthread_cond_t* cond)
+{
+    pthread_condattr_t attr;
+
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+/* Waits on cond with the CPU lock until signalled or the simulated time
+ * deadlineUs, returns 0 on timeout */
+static int waitUntil(pthread_cond_t* cond, uint64_t deadlineUs)
+{
+    struct timespec ts;
+    uint64_t ns = (deadlineUs * 1000) / timeScale;
+
+    ts.tv_sec = ns / 1000000000u;
+    ts.tv_nsec = ns % 1000000000u;
+
+    return pthread_cond_timedwait(cond, &cpuLock, &ts) != ETIMEDOUT;
+}
+
+/* Simulated time a wait of timeout Clock ticks ends at */
+static uint64_t deadlineFromTicks(UInt32 timeout)
+{
+    return HostKernel_now() + (uint64_t)timeout * HOST_CLOCK_TICK_US;
+}
+
+/*
+ *  ======== Task ========
+ */
+void Task_Params_init(Task_Params* params)
+{
+    params->stackSize = 0;
+    params->stack = NULL;
+    params->priority = 1;
+    params->arg0 = 0;
+    params->arg1 = 0;
+}
+
+void Task_construct(Task_Struct* task, Task_FuncPtr fxn, const Task_Params* params, Error_Block* eb)
+{
+    task->fxn = fxn;
+    task->arg0 = params->arg0;
+    task->arg1 = params->arg1;
+    task->priority = params->priority;
+
+    if (pthread_create(&task->thread, NULL, taskThreadFunction, task) != 0)
+    {
+        System_abort("Task_construct: thread could not be started");
+    }
+}
+
+static void* taskThreadFunction(void* arg)
+{
+    Task_Struct* task = (Task_Struct*)arg;
+
+    pthread_mutex_lock(&cpuLock);
+    while (!started)
+    {
+        pthread_cond_wait(&startCond, &cpuLock);
+    }
+
+    task->fxn(task->arg0, task->arg1);
+
+    pthread_mutex_unlock(&cpuLock);
+    return NULL;
+}
+
+void Task_sleep(UInt32 ticks)
+{
+    pthread_cond_t cond;
+    uint64_t deadlineUs = deadlineFromTicks(ticks);
+
+    initCond(&cond);
+    while (waitUntil(&cond, deadlineUs))
+    {
+        /* Spurious wake up */
+    }
+    pthread_cond_destroy(&cond);
+}
+
+void Task_yield(void)
+{
+    pthread_mutex_unlock(&cpuLock);
+    sched_yield();
+    pthread_mutex_lock(&cpuLock);
+}
+
+/*
+ *  ======== Event ========
+ */
+void Event_Params_init(Event_Params* params)
+{
+    params->unused = 0;
+}
+
+void Event_construct(Event_Struct* event, const Event_Params* params)
+{
+    initCond(&event->cond);
+    event->posted = 0;
+}
+
+UInt Event_pend(Event_Handle event, UInt andMask, UInt orMask, UInt32 timeout)
+{
+    uint64_t deadlineUs = deadlineFromTicks(timeout);
+    UInt matched;
+
+    while (1)
+    {
+        /* All of andMask and, if given, any of orMask */
+        if (((event->posted & andMask) == andMask) &&
+            ((orMask == 0) || (event->posted & orMask)))
+        {
+            matched = event->posted & (andMask | orMask);
+            event->posted &= ~matched;
+            return matched;
+        }
+
+        if (timeout == BIOS_NO_WAIT)
+        {
+            return 0;
+        }
+        else if (timeout == BIOS_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&event->cond, &cpuLock);
+        }
+        else if (!waitUntil(&event->cond, deadlineUs))
+        {
+            return 0;
+        }
+    }
+}
+
+void Event_post(Event_Handle event, UInt eventMask)
+{
+    event->posted |= eventMask;
+    pthread_cond_broadcast(&event->cond);
+}
+
+/*
+ *  ======== Semaphore ========
+ */
+void Semaphore_Params_init(Semaphore_Params* params)
+{
+    params->unused = 0;
+}
+
+void Semaphore_construct(Semaphore_Struct* sem, Int count, const Semaphore_Params* params)
+{
+    initCond(&sem->cond);
+    sem->count = count;
+}
+
+Bool Semaphore_pend(Semaphore_Handle sem, UInt32 timeout)
+{
+    uint64_t deadlineUs = deadlineFromTicks(timeout);
+
+    while (sem->count == 0)
+    {
+        if (timeout == BIOS_NO_WAIT)
+        {
+            return FALSE;
+        }
+        else if (timeout == BIOS_WAIT_FOREVER)
+        {
+            pthread_cond_wait(&sem->cond, &cpuLock);
+        }
+        else if ((!waitUntil(&sem->cond, deadlineUs)) && (sem->count == 0))
+        {
+            return FALSE;
+        }
+    }
+
+    sem->count--;
+    return TRUE;
+}
+
+void Semaphore_post(Semaphore_Handle sem)
+{
+    sem->count++;
+    pthread_cond_signal(&sem->cond);
+}
+
+Int Semaphore_getCount(Semaphore_Handle sem)
+{
+    return sem->count;
+}
+
+/*
+ *  ======== Clock ========
+ */
+void Clock_Params_init(Clock_Params* params)
+{
+    params->period = 0;
+    params->startFlag = FALSE;
+    params->arg = 0;
+}
+
+void Clock_construct(Clock_Struct* clock, Clock_FuncPtr fxn, UInt timeout, const Clock_Params* params)
+{
+    clock->timer.active = 0;
+    clock->timer.next = NULL;
+    clock->fxn = fxn;
+    clock->arg = params->arg;
+    clock->timeout = timeout;
+    clock->period = params->period;
+
+    if (params->startFlag)
+    {
+        Clock_start(clock);
+    }
+}
+
+void Clock_start(Clock_Handle clock)
+{
+    HostKernel_startTimer(&clock->timer, deadlineFromTicks(clock->timeout), clockTimeout, (uintptr_t)clock);
+}
+
+void Clock_stop(Clock_Handle clock)
+{
+    HostKernel_stopTimer(&clock->timer);
+}
+
+void Clock_setTimeout(Clock_Handle clock, UInt32 timeout)
+{
+    clock->timeout = timeout;
+}
+
+void Clock_setPeriod(Clock_Handle clock, UInt32 period)
+{
+    clock->period = period;
+}
+
+UInt32 Clock_getTimeout(Clock_Handle clock)
+{
+    uint64_t now = HostKernel_now();
+
+    if ((!clock->timer.active) || (clock->timer.expiryUs <= now))
+    {
+        return 0;
+    }
+    return (UInt32)((clock->timer.expiryUs - now) / HOST_CLOCK_TICK_US);
+}
+
+Bool Clock_isActive(Clock_Handle clock)
+{
+    return clock->timer.active;
+}
+
+UInt32 Clock_getTicks(void)
+{
+    return (UInt32)((HostKernel_now() - startUs) / HOST_CLOCK_TICK_US);
+}
+
+static void clockTimeout(uintptr_t arg)
+{
+    Clock_Struct* clock = (Clock_Struct*)arg;
+
+    /* Periodic clocks are restarted from their own expiry so they do not
+     * drift, before the function runs so it can stop them */
+    if (clock->period != 0)
+    {
+        HostKernel_startTimer(&clock->timer, clock->timer.expiryUs + (uint64_t)clock->period * HOST_CLOCK_TICK_US,
+                              clockTimeout, arg);
+    }
+
+    clock->fxn(clock->arg);
+}
@@ -0,0 +1,309 @@
+/*
+ *  ======== SceAdcSim.c ========
+ *
+ *  Host build: the SceAdc.h API without the Sensor Controller. A Clock runs
+ *  the same steps as the execution code of sce/adc_sample.scp, oversampling,
+ *  IIR filter, bins with hysteresis, minimum report interval, adaptive rate
+ *  and samplesPerAlert, on a simulated thermistor. The callback runs from
+ *  the Clock, as it runs from the alert interrupt on the target.
+ *
+ *  The temperature swings around HOST_SENSOR_CENTI_C, default 2000 plus 100
+ *  per HOST_RADIO_ID so the nodes differ, by HOST_SENSOR_SWING_CENTI_C,
+ *  default 300, with a period of HOST_SENSOR_PERIOD_S seconds, default 600.
+ *  Every ADC reading has up to HOST_SENSOR_NOISE_ADC counts of noise,
+ *  default 4.
+ */
+
+/***** Includes *****/
+#include <math.h>
+#include <stdlib.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/knl/Clock.h>
+
+#include "SceAdc.h"
+#include "TempConversion.h"
+#include "HostKernel.h"
+
+
+/***** Defines *****/
+#define SCEADC_SIM_FRAC_BITS    3   /* FILTER_FRAC_BITS of the SCE task */
+
+
+/***** Variable declarations *****/
+static SceAdc_adcCallback adcCallback;
+static SceAdc_Sample samples[SCEADC_MAX_SAMPLES];
+static Clock_Struct sampleClock;
+static uint32_t samplingTime;
+uint32_t sceAdcOverflowCount;  /* not static so you can see in ROV */
+
+/* The configuration of the SCE task */
+static struct {
+    uint32_t minReportInterval;
+    uint16_t samplesPerAlert;
+    uint16_t maxRateShift;
+    uint16_t flatSamples;
+    uint16_t oversampleLog2;
+    uint16_t filterShift;
+    uint16_t hysteresis;
+    uint16_t pThresholds[SCEADC_BIN_COUNT + 1];
+    uint16_t rtcRateShift;
+} cfg;
+
+/* The state of the SCE task */
+static struct {
+    uint16_t rawAdcValue;
+    int16_t filterValueQ3;
+    uint8_t filterPrimed;
+    uint16_t binIndex;
+    uint32_t samplesSinceLastReport;
+    uint16_t reqRateShift;
+    uint16_t flatCount;
+    uint16_t tickCount;
+    uint16_t sampleCount;
+    uint16_t pSamples[SCEADC_MAX_SAMPLES];
+    uint16_t pSampleTicks[SCEADC_MAX_SAMPLES];
+} state;
+
+static int32_t sensorCentiC;
+static int32_t sensorSwingCentiC;
+static uint32_t sensorPeriodS;
+static uint32_t sensorNoise;
+
+
+/***** Prototypes *****/
+static void sampleClockFunction(UArg arg);
+static uint16_t readAdc(void);
+static void setClockPeriod(void);
+
+
+/***** Function definitions *****/
+void SceAdc_init(uint32_t newSamplingTime, uint32_t minReportInterval) {
+    Clock_Params clockParams;
+
+    sensorCentiC = HostKernel_getEnvInt("HOST_SENSOR_CENTI_C", 2000 + 100 * HostKernel_getEnvInt("HOST_RADIO_ID", 0));
+    sensorSwingCentiC = HostKernel_getEnvInt("HOST_SENSOR_SWING_CENTI_C", 300);
+    sensorPeriodS = HostKernel_getEnvInt("HOST_SENSOR_PERIOD_S", 600);
+    sensorNoise = HostKernel_getEnvInt("HOST_SENSOR_NOISE_ADC", 4);
+
+    samplingTime = newSamplingTime;
+    cfg.minReportInterval = minReportInterval;
+    cfg.samplesPerAlert = 1;
+    cfg.maxRateShift = 0;
+    cfg.flatSamples = 1;
+    SceAdc_setThresholds(NULL, 0, 0);
+
+    Clock_Params_init(&clockParams);
+    Clock_construct(&sampleClock, sampleClockFunction, 1, &clockParams);
+    setClockPeriod();
+}
+
+void SceAdc_setReportInterval(uint32_t minReportInterval) {
+    cfg.minReportInterval = minReportInterval;
+}
+
+void SceAdc_setSamplingTime(uint32_t newSamplingTime) {
+    samplingTime = newSamplingTime;
+    setClockPeriod();
+}
+
+void SceAdc_setAdaptiveRate(uint8_t maxRateShift, uint16_t flatSamples) {
+    if (maxRateShift > SCEADC_MAX_RATE_SHIFT) {
+        maxRateShift = SCEADC_MAX_RATE_SHIFT;
+    }
+    if (flatSamples == 0) {
+        flatSamples = 1;
+    }
+
+    cfg.flatSamples = flatSamples;
+    cfg.maxRateShift = maxRateShift;
+}
+
+void SceAdc_setThresholds(const uint16_t* thresholds, uint8_t count, uint16_t hysteresis) {
+    uint8_t i;
+
+    if (count > SCEADC_MAX_THRESHOLDS) {
+        count = SCEADC_MAX_THRESHOLDS;
+    }
+
+    cfg.hysteresis = hysteresis;
+    cfg.pThresholds[0] = 0;
+    for (i = 0; i < SCEADC_MAX_THRESHOLDS; i++) {
+        if ((i < count) && (thresholds[i] < SCEADC_MAX_ADC_VALUE)) {
+            cfg.pThresholds[i + 1] = thresholds[i];
+        } else {
+            cfg.pThresholds[i + 1] = SCEADC_MAX_ADC_VALUE;
+        }
+    }
+    cfg.pThresholds[SCEADC_BIN_COUNT] = SCEADC_MAX_ADC_VALUE;
+}
+
+void SceAdc_setFilter(uint8_t oversampleLog2, uint8_t filterShift) {
+    if (oversampleLog2 > SCEADC_MAX_OVERSAMPLE_LOG2) {
+        oversampleLog2 = SCEADC_MAX_OVERSAMPLE_LOG2;
+    }
+    if (filterShift > SCEADC_MAX_FILTER_SHIFT) {
+        filterShift = SCEADC_MAX_FILTER_SHIFT;
+    }
+
+    cfg.oversampleLog2 = oversampleLog2;
+    cfg.filterShift = filterShift;
+}
+
+uint16_t SceAdc_getRawValue(void) {
+    return state.rawAdcValue;
+}
+
+void SceAdc_setSamplesPerAlert(uint8_t samplesPerAlert) {
+    if (samplesPerAlert == 0) {
+        samplesPerAlert = 1;
+    }
+    if (samplesPerAlert > SCEADC_MAX_SAMPLES) {
+        samplesPerAlert = SCEADC_MAX_SAMPLES;
+    }
+
+    cfg.samplesPerAlert = samplesPerAlert;
+}
+
+void SceAdc_start(void) {
+    Clock_start(Clock_handle(&sampleClock));
+}
+
+void SceAdc_registerAdcCallback(SceAdc_adcCallback callback) {
+    adcCallback = callback;
+}
+
+/* The sampling period in Clock ticks, samplingTime is in 1/65536 s */
+static void setClockPeriod(void) {
+    uint64_t periodUs = (((uint64_t)samplingTime << cfg.rtcRateShift) * 1000000) >> 16;
+    uint32_t period = periodUs / Clock_tickPeriod;
+
+    Clock_setPeriod(Clock_handle(&sampleClock), (period != 0) ? period : 1);
+}
+
+/* One execution of the SCE task */
+static void sampleClockFunction(UArg arg) {
+    uint16_t readingCount = 1 << cfg.oversampleLog2;
+    uint32_t adcSum = 0;
+    uint16_t adcValue;
+    uint16_t binIndex;
+    uint16_t rateShift;
+    uint8_t reportSample = 0;
+    uint8_t switchBuffer = 0;
+    uint8_t rateAlert = 0;
+    uint8_t count;
+    uint16_t ticks;
+    int16_t sampleQ3;
+    uint16_t n;
+
+    for (n = 0; n < readingCount; n++) {
+        adcSum += readAdc();
+    }
+    state.rawAdcValue = adcSum >> cfg.oversampleLog2;
+
+    sampleQ3 = state.rawAdcValue << SCEADC_SIM_FRAC_BITS;
+    if (!state.filterPrimed) {
+        state.filterValueQ3 = sampleQ3;
+        state.filterPrimed = 1;
+    }
+    state.filterValueQ3 += (int16_t)(sampleQ3 - state.filterValueQ3) >> cfg.filterShift;
+    adcValue = (state.filterValueQ3 + (1 << (SCEADC_SIM_FRAC_BITS - 1))) >> SCEADC_SIM_FRAC_BITS;
+
+    /* Bins with hysteresis */
+    binIndex = state.binIndex;
+    while ((binIndex < (SCEADC_BIN_COUNT - 1)) &&
+           (adcValue >= (cfg.pThresholds[binIndex + 1] + cfg.hysteresis))) {
+        binIndex++;
+    }
+    while ((binIndex > 0) && ((adcValue + cfg.hysteresis) < cfg.pThresholds[binIndex])) {
+        binIndex--;
+    }
+
+    if (binIndex != state.binIndex) {
+        reportSample = 1;
+        state.samplesSinceLastReport = 0;
+    } else {
+        state.samplesSinceLastReport += 1 << cfg.rtcRateShift;
+    }
+
+    /* Adaptive rate, the new rate only applies once the driver has moved the clock */
+    rateShift = state.reqRateShift;
+    if (binIndex != state.binIndex) {
+        rateShift = 0;
+        state.flatCount = 0;
+    } else if (++state.flatCount >= cfg.flatSamples) {
+        state.flatCount = 0;
+        if (rateShift < cfg.maxRateShift) {
+            rateShift++;
+        }
+    }
+    if (rateShift > cfg.maxRateShift) {
+        rateShift = cfg.maxRateShift;
+    }
+    state.binIndex = binIndex;
+
+    if ((cfg.minReportInterval != 0) && (state.samplesSinceLastReport >= cfg.minReportInterval)) {
+        reportSample = 1;
+        state.samplesSinceLastReport = 0;
+    }
+
+    if (reportSample) {
+        state.pSamples[state.sampleCount] = adcValue;
+        state.pSampleTicks[state.sampleCount] = state.tickCount;
+        state.sampleCount++;
+    }
+    if ((state.sampleCount >= cfg.samplesPerAlert) || (state.sampleCount >= SCEADC_MAX_SAMPLES)) {
+        switchBuffer = 1;
+    }
+    if (rateShift != state.reqRateShift) {
+        state.reqRateShift = rateShift;
+        rateAlert = 1;
+        switchBuffer = 1;
+    }
+
+    if (switchBuffer) {
+        count = state.sampleCount;
+        for (n = 0; n < count; n++) {
+            ticks = state.pSampleTicks[count - 1] - state.pSampleTicks[n];
+            samples[n].adcValue = state.pSamples[n];
+            samples[n].ageMs = (uint32_t)(((uint64_t)ticks * samplingTime * 1000) >> 16);
+        }
+        state.sampleCount = 0;
+
+        if (adcCallback && (count > 0)) {
+            adcCallback(samples, count);
+        }
+    }
+
+    state.tickCount += 1 << cfg.rtcRateShift;
+
+    /* The driver moves the clock to the requested rate and acknowledges it */
+    if (rateAlert && (cfg.rtcRateShift != state.reqRateShift)) {
+        cfg.rtcRateShift = state.reqRateShift;
+        setClockPeriod();
+    }
+}
+
+/* One reading of the simulated thermistor */
+static uint16_t readAdc(void) {
+    double seconds = (double)Clock_getTicks() * Clock_tickPeriod / 1000000;
+    int32_t centiC = sensorCentiC;
+    int32_t adcValue;
+
+    if (sensorPeriodS != 0) {
+        centiC += (int32_t)(sensorSwingCentiC * sin(2 * M_PI * seconds / sensorPeriodS));
+    }
+
+    adcValue = TempConversion_toAdc(centiC, 0);
+    if (sensorNoise != 0) {
+        adcValue += (rand() % (2 * sensorNoise + 1)) - (int32_t)sensorNoise;
+    }
+
+    if (adcValue < 0) {
+        adcValue = 0;
+    } else if (adcValue > SCEADC_MAX_ADC_VALUE) {
+        adcValue = SCEADC_MAX_ADC_VALUE;
+    }
+
+    return adcValue;
+}
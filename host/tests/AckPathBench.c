@@ -0,0 +1,347 @@
+/*
+ *  ======== AckPathBench.c ========
+ *
+ *  Host benchmark of the time the concentrator's radio is deaf after a
+ *  packet, from the end of the received frame to the Rx being armed again,
+ *  with the three ways the radio task has acked packets:
+ *
+ *   rearm     before continuous Rx: a single EasyLink_receiveAsync per
+ *             packet, the task sends the ack with the blocking
+ *             EasyLink_transmit, calls the packet received callback and
+ *             only then arms the next Rx
+ *   blocking  continuous Rx, the blocking ack then the callback, so the
+ *             callback holds the next ack back
+ *   async     continuous Rx, the ack goes out with EasyLink_transmitAsync
+ *             and the callback runs while it is on air
+ *
+ *  The bench starts a copy of itself as a second radio that sends a
+ *  DualModeSensorPacket every BENCH_PERIOD_MS. The packet received
+ *  callback is modelled by the task sleeping BENCH_CALLBACK_US, as on the
+ *  target the radio interrupts still run meanwhile. For each way it reads
+ *  hostRadioRxBlind, which EasyLinkUdp.c keeps from the frame end to the
+ *  next Rx arm, the time the task spends on each packet and the packets
+ *  missed while deaf. Fails if a frame is corrupted, if async leaves the
+ *  radio deaf longer than rearm, or if async keeps the task longer than
+ *  blocking.
+ *
+ *  usage: AckPathBench [frames]
+ */
+
+/***** Includes *****/
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Clock.h>
+
+#include "easylink/EasyLink.h"
+#include "RadioProtocol.h"
+#include "PacketRing.h"
+#include "HostKernel.h"
+
+
+/***** Defines *****/
+#define BENCH_DEFAULT_FRAMES    200
+#define BENCH_WARMUP_FRAMES     5
+#define BENCH_SENDER_ADDRESS    0x01
+#define BENCH_PERIOD_MS         30
+#define BENCH_CALLBACK_US       5000
+#define BENCH_TIMEOUT_MS        60000
+#define BENCH_TASK_STACK_SIZE   4096
+
+
+/***** Type declarations *****/
+enum BenchAckPath {
+    BenchAckPath_Rearm,
+    BenchAckPath_Blocking,
+    BenchAckPath_Async,
+    BenchAckPath_Count,
+};
+
+struct BenchResult {
+    struct HostRadioRxBlind blind;
+    uint32_t packets;
+    uint32_t missed;
+    uint64_t taskUs;
+};
+
+
+/***** Variable declarations *****/
+static const char* const ackPathNames[BenchAckPath_Count] = { "rearm", "blocking", "async" };
+static Task_Struct benchTask;
+static uint8_t benchTaskStack[BENCH_TASK_STACK_SIZE];
+static Semaphore_Struct rxSem;
+static Semaphore_Struct ackSem;
+static struct PacketRing ring;
+static uint32_t frameCount;
+static uint32_t errorCount;
+static pid_t sender;
+
+
+/***** Prototypes *****/
+static void receiverTaskFunction(UArg arg0, UArg arg1);
+static void senderTaskFunction(UArg arg0, UArg arg1);
+static uint8_t runAckPath(enum BenchAckPath path, struct BenchResult* result);
+static void sendAck(enum BenchAckPath path, const struct DualModeSensorPacket* packet);
+static void rxDone(EasyLink_RxPacket* rxPacket, EasyLink_Status status);
+static void ackDone(EasyLink_Status status);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    Task_Params taskParams;
+    Task_FuncPtr taskFunction = receiverTaskFunction;
+
+    if ((argc > 1) && (strcmp(argv[1], "send") == 0))
+    {
+        taskFunction = senderTaskFunction;
+    }
+    else
+    {
+        frameCount = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_FRAMES;
+
+        /* The sender is the next radio, it stops when the bench does */
+        sender = fork();
+        if (sender == 0)
+        {
+            setenv("HOST_RADIO_ID", "1", 1);
+            execl("/proc/self/exe", argv[0], "send", (char*)NULL);
+            _exit(1);
+        }
+    }
+
+    if (EasyLink_init(EasyLink_Phy_50kbps2gfsk) != EasyLink_Status_Success)
+    {
+        printf("EasyLink_init failed\n");
+        return 1;
+    }
+
+    Semaphore_construct(&rxSem, 0, NULL);
+    Semaphore_construct(&ackSem, 0, NULL);
+    PacketRing_init(&ring);
+
+    Task_Params_init(&taskParams);
+    taskParams.stackSize = BENCH_TASK_STACK_SIZE;
+    taskParams.stack = &benchTaskStack;
+    Task_construct(&benchTask, taskFunction, &taskParams, NULL);
+
+    BIOS_start();
+
+    return 0;
+}
+
+static void receiverTaskFunction(UArg arg0, UArg arg1)
+{
+    struct BenchResult results[BenchAckPath_Count];
+    uint8_t p;
+
+    for (p = 0; p < BenchAckPath_Count; p++)
+    {
+        if (!runAckPath((enum BenchAckPath)p, &results[p]))
+        {
+            errorCount++;
+            break;
+        }
+    }
+
+    kill(sender, SIGTERM);
+    waitpid(sender, NULL, 0);
+
+    if (errorCount == 0)
+    {
+        for (p = 0; p < BenchAckPath_Count; p++)
+        {
+            printf("%s: %u packets, %u missed, deaf %.0f us/packet, at most %u us, task %.0f us/packet\n",
+                   ackPathNames[p], results[p].blind.windows, results[p].missed,
+                   (double)results[p].blind.blindUs / results[p].blind.windows, results[p].blind.blindMaxUs,
+                   (double)results[p].taskUs / results[p].packets);
+        }
+
+        if (results[BenchAckPath_Async].blind.blindUs * results[BenchAckPath_Rearm].blind.windows >
+            results[BenchAckPath_Rearm].blind.blindUs * results[BenchAckPath_Async].blind.windows)
+        {
+            printf("async leaves the radio deaf longer than rearm\n");
+            errorCount++;
+        }
+        if (results[BenchAckPath_Async].taskUs * results[BenchAckPath_Blocking].packets >
+            results[BenchAckPath_Blocking].taskUs * results[BenchAckPath_Async].packets)
+        {
+            printf("async keeps the task longer than blocking\n");
+            errorCount++;
+        }
+    }
+
+    fflush(stdout);
+    exit((errorCount == 0) ? 0 : 1);
+}
+
+/* Acks [frames] packets one way, returns 0 if the Rx stopped */
+static uint8_t runAckPath(enum BenchAckPath path, struct BenchResult* result)
+{
+    struct PacketRingEntry* entry;
+    struct DualModeSensorPacket packet;
+    uint32_t received = 0;
+    uint16_t expected = 0;
+    uint64_t startUs;
+
+    memset(result, 0, sizeof(*result));
+
+    if ((path != BenchAckPath_Rearm) && (EasyLink_receiveContinuousAsync(rxDone, 0) != EasyLink_Status_Success))
+    {
+        printf("%s: continuous Rx did not start\n", ackPathNames[path]);
+        return 0;
+    }
+
+    while (received < frameCount + BENCH_WARMUP_FRAMES)
+    {
+        if ((path == BenchAckPath_Rearm) && (EasyLink_receiveAsync(rxDone, 0) != EasyLink_Status_Success))
+        {
+            printf("%s: Rx did not start\n", ackPathNames[path]);
+            return 0;
+        }
+
+        if (!Semaphore_pend(Semaphore_handle(&rxSem), BENCH_TIMEOUT_MS * 1000 / Clock_tickPeriod))
+        {
+            printf("%s: %u of %u frames received\n", ackPathNames[path], received, frameCount);
+            EasyLink_abort();
+            return 0;
+        }
+
+        startUs = HostKernel_now();
+        while ((entry = PacketRing_peek(&ring)) != NULL)
+        {
+            packet = entry->packet.dmSensorPacket;
+            PacketRing_release(&ring);
+
+            /* The sender numbers its packets, a gap is a packet the radio
+             * missed while it was deaf */
+            if (received != 0)
+            {
+                result->missed += (uint16_t)(packet.adcValue - expected);
+            }
+            expected = packet.adcValue + 1;
+
+            sendAck(path, &packet);
+            received++;
+            result->packets++;
+        }
+        result->taskUs += HostKernel_now() - startUs;
+
+        /* The first packets line the sender and the receiver up */
+        if (received == BENCH_WARMUP_FRAMES)
+        {
+            memset(result, 0, sizeof(*result));
+            memset(&hostRadioRxBlind, 0, sizeof(hostRadioRxBlind));
+        }
+    }
+
+    EasyLink_abort();
+
+    /* The window of the last packet closes when the next way arms the Rx,
+     * outside these counts */
+    result->blind = hostRadioRxBlind;
+    memset(&hostRadioRxBlind, 0, sizeof(hostRadioRxBlind));
+
+    return 1;
+}
+
+/* What the radio task does with each packet, the callback is a sleep */
+static void sendAck(enum BenchAckPath path, const struct DualModeSensorPacket* packet)
+{
+    static EasyLink_TxPacket txPacket;
+    struct AckPacket ackPacket;
+
+    memset(&ackPacket, 0, sizeof(ackPacket));
+    ackPacket.header.sourceAddress = RADIO_CONCENTRATOR_ADDRESS;
+    ackPacket.header.packetType = RADIO_PACKET_TYPE_ACK_PACKET;
+    ackPacket.slot = RADIO_TDMA_NO_SLOT;
+    ackPacket.channel = RADIO_CHANNEL_ANY;
+    ackPacket.config.version = RADIO_CONFIG_NO_VERSION;
+
+    txPacket.dstAddr[0] = packet->header.sourceAddress;
+    txPacket.len = RadioProtocol_packAckPacket(&ackPacket, txPacket.payload);
+
+    if (path == BenchAckPath_Async)
+    {
+        if (EasyLink_transmitAsync(&txPacket, ackDone) != EasyLink_Status_Success)
+        {
+            errorCount++;
+            return;
+        }
+        Task_sleep(BENCH_CALLBACK_US / Clock_tickPeriod);
+        Semaphore_pend(Semaphore_handle(&ackSem), BIOS_WAIT_FOREVER);
+    }
+    else
+    {
+        if (EasyLink_transmit(&txPacket) != EasyLink_Status_Success)
+        {
+            errorCount++;
+        }
+        Task_sleep(BENCH_CALLBACK_US / Clock_tickPeriod);
+    }
+}
+
+/* The second radio, sends a numbered sensor packet every BENCH_PERIOD_MS */
+static void senderTaskFunction(UArg arg0, UArg arg1)
+{
+    static EasyLink_TxPacket txPacket;
+    struct DualModeSensorPacket packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.header.sourceAddress = BENCH_SENDER_ADDRESS;
+    packet.header.packetType = RADIO_PACKET_TYPE_DM_SENSOR_PACKET;
+    txPacket.dstAddr[0] = RADIO_CONCENTRATOR_ADDRESS;
+
+    while (1)
+    {
+        packet.adcValue++;
+        packet.time100MiliSec = ~(uint32_t)packet.adcValue;
+        txPacket.len = RadioProtocol_packDmSensorPacket(&packet, txPacket.payload);
+        EasyLink_transmit(&txPacket);
+        Task_sleep(BENCH_PERIOD_MS * 1000 / Clock_tickPeriod);
+    }
+}
+
+/* The radio task's Rx callback, decodes into the ring and wakes the task */
+static void rxDone(EasyLink_RxPacket* rxPacket, EasyLink_Status status)
+{
+    struct PacketRingEntry* entry;
+
+    if (status == EasyLink_Status_Success)
+    {
+        entry = PacketRing_reserve(&ring);
+        if ((entry == NULL) ||
+            !RadioProtocol_unpackDmSensorPacket(rxPacket->payload, rxPacket->len, &entry->packet.dmSensorPacket) ||
+            (entry->packet.dmSensorPacket.time100MiliSec != ~(uint32_t)entry->packet.dmSensorPacket.adcValue))
+        {
+            errorCount++;
+        }
+        else
+        {
+            PacketRing_commit(&ring);
+        }
+    }
+
+    /* A single Rx that ended without a packet is armed again by the task */
+    if ((status == EasyLink_Status_Success) || (status == EasyLink_Status_Rx_Error))
+    {
+        Semaphore_post(Semaphore_handle(&rxSem));
+    }
+}
+
+static void ackDone(EasyLink_Status status)
+{
+    if (status != EasyLink_Status_Success)
+    {
+        errorCount++;
+    }
+    Semaphore_post(Semaphore_handle(&ackSem));
+}
@@ -0,0 +1,465 @@
+/*
+ *  ======== CcaSim.c ========
+ *
+ *  Host simulation of collision losses with many nodes reporting to one
+ *  concentrator, with the two ways the node has sent:
+ *
+ *   plain  the old NodeRadioTask: EasyLink_transmit as soon as a report
+ *          or a retry is due
+ *   cca    the current NodeRadioTask: EasyLink_transmitCommittedCCAAsync,
+ *          which senses the channel first and, while it is busy, backs off
+ *          a random number of EASYLINK_CCA_BACKOFF_TIMEUNITS in a window
+ *          of 2^EASYLINK_MIN_CCA_BACKOFF_WINDOW units that doubles up to
+ *          2^EASYLINK_MAX_CCA_BACKOFF_WINDOW, as EasyLink.c does. If the
+ *          channel is still busy after that the attempt fails.
+ *
+ *  The nodes are all in range of each other, so carrier sense hears every
+ *  frame that started SIM_CS_LATENCY_US before it, and a node starts its
+ *  frame SIM_RX_TX_US after it found the channel idle. With hidden nodes
+ *  carrier sense can do nothing, RetrySim covers that case. Any two frames
+ *  on the air at the same time are lost, acks included. The concentrator
+ *  acks a report a random 1 to 3 ms after it ends, without carrier sense.
+ *  A node waits NODERETRY_ACK_TIMEOUT_MS for the ack, and after a missed
+ *  ack or a busy failure retries up to NODERETRY_MAX_RETRIES times after
+ *  NodeRetry_backoffMs, as NodeRadioTask does. Reports come at random, on
+ *  average one every SIM_REPORT_PERIOD_US per node.
+ *
+ *  For both ways and a growing number of nodes the simulation prints the
+ *  delivery ratio, the share of the report frames lost to collisions, and
+ *  for cca the busy channel deferrals per report and the attempts that
+ *  failed on a busy channel. Fails if at the largest number of nodes cca
+ *  loses a larger share of its frames to collisions or delivers fewer
+ *  reports than plain.
+ *
+ *  usage: CcaSim [seconds]
+ */
+
+/***** Includes *****/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "easylink/EasyLink.h"
+#include "NodeRetry.h"
+
+
+/***** Defines *****/
+#define SIM_DEFAULT_SECONDS     3600
+#define SIM_MAX_NODES           256
+#define SIM_REPORT_PERIOD_US    2000000
+
+/* 50 kbps, the 11 bytes of preamble, sync word, length and CRC, the
+ * address and the packet */
+#define SIM_BIT_TIME_US         20
+#define SIM_FRAME_US(bytes)     ((11 + 1 + (bytes)) * 8 * SIM_BIT_TIME_US)
+#define SIM_REPORT_US           SIM_FRAME_US(11)
+#define SIM_ACK_US              SIM_FRAME_US(4)
+
+/* Task latency of the concentrator before the ack is sent */
+#define SIM_ACK_DELAY_MIN_US    1000
+#define SIM_ACK_DELAY_SPREAD_US 2000
+
+/* RSSI settling before a frame is sensed, and the turnaround from the
+ * carrier sense to the Tx */
+#define SIM_CS_LATENCY_US       100
+#define SIM_RX_TX_US            100
+
+/* Frames kept to find collisions with, far more than can overlap one */
+#define SIM_AIR_FRAMES          256
+#define SIM_MAX_EVENTS          (8 * SIM_MAX_NODES + SIM_AIR_FRAMES)
+
+
+/***** Type declarations *****/
+enum SimMode {
+    SimMode_Plain,
+    SimMode_Cca,
+};
+
+enum SimEventType {
+    SimEvent_Report,        /* A node has a new report */
+    SimEvent_Attempt,       /* A node senses the channel, or sends with plain */
+    SimEvent_TxEnd,         /* A frame ends */
+    SimEvent_AckStart,      /* The concentrator sends an ack */
+    SimEvent_AckTimeout,    /* The ack window of a node closes */
+};
+
+struct SimEvent {
+    uint64_t time;
+    enum SimEventType type;
+    uint16_t node;
+    uint16_t frame;
+    uint32_t attempt;
+};
+
+struct SimFrame {
+    uint64_t start;
+    uint64_t end;
+    uint16_t node;
+    uint8_t isAck;
+    uint32_t attempt;
+};
+
+struct SimNode {
+    uint32_t random;
+    uint32_t pending;       /* Reports waiting for the current one */
+    uint8_t active;
+    uint8_t delivered;      /* The concentrator has the current report */
+    uint8_t retriesDone;
+    uint8_t backoffExponent;
+    uint32_t attempt;       /* Ids the frames and the window of an attempt */
+    uint64_t txEnd;
+};
+
+struct SimResult {
+    uint32_t reports;
+    uint32_t delivered;
+    uint32_t frames;
+    uint32_t collided;
+    uint32_t deferrals;
+    uint32_t busyFails;
+};
+
+
+/***** Variable declarations *****/
+static enum SimMode mode;
+static uint16_t nodeCount;
+static struct SimNode nodes[SIM_MAX_NODES];
+static struct SimFrame air[SIM_AIR_FRAMES];
+static uint16_t airNext;
+static struct SimEvent events[SIM_MAX_EVENTS];
+static uint32_t eventCount;
+static uint32_t simRandom;
+static struct SimResult result;
+
+
+/***** Prototypes *****/
+static void run(enum SimMode simMode, uint16_t simNodes, uint64_t endUs);
+static void handle(const struct SimEvent* event);
+static void startAttempt(uint16_t n, uint64_t time);
+static void attemptFailed(uint16_t n, uint64_t now);
+static void finish(uint16_t n, uint64_t now);
+static uint8_t channelBusy(uint64_t now);
+static uint16_t addFrame(uint64_t start, uint32_t lengthUs, uint16_t node, uint8_t isAck, uint32_t attempt);
+static uint8_t collided(uint16_t f);
+static void push(uint64_t time, enum SimEventType type, uint16_t node, uint16_t frame, uint32_t attempt);
+static void pop(struct SimEvent* event);
+static uint32_t xorshift(uint32_t* state);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    static const uint16_t counts[] = { 16, 32, 64, 128, 256 };
+    uint64_t endUs = (uint64_t)((argc > 1) ? strtoul(argv[1], NULL, 0) : SIM_DEFAULT_SECONDS) * 1000000;
+    struct SimResult plain;
+    struct SimResult cca;
+    uint8_t i;
+
+    printf("%6s %10s %10s %12s %12s %12s %12s\n", "nodes", "plain", "cca", "plain lost", "cca lost",
+           "cca defer/r", "cca busy");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        run(SimMode_Plain, counts[i], endUs);
+        plain = result;
+        run(SimMode_Cca, counts[i], endUs);
+        cca = result;
+
+        printf("%6u %9.2f%% %9.2f%% %11.2f%% %11.2f%% %12.2f %11.2f%%\n", counts[i],
+               100.0 * plain.delivered / plain.reports, 100.0 * cca.delivered / cca.reports,
+               100.0 * plain.collided / plain.frames, 100.0 * cca.collided / cca.frames,
+               (double)cca.deferrals / cca.reports, 100.0 * cca.busyFails / (cca.frames + cca.busyFails));
+    }
+
+    /* Compared at the largest network, the last run */
+    if (((double)cca.collided / cca.frames > (double)plain.collided / plain.frames) ||
+        ((double)cca.delivered / cca.reports < (double)plain.delivered / plain.reports))
+    {
+        printf("carrier sense does no better than sending straight away\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+static void run(enum SimMode simMode, uint16_t simNodes, uint64_t endUs)
+{
+    struct SimEvent event;
+    uint16_t n;
+
+    mode = simMode;
+    nodeCount = simNodes;
+    memset(nodes, 0, sizeof(nodes));
+    memset(air, 0, sizeof(air));
+    memset(&result, 0, sizeof(result));
+    airNext = 0;
+    eventCount = 0;
+
+    /* Seeded the same for both ways */
+    simRandom = 0x2545F491 + simNodes;
+    for (n = 0; n < nodeCount; n++)
+    {
+        nodes[n].random = 0x9E3779B9 * (n + 1);
+        push(xorshift(&simRandom) % SIM_REPORT_PERIOD_US, SimEvent_Report, n, 0, 0);
+    }
+
+    while (eventCount > 0)
+    {
+        pop(&event);
+        if (event.time > endUs)
+        {
+            break;
+        }
+        handle(&event);
+    }
+
+    /* Reports still on their way are not counted */
+    for (n = 0; n < nodeCount; n++)
+    {
+        result.reports -= nodes[n].pending + nodes[n].active;
+        result.delivered -= nodes[n].active && nodes[n].delivered;
+    }
+}
+
+static void handle(const struct SimEvent* event)
+{
+    struct SimNode* node = &nodes[event->node];
+    const struct SimFrame* frame = &air[event->frame];
+    uint32_t backoffUs;
+
+    switch (event->type)
+    {
+    case SimEvent_Report:
+        /* On average one report every SIM_REPORT_PERIOD_US */
+        push(event->time + SIM_REPORT_PERIOD_US / 2 + xorshift(&simRandom) % SIM_REPORT_PERIOD_US,
+             SimEvent_Report, event->node, 0, 0);
+        result.reports++;
+        if (node->active)
+        {
+            node->pending++;
+        }
+        else
+        {
+            node->active = 1;
+            node->delivered = 0;
+            node->retriesDone = 0;
+            startAttempt(event->node, event->time);
+        }
+        break;
+
+    case SimEvent_Attempt:
+        if ((mode == SimMode_Cca) && channelBusy(event->time))
+        {
+            result.deferrals++;
+            if (node->backoffExponent > EASYLINK_MAX_CCA_BACKOFF_WINDOW)
+            {
+                result.busyFails++;
+                attemptFailed(event->node, event->time);
+            }
+            else
+            {
+                backoffUs = (xorshift(&node->random) & ((1 << node->backoffExponent++) - 1)) *
+                            EASYLINK_CCA_BACKOFF_TIMEUNITS;
+                push(event->time + backoffUs, SimEvent_Attempt, event->node, 0, event->attempt);
+            }
+            break;
+        }
+
+        /* Carrier sense turns around to Tx, the plain Tx starts at once */
+        backoffUs = (mode == SimMode_Cca) ? SIM_RX_TX_US : 0;
+        push(event->time + backoffUs + SIM_REPORT_US, SimEvent_TxEnd, event->node,
+             addFrame(event->time + backoffUs, SIM_REPORT_US, event->node, 0, event->attempt), event->attempt);
+        result.frames++;
+        break;
+
+    case SimEvent_TxEnd:
+        if (!frame->isAck)
+        {
+            /* The node listens for the ack, the concentrator acks a report
+             * it got */
+            node->txEnd = event->time;
+            push(event->time + (uint64_t)NODERETRY_ACK_TIMEOUT_MS * 1000, SimEvent_AckTimeout,
+                 event->node, 0, event->attempt);
+            if (collided(event->frame))
+            {
+                result.collided++;
+            }
+            else
+            {
+                node->delivered = 1;
+                push(event->time + SIM_ACK_DELAY_MIN_US + xorshift(&simRandom) % SIM_ACK_DELAY_SPREAD_US,
+                     SimEvent_AckStart, event->node, 0, event->attempt);
+            }
+        }
+        else if ((node->active) && (node->attempt == event->attempt) && !collided(event->frame))
+        {
+            finish(event->node, event->time);
+        }
+        break;
+
+    case SimEvent_AckStart:
+        /* An ack is heard if it starts within the window */
+        if ((node->active) && (node->attempt == event->attempt) &&
+            (event->time < node->txEnd + (uint64_t)NODERETRY_ACK_TIMEOUT_MS * 1000))
+        {
+            push(event->time + SIM_ACK_US, SimEvent_TxEnd, event->node,
+                 addFrame(event->time, SIM_ACK_US, event->node, 1, event->attempt), event->attempt);
+        }
+        else
+        {
+            /* Sent to a node that no longer listens */
+            addFrame(event->time, SIM_ACK_US, event->node, 1, 0);
+        }
+        break;
+
+    case SimEvent_AckTimeout:
+        if ((node->active) && (node->attempt == event->attempt))
+        {
+            attemptFailed(event->node, event->time);
+        }
+        break;
+    }
+}
+
+static void startAttempt(uint16_t n, uint64_t time)
+{
+    nodes[n].attempt++;
+    nodes[n].backoffExponent = EASYLINK_MIN_CCA_BACKOFF_WINDOW;
+    push(time, SimEvent_Attempt, n, 0, nodes[n].attempt);
+}
+
+/* No ack or a busy channel, retries after the node's back-off */
+static void attemptFailed(uint16_t n, uint64_t now)
+{
+    struct SimNode* node = &nodes[n];
+
+    if (node->retriesDone < NODERETRY_MAX_RETRIES)
+    {
+        node->retriesDone++;
+        startAttempt(n, now + (uint64_t)NodeRetry_backoffMs(node->retriesDone, xorshift(&node->random)) * 1000);
+    }
+    else
+    {
+        finish(n, now);
+    }
+}
+
+/* Ends the current report, acked or given up, and starts the next one */
+static void finish(uint16_t n, uint64_t now)
+{
+    struct SimNode* node = &nodes[n];
+
+    result.delivered += node->delivered;
+    node->attempt++;
+    node->active = 0;
+
+    if (node->pending > 0)
+    {
+        node->pending--;
+        node->active = 1;
+        node->delivered = 0;
+        node->retriesDone = 0;
+        startAttempt(n, now);
+    }
+}
+
+/* Carrier sense hears the frames that have been on the air long enough */
+static uint8_t channelBusy(uint64_t now)
+{
+    uint16_t i;
+
+    for (i = 0; i < SIM_AIR_FRAMES; i++)
+    {
+        if ((air[i].end > now) && (air[i].start + SIM_CS_LATENCY_US <= now))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static uint16_t addFrame(uint64_t start, uint32_t lengthUs, uint16_t node, uint8_t isAck, uint32_t attempt)
+{
+    uint16_t f = airNext;
+
+    air[f].start = start;
+    air[f].end = start + lengthUs;
+    air[f].node = node;
+    air[f].isAck = isAck;
+    air[f].attempt = attempt;
+    airNext = (airNext + 1) % SIM_AIR_FRAMES;
+
+    return f;
+}
+
+/* A frame is lost if any other frame was on the air at the same time */
+static uint8_t collided(uint16_t f)
+{
+    uint16_t i;
+
+    for (i = 0; i < SIM_AIR_FRAMES; i++)
+    {
+        if ((i != f) && (air[i].end > air[f].start) && (air[i].start < air[f].end))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Binary heap on the event time */
+static void push(uint64_t time, enum SimEventType type, uint16_t node, uint16_t frame, uint32_t attempt)
+{
+    uint32_t i = eventCount++;
+    struct SimEvent event = { time, type, node, frame, attempt };
+
+    if (eventCount > SIM_MAX_EVENTS)
+    {
+        printf("event queue full\n");
+        exit(1);
+    }
+
+    while ((i > 0) && (events[(i - 1) / 2].time > time))
+    {
+        events[i] = events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    events[i] = event;
+}
+
+static void pop(struct SimEvent* event)
+{
+    struct SimEvent last = events[--eventCount];
+    uint32_t i = 0;
+    uint32_t child;
+
+    *event = events[0];
+    while ((child = 2 * i + 1) < eventCount)
+    {
+        if ((child + 1 < eventCount) && (events[child + 1].time < events[child].time))
+        {
+            child++;
+        }
+        if (events[child].time >= last.time)
+        {
+            break;
+        }
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+}
+
+static uint32_t xorshift(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
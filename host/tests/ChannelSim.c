@@ -0,0 +1,355 @@
+/*
+ *  ======== ChannelSim.c ========
+ *
+ *  Host simulation of the TDMA channel plan, see RadioProtocol.h, with 1 to
+ *  RADIO_CHANNEL_COUNT channels and SIM_NODES_PER_CHANNEL nodes per channel
+ *  reporting to one concentrator, so the offered load grows with the
+ *  channels.
+ *
+ *  The concentrator runs one superframe per channel in turn, as in
+ *  ConcentratorRadioTask.c, and gives out the slots with its own
+ *  TdmaSchedule.c. A node without a slot sends in the contention period at
+ *  a random time, as in beaconReceived() of NodeRadioTask.c. The nodes do
+ *  not hear each other, so any two contention frames or acks on the air at
+ *  the same time are lost. The concentrator takes a slot for every node
+ *  whose report it gets, the node has it once the ack gets through. From
+ *  then on the node sends in its slot of the superframes on its channel,
+ *  which nobody else sends in. A report not acked is sent again in a later
+ *  superframe, up to NODERETRY_MAX_RETRIES times. Reports come at random,
+ *  on average one every SIM_REPORT_PERIOD_MS per node, into the
+ *  NODERADIO_TX_QUEUE_SIZE queue of the node.
+ *
+ *  Every load is run on all the channels and, for comparison, on one
+ *  channel. The concentrator has one radio, so it listens to
+ *  CONCENTRATOR_TDMA_SLOT_COUNT slots per superframe whatever the number of
+ *  channels. What the channels add are slots to give out: on one channel
+ *  the nodes beyond its slots collide in the contention period.
+ *
+ *  For every number of channels the simulation prints the offered load,
+ *  the goodput, the distinct reports the concentrator got per second, on
+ *  one channel and on all of them, the delivery ratio and the nodes that
+ *  hold a slot. Fails if the goodput does not grow with the channels, or
+ *  falls below SIM_MIN_SCALING_PERCENT of the goodput of one channel times
+ *  the channels.
+ *
+ *  usage: ChannelSim [seconds]
+ */
+
+/***** Includes *****/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "RadioProtocol.h"
+#include "TdmaSchedule.h"
+#include "NodeRadioTask.h"
+#include "NodeRetry.h"
+
+
+/***** Defines *****/
+#define SIM_DEFAULT_SECONDS     3600
+#define SIM_NODES_PER_CHANNEL   30
+#define SIM_MAX_NODES           (SIM_NODES_PER_CHANNEL * RADIO_CHANNEL_COUNT)
+#define SIM_REPORT_PERIOD_MS    8000
+#define SIM_MIN_SCALING_PERCENT 90
+
+#if SIM_MAX_NODES >= RADIO_UNJOINED_ADDRESS
+#error SIM_MAX_NODES does not fit the node addresses
+#endif
+
+/* 50 kbps, the 11 bytes of preamble, sync word, length and CRC, the
+ * address and the packet */
+#define SIM_BIT_TIME_US         20
+#define SIM_FRAME_US(bytes)     ((11 + 1 + (bytes)) * 8 * SIM_BIT_TIME_US)
+#define SIM_REPORT_US           SIM_FRAME_US(RADIO_DM_SENSOR_PACKET_SIZE)
+#define SIM_ACK_US              SIM_FRAME_US(RADIO_ACK_PACKET_SIZE)
+
+/* Task latency of the concentrator before the ack is sent */
+#define SIM_ACK_DELAY_MIN_US    1000
+#define SIM_ACK_DELAY_SPREAD_US 2000
+
+/* The random start of a contention frame, leaving a slot's time for the
+ * packet and its ack, as in beaconReceived() */
+#define SIM_CONTENTION_US       ((CONCENTRATOR_TDMA_SUPERFRAME_MS - RADIO_TDMA_FIRST_SLOT_OFFSET_MS - \
+                                  CONCENTRATOR_TDMA_SLOT_COUNT * CONCENTRATOR_TDMA_SLOT_MS - \
+                                  RADIO_TDMA_GUARD_MS - CONCENTRATOR_TDMA_SLOT_MS) * 1000)
+
+/* A report and an ack per contention sender */
+#define SIM_AIR_FRAMES          (2 * SIM_MAX_NODES)
+#define SIM_NO_FRAME            0xFFFF
+
+
+/***** Type declarations *****/
+struct SimNode {
+    uint32_t nextReportMs;
+    uint8_t queued;
+    uint8_t retriesDone;
+    uint8_t delivered;      /* The concentrator has the oldest report */
+    uint8_t slot;
+    uint8_t channel;
+    uint8_t ackSlot;        /* Slot and channel in the ack on its way */
+    uint8_t ackChannel;
+    uint8_t contending;     /* Sends in this contention period */
+    uint16_t reportFrame;
+    uint16_t ackFrame;      /* SIM_NO_FRAME if the report was lost */
+};
+
+struct SimFrame {
+    uint32_t start;
+    uint32_t end;
+};
+
+struct SimResult {
+    uint32_t reports;
+    uint32_t delivered;
+    uint32_t dropped;
+    uint16_t slotted;
+};
+
+
+/***** Variable declarations *****/
+static struct SimNode nodes[SIM_MAX_NODES];
+static uint16_t nodeCount;
+static struct TdmaSchedule schedule;
+static uint8_t channelMask;
+static struct SimFrame air[SIM_AIR_FRAMES];
+static uint16_t airCount;
+static uint32_t simRandom;
+
+
+/***** Prototypes *****/
+static struct SimResult run(uint16_t simNodes, uint8_t channelCount, uint32_t seconds);
+static void contention(void);
+static void ended(struct SimNode* node, struct SimResult* result);
+static uint16_t addFrame(uint32_t start, uint32_t lengthUs);
+static uint8_t collided(uint16_t f);
+static uint32_t xorshift(uint32_t* state);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    uint32_t seconds = (argc > 1) ? strtoul(argv[1], NULL, 0) : SIM_DEFAULT_SECONDS;
+    double goodput[RADIO_CHANNEL_COUNT + 1];
+    double single;
+    struct SimResult result;
+    uint32_t errors = 0;
+    uint16_t simNodes;
+    uint8_t c;
+
+    printf("%u nodes per channel, a report every %u ms on average\n", SIM_NODES_PER_CHANNEL, SIM_REPORT_PERIOD_MS);
+    printf("slots: %u per channel, the concentrator listens to %.1f per second\n",
+           CONCENTRATOR_TDMA_SLOT_COUNT, CONCENTRATOR_TDMA_SLOT_COUNT * 1000.0 / CONCENTRATOR_TDMA_SUPERFRAME_MS);
+    printf("%9s %6s %14s %14s %14s %10s %8s\n", "channels", "nodes", "offered rep/s",
+           "1 chan rep/s", "goodput rep/s", "delivered", "slotted");
+    for (c = 1; c <= RADIO_CHANNEL_COUNT; c++)
+    {
+        simNodes = c * SIM_NODES_PER_CHANNEL;
+        single = (double)run(simNodes, 1, seconds).delivered / seconds;
+        result = run(simNodes, c, seconds);
+        goodput[c] = (double)result.delivered / seconds;
+        printf("%9u %6u %14.2f %14.2f %14.2f %9.2f%% %8u\n", c, simNodes,
+               simNodes * 1000.0 / SIM_REPORT_PERIOD_MS, single, goodput[c],
+               100.0 * result.delivered / result.reports, result.slotted);
+
+        if ((c > 1) && (goodput[c] <= goodput[c - 1]))
+        {
+            printf("goodput does not grow from %u to %u channels\n", c - 1, c);
+            errors++;
+        }
+        if (goodput[c] * 100 < goodput[1] * c * SIM_MIN_SCALING_PERCENT)
+        {
+            printf("%u channels carry less than %u%% of %u times one\n", c, SIM_MIN_SCALING_PERCENT, c);
+            errors++;
+        }
+    }
+
+    return (errors == 0) ? 0 : 1;
+}
+
+static struct SimResult run(uint16_t simNodes, uint8_t channelCount, uint32_t seconds)
+{
+    struct SimResult result;
+    struct SimNode* node;
+    uint32_t superframe;
+    uint32_t nowMs;
+    uint8_t channel;
+    uint16_t n;
+
+    memset(&result, 0, sizeof(result));
+    memset(nodes, 0, sizeof(nodes));
+    memset(&schedule, 0, sizeof(schedule));
+    nodeCount = simNodes;
+    channelMask = (1 << channelCount) - 1;
+
+    /* The same traffic for every number of channels */
+    simRandom = 0x2545F491;
+    for (n = 0; n < nodeCount; n++)
+    {
+        nodes[n].nextReportMs = xorshift(&simRandom) % SIM_REPORT_PERIOD_MS;
+        nodes[n].slot = RADIO_TDMA_NO_SLOT;
+    }
+
+    for (superframe = 0; superframe < seconds * 1000 / CONCENTRATOR_TDMA_SUPERFRAME_MS; superframe++)
+    {
+        nowMs = superframe * CONCENTRATOR_TDMA_SUPERFRAME_MS;
+        channel = superframe % channelCount;
+        schedule.superframe++;
+
+        /* Reports that came in the last superframe, a full queue rejects
+         * them */
+        for (n = 0; n < nodeCount; n++)
+        {
+            node = &nodes[n];
+            while (node->nextReportMs <= nowMs)
+            {
+                node->nextReportMs += SIM_REPORT_PERIOD_MS / 2 + xorshift(&simRandom) % SIM_REPORT_PERIOD_MS;
+                result.reports++;
+                if (node->queued < NODERADIO_TX_QUEUE_SIZE)
+                {
+                    node->queued++;
+                }
+                else
+                {
+                    result.dropped++;
+                }
+            }
+        }
+
+        /* Slots on the channel of this superframe, the ack keeps the slot */
+        for (n = 0; n < nodeCount; n++)
+        {
+            node = &nodes[n];
+            node->contending = 0;
+            if ((node->queued > 0) && (node->slot != RADIO_TDMA_NO_SLOT) && (node->channel == channel))
+            {
+                node->slot = TdmaSchedule_getSlot(&schedule, n + 1, channelMask, &node->channel);
+                node->delivered = 1;
+                ended(node, &result);
+            }
+        }
+
+        contention();
+        for (n = 0; n < nodeCount; n++)
+        {
+            node = &nodes[n];
+            if (!node->contending)
+            {
+                continue;
+            }
+
+            /* The concentrator got the report, the ack gives the slot */
+            if (node->ackFrame != SIM_NO_FRAME)
+            {
+                node->delivered = 1;
+            }
+            if ((node->ackFrame != SIM_NO_FRAME) && !collided(node->ackFrame))
+            {
+                node->slot = node->ackSlot;
+                node->channel = node->ackChannel;
+                ended(node, &result);
+            }
+            else if (++node->retriesDone > NODERETRY_MAX_RETRIES)
+            {
+                ended(node, &result);
+            }
+        }
+    }
+
+    /* Reports still queued are not counted */
+    for (n = 0; n < nodeCount; n++)
+    {
+        result.reports -= nodes[n].queued;
+        result.slotted += (nodes[n].slot != RADIO_TDMA_NO_SLOT);
+    }
+    result.reports -= result.dropped;
+    result.dropped = 0;
+
+    return result;
+}
+
+/* The contention period of a superframe, with the reports of the nodes
+ * without a slot and the acks to the ones that got through */
+static void contention(void)
+{
+    uint32_t start;
+    struct SimNode* node;
+    uint16_t n;
+
+    airCount = 0;
+    for (n = 0; n < nodeCount; n++)
+    {
+        node = &nodes[n];
+        if ((node->queued > 0) && (node->slot == RADIO_TDMA_NO_SLOT))
+        {
+            node->contending = 1;
+            node->reportFrame = addFrame(xorshift(&simRandom) % SIM_CONTENTION_US, SIM_REPORT_US);
+        }
+    }
+
+    /* All reports are on the air before the acks can be sent */
+    for (n = 0; n < nodeCount; n++)
+    {
+        node = &nodes[n];
+        if (!node->contending)
+        {
+            continue;
+        }
+        if (collided(node->reportFrame))
+        {
+            node->ackFrame = SIM_NO_FRAME;
+        }
+        else
+        {
+            node->ackSlot = TdmaSchedule_getSlot(&schedule, n + 1, channelMask, &node->ackChannel);
+            start = air[node->reportFrame].end + SIM_ACK_DELAY_MIN_US + xorshift(&simRandom) % SIM_ACK_DELAY_SPREAD_US;
+            node->ackFrame = addFrame(start, SIM_ACK_US);
+        }
+    }
+}
+
+/* The oldest report of a node is acked or given up */
+static void ended(struct SimNode* node, struct SimResult* result)
+{
+    result->delivered += node->delivered;
+    node->delivered = 0;
+    node->retriesDone = 0;
+    node->queued--;
+}
+
+static uint16_t addFrame(uint32_t start, uint32_t lengthUs)
+{
+    air[airCount].start = start;
+    air[airCount].end = start + lengthUs;
+
+    return airCount++;
+}
+
+/* A frame is lost if any other frame was on the air at the same time */
+static uint8_t collided(uint16_t f)
+{
+    uint16_t i;
+
+    for (i = 0; i < airCount; i++)
+    {
+        if ((i != f) && (air[i].end > air[f].start) && (air[i].start < air[f].end))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static uint32_t xorshift(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
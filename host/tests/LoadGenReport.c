@@ -0,0 +1,73 @@
+/*
+ *  ======== LoadGenReport.c ========
+ *
+ *  Host build of concentrator_loadgen: prints loadGeneratorStats, which the
+ *  target shows in ROV, when the process exits after HOST_RUN_SECONDS. The
+ *  DWT cycle counter of the host shim counts host CPU cycles, so rxCycles is
+ *  the host cost of the receive callback per packet.
+ *
+ *  Exits with 1 if no packet reached the node table or if packets were
+ *  dropped on the way, so it can run as a test.
+ */
+
+/***** Includes *****/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "LoadGenerator.h"
+
+
+/***** Variable declarations *****/
+extern struct LoadGeneratorStats loadGeneratorStats;
+
+
+/***** Prototypes *****/
+static void report(void) __attribute__((destructor));
+static uint32_t percentile(const uint32_t* latency, uint32_t count, uint8_t percent);
+
+
+/***** Function definitions *****/
+static void report(void)
+{
+    const struct LoadGeneratorStats* stats = &loadGeneratorStats;
+    const uint32_t* latency = stats->latency[LoadGenerator_Stage_NodeTable];
+    uint32_t reached = stats->reached[LoadGenerator_Stage_NodeTable];
+
+    if (stats->injected == 0)
+    {
+        return;
+    }
+
+    printf("loadgen: %u injected, %u to the radio task, %u to the node table\n",
+           stats->injected, stats->reached[LoadGenerator_Stage_RadioTask], reached);
+    printf("loadgen: receive callback %.0f cycles/packet, at most %u\n",
+           (double)stats->rxCycles / stats->injected, stats->rxCyclesMax);
+    printf("loadgen: latency to the node table, 50%% below %u us, 99%% below %u us\n",
+           percentile(latency, reached, 50), percentile(latency, reached, 99));
+    fflush(stdout);
+
+    /* Packets still on their way at the exit are not drops */
+    if ((reached == 0) || (reached + LOADGEN_BURST_SIZE < stats->injected))
+    {
+        _Exit(1);
+    }
+}
+
+/* Upper end in us of the latency bucket that holds the percentile */
+static uint32_t percentile(const uint32_t* latency, uint32_t count, uint8_t percent)
+{
+    uint32_t sum = 0;
+    uint8_t bucket;
+
+    for (bucket = 0; bucket < LOADGEN_LATENCY_BUCKETS - 1; bucket++)
+    {
+        sum += latency[bucket];
+        if ((uint64_t)sum * 100 >= (uint64_t)count * percent)
+        {
+            break;
+        }
+    }
+
+    /* Bucket n holds latencies below 2^n radio timer ticks of 0.25 us */
+    return (1u << bucket) / 4;
+}
@@ -0,0 +1,240 @@
+/*
+ *  ======== NodeHistoryBench.c ========
+ *
+ *  Host benchmark of NodeHistory with the default pool: NODEHISTORY_RETAINED_NODES
+ *  nodes report every NODEHISTORY_SAMPLE_PERIOD_S seconds, with a slowly
+ *  drifting value and rssi, for three times NODEHISTORY_RETENTION_S.
+ *
+ *  Prints the RAM per retained sample and the cost of appending and of
+ *  scanning a full and a short time range. Fails if a node's history does
+ *  not read back as the samples appended, if it covers less than the
+ *  retention target, or if the regular samples take more than
+ *  NODEHISTORY_BYTES_PER_SAMPLE, which the pool is sized with.
+ *
+ *  usage: NodeHistoryBench [rounds]
+ */
+
+/***** Includes *****/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "NodeHistory.h"
+
+
+/***** Defines *****/
+#define BENCH_DEFAULT_ROUNDS    2000
+#define BENCH_SCAN_ROUNDS       2000
+#define BENCH_NODES             NODEHISTORY_RETAINED_NODES
+#define BENCH_SAMPLES           (3 * NODEHISTORY_RETENTION_S / NODEHISTORY_SAMPLE_PERIOD_S)
+
+/* Length of the short range scanned, the last ten minutes */
+#define BENCH_SHORT_RANGE_S     600
+
+
+/***** Variable declarations *****/
+static struct NodeHistory history;
+static struct NodeHistorySample reference[BENCH_NODES][BENCH_SAMPLES];
+static volatile uint32_t sink;
+
+
+/***** Prototypes *****/
+static double now(void);
+static void makeSamples(void);
+static void appendAll(void);
+static uint32_t scan(uint16_t n, uint32_t fromTime, uint32_t toTime);
+static uint8_t check(uint16_t n, uint32_t* retained);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    uint32_t rounds = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_ROUNDS;
+    uint32_t endTime;
+    uint32_t retained = 0;
+    uint32_t scanned;
+    uint32_t errors = 0;
+    uint32_t i;
+    uint16_t n;
+    double start;
+    double appendNs;
+    double fullNs;
+    double shortNs;
+
+    makeSamples();
+    endTime = reference[0][BENCH_SAMPLES - 1].time;
+
+    start = now();
+    for (i = 0; i < rounds; i++)
+    {
+        appendAll();
+    }
+    appendNs = (now() - start) / ((double)rounds * BENCH_NODES * BENCH_SAMPLES);
+
+    for (n = 0; n < BENCH_NODES; n++)
+    {
+        errors += check(n, &retained);
+    }
+
+    scanned = 0;
+    start = now();
+    for (i = 0; i < BENCH_SCAN_ROUNDS; i++)
+    {
+        scanned += scan(i % BENCH_NODES, 0, endTime);
+    }
+    fullNs = (now() - start) / scanned;
+
+    start = now();
+    for (i = 0; i < BENCH_SCAN_ROUNDS; i++)
+    {
+        scan(i % BENCH_NODES, endTime - BENCH_SHORT_RANGE_S, endTime);
+    }
+    shortNs = (now() - start) / BENCH_SCAN_ROUNDS;
+
+    printf("pool: %u blocks, %u bytes\n", NODEHISTORY_BLOCK_COUNT, (uint32_t)sizeof(history.blocks));
+    printf("retained: %u samples, %.2f bytes/sample of pool (a full sample is %u bytes)\n",
+           retained, (double)sizeof(history.blocks) / retained, (uint32_t)sizeof(struct NodeHistorySample));
+    printf("append: %.1f ns/sample\n", appendNs);
+    printf("scan all: %.1f ns/sample, last %u s: %.1f ns/query\n", fullNs, BENCH_SHORT_RANGE_S, shortNs);
+
+    return (errors == 0) ? 0 : 1;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Regular reports of a slowly changing temperature */
+static void makeSamples(void)
+{
+    uint32_t seed = 12345;
+    uint16_t n;
+    uint32_t i;
+    struct NodeHistorySample sample;
+
+    for (n = 0; n < BENCH_NODES; n++)
+    {
+        sample.time = n;
+        sample.value = 1500 + 100 * n;
+        sample.rssi = -60 - n;
+
+        for (i = 0; i < BENCH_SAMPLES; i++)
+        {
+            seed = seed * 1103515245 + 12345;
+            sample.time += NODEHISTORY_SAMPLE_PERIOD_S + ((seed >> 16) & 1);
+            sample.value += (int16_t)((seed >> 17) % 7) - 3;
+            sample.rssi += (int8_t)((seed >> 20) % 5) - 2;
+            if ((sample.rssi < -100) || (sample.rssi > -30))
+            {
+                sample.rssi = -60;
+            }
+            reference[n][i] = sample;
+        }
+    }
+}
+
+/* Appends the samples of all nodes in time order, as they arrive */
+static void appendAll(void)
+{
+    uint32_t i;
+    uint16_t n;
+
+    NodeHistory_init(&history);
+    for (i = 0; i < BENCH_SAMPLES; i++)
+    {
+        for (n = 0; n < BENCH_NODES; n++)
+        {
+            NodeHistory_append(&history, n, &reference[n][i]);
+        }
+    }
+    sink = history.evictedCount;
+}
+
+static uint32_t scan(uint16_t n, uint32_t fromTime, uint32_t toTime)
+{
+    struct NodeHistoryIterator it;
+    struct NodeHistorySample sample;
+    uint32_t count = 0;
+
+    NodeHistory_iterate(&history, n, fromTime, toTime, &it);
+    while (NodeHistory_next(&it, &sample))
+    {
+        sink += sample.value;
+        count++;
+    }
+
+    return count;
+}
+
+/* The history of node n must be the newest samples appended, in order, and
+ * cover the retention target */
+static uint8_t check(uint16_t n, uint32_t* retained)
+{
+    struct NodeHistoryIterator it;
+    struct NodeHistorySample sample;
+    const struct NodeHistorySample* expected;
+    uint32_t count = 0;
+    uint32_t first = BENCH_SAMPLES;
+    uint32_t deltaBytes = 0;
+    uint32_t blocks = 0;
+    uint8_t b;
+
+    NodeHistory_iterate(&history, n, 0, 0xFFFFFFFF, &it);
+    while (NodeHistory_next(&it, &sample))
+    {
+        if (first == BENCH_SAMPLES)
+        {
+            for (first = 0; reference[n][first].time != sample.time; first++)
+            {
+                if (first == BENCH_SAMPLES - 1)
+                {
+                    printf("node %u: unknown sample time %u\n", n, sample.time);
+                    return 1;
+                }
+            }
+        }
+
+        expected = &reference[n][first + count];
+        if ((first + count >= BENCH_SAMPLES) || (sample.time != expected->time) ||
+            (sample.value != expected->value) || (sample.rssi != expected->rssi))
+        {
+            printf("node %u: sample %u does not match\n", n, first + count);
+            return 1;
+        }
+        count++;
+    }
+
+    if (first + count != BENCH_SAMPLES)
+    {
+        printf("node %u: newest samples missing\n", n);
+        return 1;
+    }
+
+    if (reference[n][BENCH_SAMPLES - 1].time - reference[n][first].time < NODEHISTORY_RETENTION_S)
+    {
+        printf("node %u: history covers %u s, less than %u s\n", n,
+               reference[n][BENCH_SAMPLES - 1].time - reference[n][first].time, NODEHISTORY_RETENTION_S);
+        return 1;
+    }
+
+    for (b = history.nodes[n].oldest; b != NODEHISTORY_NO_BLOCK; b = history.blocks[b].next)
+    {
+        deltaBytes += history.blocks[b].used;
+        blocks++;
+    }
+
+    /* The first sample of every block is in its header */
+    if (deltaBytes > NODEHISTORY_BYTES_PER_SAMPLE * (count - blocks))
+    {
+        printf("node %u: %u bytes for %u samples, more than NODEHISTORY_BYTES_PER_SAMPLE\n",
+               n, deltaBytes, count - blocks);
+        return 1;
+    }
+
+    *retained += count;
+    return 0;
+}
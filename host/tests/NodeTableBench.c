@@ -0,0 +1,200 @@
+/*
+ *  ======== NodeTableBench.c ========
+ *
+ *  Host benchmark: the cost per packet of NodeTable_findOrAdd from 7 to 4096
+ *  nodes, next to the two linear scans per packet the concentrator did before
+ *  the hash index. NodeTable.c is built with 16-bit addresses and room for
+ *  4096 nodes for this, see CMakeLists.txt.
+ *
+ *  Fails if the cost at 4096 nodes is more than BENCH_MAX_GROWTH times the
+ *  cost at 7 nodes.
+ *
+ *  usage: NodeTableBench [packets]
+ */
+
+/***** Includes *****/
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "NodeTable.h"
+
+
+/***** Defines *****/
+#define BENCH_DEFAULT_PACKETS   2000000
+#define BENCH_RUNS              5
+#define BENCH_MAX_GROWTH        3.0
+
+/* The linear scans only get every n-th packet, they are that slow */
+#define BENCH_LINEAR_DIVIDER    100
+
+
+/***** Variable declarations *****/
+static const uint16_t nodeCounts[] = { 7, 64, 255, 1024, 4096 };
+#define BENCH_SIZE_COUNT (sizeof(nodeCounts) / sizeof(nodeCounts[0]))
+
+static struct NodeTable table;
+static NodeTable_Address* packetAddresses;
+static uint32_t packetCount;
+static volatile uint32_t sink;
+
+/* The node table of the concentrator before the hash index */
+static struct AdcSensorNode linearNodes[NODETABLE_MAX_NODES];
+static uint16_t linearCount;
+
+
+/***** Prototypes *****/
+static double now(void);
+static void makePackets(uint16_t nodeCount);
+static double runHash(uint16_t nodeCount);
+static double runLinear(uint16_t nodeCount);
+static struct AdcSensorNode* linearFindOrAdd(NodeTable_Address address);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    double hashNs[BENCH_SIZE_COUNT];
+    double linearNs;
+    uint8_t i;
+    uint8_t run;
+    double ns;
+
+    packetCount = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_PACKETS;
+    packetAddresses = malloc(packetCount * sizeof(NodeTable_Address));
+    if (packetAddresses == NULL)
+    {
+        return 1;
+    }
+
+    printf("%8s %14s %14s\n", "nodes", "hash ns/pkt", "linear ns/pkt");
+    for (i = 0; i < BENCH_SIZE_COUNT; i++)
+    {
+        makePackets(nodeCounts[i]);
+
+        /* Best of a few runs, to keep other load on the machine out */
+        hashNs[i] = 1e9;
+        linearNs = 1e9;
+        for (run = 0; run < BENCH_RUNS; run++)
+        {
+            ns = runHash(nodeCounts[i]);
+            hashNs[i] = (ns < hashNs[i]) ? ns : hashNs[i];
+            ns = runLinear(nodeCounts[i]);
+            linearNs = (ns < linearNs) ? ns : linearNs;
+        }
+
+        printf("%8u %14.1f %14.1f\n", nodeCounts[i], hashNs[i], linearNs);
+    }
+
+    free(packetAddresses);
+
+    if (hashNs[BENCH_SIZE_COUNT - 1] > BENCH_MAX_GROWTH * hashNs[0])
+    {
+        printf("hash cost per packet grows with the number of nodes\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+static double now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* Packets from random nodes, with addresses from 1 to nodeCount */
+static void makePackets(uint16_t nodeCount)
+{
+    uint32_t seed = 12345;
+    uint32_t i;
+
+    for (i = 0; i < packetCount; i++)
+    {
+        seed = seed * 1103515245 + 12345;
+        packetAddresses[i] = 1 + (seed >> 16) % nodeCount;
+    }
+}
+
+static double runHash(uint16_t nodeCount)
+{
+    struct AdcSensorNode* node;
+    uint8_t isNew;
+    uint32_t i;
+    double start;
+
+    NodeTable_init(&table);
+    for (i = 1; i <= nodeCount; i++)
+    {
+        NodeTable_findOrAdd(&table, i, &isNew);
+    }
+
+    start = now();
+    for (i = 0; i < packetCount; i++)
+    {
+        node = NodeTable_findOrAdd(&table, packetAddresses[i], &isNew);
+        node->latestAdcValue = i;
+    }
+    sink = table.count;
+
+    return (now() - start) / packetCount;
+}
+
+static double runLinear(uint16_t nodeCount)
+{
+    uint32_t linearPacketCount = packetCount / BENCH_LINEAR_DIVIDER;
+    struct AdcSensorNode* node;
+    uint32_t i;
+    double start;
+
+    linearCount = 0;
+    for (i = 1; i <= nodeCount; i++)
+    {
+        linearFindOrAdd(i);
+    }
+
+    start = now();
+    for (i = 0; i < linearPacketCount; i++)
+    {
+        node = linearFindOrAdd(packetAddresses[i]);
+        node->latestAdcValue = i;
+    }
+    sink = linearCount;
+
+    return (now() - start) / linearPacketCount;
+}
+
+/* isKnownNodeAddress, then addNewNode or updateNode, as in the old
+ * ConcentratorTask.c */
+static struct AdcSensorNode* linearFindOrAdd(NodeTable_Address address)
+{
+    uint8_t found = 0;
+    uint16_t i;
+
+    for (i = 0; i < linearCount; i++)
+    {
+        if (linearNodes[i].address == address)
+        {
+            found = 1;
+            break;
+        }
+    }
+
+    if (!found)
+    {
+        linearNodes[linearCount].address = address;
+        return &linearNodes[linearCount++];
+    }
+
+    for (i = 0; i < linearCount; i++)
+    {
+        if (linearNodes[i].address == address)
+        {
+            return &linearNodes[i];
+        }
+    }
+
+    return NULL;
+}
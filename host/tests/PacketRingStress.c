@@ -0,0 +1,283 @@
+/*
+ *  ======== PacketRingStress.c ========
+ *
+ *  Host test: a producer and a consumer thread run PacketRing against each
+ *  other, as the RF callback and the ConcentratorRadioTask do on the target.
+ *  The producer numbers every committed entry and writes the number at both
+ *  ends of the entry, the consumer checks that it gets every committed entry
+ *  exactly once, in order and completely written, and that the entries the
+ *  ring refused are counted in overflowCount.
+ *
+ *  The burst case then delivers bursts of 1 to PACKETRING_SIZE packets while
+ *  the consumer is busy, as when the task runs late behind a packet burst,
+ *  both to the ring and to the single latest packet slot the ring replaced.
+ *  The single slot keeps only the last packet of a burst. The test fails if
+ *  the ring drops or corrupts any packet of a burst.
+ *
+ *  usage: PacketRingStress [packets]
+ */
+
+/***** Includes *****/
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "PacketRing.h"
+
+
+/***** Defines *****/
+#define STRESS_DEFAULT_PACKETS  2000000
+#define STRESS_LAST_SAMPLE      (RADIO_BATCH_MAX_SAMPLES - 1)
+#define STRESS_BURST_ROUNDS     10000
+
+
+/***** Variable declarations *****/
+static struct PacketRing ring;
+static uint32_t packetCount;
+static uint32_t refusedCount;
+static uint32_t errorCount;
+
+/* The hand-off the ring replaced: the Rx callback overwrote one latest
+ * packet and posted an event, and the task took whatever was there */
+static struct {
+    struct PacketRingEntry entry;
+    uint8_t pending;
+} singleSlot;
+
+/* Burst case, the producer wakes the consumer after each burst and waits
+ * for it to drain both hand-offs */
+static sem_t burstDelivered;
+static sem_t burstDrained;
+static uint32_t burstSequence;
+static uint32_t burstExpected;
+static uint32_t singleSlotDropCount;
+static uint8_t burstDone;
+
+
+/***** Prototypes *****/
+static void* producerThread(void* arg);
+static void* consumerThread(void* arg);
+static uint32_t runBursts(void);
+static void* burstConsumerThread(void* arg);
+static void fillEntry(struct PacketRingEntry* entry, uint32_t sequence);
+static uint8_t checkEntry(const struct PacketRingEntry* entry, uint32_t sequence);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    pthread_t producer;
+    pthread_t consumer;
+
+    packetCount = (argc > 1) ? strtoul(argv[1], NULL, 0) : STRESS_DEFAULT_PACKETS;
+    PacketRing_init(&ring);
+
+    pthread_create(&consumer, NULL, consumerThread, NULL);
+    pthread_create(&producer, NULL, producerThread, NULL);
+    pthread_join(producer, NULL);
+    pthread_join(consumer, NULL);
+
+    printf("packets %u, refused %u, overflowCount %u, highWaterMark %u, errors %u\n",
+           packetCount, refusedCount, ring.overflowCount, ring.highWaterMark, errorCount);
+
+    if (ring.overflowCount != refusedCount)
+    {
+        printf("overflowCount does not match the refused entries\n");
+        errorCount++;
+    }
+    if (ring.highWaterMark > PACKETRING_SIZE)
+    {
+        printf("highWaterMark above PACKETRING_SIZE\n");
+        errorCount++;
+    }
+    if (PacketRing_count(&ring) != 0)
+    {
+        printf("ring not empty at the end\n");
+        errorCount++;
+    }
+
+    errorCount += runBursts();
+
+    return (errorCount == 0) ? 0 : 1;
+}
+
+/* Returns the number of errors of the burst case */
+static uint32_t runBursts(void)
+{
+    pthread_t consumer;
+    uint32_t burstSize;
+    uint32_t round;
+    uint32_t ringDrops;
+    uint32_t singleSlotDrops;
+    uint32_t errors = 0;
+    struct PacketRingEntry* entry;
+
+    sem_init(&burstDelivered, 0, 0);
+    sem_init(&burstDrained, 0, 0);
+    pthread_create(&consumer, NULL, burstConsumerThread, NULL);
+
+    for (burstSize = 1; burstSize <= PACKETRING_SIZE; burstSize++)
+    {
+        ringDrops = ring.overflowCount;
+        singleSlotDrops = singleSlotDropCount;
+
+        for (round = 0; round < STRESS_BURST_ROUNDS; round++)
+        {
+            uint32_t n;
+
+            for (n = 0; n < burstSize; n++)
+            {
+                entry = PacketRing_reserve(&ring);
+                if (entry != NULL)
+                {
+                    fillEntry(entry, burstSequence);
+                    PacketRing_commit(&ring);
+                }
+
+                if (singleSlot.pending)
+                {
+                    singleSlotDropCount++;
+                }
+                fillEntry(&singleSlot.entry, burstSequence);
+                singleSlot.pending = 1;
+
+                burstSequence++;
+            }
+
+            sem_post(&burstDelivered);
+            sem_wait(&burstDrained);
+        }
+
+        ringDrops = ring.overflowCount - ringDrops;
+        singleSlotDrops = singleSlotDropCount - singleSlotDrops;
+        printf("bursts of %u: single slot dropped %u of %u, ring dropped %u\n",
+               burstSize, singleSlotDrops, burstSize * STRESS_BURST_ROUNDS, ringDrops);
+        if (ringDrops != 0)
+        {
+            printf("ring dropped packets of bursts of %u\n", burstSize);
+            errors++;
+        }
+    }
+
+    burstDone = 1;
+    sem_post(&burstDelivered);
+    pthread_join(consumer, NULL);
+
+    if (burstExpected != burstSequence)
+    {
+        printf("burst consumer got %u of %u packets\n", burstExpected, burstSequence);
+        errors++;
+    }
+
+    return errors;
+}
+
+static void* burstConsumerThread(void* arg)
+{
+    struct PacketRingEntry* entry;
+
+    while (1)
+    {
+        sem_wait(&burstDelivered);
+        if (burstDone)
+        {
+            break;
+        }
+
+        while ((entry = PacketRing_peek(&ring)) != NULL)
+        {
+            if (!checkEntry(entry, burstExpected))
+            {
+                if (errorCount++ < 10)
+                {
+                    printf("burst entry %u: rxTime %u\n", burstExpected, entry->rxTime);
+                }
+            }
+            PacketRing_release(&ring);
+            burstExpected++;
+        }
+        singleSlot.pending = 0;
+
+        sem_post(&burstDrained);
+    }
+
+    return NULL;
+}
+
+static void fillEntry(struct PacketRingEntry* entry, uint32_t sequence)
+{
+    entry->rxTime = sequence;
+    entry->rssi = (int8_t)sequence;
+    entry->packet.header.sourceAddress = (uint8_t)sequence;
+    entry->packet.sensorReport.samples[RADIO_REPORT_SAMPLE_FIELD_COUNT - 1][STRESS_LAST_SAMPLE] =
+        (uint16_t)~sequence;
+}
+
+/* Returns 1 if the entry is completely written with sequence */
+static uint8_t checkEntry(const struct PacketRingEntry* entry, uint32_t sequence)
+{
+    return ((entry->rxTime == sequence) &&
+            (entry->rssi == (int8_t)sequence) &&
+            (entry->packet.header.sourceAddress == (uint8_t)sequence) &&
+            (entry->packet.sensorReport.samples[RADIO_REPORT_SAMPLE_FIELD_COUNT - 1][STRESS_LAST_SAMPLE] ==
+             (uint16_t)~sequence));
+}
+
+static void* producerThread(void* arg)
+{
+    uint32_t sequence = 0;
+    struct PacketRingEntry* entry;
+
+    while (sequence < packetCount)
+    {
+        entry = PacketRing_reserve(&ring);
+        if (entry == NULL)
+        {
+            refusedCount++;
+            sched_yield();
+            continue;
+        }
+
+        fillEntry(entry, sequence);
+        PacketRing_commit(&ring);
+        sequence++;
+    }
+
+    return NULL;
+}
+
+static void* consumerThread(void* arg)
+{
+    uint32_t expected = 0;
+    struct PacketRingEntry* entry;
+
+    while (expected < packetCount)
+    {
+        entry = PacketRing_peek(&ring);
+        if (entry == NULL)
+        {
+            sched_yield();
+            continue;
+        }
+
+        if (!checkEntry(entry, expected))
+        {
+            if (errorCount++ < 10)
+            {
+                printf("entry %u: rxTime %u\n", expected, entry->rxTime);
+            }
+        }
+        PacketRing_release(&ring);
+        expected++;
+
+        /* Let the ring run full now and then */
+        if ((expected & 0xFFF) == 0)
+        {
+            sched_yield();
+        }
+    }
+
+    return NULL;
+}
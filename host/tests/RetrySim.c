@@ -0,0 +1,428 @@
+/*
+ *  ======== RetrySim.c ========
+ *
+ *  Host simulation of the node retransmissions with many nodes reporting to
+ *  one concentrator, with the two retry policies the node has had:
+ *
+ *   fixed     the old NodeRadioTask: a 160 ms ack window and a retry right
+ *             after it closes
+ *   adaptive  the current NodeRadioTask: the ack window sized from the
+ *             measured round trip time, doubled on every retry, and a
+ *             random wait of 1 to NODERETRY_BACKOFF_BASE_MS << retry ms
+ *             before a retry, all with the node's own NodeRetry.c
+ *
+ *  Both send a report and up to NODERETRY_MAX_RETRIES retries. The nodes
+ *  do not hear each other, as in a star network with hidden nodes, so any
+ *  two frames on the air at the same time are lost, acks included. The
+ *  concentrator acks a report a random 1 to 3 ms after it ends, which is
+ *  its task latency. Reports come at random, on average one every
+ *  SIM_REPORT_PERIOD_US per node.
+ *
+ *  For both policies and a growing number of nodes the simulation prints
+ *  the delivery ratio, the radio charge per delivered report, with the
+ *  CC1310 TX and RX currents, and the frames sent per report. Fails if at
+ *  the largest number of nodes the adaptive policy delivers fewer reports
+ *  or takes more charge per delivered report than the fixed one.
+ *
+ *  usage: RetrySim [seconds]
+ */
+
+/***** Includes *****/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "NodeRetry.h"
+
+
+/***** Defines *****/
+#define SIM_DEFAULT_SECONDS     3600
+#define SIM_MAX_NODES           128
+#define SIM_REPORT_PERIOD_US    2000000
+
+/* 50 kbps, the 11 bytes of preamble, sync word, length and CRC, the
+ * address and the packet */
+#define SIM_BIT_TIME_US         20
+#define SIM_FRAME_US(bytes)     ((11 + 1 + (bytes)) * 8 * SIM_BIT_TIME_US)
+#define SIM_REPORT_US           SIM_FRAME_US(11)
+#define SIM_ACK_US              SIM_FRAME_US(4)
+
+/* Task latency of the concentrator before the ack is sent */
+#define SIM_ACK_DELAY_MIN_US    1000
+#define SIM_ACK_DELAY_SPREAD_US 2000
+
+/* CC1310 at 3.0 V: TX at +10 dBm and RX, in uA */
+#define SIM_TX_UA               13400
+#define SIM_RX_UA               5400
+
+/* Frames kept to find collisions with, far more than can overlap one */
+#define SIM_AIR_FRAMES          256
+#define SIM_MAX_EVENTS          (8 * SIM_MAX_NODES + SIM_AIR_FRAMES)
+
+
+/***** Type declarations *****/
+enum SimPolicy {
+    SimPolicy_Fixed,
+    SimPolicy_Adaptive,
+};
+
+enum SimEventType {
+    SimEvent_Report,        /* A node has a new report */
+    SimEvent_TxStart,       /* A node sends its report */
+    SimEvent_TxEnd,         /* A frame ends */
+    SimEvent_AckStart,      /* The concentrator sends an ack */
+    SimEvent_AckTimeout,    /* The ack window of a node closes */
+};
+
+struct SimEvent {
+    uint64_t time;
+    enum SimEventType type;
+    uint16_t node;
+    uint16_t frame;
+    uint32_t attempt;
+};
+
+struct SimFrame {
+    uint64_t start;
+    uint64_t end;
+    uint16_t node;
+    uint8_t isAck;
+    uint32_t attempt;
+};
+
+struct SimNode {
+    uint32_t random;
+    uint32_t pending;       /* Reports waiting for the current one */
+    uint8_t active;
+    uint8_t delivered;      /* The concentrator has the current report */
+    uint8_t retriesDone;
+    uint32_t attempt;       /* Ids the frames and the window of an attempt */
+    uint32_t ackWindowMs;   /* Window of the current attempt */
+    uint64_t txEnd;
+    struct NodeRetry_AckTimer ackTimer;
+};
+
+struct SimResult {
+    uint32_t reports;
+    uint32_t delivered;
+    uint32_t frames;
+    double chargeUc;
+};
+
+
+/***** Variable declarations *****/
+static enum SimPolicy policy;
+static uint16_t nodeCount;
+static struct SimNode nodes[SIM_MAX_NODES];
+static struct SimFrame air[SIM_AIR_FRAMES];
+static uint16_t airNext;
+static struct SimEvent events[SIM_MAX_EVENTS];
+static uint32_t eventCount;
+static uint32_t simRandom;
+static struct SimResult result;
+
+
+/***** Prototypes *****/
+static void run(enum SimPolicy simPolicy, uint16_t simNodes, uint64_t endUs);
+static void handle(const struct SimEvent* event);
+static void startAttempt(uint16_t n, uint64_t time);
+static void finish(uint16_t n, uint64_t now);
+static uint16_t addFrame(uint64_t start, uint32_t lengthUs, uint16_t node, uint8_t isAck, uint32_t attempt);
+static uint8_t collided(uint16_t f);
+static void push(uint64_t time, enum SimEventType type, uint16_t node, uint16_t frame, uint32_t attempt);
+static void pop(struct SimEvent* event);
+static uint32_t xorshift(uint32_t* state);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    static const uint16_t counts[] = { 8, 16, 32, 64, 128 };
+    uint64_t endUs = (uint64_t)((argc > 1) ? strtoul(argv[1], NULL, 0) : SIM_DEFAULT_SECONDS) * 1000000;
+    struct SimResult fixed;
+    struct SimResult adaptive;
+    uint8_t i;
+
+    printf("%6s %10s %10s %12s %12s %10s %10s\n", "nodes", "fixed", "adaptive",
+           "fixed uC", "adaptive uC", "fixed f/r", "adapt f/r");
+    for (i = 0; i < sizeof(counts) / sizeof(counts[0]); i++)
+    {
+        run(SimPolicy_Fixed, counts[i], endUs);
+        fixed = result;
+        run(SimPolicy_Adaptive, counts[i], endUs);
+        adaptive = result;
+
+        printf("%6u %9.2f%% %9.2f%% %12.1f %12.1f %10.2f %10.2f\n", counts[i],
+               100.0 * fixed.delivered / fixed.reports, 100.0 * adaptive.delivered / adaptive.reports,
+               fixed.chargeUc / fixed.delivered, adaptive.chargeUc / adaptive.delivered,
+               (double)fixed.frames / fixed.reports, (double)adaptive.frames / adaptive.reports);
+    }
+
+    /* Compared at the largest network, the last run */
+    if (((double)adaptive.delivered / adaptive.reports < (double)fixed.delivered / fixed.reports) ||
+        (adaptive.chargeUc / adaptive.delivered > fixed.chargeUc / fixed.delivered))
+    {
+        printf("adaptive retries do no better than fixed ones\n");
+        return 1;
+    }
+
+    return 0;
+}
+
+static void run(enum SimPolicy simPolicy, uint16_t simNodes, uint64_t endUs)
+{
+    struct SimEvent event;
+    uint16_t n;
+
+    policy = simPolicy;
+    nodeCount = simNodes;
+    memset(nodes, 0, sizeof(nodes));
+    memset(air, 0, sizeof(air));
+    memset(&result, 0, sizeof(result));
+    airNext = 0;
+    eventCount = 0;
+
+    /* Seeded the same for both policies */
+    simRandom = 0x2545F491 + simNodes;
+    for (n = 0; n < nodeCount; n++)
+    {
+        nodes[n].random = 0x9E3779B9 * (n + 1);
+        NodeRetry_init(&nodes[n].ackTimer);
+        push(xorshift(&simRandom) % SIM_REPORT_PERIOD_US, SimEvent_Report, n, 0, 0);
+    }
+
+    while (eventCount > 0)
+    {
+        pop(&event);
+        if (event.time > endUs)
+        {
+            break;
+        }
+        handle(&event);
+    }
+
+    /* Reports still on their way are not counted */
+    for (n = 0; n < nodeCount; n++)
+    {
+        result.reports -= nodes[n].pending + nodes[n].active;
+        result.delivered -= nodes[n].active && nodes[n].delivered;
+    }
+}
+
+static void handle(const struct SimEvent* event)
+{
+    struct SimNode* node = &nodes[event->node];
+    const struct SimFrame* frame = &air[event->frame];
+    uint32_t delayMs;
+
+    switch (event->type)
+    {
+    case SimEvent_Report:
+        /* On average one report every SIM_REPORT_PERIOD_US */
+        push(event->time + SIM_REPORT_PERIOD_US / 2 + xorshift(&simRandom) % SIM_REPORT_PERIOD_US,
+             SimEvent_Report, event->node, 0, 0);
+        result.reports++;
+        if (node->active)
+        {
+            node->pending++;
+        }
+        else
+        {
+            node->active = 1;
+            node->delivered = 0;
+            node->retriesDone = 0;
+            node->ackWindowMs = node->ackTimer.timeoutMs;
+            startAttempt(event->node, event->time);
+        }
+        break;
+
+    case SimEvent_TxStart:
+        push(event->time + SIM_REPORT_US, SimEvent_TxEnd, event->node,
+             addFrame(event->time, SIM_REPORT_US, event->node, 0, event->attempt), event->attempt);
+        result.frames++;
+        result.chargeUc += (double)SIM_TX_UA * SIM_REPORT_US / 1e6;
+        break;
+
+    case SimEvent_TxEnd:
+        if (!frame->isAck)
+        {
+            /* The node listens for the ack, the concentrator acks a report
+             * it got */
+            node->txEnd = event->time;
+            push(event->time + (uint64_t)node->ackWindowMs * 1000, SimEvent_AckTimeout,
+                 event->node, 0, event->attempt);
+            if (!collided(event->frame))
+            {
+                node->delivered = 1;
+                push(event->time + SIM_ACK_DELAY_MIN_US + xorshift(&simRandom) % SIM_ACK_DELAY_SPREAD_US,
+                     SimEvent_AckStart, event->node, 0, event->attempt);
+            }
+        }
+        else if ((node->active) && (node->attempt == event->attempt) && !collided(event->frame))
+        {
+            /* Only acks to a first attempt are timed, the fixed policy
+             * keeps its window */
+            if ((policy == SimPolicy_Adaptive) && (node->retriesDone == 0))
+            {
+                NodeRetry_updateAckTimer(&node->ackTimer, (uint32_t)(event->time - node->txEnd));
+            }
+            result.chargeUc += (double)SIM_RX_UA * (event->time - node->txEnd) / 1e6;
+            finish(event->node, event->time);
+        }
+        break;
+
+    case SimEvent_AckStart:
+        /* An ack is heard if it starts within the window */
+        if ((node->active) && (node->attempt == event->attempt) &&
+            (event->time < node->txEnd + (uint64_t)node->ackWindowMs * 1000))
+        {
+            push(event->time + SIM_ACK_US, SimEvent_TxEnd, event->node,
+                 addFrame(event->time, SIM_ACK_US, event->node, 1, event->attempt), event->attempt);
+        }
+        else
+        {
+            /* Sent to a node that no longer listens */
+            addFrame(event->time, SIM_ACK_US, event->node, 1, 0);
+        }
+        break;
+
+    case SimEvent_AckTimeout:
+        if ((!node->active) || (node->attempt != event->attempt))
+        {
+            break;
+        }
+        result.chargeUc += (double)SIM_RX_UA * node->ackWindowMs / 1e3;
+
+        if (node->retriesDone < NODERETRY_MAX_RETRIES)
+        {
+            node->retriesDone++;
+            if (policy == SimPolicy_Fixed)
+            {
+                startAttempt(event->node, event->time);
+            }
+            else
+            {
+                node->ackWindowMs = NodeRetry_ackWindowMs(node->ackTimer.timeoutMs, node->retriesDone);
+                delayMs = NodeRetry_backoffMs(node->retriesDone, xorshift(&node->random));
+                startAttempt(event->node, event->time + (uint64_t)delayMs * 1000);
+            }
+        }
+        else
+        {
+            finish(event->node, event->time);
+        }
+        break;
+    }
+}
+
+static void startAttempt(uint16_t n, uint64_t time)
+{
+    nodes[n].attempt++;
+    push(time, SimEvent_TxStart, n, 0, nodes[n].attempt);
+}
+
+/* Ends the current report, acked or given up, and starts the next one */
+static void finish(uint16_t n, uint64_t now)
+{
+    struct SimNode* node = &nodes[n];
+
+    result.delivered += node->delivered;
+    node->attempt++;
+    node->active = 0;
+
+    if (node->pending > 0)
+    {
+        node->pending--;
+        node->active = 1;
+        node->delivered = 0;
+        node->retriesDone = 0;
+        node->ackWindowMs = node->ackTimer.timeoutMs;
+        startAttempt(n, now);
+    }
+}
+
+static uint16_t addFrame(uint64_t start, uint32_t lengthUs, uint16_t node, uint8_t isAck, uint32_t attempt)
+{
+    uint16_t f = airNext;
+
+    air[f].start = start;
+    air[f].end = start + lengthUs;
+    air[f].node = node;
+    air[f].isAck = isAck;
+    air[f].attempt = attempt;
+    airNext = (airNext + 1) % SIM_AIR_FRAMES;
+
+    return f;
+}
+
+/* A frame is lost if any other frame was on the air at the same time */
+static uint8_t collided(uint16_t f)
+{
+    uint16_t i;
+
+    for (i = 0; i < SIM_AIR_FRAMES; i++)
+    {
+        if ((i != f) && (air[i].end > air[f].start) && (air[i].start < air[f].end))
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/* Binary heap on the event time */
+static void push(uint64_t time, enum SimEventType type, uint16_t node, uint16_t frame, uint32_t attempt)
+{
+    uint32_t i = eventCount++;
+    struct SimEvent event = { time, type, node, frame, attempt };
+
+    if (eventCount > SIM_MAX_EVENTS)
+    {
+        printf("event queue full\n");
+        exit(1);
+    }
+
+    while ((i > 0) && (events[(i - 1) / 2].time > time))
+    {
+        events[i] = events[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    events[i] = event;
+}
+
+static void pop(struct SimEvent* event)
+{
+    struct SimEvent last = events[--eventCount];
+    uint32_t i = 0;
+    uint32_t child;
+
+    *event = events[0];
+    while ((child = 2 * i + 1) < eventCount)
+    {
+        if ((child + 1 < eventCount) && (events[child + 1].time < events[child].time))
+        {
+            child++;
+        }
+        if (events[child].time >= last.time)
+        {
+            break;
+        }
+        events[i] = events[child];
+        i = child;
+    }
+    events[i] = last;
+}
+
+static uint32_t xorshift(uint32_t* state)
+{
+    uint32_t x = *state;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
@@ -0,0 +1,292 @@
+/*
+ *  ======== RxPathBench.c ========
+ *
+ *  Host benchmark of the concentrator's receive path through the EasyLink
+ *  shim, with the two hand-offs it has had:
+ *
+ *   copy  before the Rx loans: EasyLink_receiveContinuousAsync copies the
+ *         filled Rx queue entry into its EasyLink_RxPacket, the radio task
+ *         decodes that into the packet ring, and ConcentratorTask copies the
+ *         whole ConcentratorPacket out of the ring
+ *   loan  EasyLink_receiveContinuousLoanAsync lends the Rx queue entry, the
+ *         radio task decodes it into the packet ring and returns it with
+ *         EasyLink_returnRxLoan, and ConcentratorTask copies only the
+ *         sensor packet it keeps
+ *
+ *  The bench starts a copy of itself as a second radio that sends
+ *  DualModeSensorPackets back to back over the UDP radio of EasyLinkUdp.c.
+ *  For each hand-off it receives [frames] of them and reads the host
+ *  cycles EasyLinkUdp.c counted per frame in hostRadioRxCycles, from filling
+ *  the Rx queue entry to the return of the callback. The radio task and
+ *  ConcentratorTask steps run in the callback here, so the count covers all
+ *  three hops. Fails if a frame arrives corrupted or if the loans take more
+ *  cycles than the copies for the fastest frame, which the other processes
+ *  on the machine disturb the least.
+ *
+ *  usage: RxPathBench [frames]
+ */
+
+/***** Includes *****/
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <xdc/std.h>
+#include <ti/sysbios/BIOS.h>
+#include <ti/sysbios/knl/Task.h>
+#include <ti/sysbios/knl/Semaphore.h>
+#include <ti/sysbios/knl/Clock.h>
+
+#include "easylink/EasyLink.h"
+#include "RadioProtocol.h"
+#include "PacketRing.h"
+#include "HostKernel.h"
+
+
+/***** Defines *****/
+#define BENCH_DEFAULT_FRAMES    2000
+#define BENCH_WARMUP_FRAMES     50
+#define BENCH_SENDER_ADDRESS    0x01
+#define BENCH_TIMEOUT_MS        60000
+#define BENCH_TASK_STACK_SIZE   4096
+
+
+/***** Type declarations *****/
+enum BenchHandOff {
+    BenchHandOff_Copy,
+    BenchHandOff_Loan,
+    BenchHandOff_Count,
+};
+
+
+/***** Variable declarations *****/
+static const char* const handOffNames[BenchHandOff_Count] = { "copy", "loan" };
+static Task_Struct benchTask;
+static uint8_t benchTaskStack[BENCH_TASK_STACK_SIZE];
+static Semaphore_Struct doneSem;
+static struct PacketRing ring;
+static uint32_t frameCount;
+static uint32_t received;
+static uint32_t errorCount;
+static pid_t sender;
+
+/* What ConcentratorTask keeps of a packet, with each hand-off */
+static union ConcentratorPacket taskPacket;
+static struct DualModeSensorPacket taskSensorPacket;
+
+
+/***** Prototypes *****/
+static void receiverTaskFunction(UArg arg0, UArg arg1);
+static void senderTaskFunction(UArg arg0, UArg arg1);
+static void copyRxDone(EasyLink_RxPacket* rxPacket, EasyLink_Status status);
+static void loanRxDone(EasyLink_RxLoan* rxLoan, EasyLink_Status status);
+static struct PacketRingEntry* decode(const uint8_t* payload, uint8_t len, int8_t rssi, uint32_t absTime);
+static void delivered(const struct DualModeSensorPacket* packet);
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    Task_Params taskParams;
+    Task_FuncPtr taskFunction = receiverTaskFunction;
+
+    if ((argc > 1) && (strcmp(argv[1], "send") == 0))
+    {
+        taskFunction = senderTaskFunction;
+    }
+    else
+    {
+        frameCount = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_FRAMES;
+
+        /* The sender is the next radio, it stops when the bench does */
+        sender = fork();
+        if (sender == 0)
+        {
+            setenv("HOST_RADIO_ID", "1", 1);
+            execl("/proc/self/exe", argv[0], "send", (char*)NULL);
+            _exit(1);
+        }
+    }
+
+    if (EasyLink_init(EasyLink_Phy_50kbps2gfsk) != EasyLink_Status_Success)
+    {
+        printf("EasyLink_init failed\n");
+        return 1;
+    }
+
+    Semaphore_construct(&doneSem, 0, NULL);
+    PacketRing_init(&ring);
+
+    Task_Params_init(&taskParams);
+    taskParams.stackSize = BENCH_TASK_STACK_SIZE;
+    taskParams.stack = &benchTaskStack;
+    Task_construct(&benchTask, taskFunction, &taskParams, NULL);
+
+    BIOS_start();
+
+    return 0;
+}
+
+static void receiverTaskFunction(UArg arg0, UArg arg1)
+{
+    struct HostRadioRxCycles cycles[BenchHandOff_Count];
+    EasyLink_Status status;
+    uint8_t h;
+
+    for (h = 0; h < BenchHandOff_Count; h++)
+    {
+        received = 0;
+        memset(&hostRadioRxCycles, 0, sizeof(hostRadioRxCycles));
+
+        if (h == BenchHandOff_Copy)
+        {
+            status = EasyLink_receiveContinuousAsync(copyRxDone, 0);
+        }
+        else
+        {
+            status = EasyLink_receiveContinuousLoanAsync(loanRxDone, 0);
+        }
+        if (status != EasyLink_Status_Success)
+        {
+            printf("%s: continuous Rx did not start\n", handOffNames[h]);
+            errorCount++;
+            break;
+        }
+
+        if (!Semaphore_pend(Semaphore_handle(&doneSem), BENCH_TIMEOUT_MS * 1000 / Clock_tickPeriod))
+        {
+            printf("%s: %u of %u frames received\n", handOffNames[h], received, frameCount);
+            errorCount++;
+        }
+        EasyLink_abort();
+        cycles[h] = hostRadioRxCycles;
+    }
+
+    kill(sender, SIGTERM);
+    waitpid(sender, NULL, 0);
+
+    if (errorCount == 0)
+    {
+        for (h = 0; h < BenchHandOff_Count; h++)
+        {
+            printf("%s: %u frames, %.0f cycles/frame, at least %u, at most %u\n", handOffNames[h],
+                   cycles[h].frames, (double)cycles[h].cycles / cycles[h].frames, cycles[h].cyclesMin,
+                   cycles[h].cyclesMax);
+        }
+
+        if (cycles[BenchHandOff_Loan].cyclesMin > cycles[BenchHandOff_Copy].cyclesMin)
+        {
+            printf("the loans take more cycles per frame than the copies\n");
+            errorCount++;
+        }
+    }
+
+    fflush(stdout);
+    exit((errorCount == 0) ? 0 : 1);
+}
+
+/* The second radio, sends a numbered sensor packet after the other */
+static void senderTaskFunction(UArg arg0, UArg arg1)
+{
+    static EasyLink_TxPacket txPacket;
+    struct DualModeSensorPacket packet;
+
+    memset(&packet, 0, sizeof(packet));
+    packet.header.sourceAddress = BENCH_SENDER_ADDRESS;
+    packet.header.packetType = RADIO_PACKET_TYPE_DM_SENSOR_PACKET;
+    txPacket.dstAddr[0] = RADIO_CONCENTRATOR_ADDRESS;
+
+    while (1)
+    {
+        packet.adcValue++;
+        packet.time100MiliSec = ~(uint32_t)packet.adcValue;
+        txPacket.len = RadioProtocol_packDmSensorPacket(&packet, txPacket.payload);
+        EasyLink_transmit(&txPacket);
+    }
+}
+
+static void copyRxDone(EasyLink_RxPacket* rxPacket, EasyLink_Status status)
+{
+    struct PacketRingEntry* entry;
+
+    if (status != EasyLink_Status_Success)
+    {
+        return;
+    }
+
+    if (decode(rxPacket->payload, rxPacket->len, rxPacket->rssi, rxPacket->absTime) == NULL)
+    {
+        return;
+    }
+
+    /* ConcentratorTask before the loans copied the whole packet */
+    entry = PacketRing_peek(&ring);
+    memcpy(&taskPacket, &entry->packet, sizeof(taskPacket));
+    PacketRing_release(&ring);
+
+    delivered(&taskPacket.dmSensorPacket);
+}
+
+static void loanRxDone(EasyLink_RxLoan* rxLoan, EasyLink_Status status)
+{
+    struct PacketRingEntry* entry;
+
+    if (status != EasyLink_Status_Success)
+    {
+        return;
+    }
+
+    /* The entry goes back to the radio as soon as it is decoded */
+    entry = decode(rxLoan->payload, rxLoan->len, rxLoan->rssi, rxLoan->absTime);
+    EasyLink_returnRxLoan(rxLoan);
+    if (entry == NULL)
+    {
+        return;
+    }
+
+    /* ConcentratorTask keeps only the sensor packet */
+    entry = PacketRing_peek(&ring);
+    taskSensorPacket = entry->packet.dmSensorPacket;
+    PacketRing_release(&ring);
+
+    delivered(&taskSensorPacket);
+}
+
+/* What the radio task's Rx callback does with a sensor packet */
+static struct PacketRingEntry* decode(const uint8_t* payload, uint8_t len, int8_t rssi, uint32_t absTime)
+{
+    struct PacketRingEntry* entry = PacketRing_reserve(&ring);
+
+    if ((entry == NULL) || !RadioProtocol_unpackDmSensorPacket(payload, len, &entry->packet.dmSensorPacket))
+    {
+        errorCount++;
+        return NULL;
+    }
+    entry->rssi = rssi;
+    entry->rxTime = absTime;
+    PacketRing_commit(&ring);
+
+    return entry;
+}
+
+static void delivered(const struct DualModeSensorPacket* packet)
+{
+    if ((packet->header.sourceAddress != BENCH_SENDER_ADDRESS) ||
+        (packet->time100MiliSec != ~(uint32_t)packet->adcValue))
+    {
+        errorCount++;
+    }
+
+    /* The first frames warm the caches up */
+    if (++received == BENCH_WARMUP_FRAMES)
+    {
+        memset(&hostRadioRxCycles, 0, sizeof(hostRadioRxCycles));
+    }
+    if (received == frameCount + BENCH_WARMUP_FRAMES)
+    {
+        Semaphore_post(Semaphore_handle(&doneSem));
+    }
+}
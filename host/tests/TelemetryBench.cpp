@@ -0,0 +1,255 @@
+/*
+ *  ======== TelemetryBench.cpp ========
+ *
+ *  Host benchmark of the telemetry stream against the text output it
+ *  replaced, where every packet cleared the terminal and reprinted the
+ *  table of all nodes with Display_printf.
+ *
+ *  The binary path runs Telemetry.c on a UART that completes every write at
+ *  once, and decodes the bytes with TelemetryDecoder. The text path renders
+ *  the old table for every reading and parses it back. Both are checked to
+ *  give back the readings sent. For each path the benchmark prints the
+ *  bytes per reading, the readings per second the 115200 baud UART carries,
+ *  and the host CPU time per reading. The old path also halted the CPU for
+ *  a CIO printf per node under the debugger, which is not counted here.
+ *
+ *  Fails if the binary path carries fewer readings per second on the UART.
+ *
+ *  usage: TelemetryBench [readings]
+ */
+
+/***** Includes *****/
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <ti/drivers/UART.h>
+
+extern "C" {
+#include "Telemetry.h"
+}
+
+#include "TelemetryDecoder.h"
+
+
+/***** Defines *****/
+#define BENCH_DEFAULT_READINGS  100000
+
+/* Nodes in the network, the old concentrator showed up to 7 */
+#define BENCH_NODES             7
+
+/* 8N1: a start and a stop bit per byte */
+#define BENCH_UART_BYTES_PER_S  (TELEMETRY_BAUD_RATE / 10)
+
+
+/***** Type declarations *****/
+struct UART_Config_s {
+    UART_Callback writeCallback;
+};
+
+struct PathResult {
+    size_t bytes;
+    double ns;
+};
+
+
+/***** Variable declarations *****/
+static struct UART_Config_s uart;
+static std::vector<uint8_t> wire;
+
+
+/***** Function definitions *****/
+/* UART driver that completes every write at once */
+extern "C" void UART_Params_init(UART_Params* params)
+{
+    memset(params, 0, sizeof(UART_Params));
+}
+
+extern "C" UART_Handle UART_open(uint_least8_t index, UART_Params* params)
+{
+    uart.writeCallback = params->writeCallback;
+    return &uart;
+}
+
+extern "C" int_fast32_t UART_write(UART_Handle handle, const void* buffer, size_t size)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(buffer);
+
+    wire.insert(wire.end(), bytes, bytes + size);
+    handle->writeCallback(handle, const_cast<void*>(buffer), size);
+
+    return size;
+}
+
+static TelemetryReading makeReading(uint32_t i)
+{
+    TelemetryReading reading;
+
+    reading.address = 1 + (i % BENCH_NODES);
+    reading.value = (1000 + i * 7) & 0xFFF;
+    reading.button = (i >> 4) & 1;
+    reading.batt = 3300 - (i & 0xFF);
+    reading.rssi = -40 - (int8_t)(i % 50);
+    reading.time = i / BENCH_NODES;
+
+    return reading;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool runBinary(uint32_t count, PathResult& result)
+{
+    TelemetryDecoder decoder;
+    std::vector<TelemetryRow> rows;
+
+    wire.clear();
+    wire.reserve(count * 16);
+    rows.reserve(count);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TelemetryReading reading = makeReading(i);
+        Telemetry_sendReading(&reading);
+    }
+    decoder.feed(wire.data(), wire.size(), rows);
+    result.ns = elapsedNs(start) / count;
+    result.bytes = wire.size();
+
+    if (rows.size() != count)
+    {
+        printf("binary: %zu of %u readings decoded\n", rows.size(), count);
+        return false;
+    }
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TelemetryReading reading = makeReading(i);
+        if ((rows[i].address != reading.address) || (rows[i].value != reading.value) ||
+            (rows[i].button != reading.button) || (rows[i].batt != reading.batt) ||
+            (rows[i].rssi != reading.rssi) || (rows[i].time != reading.time))
+        {
+            printf("binary: reading %u does not match\n", i);
+            return false;
+        }
+    }
+
+    /* A corrupted frame is skipped, the next one is decoded */
+    TelemetryDecoder corruptDecoder;
+    rows.clear();
+    wire[5] ^= 0x10;
+    corruptDecoder.feed(wire.data(), 2 * 16, rows);
+    if ((rows.size() != 1) || (corruptDecoder.crcErrorCount() + corruptDecoder.framingErrorCount() != 1))
+    {
+        printf("binary: corrupted frame not detected\n");
+        return false;
+    }
+
+    return true;
+}
+
+/* updateLcd() of the old ConcentratorTask.c, the part written to the UART.
+ * DisplayUart ends every Display_printf with "\r\n". */
+static void renderText(const TelemetryReading* nodes, uint8_t nodeCount, std::string& out)
+{
+    char line[64];
+
+    out += "\033[2J \033[0;0HNodes   Value   SW    RSSI\r\n";
+    for (uint8_t n = 0; n < nodeCount; n++)
+    {
+        snprintf(line, sizeof(line), "0x%02x    %04d    %d    %04d\r\n",
+                 nodes[n].address, nodes[n].value, nodes[n].button, nodes[n].rssi);
+        out += line;
+    }
+}
+
+static bool runText(uint32_t count, PathResult& result)
+{
+    TelemetryReading nodes[BENCH_NODES];
+    TelemetryReading parsed[BENCH_NODES];
+    uint8_t nodeCount = 0;
+    uint8_t parsedCount = 0;
+    std::string text;
+    bool ok = true;
+
+    text.reserve((size_t)count * 256);
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TelemetryReading reading = makeReading(i);
+        nodes[reading.address - 1] = reading;
+        if (reading.address > nodeCount)
+        {
+            nodeCount = reading.address;
+        }
+        renderText(nodes, nodeCount, text);
+    }
+
+    /* A terminal log parser: a table per clear screen, a row per line */
+    size_t pos = 0;
+    while (pos < text.size())
+    {
+        size_t end = text.find("\r\n", pos);
+        std::string line = text.substr(pos, end - pos);
+        unsigned address, button;
+        int value, rssi;
+
+        if (line.compare(0, 4, "\033[2J") == 0)
+        {
+            parsedCount = 0;
+        }
+        else if (sscanf(line.c_str(), "0x%x %d %d %d", &address, &value, &button, &rssi) == 4)
+        {
+            parsed[parsedCount].address = address;
+            parsed[parsedCount].value = value;
+            parsed[parsedCount].button = button;
+            parsed[parsedCount].rssi = rssi;
+            parsedCount++;
+        }
+        pos = end + 2;
+    }
+    result.ns = elapsedNs(start) / count;
+    result.bytes = text.size();
+
+    /* The last table holds the latest reading of every node */
+    for (uint8_t n = 0; n < BENCH_NODES; n++)
+    {
+        if ((parsed[n].address != nodes[n].address) || (parsed[n].value != nodes[n].value) ||
+            (parsed[n].button != nodes[n].button) || (parsed[n].rssi != nodes[n].rssi))
+        {
+            printf("text: node %u does not match\n", n + 1);
+            ok = false;
+        }
+    }
+
+    return ok && (parsedCount == BENCH_NODES);
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t count = (argc > 1) ? strtoul(argv[1], NULL, 0) : BENCH_DEFAULT_READINGS;
+    PathResult binary;
+    PathResult text;
+    double binaryBytes;
+    double textBytes;
+
+    Telemetry_init();
+    if (!runBinary(count, binary) || !runText(count, text))
+    {
+        return 1;
+    }
+
+    binaryBytes = (double)binary.bytes / count;
+    textBytes = (double)text.bytes / count;
+    printf("%8s %12s %16s %12s\n", "path", "bytes/rdg", "rdg/s at UART", "ns/rdg");
+    printf("%8s %12.1f %16.0f %12.1f\n", "binary", binaryBytes, BENCH_UART_BYTES_PER_S / binaryBytes, binary.ns);
+    printf("%8s %12.1f %16.0f %12.1f\n", "text", textBytes, BENCH_UART_BYTES_PER_S / textBytes, text.ns);
+
+    return (binaryBytes < textBytes) ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+/*
+ *  ======== TempConversionTest.c ========
+ *
+ *  Host test of TempConversion: every ADC reading from 0 to TEMPCONV_ADC_MAX
+ *  is converted and compared with the Beta equation of the thermistor on the
+ *  divider of TempConversion.h, worked out in floating point. Inside the
+ *  table the error must stay within TEMPCONV_TEST_MAX_ERROR, outside of it
+ *  the result must be clamped to the table ends. The conversion must be
+ *  monotonic, apply the board offset as is, and TempConversion_toAdc must
+ *  give back the reading of a temperature.
+ */
+
+/***** Includes *****/
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "TempConversion.h"
+
+
+/***** Defines *****/
+/* Error bound stated in TempConversion.h, in 0.01 C */
+#define TEMPCONV_TEST_MAX_ERROR 20
+
+/* Thermistor of the table */
+#define TEMPCONV_TEST_R25       10000.0
+#define TEMPCONV_TEST_BETA      3380.0
+#define TEMPCONV_TEST_T25       298.15
+
+
+/***** Prototypes *****/
+static double betaCentiC(uint16_t adcValue);
+
+
+/***** Function definitions *****/
+int main(void)
+{
+    uint16_t minAdc = TempConversion_toAdc(TEMPCONV_MAX_CENTI_C, 0);
+    uint16_t maxAdc = TempConversion_toAdc(TEMPCONV_MIN_CENTI_C, 0);
+    uint32_t errors = 0;
+    double maxError = 0;
+    uint16_t maxErrorAdc = 0;
+    int16_t previous = TEMPCONV_MAX_CENTI_C;
+    int16_t centiC;
+    double error;
+    uint16_t adcValue;
+    int32_t c;
+
+    for (adcValue = 0; adcValue <= TEMPCONV_ADC_MAX; adcValue++)
+    {
+        centiC = TempConversion_toCentiC(adcValue, 0);
+
+        if (centiC > previous)
+        {
+            printf("adc %u: %d above %d of the reading before\n", adcValue, centiC, previous);
+            errors++;
+        }
+        previous = centiC;
+
+        if (TempConversion_toCentiC(adcValue, -123) != centiC - 123)
+        {
+            printf("adc %u: offset not applied\n", adcValue);
+            errors++;
+        }
+
+        if ((adcValue <= minAdc) || (adcValue >= maxAdc))
+        {
+            if (centiC != ((adcValue <= minAdc) ? TEMPCONV_MAX_CENTI_C : TEMPCONV_MIN_CENTI_C))
+            {
+                printf("adc %u: %d not clamped\n", adcValue, centiC);
+                errors++;
+            }
+            continue;
+        }
+
+        error = fabs(centiC - betaCentiC(adcValue));
+        if (error > maxError)
+        {
+            maxError = error;
+            maxErrorAdc = adcValue;
+        }
+        if (error > TEMPCONV_TEST_MAX_ERROR)
+        {
+            printf("adc %u: %d, Beta equation %.1f\n", adcValue, centiC, betaCentiC(adcValue));
+            errors++;
+        }
+    }
+
+    /* A temperature must come back within the step of one ADC count */
+    for (c = TEMPCONV_MIN_CENTI_C; c <= TEMPCONV_MAX_CENTI_C; c++)
+    {
+        adcValue = TempConversion_toAdc(c, 0);
+        if ((TempConversion_toCentiC(adcValue + 1, 0) > c) || (TempConversion_toCentiC(adcValue - 1, 0) < c))
+        {
+            printf("%d: adc %u converts back to %d\n", c, adcValue, TempConversion_toCentiC(adcValue, 0));
+            errors++;
+        }
+    }
+
+    printf("table adc %u..%u, largest error %.1f (0.01 C) at adc %u, %u errors\n",
+           minAdc, maxAdc, maxError, maxErrorAdc, errors);
+
+    return (errors == 0) ? 0 : 1;
+}
+
+/* Temperature in 0.01 C of the reading by the Beta equation */
+static double betaCentiC(uint16_t adcValue)
+{
+    double volts = (double)adcValue * TEMPCONV_ADC_REF_MV / TEMPCONV_ADC_MAX;
+    double ohms = TEMPCONV_SERIES_OHMS * volts / (TEMPCONV_SUPPLY_MV - volts);
+
+    return (1.0 / (1.0 / TEMPCONV_TEST_T25 + log(ohms / TEMPCONV_TEST_R25) / TEMPCONV_TEST_BETA) -
+            273.15) * 100;
+}
@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+#
+# Runs a concentrator and three nodes on the UDP radio of the host build and
+# checks that the telemetry stream of the concentrator carries readings of
+# all three nodes, see Telemetry.h for the frame format.
+#
+# usage: network_smoke.py <concentrator> <node>
+
+import os
+import subprocess
+import sys
+import tempfile
+
+NODE_COUNT = 3
+TIME_SCALE = 10
+RUN_SECONDS = 120
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if (crc & 0x8000) else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def cobs_decode(frame):
+    out = bytearray()
+    i = 0
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame) + 1:
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code != 0xFF and i < len(frame):
+            out.append(0)
+    return bytes(out)
+
+
+def readings(stream):
+    for frame in stream.split(b"\0"):
+        record = cobs_decode(frame)
+        if record is None or len(record) != 14:
+            continue
+        if crc16(record[:12]) != (record[12] << 8 | record[13]) or record[0] != 1:
+            continue
+        yield record[1], record[2] << 8 | record[3]
+
+
+def main():
+    concentrator, node = sys.argv[1], sys.argv[2]
+    port_base = 20000 + (os.getpid() % 2000) * 16
+
+    with tempfile.TemporaryDirectory() as work:
+        uart = os.path.join(work, "uart.bin")
+        env = dict(os.environ, HOST_TIME_SCALE=str(TIME_SCALE),
+                   HOST_RADIO_PORT_BASE=str(port_base),
+                   HOST_RADIO_COUNT=str(NODE_COUNT + 1))
+
+        processes = [subprocess.Popen([concentrator], env=dict(
+            env, HOST_RADIO_ID="0", HOST_UART=uart,
+            HOST_RUN_SECONDS=str(RUN_SECONDS + 1)))]
+        for i in range(1, NODE_COUNT + 1):
+            processes.append(subprocess.Popen([node], env=dict(
+                env, HOST_RADIO_ID=str(i), HOST_RUN_SECONDS=str(RUN_SECONDS))))
+
+        for process in processes:
+            if process.wait(timeout=RUN_SECONDS) != 0:
+                print("process exited with", process.returncode)
+                return 1
+
+        with open(uart, "rb") as f:
+            counts = {}
+            for address, value in readings(f.read()):
+                if not 0 < value < 4096:
+                    print("reading out of range:", address, value)
+                    return 1
+                counts[address] = counts.get(address, 0) + 1
+
+    print("readings per node:", counts)
+    return 0 if len(counts) == NODE_COUNT else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
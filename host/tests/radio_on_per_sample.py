@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+#
+# Runs a concentrator and one node on the UDP radio of the host build, once
+# with a node that sends every reading on its own and once with the batching
+# node, and compares the node's time on air and time in Rx per reading the
+# concentrator delivered. The node prints its radio time at the exit, see
+# HOST_RADIO_STATS in EasyLinkUdp.c, and the readings are counted in the
+# telemetry stream of the concentrator like network_smoke.py does. Fails if
+# batching does not cut both per reading.
+#
+# usage: radio_on_per_sample.py <concentrator> <unbatched node> <node>
+
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+from network_smoke import readings
+
+TIME_SCALE = 10
+RUN_SECONDS = 400
+SENSOR_PERIOD_S = 120
+
+STATS = re.compile(rb"radio 1: (\d+) frames sent, tx (\d+) us, rx (\d+) us")
+
+
+def run(concentrator, node, port_base):
+    with tempfile.TemporaryDirectory() as work:
+        uart = os.path.join(work, "uart.bin")
+        env = dict(os.environ, HOST_TIME_SCALE=str(TIME_SCALE),
+                   HOST_RADIO_PORT_BASE=str(port_base), HOST_RADIO_COUNT="2",
+                   HOST_SENSOR_PERIOD_S=str(SENSOR_PERIOD_S))
+
+        gateway = subprocess.Popen([concentrator], env=dict(
+            env, HOST_RADIO_ID="0", HOST_UART=uart,
+            HOST_RUN_SECONDS=str(RUN_SECONDS + 1)))
+        sensor = subprocess.Popen([node], stderr=subprocess.PIPE, env=dict(
+            env, HOST_RADIO_ID="1", HOST_RADIO_STATS="1",
+            HOST_RUN_SECONDS=str(RUN_SECONDS)))
+
+        _, errors = sensor.communicate(timeout=RUN_SECONDS)
+        if sensor.returncode != 0 or gateway.wait(timeout=RUN_SECONDS) != 0:
+            print("process exited with", sensor.returncode, gateway.returncode)
+            return None
+
+        stats = STATS.search(errors)
+        with open(uart, "rb") as f:
+            count = sum(1 for _ in readings(f.read()))
+        if stats is None or count == 0:
+            print("no radio stats or no readings")
+            return None
+
+        frames, tx_us, rx_us = (int(x) for x in stats.groups())
+        return frames, tx_us, rx_us, count
+
+
+def main():
+    concentrator = sys.argv[1]
+    port_base = 20000 + (os.getpid() % 2000) * 16
+    results = {}
+
+    for name, node in (("unbatched", sys.argv[2]), ("batched", sys.argv[3])):
+        result = run(concentrator, node, port_base)
+        if result is None:
+            return 1
+        frames, tx_us, rx_us, count = result
+        results[name] = (tx_us / count, (tx_us + rx_us) / count)
+        print("%s: %d readings, %d frames, %.0f us on air and %.0f us radio on"
+              " per reading" % (name, count, frames, results[name][0],
+                                results[name][1]))
+
+    if results["batched"][0] >= results["unbatched"][0]:
+        print("batching does not cut the time on air per reading")
+        return 1
+    if results["batched"][1] >= results["unbatched"][1]:
+        print("batching does not cut the radio on time per reading")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+/*
+ *  ======== TelemetryDecoder.cpp ========
+ */
+
+/***** Includes *****/
+#include "TelemetryDecoder.h"
+
+
+/***** Defines *****/
+#define TELEMETRY_RECORD_READING 1
+
+
+/***** Function definitions *****/
+size_t TelemetryDecoder::feed(const uint8_t* data, size_t length, std::vector<TelemetryRow>& rows)
+{
+    size_t added = 0;
+    TelemetryRow row;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (data[i] != 0)
+        {
+            /* Too long for a reading, drop it at its delimiter */
+            if (frameLength < sizeof(frame))
+            {
+                frame[frameLength++] = data[i];
+            }
+            else
+            {
+                overlong = true;
+            }
+            continue;
+        }
+
+        /* A 0x00 ends the frame, empty frames are just extra delimiters */
+        if ((frameLength != 0) || overlong)
+        {
+            if (!overlong && decodeFrame(row))
+            {
+                rows.push_back(row);
+                added++;
+            }
+            else if (overlong)
+            {
+                framingErrors++;
+            }
+        }
+        frameLength = 0;
+        overlong = false;
+    }
+
+    return added;
+}
+
+/* COBS decodes the frame in progress and checks it */
+bool TelemetryDecoder::decodeFrame(TelemetryRow& row)
+{
+    uint8_t record[RecordSize + CrcSize];
+    size_t recordLength = 0;
+    size_t pos = 0;
+
+    while (pos < frameLength)
+    {
+        uint8_t code = frame[pos++];
+
+        if (pos + code - 1 > frameLength)
+        {
+            framingErrors++;
+            return false;
+        }
+        for (uint8_t i = 1; i < code; i++)
+        {
+            if (recordLength == sizeof(record))
+            {
+                framingErrors++;
+                return false;
+            }
+            record[recordLength++] = frame[pos++];
+        }
+
+        /* Every group but the last and 0xFF groups stand for a 0x00 */
+        if ((code != 0xFF) && (pos < frameLength))
+        {
+            if (recordLength == sizeof(record))
+            {
+                framingErrors++;
+                return false;
+            }
+            record[recordLength++] = 0;
+        }
+    }
+
+    if ((recordLength != sizeof(record)) || (record[0] != TELEMETRY_RECORD_READING))
+    {
+        framingErrors++;
+        return false;
+    }
+
+    if (crc16(record, RecordSize) != ((record[12] << 8) | record[13]))
+    {
+        crcErrors++;
+        return false;
+    }
+
+    row.address = record[1];
+    row.value = (record[2] << 8) | record[3];
+    row.button = record[4];
+    row.batt = (record[5] << 8) | record[6];
+    row.rssi = (int8_t)record[7];
+    row.time = ((uint32_t)record[8] << 24) | ((uint32_t)record[9] << 16) | (record[10] << 8) | record[11];
+    frames++;
+
+    return true;
+}
+
+/* CRC-16/CCITT-FALSE, as in Telemetry.c */
+uint16_t TelemetryDecoder::crc16(const uint8_t* data, size_t length)
+{
+    uint16_t crc = 0xFFFF;
+
+    while (length--)
+    {
+        crc ^= (uint16_t)(*data++) << 8;
+        for (uint8_t i = 0; i < 8; i++)
+        {
+            crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+        }
+    }
+
+    return crc;
+}
@@ -0,0 +1,58 @@
+/*
+ *  ======== TelemetryDecoder.h ========
+ *
+ *  Host side decoder of the telemetry stream of the concentrator, see
+ *  Telemetry.h for the frame format.
+ *
+ *  Bytes are fed in as they come from the serial port, in chunks of any
+ *  size. Every complete frame with a valid CRC becomes a TelemetryRow. Frames
+ *  that fail COBS decoding, have the wrong length or a bad CRC are counted
+ *  and skipped, decoding resynchronises on the next 0x00.
+ */
+
+#ifndef TELEMETRYDECODER_H_
+#define TELEMETRYDECODER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct TelemetryRow {
+    uint8_t address;
+    uint16_t value;
+    uint8_t button;
+    uint16_t batt;
+    int8_t rssi;
+    uint32_t time;
+};
+
+class TelemetryDecoder {
+public:
+    /* Record and CRC, as in Telemetry.c */
+    static const size_t RecordSize = 12;
+    static const size_t CrcSize = 2;
+
+    /* Decodes the bytes, appends the complete readings to rows and returns
+     * the number appended */
+    size_t feed(const uint8_t* data, size_t length, std::vector<TelemetryRow>& rows);
+
+    uint32_t frameCount() const { return frames; }
+    uint32_t crcErrorCount() const { return crcErrors; }
+    uint32_t framingErrorCount() const { return framingErrors; }
+
+    static uint16_t crc16(const uint8_t* data, size_t length);
+
+private:
+    bool decodeFrame(TelemetryRow& row);
+
+    /* Encoded bytes of the frame in progress, a frame never exceeds this */
+    uint8_t frame[RecordSize + CrcSize + 2];
+    size_t frameLength = 0;
+    bool overlong = false;
+
+    uint32_t frames = 0;
+    uint32_t crcErrors = 0;
+    uint32_t framingErrors = 0;
+};
+
+#endif /* TELEMETRYDECODER_H_ */
@@ -0,0 +1,51 @@
+/*
+ *  ======== TelemetryDump.cpp ========
+ *
+ *  Prints the readings of a telemetry stream as CSV rows, from a file or a
+ *  serial port set to 115200 baud raw, or from stdin.
+ *
+ *  usage: TelemetryDump [file]
+ */
+
+/***** Includes *****/
+#include <cstdio>
+
+#include "TelemetryDecoder.h"
+
+
+/***** Function definitions *****/
+int main(int argc, char** argv)
+{
+    FILE* in = stdin;
+    TelemetryDecoder decoder;
+    std::vector<TelemetryRow> rows;
+    uint8_t buffer[256];
+    size_t length;
+
+    if (argc > 1)
+    {
+        in = fopen(argv[1], "rb");
+        if (in == NULL)
+        {
+            perror(argv[1]);
+            return 1;
+        }
+    }
+
+    printf("time,address,value,button,batt,rssi\n");
+    while ((length = fread(buffer, 1, sizeof(buffer), in)) > 0)
+    {
+        rows.clear();
+        decoder.feed(buffer, length, rows);
+        for (const TelemetryRow& row : rows)
+        {
+            printf("%u,%u,%u,%u,%u,%d\n", row.time, row.address, row.value, row.button, row.batt, row.rssi);
+        }
+        fflush(stdout);
+    }
+
+    fprintf(stderr, "%u readings, %u CRC errors, %u framing errors\n",
+            decoder.frameCount(), decoder.crcErrorCount(), decoder.framingErrorCount());
+
+    return 0;
+}